@@ -35,8 +35,8 @@
 #include <string.h>
 #include <stdint.h>
 #include "GlobalState.h"
-#include "checkpoint/ProcSelfMaps.h"
-#include "checkpoint/ProcMapsArea.h"
+#include "checkpoint/ProcMapsCache.h"
+#include "GameHacks.h"
 #include "../shared/SharedConfig.h"
 
 extern char**environ;
@@ -50,6 +50,9 @@ static uint64_t timecall_count;
 
 void BusyLoopDetection::reset()
 {
+    /* Mappings may have changed during the frame */
+    ProcMapsCache::invalidate();
+
     if (!shared_config.busyloop_detection)
         return;
 
@@ -174,19 +177,15 @@ void BusyLoopDetection::increment(int type)
                 oss << " ";
             }
         }
-        else {
+        else if (GameHacks::hashAnonymousCode()) {
             /* Executed code comes from some anonymous mapping, which is often
              * the sign of JIT execution. For now, we trust that the code always
              * has the same offset from the beginning of the mapped section. */
 
             /* Find the corresponding memory area */
-            ProcSelfMaps procSelfMaps;
-            Area area;
-            while (procSelfMaps.getNextArea(&area)) {
-                if ((addresses[cnt] >= area.addr) && (addresses[cnt] < area.endAddr)) {
-                    toHash(reinterpret_cast<intptr_t>(addresses[cnt]) - reinterpret_cast<intptr_t>(area.addr));
-                    break;
-                }
+            uintptr_t areaStart, areaEnd;
+            if (ProcMapsCache::findArea(reinterpret_cast<uintptr_t>(addresses[cnt]), &areaStart, &areaEnd)) {
+                toHash(reinterpret_cast<uintptr_t>(addresses[cnt]) - areaStart);
             }
         }
         if (shared_config.time_trace) {
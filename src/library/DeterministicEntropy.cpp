@@ -0,0 +1,184 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DeterministicEntropy.h"
+#include "global.h" // shared_config
+#include "GlobalState.h"
+#include <cstring>
+#include <mutex>
+#include <signal.h>
+
+namespace libtas {
+
+/* State of one ChaCha stream. We only keep the last generated block, the
+ * position is enough to regenerate everything else. */
+struct ChaChaStream {
+    uint64_t pos = 0;
+    uint64_t block_index = UINT64_MAX;
+    uint8_t block[64];
+};
+
+static ChaChaStream streams[DeterministicEntropy::STREAM_COUNT];
+
+/* Key derived from the seed, and the seed it was derived from */
+static uint32_t key[8];
+static uint64_t key_seed = 0;
+static bool key_valid = false;
+
+static std::mutex mutex;
+
+/* Lock the state. The /dev/urandom pipe is refilled from a SIGIO handler, so
+ * we block SIGIO while holding the mutex, otherwise the handler could
+ * interrupt the thread that owns it and deadlock. */
+class EntropyLock {
+    public:
+        EntropyLock()
+        {
+            sigset_t mask;
+            sigemptyset(&mask);
+            sigaddset(&mask, SIGIO);
+            NATIVECALL(pthread_sigmask(SIG_BLOCK, &mask, &old_mask));
+            mutex.lock();
+        }
+
+        ~EntropyLock()
+        {
+            mutex.unlock();
+            NATIVECALL(pthread_sigmask(SIG_SETMASK, &old_mask, nullptr));
+        }
+
+    private:
+        sigset_t old_mask;
+};
+
+#define ROTL32(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+#define QUARTERROUND(a, b, c, d) \
+    a += b; d ^= a; d = ROTL32(d, 16); \
+    c += d; b ^= c; b = ROTL32(b, 12); \
+    a += b; d ^= a; d = ROTL32(d, 8); \
+    c += d; b ^= c; b = ROTL32(b, 7);
+
+/* Original ChaCha20 block function, with a 64-bit block counter and a 64-bit
+ * nonce which holds the stream index */
+static void chachaBlock(uint64_t counter, uint64_t nonce, uint8_t out[64])
+{
+    uint32_t in[16] = {
+        0x61707865, 0x3320646e, 0x79622d32, 0x6b206574, // "expand 32-byte k"
+        key[0], key[1], key[2], key[3], key[4], key[5], key[6], key[7],
+        static_cast<uint32_t>(counter), static_cast<uint32_t>(counter >> 32),
+        static_cast<uint32_t>(nonce), static_cast<uint32_t>(nonce >> 32)
+    };
+
+    uint32_t x[16];
+    memcpy(x, in, sizeof(x));
+
+    for (int i = 0; i < 10; i++) {
+        QUARTERROUND(x[0], x[4], x[8], x[12])
+        QUARTERROUND(x[1], x[5], x[9], x[13])
+        QUARTERROUND(x[2], x[6], x[10], x[14])
+        QUARTERROUND(x[3], x[7], x[11], x[15])
+        QUARTERROUND(x[0], x[5], x[10], x[15])
+        QUARTERROUND(x[1], x[6], x[11], x[12])
+        QUARTERROUND(x[2], x[7], x[8], x[13])
+        QUARTERROUND(x[3], x[4], x[9], x[14])
+    }
+
+    /* Output in little-endian order, so that the stream does not depend on
+     * the host */
+    for (int i = 0; i < 16; i++) {
+        uint32_t v = x[i] + in[i];
+        out[4*i] = v;
+        out[4*i+1] = v >> 8;
+        out[4*i+2] = v >> 16;
+        out[4*i+3] = v >> 24;
+    }
+}
+
+/* Build the key from the seed. The seed may only be received from the program
+ * after some early calls, so we check it each time. */
+static void updateKey()
+{
+    if (key_valid && (key_seed == shared_config.prng_seed))
+        return;
+
+    key_seed = shared_config.prng_seed;
+    key[0] = static_cast<uint32_t>(key_seed);
+    key[1] = static_cast<uint32_t>(key_seed >> 32);
+    /* Fixed words: "libTAS entropy source!!!" */
+    key[2] = 0x5462696c;
+    key[3] = 0x65205341;
+    key[4] = 0x6f72746e;
+    key[5] = 0x73207970;
+    key[6] = 0x6372756f;
+    key[7] = 0x21212165;
+    key_valid = true;
+
+    /* Cached blocks were generated with the old key */
+    for (ChaChaStream& s : streams)
+        s.block_index = UINT64_MAX;
+}
+
+void DeterministicEntropy::getBytes(int stream, void* buf, size_t len)
+{
+    EntropyLock lock;
+    updateKey();
+
+    ChaChaStream& s = streams[stream];
+    uint8_t* out = static_cast<uint8_t*>(buf);
+
+    while (len > 0) {
+        uint64_t index = s.pos / 64;
+        size_t offset = s.pos % 64;
+
+        if (s.block_index != index) {
+            chachaBlock(index, stream, s.block);
+            s.block_index = index;
+        }
+
+        size_t chunk = 64 - offset;
+        if (chunk > len)
+            chunk = len;
+
+        memcpy(out, s.block + offset, chunk);
+        out += chunk;
+        len -= chunk;
+        s.pos += chunk;
+    }
+}
+
+uint32_t DeterministicEntropy::getUInt32(int stream)
+{
+    uint8_t b[4];
+    getBytes(stream, b, 4);
+    return b[0] | (b[1] << 8) | (b[2] << 16) | (static_cast<uint32_t>(b[3]) << 24);
+}
+
+uint64_t DeterministicEntropy::tell(int stream)
+{
+    EntropyLock lock;
+    return streams[stream].pos;
+}
+
+void DeterministicEntropy::seek(int stream, uint64_t pos)
+{
+    EntropyLock lock;
+    streams[stream].pos = pos;
+}
+
+}
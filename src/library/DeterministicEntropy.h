@@ -0,0 +1,64 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBTAS_DETERMINISTICENTROPY_H_INCL
+#define LIBTAS_DETERMINISTICENTROPY_H_INCL
+
+#include <cstdint>
+#include <cstddef>
+
+/* Deterministic source of entropy, which replaces every source of true
+ * randomness the game can access (getrandom, /dev/urandom, arc4random...).
+ *
+ * Bytes are generated by a ChaCha20 stream cipher keyed from
+ * shared_config.prng_seed, which is stored in the movie. The state is only
+ * made of a few words in our memory, so it is naturally saved and restored
+ * with savestates. Because ChaCha is a counter-based generator, any position
+ * of a stream can be reached in constant time, which makes reseeding and
+ * rewinding cheap.
+ */
+
+namespace libtas {
+namespace DeterministicEntropy {
+
+/* Independent streams, so that the order in which one consumer draws bytes
+ * does not change what is served to another one */
+enum Stream {
+    STREAM_GETRANDOM = 0, // getrandom(), getentropy() and arc4random family
+    STREAM_URANDOM_FD = 1, // content of the /dev/urandom pipe
+    STREAM_URANDOM_FILE = 2, // /dev/urandom FILE stream
+    STREAM_COUNT
+};
+
+/* Fill the buffer with the next bytes of the stream */
+void getBytes(int stream, void* buf, size_t len);
+
+/* Return the next 32-bit word of the stream */
+uint32_t getUInt32(int stream);
+
+/* Return the current position (in bytes) of the stream */
+uint64_t tell(int stream);
+
+/* Move the stream to an absolute position (in bytes) */
+void seek(int stream, uint64_t pos);
+
+}
+}
+
+#endif
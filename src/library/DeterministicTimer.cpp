@@ -28,6 +28,7 @@
 #include "renderhud/RenderHUD.h"
 #include "global.h" // shared_config
 #include "BusyLoopDetection.h"
+#include "VirtualTimers.h"
 
 #include <sched.h> // sched_yield()
 #include <stdint.h>
@@ -173,6 +174,9 @@ void DeterministicTimer::addDelay(struct timespec delayTicks)
             frameBoundary(dummy_draw);
     #endif
         }
+
+        /* Deliver the expirations of game timers during the delay */
+        VirtualTimers::update(false);
     }
 }
 
@@ -0,0 +1,81 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FrameProfiler.h"
+#include "global.h" // shared_config
+#include "GlobalState.h" // NATIVECALL
+#include "timewrappers.h" // clock_gettime
+#include "../shared/sockethelpers.h"
+#include "../shared/messages.h"
+
+namespace libtas {
+
+/* Stages of the current and of the previous frame boundary */
+static FrameProfile current;
+static FrameProfile previous;
+
+/* Time of the last mark in nanoseconds, or 0 if not measuring */
+static uint64_t last_mark = 0;
+
+static uint64_t now()
+{
+    struct timespec ts;
+    NATIVECALL(clock_gettime(CLOCK_MONOTONIC, &ts));
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+void FrameProfiler::begin()
+{
+    if (!(shared_config.debug_state & SharedConfig::DEBUG_FRAME_PROFILE)) {
+        last_mark = 0;
+        return;
+    }
+
+    mark(FrameProfile::GAME);
+    previous = current;
+    current = FrameProfile();
+}
+
+void FrameProfiler::mark(FrameProfile::Stage stage)
+{
+    if (!(shared_config.debug_state & SharedConfig::DEBUG_FRAME_PROFILE))
+        return;
+
+    uint64_t t = now();
+    if (last_mark)
+        current.ns[stage] += t - last_mark;
+    last_mark = t;
+}
+
+void FrameProfiler::restart()
+{
+    if (last_mark)
+        last_mark = now();
+}
+
+void FrameProfiler::send()
+{
+    if (!(shared_config.debug_state & SharedConfig::DEBUG_FRAME_PROFILE))
+        return;
+
+    sendMessage(MSGB_FRAME_PROFILE);
+    sendData(&previous, sizeof(FrameProfile));
+}
+
+}
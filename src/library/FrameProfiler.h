@@ -0,0 +1,55 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBTAS_FRAMEPROFILER_H_INCL
+#define LIBTAS_FRAMEPROFILER_H_INCL
+
+#include "../shared/FrameProfile.h"
+
+/* Measure the real time spent in each stage of the frame boundary, when
+ * the DEBUG_FRAME_PROFILE flag is set. This is used to benchmark the
+ * frame boundary itself, independently of the game.
+ *
+ * Each call to mark() adds the time elapsed since the previous mark to a
+ * stage. Stages of a full frame boundary, followed by the game code until
+ * the next frame boundary, are sent at the beginning of the next one.
+ */
+
+namespace libtas {
+namespace FrameProfiler {
+
+/* Start a new frame boundary, attributing the time since the end of the
+ * previous one to the game */
+void begin();
+
+/* Add the time since the previous mark to a stage */
+void mark(FrameProfile::Stage stage);
+
+/* Restart measuring from now, discarding the time since the previous mark.
+ * Used after loading a state, where the previous mark is from the past. */
+void restart();
+
+/* Send the stages of the previous frame boundary. Must be called with the
+ * socket locked. */
+void send();
+
+}
+}
+
+#endif
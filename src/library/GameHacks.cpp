@@ -19,20 +19,282 @@
 
 #include "GameHacks.h"
 #include "logging.h"
+#include "global.h"
+#include "GlobalState.h"
+#include "checkpoint/ThreadManager.h"
+#include "checkpoint/ThreadInfo.h"
+#include "../shared/SharedConfig.h"
+#include "../shared/GameInfo.h"
+
+#include <link.h>
+#include <string>
+#include <string.h>
+#include <unistd.h>
+#include <limits.h>
 
 namespace libtas {
 
-static bool unity = false;
+static int engine = GameInfo::ENGINE_UNKNOWN;
+
+/* The engine was guessed from a marker that is shared with another engine */
+static bool weak_detection = false;
+
+/* Unity was detected from the Mono symbol, which is what the Unity sleep
+ * hack always used when the engine profile is not applied */
+static bool unity_mono_symbol = false;
+
+static const char* const no_threads[] = {nullptr};
+static const long no_sleeps[] = {0};
+
+/* Unity waits for its loading threads by sleeping 9999 usec in a loop */
+static const char* const unity_loader_threads[] = {"Loading.", "UnityPreload", nullptr};
+static const long unity_sleeps[] = {9999000, 0};
+
+/* Only the Unity profiles have loader thread, sleep and wait policies for
+ * now. For the other engines, the profile only tells if the game runs code
+ * generated at runtime (Mono, .NET, Godot scripts or V8), which the busy
+ * loop detection must hash. Their detection is otherwise only reported to
+ * the program. */
+static const GameHacks::EngineProfile profiles[GameInfo::ENGINE_COUNT] = {
+    {GameInfo::ENGINE_UNKNOWN, "unknown", no_threads, no_sleeps, true, -1},
+    {GameInfo::ENGINE_UNITY_MONO, "Unity (Mono)", unity_loader_threads, unity_sleeps, true, SharedConfig::WAIT_FINITE},
+    {GameInfo::ENGINE_UNITY_IL2CPP, "Unity (IL2CPP)", unity_loader_threads, unity_sleeps, false, SharedConfig::WAIT_FINITE},
+    {GameInfo::ENGINE_UNREAL, "Unreal Engine", no_threads, no_sleeps, false, -1},
+    {GameInfo::ENGINE_GODOT, "Godot", no_threads, no_sleeps, true, -1},
+    {GameInfo::ENGINE_GAMEMAKER, "GameMaker", no_threads, no_sleeps, false, -1},
+    {GameInfo::ENGINE_XNA_FNA, "XNA/FNA", no_threads, no_sleeps, true, -1},
+    {GameInfo::ENGINE_RPGMAKER, "RPG Maker", no_threads, no_sleeps, true, -1},
+    {GameInfo::ENGINE_RENPY, "Ren'Py", no_threads, no_sleeps, false, -1},
+};
+
+struct EngineMarker {
+    const char* pattern;
+    int engine;
+    bool weak;
+};
+
+/* Libraries, matched anywhere in the file name */
+static const EngineMarker library_markers[] = {
+    {"GameAssembly.so", GameInfo::ENGINE_UNITY_IL2CPP, false},
+    {"libmonobdwgc-2.0.so", GameInfo::ENGINE_UNITY_MONO, false},
+    /* Also loaded by IL2CPP games, before GameAssembly.so */
+    {"UnityPlayer.so", GameInfo::ENGINE_UNITY_MONO, true},
+    {"libFNA3D.so", GameInfo::ENGINE_XNA_FNA, false},
+    {"libmojoshader.so", GameInfo::ENGINE_XNA_FNA, false},
+    {"libUE4", GameInfo::ENGINE_UNREAL, false},
+    {"libUnreal", GameInfo::ENGINE_UNREAL, false},
+    {"libgodot", GameInfo::ENGINE_GODOT, false},
+    {"librenpython", GameInfo::ENGINE_RENPY, false},
+    /* NW.js, used by RPG Maker MV and MZ but also by other games */
+    {"libnode.so", GameInfo::ENGINE_RPGMAKER, true},
+    {nullptr, 0, false}
+};
+
+/* Executable names */
+static const EngineMarker executable_markers[] = {
+    {"-Linux-Shipping", GameInfo::ENGINE_UNREAL, false},
+    {"-Linux-Test", GameInfo::ENGINE_UNREAL, false},
+    {"UE4Game", GameInfo::ENGINE_UNREAL, false},
+    {"godot", GameInfo::ENGINE_GODOT, false},
+    {"renpy", GameInfo::ENGINE_RENPY, false},
+    {nullptr, 0, false}
+};
+
+/* Data files, relative to the executable directory */
+static const EngineMarker file_markers[] = {
+    {"GameAssembly.so", GameInfo::ENGINE_UNITY_IL2CPP, false},
+    {"assets/game.unx", GameInfo::ENGINE_GAMEMAKER, false},
+    {"game.unx", GameInfo::ENGINE_GAMEMAKER, false},
+    {"www/js/rpg_core.js", GameInfo::ENGINE_RPGMAKER, false},
+    {"js/rmmz_core.js", GameInfo::ENGINE_RPGMAKER, false},
+    {"../../renpy", GameInfo::ENGINE_RENPY, false},
+    {nullptr, 0, false}
+};
+
+/* Symbols looked up by the game */
+static const EngineMarker symbol_markers[] = {
+    {"mono_unity_liveness_allocate_struct", GameInfo::ENGINE_UNITY_MONO, false},
+    {"il2cpp_init", GameInfo::ENGINE_UNITY_IL2CPP, false},
+    {"godot_gdnative_init", GameInfo::ENGINE_GODOT, false},
+    {nullptr, 0, false}
+};
+
+void GameHacks::setEngine(int new_engine, bool weak)
+{
+    if (new_engine == engine) {
+        if (!weak)
+            weak_detection = false;
+        return;
+    }
+
+    /* Only a certain detection can replace a guess */
+    if ((engine != GameInfo::ENGINE_UNKNOWN) && (weak || !weak_detection))
+        return;
+
+    engine = new_engine;
+    weak_detection = weak;
+
+    debuglogstdio(LCF_HOOK, "   detected %s engine", profiles[engine].name);
+
+    game_info.engine = engine;
+    game_info.tosend = true;
+}
+
+const GameHacks::EngineProfile* GameHacks::profile()
+{
+    return &profiles[engine];
+}
+
+static void detectMarkers(const EngineMarker* markers, const char* name, bool (*match)(const char*, const char*))
+{
+    for (const EngineMarker* m = markers; m->pattern; m++) {
+        if (match(name, m->pattern))
+            GameHacks::setEngine(m->engine, m->weak);
+    }
+}
+
+static bool matchSubstring(const char* name, const char* pattern)
+{
+    return strstr(name, pattern) != nullptr;
+}
+
+static bool matchExact(const char* name, const char* pattern)
+{
+    return strcmp(name, pattern) == 0;
+}
+
+static int detectLoadedLibrary(struct dl_phdr_info *info, size_t size, void *data)
+{
+    if (info->dlpi_name && info->dlpi_name[0])
+        GameHacks::detectLibrary(info->dlpi_name);
+    return 0;
+}
+
+void GameHacks::detectAtStartup()
+{
+    /* Libraries that the executable is linked to */
+    dl_iterate_phdr(detectLoadedLibrary, nullptr);
+
+    char exe[PATH_MAX];
+    ssize_t len;
+    NATIVECALL(len = readlink("/proc/self/exe", exe, PATH_MAX-1));
+    if (len <= 0)
+        return;
+    exe[len] = '\0';
+
+    std::string exepath(exe);
+    size_t sep = exepath.find_last_of('/');
+    std::string dir = exepath.substr(0, sep + 1);
+    std::string exename = exepath.substr(sep + 1);
+
+    detectMarkers(executable_markers, exename.c_str(), matchSubstring);
+
+    for (const EngineMarker* m = file_markers; m->pattern; m++) {
+        int ret;
+        NATIVECALL(ret = access((dir + m->pattern).c_str(), F_OK));
+        if (ret == 0)
+            setEngine(m->engine, m->weak);
+    }
+
+    /* Godot stores the game data in a pck file named after the executable */
+    std::string pck = dir + exename.substr(0, exename.find_last_of('.')) + ".pck";
+    int ret;
+    NATIVECALL(ret = access(pck.c_str(), F_OK));
+    if (ret == 0)
+        setEngine(GameInfo::ENGINE_GODOT, false);
+}
+
+void GameHacks::detectLibrary(const char* file)
+{
+    if (!file)
+        return;
+
+    detectMarkers(library_markers, file, matchSubstring);
+}
+
+void GameHacks::detectSymbol(const char* symbol)
+{
+    if (strcmp(symbol, "mono_unity_liveness_allocate_struct") == 0)
+        unity_mono_symbol = true;
+
+    detectMarkers(symbol_markers, symbol, matchExact);
+}
 
-void GameHacks::setUnity()
+int GameHacks::getEngine()
 {
-    debuglog(LCF_HOOK, "   detected Unity engine");
-    unity = true;
+    return engine;
 }
 
 bool GameHacks::isUnity()
 {
-    return unity;
+    return (engine == GameInfo::ENGINE_UNITY_MONO) || (engine == GameInfo::ENGINE_UNITY_IL2CPP);
+}
+
+void GameHacks::checkLoaderThread(pthread_t thread, const char* name)
+{
+    for (const char* const* l = profile()->loader_threads; *l; l++) {
+        if (strncmp(name, *l, strlen(*l)) == 0) {
+            ThreadInfo* th = ThreadManager::getThread(thread);
+            if (th) {
+                debuglogstdio(LCF_THREAD, "   thread %s is a %s loader thread", name, profile()->name);
+                th->loader = true;
+            }
+            return;
+        }
+    }
+}
+
+bool GameHacks::isPassthroughSleep(const struct timespec& ts)
+{
+    if (ts.tv_sec != 0)
+        return false;
+
+    if (!shared_config.engine_profile)
+        return unity_mono_symbol && (ts.tv_nsec == 9999000);
+
+    const EngineProfile* p = profile();
+
+    bool listed = false;
+    for (const long* s = p->passthrough_sleeps; *s; s++) {
+        if (ts.tv_nsec == *s) {
+            listed = true;
+            break;
+        }
+    }
+
+    if (!listed)
+        return false;
+
+    if (!p->loader_threads[0])
+        return true;
+
+    bool loading = false;
+    ThreadManager::lockList();
+    for (ThreadInfo* th = ThreadManager::getThreadList(); th != nullptr; th = th->next) {
+        if (th->loader && (th->state == ThreadInfo::ST_RUNNING)) {
+            loading = true;
+            break;
+        }
+    }
+    ThreadManager::unlockList();
+
+    return loading;
+}
+
+bool GameHacks::hashAnonymousCode()
+{
+    if (!shared_config.engine_profile)
+        return true;
+
+    return profile()->hash_anonymous_code;
+}
+
+int GameHacks::waitTimeout()
+{
+    if (shared_config.engine_profile && (profile()->wait_timeout >= 0))
+        return profile()->wait_timeout;
+
+    return shared_config.wait_timeout;
 }
 
 }
@@ -20,14 +20,77 @@
 #ifndef LIBTAS_GAMEHACKS_H_INCLUDED
 #define LIBTAS_GAMEHACKS_H_INCLUDED
 
+#include <time.h>
+#include <pthread.h>
+
 namespace libtas {
 
 class GameHacks
 {
     public:
-        static void setUnity();
+        /* Policies that work well for games made with an engine. They are
+         * only applied when the engine profile option is enabled, so that
+         * the detection alone does not change how existing movies sync. */
+        struct EngineProfile {
+            /* Engine, from GameInfo::Engine */
+            int engine;
+
+            /* Name shown in the logs */
+            const char* name;
+
+            /* Prefixes of the names of threads that only load resources,
+             * terminated by nullptr */
+            const char* const* loader_threads;
+
+            /* Durations (in nsec) of main thread sleeps that only wait for
+             * loader threads, and are not added to the timer, terminated
+             * by 0. If the profile has loader threads, the sleeps are only
+             * skipped while one of them is running. */
+            const long* passthrough_sleeps;
+
+            /* Hash code from anonymous mappings (JIT code) in busy loop
+             * detection. Engines without JIT only have noise there. */
+            bool hash_anonymous_code;
+
+            /* Wait mode from SharedConfig::WaitType, or -1 to keep the
+             * user setting */
+            int wait_timeout;
+        };
+
+        /* Detect the engine from the executable, the libraries that are
+         * already loaded and the data files next to the executable */
+        static void detectAtStartup();
+
+        /* Detect the engine from a library that the game loads */
+        static void detectLibrary(const char* file);
+
+        /* Detect the engine from a symbol that the game looks up */
+        static void detectSymbol(const char* symbol);
+
+        static int getEngine();
 
         static bool isUnity();
+
+        /* Check the name of a thread against the loader threads of the
+         * profile, and flag the thread */
+        static void checkLoaderThread(pthread_t thread, const char* name);
+
+        /* Returns if a sleep from the main thread must not be added to
+         * the timer */
+        static bool isPassthroughSleep(const struct timespec& ts);
+
+        /* Returns if busy loop detection must hash anonymous code */
+        static bool hashAnonymousCode();
+
+        /* Returns the wait mode to use, from the profile or the user */
+        static int waitTimeout();
+
+        /* Set the detected engine. A weak detection is only a guess, and can
+         * be replaced by another detection */
+        static void setEngine(int engine, bool weak);
+
+    private:
+        static const EngineProfile* profile();
 };
 
 }
@@ -0,0 +1,89 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LaunchTemplate.h"
+#include "logging.h"
+#include "GlobalState.h"
+#include "../shared/sockethelpers.h"
+#include <cstdlib>
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <sys/socket.h>
+
+namespace libtas {
+
+void LaunchTemplate::serve()
+{
+    char* templatestr;
+    NATIVECALL(templatestr = getenv("LIBTAS_LAUNCH_TEMPLATE"));
+    if (!templatestr || (templatestr[0] != '1'))
+        return;
+
+    /* Processes spawned by the game must not become templates */
+    NATIVECALL(unsetenv("LIBTAS_LAUNCH_TEMPLATE"));
+
+    int listen_fd = initTemplateSocket();
+    if (listen_fd < 0) {
+        debuglogstdio(LCF_ERROR, "Could not create the launch template socket, starting the game normally");
+        return;
+    }
+
+    /* Let the system reap the game processes, so that the program can check
+     * that a game process is gone using its pid */
+    struct sigaction sa, old_sa;
+    sa.sa_handler = SIG_IGN;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = 0;
+    NATIVECALL(sigaction(SIGCHLD, &sa, &old_sa));
+
+    pid_t pids[2];
+    NATIVECALL(pids[0] = getpid());
+    debuglogstdio(LCF_INFO, "Waiting for fork requests as launch template %d", pids[0]);
+
+    while (true) {
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR)
+                continue;
+            debuglogstdio(LCF_ERROR, "Launch template could not accept a connection");
+            _exit(1);
+        }
+
+        NATIVECALL(pids[1] = fork());
+
+        if (pids[1] == 0) {
+            /* We are the new game process */
+            close(fd);
+            close(listen_fd);
+            NATIVECALL(sigaction(SIGCHLD, &old_sa, nullptr));
+            return;
+        }
+
+        if (pids[1] < 0) {
+            debuglogstdio(LCF_ERROR, "Launch template could not fork");
+        }
+        else {
+            send(fd, pids, sizeof(pids), 0);
+        }
+        close(fd);
+    }
+}
+
+}
@@ -0,0 +1,37 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBTAS_LAUNCHTEMPLATE_H_INCL
+#define LIBTAS_LAUNCHTEMPLATE_H_INCL
+
+namespace libtas {
+namespace LaunchTemplate {
+
+/* If the program asked the game to be started as a launch template, the
+ * process stops here before reaching the game main, and waits for requests
+ * from the program. Each request forks a new process which returns from this
+ * function and initializes as a regular game process, so that game restarts
+ * skip the process execution and dynamic loading. The template process itself
+ * never returns. */
+void serve();
+
+}
+}
+
+#endif
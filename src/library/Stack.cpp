@@ -19,8 +19,7 @@
 
 #include "Stack.h"
 #include "logging.h"
-#include "checkpoint/ProcSelfMaps.h"
-#include "checkpoint/ProcMapsArea.h"
+#include "checkpoint/ProcMapsCache.h"
 #include <sys/resource.h>
 #include <alloca.h>
 
@@ -45,50 +44,30 @@ void Stack::grow()
     }
 
     /* Find the current stack area */
-    ProcSelfMaps procSelfMaps;
-    Area stackArea;
-    uintptr_t stackPointer = reinterpret_cast<uintptr_t>(&stackArea);
-    while (procSelfMaps.getNextArea(&stackArea)) {
-        if ((stackPointer >= reinterpret_cast<uintptr_t>(stackArea.addr)) && (stackPointer < reinterpret_cast<uintptr_t>(stackArea.endAddr))) {
-            break;
-        }
-    }
-
-    /* Check if we found the stack */
-    if (!stackArea.addr) {
+    uintptr_t stackPointer = reinterpret_cast<uintptr_t>(&stackSize);
+    uintptr_t stackStart, stackEnd;
+    if (!ProcMapsCache::findArea(stackPointer, &stackStart, &stackEnd)) {
         debuglogstdio(LCF_ERROR, "Could not find the stack area");
         return;
     }
+    size_t currentSize = stackEnd - stackStart;
 
-    // debuglogstdio(LCF_INFO, "Current stack size is %d", stackArea.size);
+    // debuglogstdio(LCF_INFO, "Current stack size is %d", currentSize);
 
     /* Check if we need to grow it */
-    if (stackSize <= stackArea.size)
+    if (stackSize <= currentSize)
         return;
 
     /* Grow the stack */
-    size_t allocSize = stackSize - stackArea.size - 4095;
+    size_t allocSize = stackSize - currentSize - 4095;
     void* tmpbuf = alloca(allocSize);
     MYASSERT(tmpbuf != nullptr);
     memset(tmpbuf, 0, allocSize);
+    /* Use the buffer, otherwise the compiler optimizes the alloca code above */
     debuglogstdio(LCF_NONE, "Some value %d", static_cast<char*>(tmpbuf)[0]);
 
-    /* Look at the new stack area */
-    /* Apparently, if we don't use another local variable here, the compiler
-     * optimizes the alloca code above! */
-    ProcSelfMaps newProcSelfMaps;
-    while (newProcSelfMaps.getNextArea(&stackArea)) {
-        if ((stackPointer >= reinterpret_cast<uintptr_t>(stackArea.addr)) && (stackPointer < reinterpret_cast<uintptr_t>(stackArea.endAddr))) {
-            break;
-        }
-    }
-
-    /* Check if we found the stack */
-    if (stackArea.addr) {
-        // debuglogstdio(LCF_INFO, "New stack size is %d", stackArea.size);
-        return;
-    }
-
+    /* The stack area has changed */
+    ProcMapsCache::invalidate();
 }
 
 }
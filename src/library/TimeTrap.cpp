@@ -0,0 +1,624 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "TimeTrap.h"
+#include "DeterministicTimer.h"
+#include "GlobalState.h"
+#include "logging.h"
+#include "global.h" // shared_config, game_info
+
+#include <atomic>
+#include <cstring>
+#include <cstddef> // offsetof
+#include <link.h> // ElfW
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <ucontext.h>
+#include <sys/auxv.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <linux/audit.h>
+#include <linux/filter.h>
+#include <linux/seccomp.h>
+
+#ifndef SYS_SECCOMP
+#define SYS_SECCOMP 1
+#endif
+
+#ifndef PR_SET_TSC
+#define PR_SET_TSC 26
+#define PR_TSC_SIGSEGV 2
+#endif
+
+/* Issue a time syscall. The filter lets through syscalls whose return
+ * address is `libtas_time_syscall_end`, so that we can still query the
+ * real time while the game syscalls are trapped. */
+#if defined(__x86_64__)
+asm(".text\n"
+    ".globl libtas_time_syscall\n"
+    ".hidden libtas_time_syscall\n"
+    ".type libtas_time_syscall, @function\n"
+    "libtas_time_syscall:\n"
+    "    movq %rdi, %rax\n"
+    "    movq %rsi, %rdi\n"
+    "    movq %rdx, %rsi\n"
+    "    syscall\n"
+    ".globl libtas_time_syscall_end\n"
+    ".hidden libtas_time_syscall_end\n"
+    "libtas_time_syscall_end:\n"
+    "    ret\n");
+#define TIMETRAP_AUDIT_ARCH AUDIT_ARCH_X86_64
+#define TIMETRAP_REG_IP REG_RIP
+#define TIMETRAP_REG_RET REG_RAX
+#define TIMETRAP_REG_ARG1 REG_RDI
+#define TIMETRAP_REG_ARG2 REG_RSI
+#define TIMETRAP_REG_TSC_LOW REG_RAX
+#define TIMETRAP_REG_TSC_HIGH REG_RDX
+#define TIMETRAP_REG_TSC_AUX REG_RCX
+#elif defined(__i386__)
+asm(".text\n"
+    ".globl libtas_time_syscall\n"
+    ".hidden libtas_time_syscall\n"
+    ".type libtas_time_syscall, @function\n"
+    "libtas_time_syscall:\n"
+    "    pushl %ebx\n"
+    "    movl 8(%esp), %eax\n"
+    "    movl 12(%esp), %ebx\n"
+    "    movl 16(%esp), %ecx\n"
+    "    int $0x80\n"
+    ".globl libtas_time_syscall_end\n"
+    ".hidden libtas_time_syscall_end\n"
+    "libtas_time_syscall_end:\n"
+    "    popl %ebx\n"
+    "    ret\n");
+#define TIMETRAP_AUDIT_ARCH AUDIT_ARCH_I386
+#define TIMETRAP_REG_IP REG_EIP
+#define TIMETRAP_REG_RET REG_EAX
+#define TIMETRAP_REG_ARG1 REG_EBX
+#define TIMETRAP_REG_ARG2 REG_ECX
+#define TIMETRAP_REG_TSC_LOW REG_EAX
+#define TIMETRAP_REG_TSC_HIGH REG_EDX
+#define TIMETRAP_REG_TSC_AUX REG_ECX
+#endif
+
+extern "C" long libtas_time_syscall(long nr, long arg1, long arg2);
+extern "C" char libtas_time_syscall_end[];
+
+namespace libtas {
+
+static std::atomic<uint64_t> counts[TimeTrap::SOURCE_COUNT];
+static uint64_t reported_counts[TimeTrap::SOURCE_COUNT];
+
+static const char* source_names[TimeTrap::SOURCE_COUNT] = {"raw syscalls", "vDSO", "rdtsc"};
+static const int source_flags[TimeTrap::SOURCE_COUNT] = {
+    SharedConfig::TIME_TRAP_SYSCALL, SharedConfig::TIME_TRAP_VDSO, SharedConfig::TIME_TRAP_TSC};
+
+/* SIGSEGV handler registered by the game */
+static struct sigaction game_segv;
+
+/* 64-bit timespec used by the time64 syscalls of 32-bit arch */
+struct timespec64 {
+    int64_t tv_sec;
+    int64_t tv_nsec;
+};
+
+/* Time queried by a trapped source */
+static struct timespec getTime(TimeTrap::Source source, SharedConfig::TimeCallType type)
+{
+    counts[source]++;
+
+    /* Syscalls and rdtsc are emulated inside a signal handler, where we must
+     * not advance time, because it could trigger a frame boundary with all
+     * signals blocked. */
+    if (source != TimeTrap::SOURCE_VDSO)
+        type = SharedConfig::TIMETYPE_UNTRACKED;
+
+    return detTimer.getTicks(type);
+}
+
+static long trappedClockGettime(TimeTrap::Source source, clockid_t clock_id, struct timespec* tp)
+{
+    if (GlobalState::isNative())
+        return libtas_time_syscall(SYS_clock_gettime, clock_id, reinterpret_cast<long>(tp));
+
+    *tp = getTime(source, SharedConfig::TIMETYPE_CLOCKGETTIME);
+    return 0;
+}
+
+#ifdef SYS_clock_gettime64
+static long trappedClockGettime64(TimeTrap::Source source, clockid_t clock_id, struct timespec64* tp)
+{
+    if (GlobalState::isNative())
+        return libtas_time_syscall(SYS_clock_gettime64, clock_id, reinterpret_cast<long>(tp));
+
+    struct timespec ts = getTime(source, SharedConfig::TIMETYPE_CLOCKGETTIME);
+    tp->tv_sec = ts.tv_sec;
+    tp->tv_nsec = ts.tv_nsec;
+    return 0;
+}
+#endif
+
+static long trappedGettimeofday(TimeTrap::Source source, struct timeval* tv, struct timezone* tz)
+{
+    if (GlobalState::isNative())
+        return libtas_time_syscall(SYS_gettimeofday, reinterpret_cast<long>(tv), reinterpret_cast<long>(tz));
+
+    struct timespec ts = getTime(source, SharedConfig::TIMETYPE_GETTIMEOFDAY);
+    if (tv) {
+        tv->tv_sec = ts.tv_sec;
+        tv->tv_usec = ts.tv_nsec / 1000;
+    }
+    if (tz) {
+        tz->tz_minuteswest = 0;
+        tz->tz_dsttime = 0;
+    }
+    return 0;
+}
+
+static long trappedTime(TimeTrap::Source source, time_t* t)
+{
+    if (GlobalState::isNative())
+        return libtas_time_syscall(SYS_time, reinterpret_cast<long>(t), 0);
+
+    struct timespec ts = getTime(source, SharedConfig::TIMETYPE_TIME);
+    if (t)
+        *t = ts.tv_sec;
+    return ts.tv_sec;
+}
+
+/* Replacements of the vDSO functions */
+static int vdsoClockGettime(clockid_t clock_id, struct timespec* tp)
+{
+    return trappedClockGettime(TimeTrap::SOURCE_VDSO, clock_id, tp);
+}
+
+#ifdef SYS_clock_gettime64
+static int vdsoClockGettime64(clockid_t clock_id, struct timespec64* tp)
+{
+    return trappedClockGettime64(TimeTrap::SOURCE_VDSO, clock_id, tp);
+}
+#endif
+
+static int vdsoGettimeofday(struct timeval* tv, struct timezone* tz)
+{
+    return trappedGettimeofday(TimeTrap::SOURCE_VDSO, tv, tz);
+}
+
+static time_t vdsoTime(time_t* t)
+{
+    return trappedTime(TimeTrap::SOURCE_VDSO, t);
+}
+
+/* Thread created before installing the seccomp filter. The filter is kept
+ * across fork() and exec(), so processes are spawned from this thread, which
+ * does not have it. Otherwise, a child process like ffmpeg would be killed
+ * by the first raw time syscall, as it has no SIGSYS handler. */
+static bool spawn_thread_started = false;
+static pthread_mutex_t spawn_call_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t spawn_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t spawn_cond = PTHREAD_COND_INITIALIZER;
+static void (*spawn_func)(void*) = nullptr;
+static void* spawn_arg = nullptr;
+
+static void* spawnThread(void*)
+{
+    GlobalState::setNative(true);
+
+    /* Don't receive the game signals while waiting, but spawn processes
+     * with the signal mask of the main thread */
+    sigset_t all_mask, orig_mask;
+    sigfillset(&all_mask);
+    pthread_sigmask(SIG_SETMASK, &all_mask, &orig_mask);
+
+    pthread_mutex_lock(&spawn_mutex);
+    while (true) {
+        while (!spawn_func)
+            pthread_cond_wait(&spawn_cond, &spawn_mutex);
+
+        pthread_sigmask(SIG_SETMASK, &orig_mask, nullptr);
+        spawn_func(spawn_arg);
+        pthread_sigmask(SIG_SETMASK, &all_mask, nullptr);
+
+        spawn_func = nullptr;
+        pthread_cond_broadcast(&spawn_cond);
+    }
+    return nullptr;
+}
+
+/* SIGSYS handler used until the checkpoint handler is registered at the
+ * first frame boundary, which also handles trapped syscalls */
+static void sigsysHandler(int signum, siginfo_t* info, void* ucontext)
+{
+    if (TimeTrap::isTrappedSyscall(info))
+        TimeTrap::handleSyscall(signum, info, ucontext);
+}
+
+static void initSeccomp()
+{
+    static const unsigned int syscalls[] = {
+        SYS_clock_gettime,
+#ifdef SYS_clock_gettime64
+        SYS_clock_gettime64,
+#endif
+        SYS_gettimeofday,
+        SYS_time,
+    };
+    static const int syscall_count = sizeof(syscalls) / sizeof(syscalls[0]);
+
+    uint64_t allowed_ip = reinterpret_cast<uintptr_t>(libtas_time_syscall_end);
+
+    struct sock_filter filter[9 + syscall_count];
+    int i = 0;
+
+    /* Only look at syscalls from our arch */
+    filter[i++] = BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, arch));
+    filter[i++] = BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, TIMETRAP_AUDIT_ARCH, 1, 0);
+    filter[i++] = BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW);
+
+    /* Let our own syscall through */
+    filter[i++] = BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, instruction_pointer));
+    filter[i++] = BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, static_cast<uint32_t>(allowed_ip), 0, 3);
+    filter[i++] = BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, instruction_pointer) + 4);
+    filter[i++] = BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, static_cast<uint32_t>(allowed_ip >> 32), 0, 1);
+    filter[i++] = BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW);
+
+    /* Trap time syscalls */
+    filter[i++] = BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, nr));
+    for (int s = 0; s < syscall_count; s++) {
+        /* Jump over the remaining comparisons and the allow statement */
+        filter[i++] = BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, syscalls[s], static_cast<uint8_t>(syscall_count - s), 0);
+    }
+    filter[i++] = BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW);
+    filter[i++] = BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_TRAP);
+
+    struct sock_fprog prog;
+    prog.len = i;
+    prog.filter = filter;
+
+    /* A trapped syscall with no handler, or with SIGSYS blocked, kills the
+     * process, so the handler must be registered before the filter */
+    struct sigaction sigsys, old_sigsys;
+    memset(&sigsys, 0, sizeof(struct sigaction));
+    sigfillset(&sigsys.sa_mask);
+    sigsys.sa_flags = SA_SIGINFO | SA_ONSTACK;
+    sigsys.sa_sigaction = sigsysHandler;
+
+    int ret;
+    NATIVECALL(ret = sigaction(SIGSYS, &sigsys, &old_sigsys));
+    if (ret != 0) {
+        debuglog(LCF_TIMEGET | LCF_ERROR, "Could not register SIGSYS handler, raw time syscalls are not intercepted");
+        return;
+    }
+
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGSYS);
+    NATIVECALL(pthread_sigmask(SIG_UNBLOCK, &mask, nullptr));
+
+    /* Required to install a filter without privileges */
+    if (prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) != 0) {
+        debuglog(LCF_TIMEGET | LCF_ERROR, "Could not set no_new_privs, raw time syscalls are not intercepted");
+        NATIVECALL(sigaction(SIGSYS, &old_sigsys, nullptr));
+        return;
+    }
+
+    /* Start the thread spawning processes before the filter, which must not
+     * be synchronized to it. This is done before the game creates threads,
+     * so all game threads inherit the filter from the main thread. */
+    pthread_t spawn_thread;
+    NATIVECALL(ret = pthread_create(&spawn_thread, nullptr, spawnThread, nullptr));
+    if (ret == 0) {
+        NATIVECALL(pthread_detach(spawn_thread));
+        spawn_thread_started = true;
+    }
+    else {
+        debuglog(LCF_TIMEGET | LCF_ERROR, "Could not create the spawn thread, child processes will inherit the seccomp filter");
+    }
+
+    if (syscall(SYS_seccomp, SECCOMP_SET_MODE_FILTER, 0, &prog) != 0) {
+        debuglog(LCF_TIMEGET | LCF_ERROR, "Could not install seccomp filter, raw time syscalls are not intercepted");
+        NATIVECALL(sigaction(SIGSYS, &old_sigsys, nullptr));
+        return;
+    }
+
+    debuglog(LCF_TIMEGET | LCF_INFO, "Raw time syscalls are intercepted");
+}
+
+/* Overwrite the beginning of a function with an absolute jump */
+static bool patchJump(uintptr_t addr, const void* target)
+{
+#if defined(__x86_64__)
+    /* movabs $target, %rax ; jmp *%rax */
+    unsigned char code[12] = {0x48, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xe0};
+    uint64_t target_addr = reinterpret_cast<uintptr_t>(target);
+    memcpy(&code[2], &target_addr, sizeof(uint64_t));
+#else
+    /* mov $target, %eax ; jmp *%eax */
+    unsigned char code[7] = {0xb8, 0, 0, 0, 0, 0xff, 0xe0};
+    uint32_t target_addr = reinterpret_cast<uintptr_t>(target);
+    memcpy(&code[1], &target_addr, sizeof(uint32_t));
+#endif
+
+    uintptr_t page_size = sysconf(_SC_PAGESIZE);
+    uintptr_t start = addr & ~(page_size - 1);
+    uintptr_t end = (addr + sizeof(code) + page_size - 1) & ~(page_size - 1);
+
+    if (mprotect(reinterpret_cast<void*>(start), end - start, PROT_READ | PROT_WRITE | PROT_EXEC) == 0) {
+        memcpy(reinterpret_cast<void*>(addr), code, sizeof(code));
+        mprotect(reinterpret_cast<void*>(start), end - start, PROT_READ | PROT_EXEC);
+        return true;
+    }
+
+    /* Recent kernels seal the vDSO mapping, but it can still be written
+     * like a debugger does */
+    int fd;
+    NATIVECALL(fd = open("/proc/self/mem", O_RDWR));
+    if (fd < 0)
+        return false;
+
+    ssize_t ret = pwrite(fd, code, sizeof(code), addr);
+    NATIVECALL(close(fd));
+    return ret == static_cast<ssize_t>(sizeof(code));
+}
+
+static void initVdso()
+{
+    uintptr_t base = getauxval(AT_SYSINFO_EHDR);
+    if (!base) {
+        debuglog(LCF_TIMEGET | LCF_ERROR, "No vDSO found");
+        return;
+    }
+
+    /* The vDSO image is entirely mapped, including its section headers */
+    const ElfW(Ehdr)* ehdr = reinterpret_cast<const ElfW(Ehdr)*>(base);
+    const ElfW(Shdr)* shdrs = reinterpret_cast<const ElfW(Shdr)*>(base + ehdr->e_shoff);
+    const ElfW(Phdr)* phdrs = reinterpret_cast<const ElfW(Phdr)*>(base + ehdr->e_phoff);
+
+    /* Compute the load offset of symbols */
+    uintptr_t load_offset = base;
+    for (int p = 0; p < ehdr->e_phnum; p++) {
+        if (phdrs[p].p_type == PT_LOAD) {
+            load_offset = base + phdrs[p].p_offset - phdrs[p].p_vaddr;
+            break;
+        }
+    }
+
+    static const struct {
+        const char* name;
+        const void* target;
+    } patches[] = {
+        {"__vdso_clock_gettime", reinterpret_cast<const void*>(vdsoClockGettime)},
+#ifdef SYS_clock_gettime64
+        {"__vdso_clock_gettime64", reinterpret_cast<const void*>(vdsoClockGettime64)},
+#endif
+        {"__vdso_gettimeofday", reinterpret_cast<const void*>(vdsoGettimeofday)},
+        {"__vdso_time", reinterpret_cast<const void*>(vdsoTime)},
+    };
+
+    for (int s = 0; s < ehdr->e_shnum; s++) {
+        if (shdrs[s].sh_type != SHT_DYNSYM)
+            continue;
+
+        const ElfW(Sym)* syms = reinterpret_cast<const ElfW(Sym)*>(base + shdrs[s].sh_offset);
+        const char* strtab = reinterpret_cast<const char*>(base + shdrs[shdrs[s].sh_link].sh_offset);
+        int sym_count = shdrs[s].sh_size / sizeof(ElfW(Sym));
+
+        for (int y = 0; y < sym_count; y++) {
+            if ((ELF32_ST_TYPE(syms[y].st_info) != STT_FUNC) || (syms[y].st_shndx == SHN_UNDEF))
+                continue;
+
+            for (const auto& patch : patches) {
+                if (strcmp(strtab + syms[y].st_name, patch.name) != 0)
+                    continue;
+
+                if (patchJump(load_offset + syms[y].st_value, patch.target))
+                    debuglog(LCF_TIMEGET | LCF_INFO, "Patched vDSO function ", patch.name);
+                else
+                    debuglog(LCF_TIMEGET | LCF_ERROR, "Could not patch vDSO function ", patch.name);
+            }
+        }
+    }
+}
+
+static void segvHandler(int signum, siginfo_t* info, void* ucontext)
+{
+    ucontext_t* uc = static_cast<ucontext_t*>(ucontext);
+
+    /* A faulting rdtsc raises a general protection fault */
+    if (info->si_code == SI_KERNEL) {
+        const unsigned char* ip = reinterpret_cast<const unsigned char*>(uc->uc_mcontext.gregs[TIMETRAP_REG_IP]);
+        int length = 0;
+        if ((ip[0] == 0x0f) && (ip[1] == 0x31))
+            length = 2; // rdtsc
+        else if ((ip[0] == 0x0f) && (ip[1] == 0x01) && (ip[2] == 0xf9))
+            length = 3; // rdtscp
+
+        if (length) {
+            /* Report a TSC running at 1 GHz */
+            struct timespec ts;
+            if (GlobalState::isNative()) {
+                libtas_time_syscall(SYS_clock_gettime, CLOCK_MONOTONIC, reinterpret_cast<long>(&ts));
+            }
+            else {
+                ts = getTime(TimeTrap::SOURCE_TSC, SharedConfig::TIMETYPE_CLOCKGETTIME);
+            }
+            uint64_t tsc = static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+
+            uc->uc_mcontext.gregs[TIMETRAP_REG_TSC_LOW] = static_cast<uint32_t>(tsc);
+            uc->uc_mcontext.gregs[TIMETRAP_REG_TSC_HIGH] = static_cast<uint32_t>(tsc >> 32);
+            if (length == 3)
+                uc->uc_mcontext.gregs[TIMETRAP_REG_TSC_AUX] = 0;
+            uc->uc_mcontext.gregs[TIMETRAP_REG_IP] += length;
+            return;
+        }
+    }
+
+    /* Not ours, forward to the game handler */
+    if (game_segv.sa_flags & SA_SIGINFO) {
+        game_segv.sa_sigaction(signum, info, ucontext);
+    }
+    else if ((game_segv.sa_handler == SIG_DFL) || (game_segv.sa_handler == SIG_IGN)) {
+        /* Restore the default action, the faulting instruction will be
+         * executed again and terminate the game */
+        struct sigaction dfl;
+        memset(&dfl, 0, sizeof(struct sigaction));
+        dfl.sa_handler = SIG_DFL;
+        NATIVECALL(sigaction(SIGSEGV, &dfl, nullptr));
+    }
+    else {
+        game_segv.sa_handler(signum);
+    }
+}
+
+static void initTsc()
+{
+    struct sigaction segv;
+    memset(&segv, 0, sizeof(struct sigaction));
+    sigemptyset(&segv.sa_mask);
+    segv.sa_flags = SA_SIGINFO | SA_ONSTACK;
+    segv.sa_sigaction = segvHandler;
+
+    int ret;
+    NATIVECALL(ret = sigaction(SIGSEGV, &segv, &game_segv));
+    if (ret != 0) {
+        debuglog(LCF_TIMEGET | LCF_ERROR, "Could not register SIGSEGV handler, rdtsc is not intercepted");
+        return;
+    }
+
+    if (prctl(PR_SET_TSC, PR_TSC_SIGSEGV, 0, 0, 0) != 0) {
+        debuglog(LCF_TIMEGET | LCF_ERROR, "Could not make rdtsc fault, rdtsc is not intercepted");
+        NATIVECALL(sigaction(SIGSEGV, &game_segv, nullptr));
+        return;
+    }
+
+    debuglog(LCF_TIMEGET | LCF_INFO, "rdtsc is intercepted");
+}
+
+void TimeTrap::init()
+{
+    if (shared_config.time_trap & SharedConfig::TIME_TRAP_VDSO)
+        initVdso();
+    if (shared_config.time_trap & SharedConfig::TIME_TRAP_TSC)
+        initTsc();
+    if (shared_config.time_trap & SharedConfig::TIME_TRAP_SYSCALL)
+        initSeccomp();
+}
+
+void TimeTrap::runUntrapped(void (*func)(void*), void* arg)
+{
+    if (!spawn_thread_started) {
+        func(arg);
+        return;
+    }
+
+    GlobalNative gn;
+
+    /* Only one call at a time */
+    pthread_mutex_lock(&spawn_call_mutex);
+    pthread_mutex_lock(&spawn_mutex);
+
+    spawn_arg = arg;
+    spawn_func = func;
+    pthread_cond_broadcast(&spawn_cond);
+
+    while (spawn_func)
+        pthread_cond_wait(&spawn_cond, &spawn_mutex);
+
+    pthread_mutex_unlock(&spawn_mutex);
+    pthread_mutex_unlock(&spawn_call_mutex);
+}
+
+bool TimeTrap::isTrappedSyscall(const siginfo_t* info)
+{
+    return info && (info->si_code == SYS_SECCOMP);
+}
+
+void TimeTrap::handleSyscall(int signum, siginfo_t* info, void* ucontext)
+{
+    ucontext_t* uc = static_cast<ucontext_t*>(ucontext);
+    greg_t* regs = uc->uc_mcontext.gregs;
+    long ret;
+
+    switch (info->si_syscall) {
+        case SYS_clock_gettime:
+            ret = trappedClockGettime(SOURCE_SYSCALL, regs[TIMETRAP_REG_ARG1],
+                reinterpret_cast<struct timespec*>(regs[TIMETRAP_REG_ARG2]));
+            break;
+#ifdef SYS_clock_gettime64
+        case SYS_clock_gettime64:
+            ret = trappedClockGettime64(SOURCE_SYSCALL, regs[TIMETRAP_REG_ARG1],
+                reinterpret_cast<struct timespec64*>(regs[TIMETRAP_REG_ARG2]));
+            break;
+#endif
+        case SYS_gettimeofday:
+            ret = trappedGettimeofday(SOURCE_SYSCALL, reinterpret_cast<struct timeval*>(regs[TIMETRAP_REG_ARG1]),
+                reinterpret_cast<struct timezone*>(regs[TIMETRAP_REG_ARG2]));
+            break;
+        case SYS_time:
+            ret = trappedTime(SOURCE_SYSCALL, reinterpret_cast<time_t*>(regs[TIMETRAP_REG_ARG1]));
+            break;
+        default:
+            ret = -ENOSYS;
+            break;
+    }
+
+    regs[TIMETRAP_REG_RET] = ret;
+}
+
+bool TimeTrap::handlesSegv()
+{
+    return shared_config.time_trap & SharedConfig::TIME_TRAP_TSC;
+}
+
+void TimeTrap::setGameSegvHandler(const struct sigaction* act, struct sigaction* oact)
+{
+    if (oact)
+        *oact = game_segv;
+    if (act)
+        game_segv = *act;
+}
+
+uint64_t TimeTrap::count(Source source)
+{
+    return counts[source];
+}
+
+void TimeTrap::report()
+{
+    for (int s = 0; s < SOURCE_COUNT; s++) {
+        uint64_t c = counts[s];
+        if (c == reported_counts[s])
+            continue;
+
+        debuglog(LCF_TIMEGET | LCF_FREQUENT, "Time queried ", c - reported_counts[s], " time(s) using ", source_names[s]);
+        reported_counts[s] = c;
+
+        if (!(game_info.time_trap & source_flags[s])) {
+            debuglog(LCF_TIMEGET | LCF_WARNING, "Game queries time using ", source_names[s]);
+            game_info.time_trap |= source_flags[s];
+            game_info.tosend = true;
+        }
+    }
+}
+
+}
@@ -0,0 +1,83 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LIBTAS_TIMETRAP_H_INCL
+#define LIBTAS_TIMETRAP_H_INCL
+
+#include <signal.h>
+#include <stdint.h>
+
+namespace libtas {
+/* Interception of time sources that don't go through our libc hooks:
+ * statically linked runtimes issuing raw syscalls or calling the vDSO
+ * directly, and engines reading the TSC with rdtsc. Each source can be
+ * enabled separately in SharedConfig::time_trap, and returns the
+ * deterministic time.
+ *
+ * - Raw syscalls are trapped with a seccomp filter returning SIGSYS, which
+ *   shares the checkpoint signal. Our own native syscalls are issued from a
+ *   single instruction that the filter lets through.
+ *   The filter is kept by child processes, so they are spawned from a
+ *   thread that was created before installing it.
+ * - vDSO time functions are patched with a jump to our own functions.
+ * - rdtsc is made to fault with PR_SET_TSC, and the SIGSEGV is emulated.
+ *   The game SIGSEGV handler is kept and called for other faults.
+ */
+namespace TimeTrap {
+
+enum Source {
+    SOURCE_SYSCALL,
+    SOURCE_VDSO,
+    SOURCE_TSC,
+    SOURCE_COUNT
+};
+
+/* Install the enabled interceptions. Must be called after receiving the
+ * config and before the game creates threads. */
+void init();
+
+/* Run a function (which spawns a process) on a thread without the seccomp
+ * filter, and wait for it to return. The function is called directly if the
+ * filter is not installed. */
+void runUntrapped(void (*func)(void*), void* arg);
+
+/* Returns if a SIGSYS was raised by our seccomp filter */
+bool isTrappedSyscall(const siginfo_t* info);
+
+/* Emulate a trapped syscall */
+void handleSyscall(int signum, siginfo_t* info, void* ucontext);
+
+/* Returns if we handle SIGSEGV for rdtsc emulation */
+bool handlesSegv();
+
+/* Store the SIGSEGV handler registered by the game, and return the previous
+ * one, like sigaction() */
+void setGameSegvHandler(const struct sigaction* act, struct sigaction* oact);
+
+/* Number of time queries intercepted from a source */
+uint64_t count(Source source);
+
+/* Called at each frame boundary, to report the sources used by the game */
+void report();
+
+}
+}
+
+#endif
@@ -0,0 +1,349 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "VirtualSignals.h"
+#include "GlobalState.h"
+#include "logging.h"
+#include "checkpoint/ThreadManager.h"
+#include "checkpoint/ThreadInfo.h"
+#include "checkpoint/ThreadSync.h"
+#include "checkpoint/SaveStateManager.h"
+#include "checkpoint/ReservedMemory.h"
+#include "../shared/SharedConfig.h"
+
+#include <mutex>
+#include <atomic>
+#include <cstring>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/syscall.h>
+
+namespace libtas {
+
+#define MAX_QUEUED_SIGNALS 64
+
+struct QueuedSignal {
+    pid_t sender; // tid of the thread that sent the signal
+    pid_t target; // tid of the target thread, or 0 for the process
+    siginfo_t info;
+};
+
+static QueuedSignal queued_signals[MAX_QUEUED_SIGNALS];
+
+/* Only modified with queue_mutex held, but read without it to quickly check
+ * if there is anything to do */
+static std::atomic<int> queued_count(0);
+static std::mutex queue_mutex;
+
+/* Copy of the handlers registered by the game */
+static struct sigaction handlers[NSIG];
+static bool handler_set[NSIG] = {};
+
+/* Bitmap of the signals whose handler was ever changed by the game. It is
+ * stored in the reserved memory, which is not part of savestates, so that
+ * we know which handlers to reset when loading a state saved before they
+ * were registered. */
+static uint64_t* touchedSignals()
+{
+    ReservedMemory::init();
+    return static_cast<uint64_t*>(ReservedMemory::getAddr(ReservedMemory::SIGNALS_ADDR));
+}
+
+void VirtualSignals::setHandler(int sig)
+{
+    if ((sig <= 0) || (sig >= NSIG))
+        return;
+
+    /* Store the handler as the kernel sees it, which is simpler for signal() */
+    int ret;
+    NATIVECALL(ret = sigaction(sig, nullptr, &handlers[sig]));
+    handler_set[sig] = (ret == 0);
+
+    if (sig <= 64)
+        *touchedSignals() |= (1ULL << (sig - 1));
+}
+
+void VirtualSignals::restoreHandlers()
+{
+    uint64_t touched = *touchedSignals();
+
+    for (int sig = 1; sig < NSIG; sig++) {
+        if (!handler_set[sig]) {
+            /* The handler was registered after the state was saved */
+            if ((sig <= 64) && (touched & (1ULL << (sig - 1)))) {
+                struct sigaction act;
+                memset(&act, 0, sizeof(act));
+                act.sa_handler = SIG_DFL;
+                sigemptyset(&act.sa_mask);
+                int ret;
+                NATIVECALL(ret = sigaction(sig, &act, nullptr));
+                if (ret < 0)
+                    debuglogstdio(LCF_SIGNAL | LCF_ERROR, "Could not reset the handler of signal %d", sig);
+            }
+            continue;
+        }
+
+        /* We cannot know if a one-shot handler was reset by the kernel
+         * before the state was saved */
+        if (handlers[sig].sa_flags & SA_RESETHAND)
+            continue;
+
+        int ret;
+        NATIVECALL(ret = sigaction(sig, &handlers[sig], nullptr));
+        if (ret < 0)
+            debuglogstdio(LCF_SIGNAL | LCF_ERROR, "Could not register again the handler of signal %d", sig);
+    }
+}
+
+void VirtualSignals::setAltStack(const stack_t *ss)
+{
+    ThreadInfo* thread = ThreadManager::getCurrentThread();
+    if (!thread || !ss)
+        return;
+
+    thread->game_altstack = *ss;
+    thread->game_altstack_set = true;
+    thread->altstack_invalid = false;
+}
+
+void VirtualSignals::invalidateAltStack()
+{
+    ThreadInfo* thread = ThreadManager::getCurrentThread();
+    if (thread)
+        thread->altstack_invalid = true;
+}
+
+static void restoreAltStack(ThreadInfo* thread)
+{
+    thread->altstack_invalid = false;
+
+    /* Without a game altstack, the thread uses our own one for the suspend
+     * signal */
+    const stack_t* ss = thread->game_altstack_set ? &thread->game_altstack : &thread->altstack;
+    if (!ss->ss_sp && !(ss->ss_flags & SS_DISABLE))
+        return;
+
+    int ret;
+    NATIVECALL(ret = sigaltstack(ss, nullptr));
+    if (ret < 0)
+        debuglogstdio(LCF_SIGNAL | LCF_ERROR, "Could not register again the alternate stack");
+}
+
+static void sendSignal(pid_t tid, siginfo_t info)
+{
+    pid_t pid = getpid();
+
+    int ret;
+    if (tid)
+        ret = syscall(SYS_rt_tgsigqueueinfo, pid, tid, info.si_signo, &info);
+    else
+        ret = syscall(SYS_rt_sigqueueinfo, pid, info.si_signo, &info);
+
+    /* Only the main thread of the process is allowed to send a signal that
+     * looks like it comes from kill() or tgkill() */
+    if ((ret < 0) && (errno == EPERM)) {
+        info.si_code = SI_QUEUE;
+        if (tid)
+            ret = syscall(SYS_rt_tgsigqueueinfo, pid, tid, info.si_signo, &info);
+        else
+            ret = syscall(SYS_rt_sigqueueinfo, pid, info.si_signo, &info);
+    }
+
+    if (ret < 0)
+        debuglogstdio(LCF_SIGNAL | LCF_WARNING, "Could not deliver signal %d to thread %d", info.si_signo, tid);
+}
+
+/* Remove the queued signals matching a predicate, keeping the order */
+template<typename Predicate>
+static int extractSignals(Predicate pred, QueuedSignal* out)
+{
+    std::lock_guard<std::mutex> lock(queue_mutex);
+
+    int n = 0;
+    int kept = 0;
+    for (int i = 0; i < queued_count; i++) {
+        if (pred(queued_signals[i]))
+            out[n++] = queued_signals[i];
+        else
+            queued_signals[kept++] = queued_signals[i];
+    }
+    queued_count = kept;
+    return n;
+}
+
+/* Signals that must keep their immediate effect: the ones that cannot be
+ * caught, synchronous faults which are expected to be handled right away,
+ * and the signals used by our checkpoint code */
+static bool isDeferrable(int sig)
+{
+    switch (sig) {
+        case SIGKILL:
+        case SIGSTOP:
+        case SIGSEGV:
+        case SIGBUS:
+        case SIGILL:
+        case SIGFPE:
+        case SIGTRAP:
+        case SIGSYS:
+        case SIGABRT:
+            return false;
+        default:
+            break;
+    }
+
+    return (sig != SaveStateManager::sigSuspend()) && (sig != SaveStateManager::sigCheckpoint());
+}
+
+bool VirtualSignals::queue(pid_t tid, const siginfo_t *info)
+{
+    if (!shared_config.deferred_signals)
+        return false;
+
+    if (!isDeferrable(info->si_signo))
+        return false;
+
+    /* The main thread runs deterministically, so its signals can be sent
+     * right away. It may also wait for the target to handle the signal in
+     * a way that we don't hook, such as a spinning loop or a mutex, and it
+     * never reaches the frame boundary in that case. */
+    if (ThreadManager::isMainThread())
+        return false;
+
+    std::lock_guard<std::mutex> lock(queue_mutex);
+
+    if (queued_count == MAX_QUEUED_SIGNALS) {
+        debuglogstdio(LCF_SIGNAL | LCF_WARNING, "Too many queued signals, sending signal %d immediately", info->si_signo);
+        return false;
+    }
+
+    QueuedSignal& qs = queued_signals[queued_count++];
+    qs.sender = ThreadManager::getThreadTid();
+    qs.target = tid;
+    qs.info = *info;
+
+    debuglogstdio(LCF_SIGNAL, "Queued signal %d for thread %d", info->si_signo, tid);
+    return true;
+}
+
+void VirtualSignals::flush()
+{
+    ThreadInfo* thread = ThreadManager::getCurrentThread();
+    if (thread && thread->altstack_invalid)
+        restoreAltStack(thread);
+
+    if (queued_count == 0)
+        return;
+
+    /* Our checkpoint code uses signals, so we must prevent signaling
+     * threads at the same time. */
+    ThreadSync::wrapperExecutionLockLock();
+
+    pid_t self = ThreadManager::getThreadTid();
+    QueuedSignal signals[MAX_QUEUED_SIGNALS];
+    int n = extractSignals([self](const QueuedSignal& qs) {
+        return (qs.sender == self) && (qs.target != 0);
+    }, signals);
+
+    for (int i = 0; i < n; i++)
+        sendSignal(signals[i].target, signals[i].info);
+
+    ThreadSync::wrapperExecutionLockUnlock();
+}
+
+void VirtualSignals::deliver()
+{
+    if (queued_count == 0)
+        return;
+
+    QueuedSignal signals[MAX_QUEUED_SIGNALS];
+    int n = extractSignals([](const QueuedSignal& qs) {
+        return true;
+    }, signals);
+
+    pid_t self = ThreadManager::getThreadTid();
+    sigset_t mask;
+    NATIVECALL(pthread_sigmask(SIG_BLOCK, nullptr, &mask));
+
+    for (int i = 0; i < n; i++) {
+        pid_t tid = signals[i].target;
+
+        /* Like timer signals, signals directed to the process are handled by
+         * the main thread, unless it blocks them */
+        if (!tid && !sigismember(&mask, signals[i].info.si_signo))
+            tid = self;
+
+        sendSignal(tid, signals[i].info);
+    }
+}
+
+void VirtualSignals::deliverToCurrentThread()
+{
+    if (queued_count == 0)
+        return;
+
+    pid_t self = ThreadManager::getThreadTid();
+    QueuedSignal signals[MAX_QUEUED_SIGNALS];
+    int n = extractSignals([self](const QueuedSignal& qs) {
+        return qs.target == self;
+    }, signals);
+
+    for (int i = 0; i < n; i++)
+        sendSignal(self, signals[i].info);
+}
+
+bool VirtualSignals::take(const sigset_t *set, siginfo_t *info)
+{
+    if ((queued_count == 0) || !set)
+        return false;
+
+    pid_t self = ThreadManager::getThreadTid();
+
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    for (int i = 0; i < queued_count; i++) {
+        const QueuedSignal& qs = queued_signals[i];
+        if (((qs.target == self) || (qs.target == 0)) &&
+            (sigismember(set, qs.info.si_signo) == 1)) {
+            if (info)
+                *info = qs.info;
+            for (int j = i + 1; j < queued_count; j++)
+                queued_signals[j-1] = queued_signals[j];
+            queued_count--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void VirtualSignals::addPending(sigset_t *set)
+{
+    if ((queued_count == 0) || !set)
+        return;
+
+    pid_t self = ThreadManager::getThreadTid();
+
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    for (int i = 0; i < queued_count; i++) {
+        const QueuedSignal& qs = queued_signals[i];
+        if ((qs.target == self) || (qs.target == 0))
+            sigaddset(set, qs.info.si_signo);
+    }
+}
+
+}
@@ -0,0 +1,89 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBTAS_VIRTUALSIGNALS_H_INCL
+#define LIBTAS_VIRTUALSIGNALS_H_INCL
+
+#include <signal.h>
+#include <sys/types.h>
+
+namespace libtas {
+/* Signal handlers and alternate stacks are kernel state, so they are not
+ * part of savestates. We keep a copy of the ones registered by the game in
+ * our memory, and register them again after loading a state.
+ *
+ * When enabled, signals sent by secondary threads to other game threads
+ * (pthread_kill, kill, sigqueue, etc.) are not sent right away but queued.
+ * They are delivered at deterministic points: when the sender thread is
+ * about to block in a hooked function (condition variables, semaphores,
+ * join, sleeps, poll, select, epoll and signal waits), at the end of the
+ * frame boundary, or when the target waits for them with sigwait(). Mutex
+ * locks and blocking reads are not delivery points. The queue is in our
+ * memory, so pending signals are saved and restored with savestates.
+ *
+ * Signals sent by the main thread, and signals that a thread sends to
+ * itself, are still delivered immediately. The main thread runs
+ * deterministically, and it may wait for the target in ways that we don't
+ * hook, which would otherwise never let it reach the frame boundary.
+ */
+namespace VirtualSignals {
+
+/* Record the handler registered by the game for a signal */
+void setHandler(int sig);
+
+/* Register again the game handlers after loading a savestate, and reset
+ * the ones that were registered after the state was saved */
+void restoreHandlers();
+
+/* Record the alternate stack registered by the game for the current thread */
+void setAltStack(const stack_t *ss);
+
+/* Mark the alternate stack of the current thread to be registered again by
+ * the next flush(), after loading a savestate. It cannot be done while the
+ * thread runs on it. Until then, the thread keeps our own alternate stack,
+ * so a game handler with SA_ONSTACK runs on it instead of the game one. */
+void invalidateAltStack();
+
+/* Queue a signal for a thread (tid), or for the process (tid 0). Returns
+ * false if the signal must be sent immediately, which is always the case
+ * for uncatchable signals, synchronous faults and our own signals. */
+bool queue(pid_t tid, const siginfo_t *info);
+
+/* Send the queued signals that the current thread sent to other threads,
+ * before it blocks, and register again its alternate stack if needed */
+void flush();
+
+/* Send all queued signals, at the end of the frame boundary */
+void deliver();
+
+/* Send the queued signals targeting the current thread, before it waits
+ * for a signal */
+void deliverToCurrentThread();
+
+/* Remove and return the first queued signal of `set` targeting the current
+ * thread or the process. Returns false if there is none. */
+bool take(const sigset_t *set, siginfo_t *info);
+
+/* Add the queued signals targeting the current thread or the process */
+void addPending(sigset_t *set);
+
+}
+}
+
+#endif
@@ -0,0 +1,498 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "VirtualTimers.h"
+#include "DeterministicTimer.h"
+#include "GlobalState.h"
+#include "logging.h"
+#include "checkpoint/ThreadManager.h"
+#include "fileio/FileHandleList.h"
+
+#include <mutex>
+#include <cstring>
+#include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/syscall.h>
+#include <sys/time.h> // ITIMER_*
+
+namespace libtas {
+
+#define MAX_TIMERS 64
+
+struct VirtualTimer {
+    bool used;
+    VirtualTimers::NotifyType type;
+
+    /* Next expiration in deterministic time, if armed */
+    bool armed;
+    TimeHolder next;
+    TimeHolder interval;
+
+    /* Signal notification */
+    int signo;
+    union sigval value;
+    pid_t tid;
+    int overrun;
+
+    /* Thread notification */
+    void (*function)(union sigval);
+
+    /* SDL notification */
+    VirtualTimers::SDLCallback sdl_callback;
+    void *sdl_param;
+
+    /* File descriptor notification, read and write ends of a pipe */
+    int fds[2];
+};
+
+/* All the timer state lives here, so that it is part of savestates */
+static VirtualTimer timers[MAX_TIMERS];
+static std::mutex timers_mutex;
+
+/* Dedicated thread executing thread callbacks */
+static bool callback_thread_created = false;
+static sem_t work_sem;
+static sem_t done_sem;
+
+/* Job to be executed by the dedicated thread */
+static VirtualTimers::NotifyType job_type;
+static void (*job_function)(union sigval);
+static union sigval job_value;
+static VirtualTimers::SDLCallback job_sdl_callback;
+static void *job_sdl_param;
+static uint32_t job_sdl_interval;
+
+static int64_t toNsec(const TimeHolder& th)
+{
+    return static_cast<int64_t>(th.tv_sec) * 1000000000 + th.tv_nsec;
+}
+
+static TimeHolder fromNsec(int64_t nsec)
+{
+    TimeHolder th;
+    th.tv_sec = nsec / 1000000000;
+    th.tv_nsec = nsec % 1000000000;
+    return th;
+}
+
+static VirtualTimer* getTimer(int id)
+{
+    if ((id < 1) || (id > MAX_TIMERS) || !timers[id-1].used)
+        return nullptr;
+    return &timers[id-1];
+}
+
+static void resetTimer(VirtualTimer& timer, VirtualTimers::NotifyType type)
+{
+    timer = VirtualTimer();
+    timer.used = true;
+    timer.type = type;
+    timer.fds[0] = -1;
+    timer.fds[1] = -1;
+}
+
+static void* callbackThread(void* arg)
+{
+    while (true) {
+        while (sem_wait(&work_sem) != 0) {}
+
+        if (job_type == VirtualTimers::NOTIFY_SDL)
+            job_sdl_interval = job_sdl_callback(job_sdl_interval, job_sdl_param);
+        else
+            job_function(job_value);
+
+        sem_post(&done_sem);
+    }
+    return nullptr;
+}
+
+/* Execute the current job in the dedicated thread, and wait for it to complete */
+static void runJob()
+{
+    if (!callback_thread_created) {
+        sem_init(&work_sem, 0, 0);
+        sem_init(&done_sem, 0, 0);
+        pthread_t thread;
+        if (pthread_create(&thread, nullptr, callbackThread, nullptr) != 0) {
+            debuglog(LCF_TIMERS | LCF_ERROR, "Could not create the timer callback thread");
+            return;
+        }
+        callback_thread_created = true;
+    }
+
+    sem_post(&work_sem);
+    while (sem_wait(&done_sem) != 0) {}
+}
+
+/* Remove and return the expiration count stored in the timer pipe */
+static uint64_t takePendingFd(const VirtualTimer& timer)
+{
+    /* The read end may be blocking, so we temporarily switch it to non-blocking */
+    int flags = fcntl(timer.fds[0], F_GETFL);
+    fcntl(timer.fds[0], F_SETFL, flags | O_NONBLOCK);
+    uint64_t pending = 0;
+    if (read(timer.fds[0], &pending, sizeof(uint64_t)) != sizeof(uint64_t))
+        pending = 0;
+    fcntl(timer.fds[0], F_SETFL, flags);
+    return pending;
+}
+
+int VirtualTimers::create(NotifyType type)
+{
+    std::lock_guard<std::mutex> lock(timers_mutex);
+
+    for (int i = ITIMER_PROF + 1; i < MAX_TIMERS; i++) {
+        if (!timers[i].used) {
+            resetTimer(timers[i], type);
+            return i+1;
+        }
+    }
+
+    debuglog(LCF_TIMERS | LCF_ERROR, "Too many timers created");
+    return -1;
+}
+
+int VirtualTimers::getITimer(int which)
+{
+    static const int itimer_signals[] = {SIGALRM, SIGVTALRM, SIGPROF};
+
+    if ((which < ITIMER_REAL) || (which > ITIMER_PROF))
+        return -1;
+
+    std::lock_guard<std::mutex> lock(timers_mutex);
+
+    VirtualTimer& timer = timers[which];
+    if (!timer.used) {
+        resetTimer(timer, NOTIFY_SIGNAL);
+        timer.signo = itimer_signals[which];
+    }
+    return which+1;
+}
+
+void VirtualTimers::setSignal(int id, int signo, union sigval value, pid_t tid)
+{
+    std::lock_guard<std::mutex> lock(timers_mutex);
+    VirtualTimer* timer = getTimer(id);
+    if (!timer)
+        return;
+
+    timer->signo = signo;
+    timer->value = value;
+    timer->tid = tid;
+}
+
+void VirtualTimers::setThread(int id, void (*function)(union sigval), union sigval value)
+{
+    std::lock_guard<std::mutex> lock(timers_mutex);
+    VirtualTimer* timer = getTimer(id);
+    if (!timer)
+        return;
+
+    timer->function = function;
+    timer->value = value;
+}
+
+void VirtualTimers::setSDL(int id, SDLCallback callback, void *param)
+{
+    std::lock_guard<std::mutex> lock(timers_mutex);
+    VirtualTimer* timer = getTimer(id);
+    if (!timer)
+        return;
+
+    timer->sdl_callback = callback;
+    timer->sdl_param = param;
+}
+
+int VirtualTimers::createFd(int flags)
+{
+    int id = create(NOTIFY_FD);
+    if (id < 0)
+        return -1;
+
+    std::pair<int, int> fds = FileHandleList::createPipe(flags & (O_NONBLOCK | O_CLOEXEC));
+    if (fds.first < 0) {
+        remove(id);
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(timers_mutex);
+    timers[id-1].fds[0] = fds.first;
+    timers[id-1].fds[1] = fds.second;
+    return fds.first;
+}
+
+int VirtualTimers::fromFd(int fd)
+{
+    if (fd < 0)
+        return -1;
+
+    std::lock_guard<std::mutex> lock(timers_mutex);
+    for (int i = 0; i < MAX_TIMERS; i++) {
+        if (timers[i].used && (timers[i].type == NOTIFY_FD) && (timers[i].fds[0] == fd))
+            return i+1;
+    }
+    return -1;
+}
+
+void VirtualTimers::closeFd(int fd)
+{
+    int id = fromFd(fd);
+    if (id > 0)
+        remove(id);
+}
+
+bool VirtualTimers::exists(int id)
+{
+    std::lock_guard<std::mutex> lock(timers_mutex);
+    return getTimer(id) != nullptr;
+}
+
+bool VirtualTimers::remove(int id)
+{
+    std::lock_guard<std::mutex> lock(timers_mutex);
+    VirtualTimer* timer = getTimer(id);
+    if (!timer)
+        return false;
+
+    timer->used = false;
+    timer->armed = false;
+    return true;
+}
+
+bool VirtualTimers::remove(int id, NotifyType type)
+{
+    std::lock_guard<std::mutex> lock(timers_mutex);
+    VirtualTimer* timer = getTimer(id);
+    if (!timer || (timer->type != type))
+        return false;
+
+    timer->used = false;
+    timer->armed = false;
+    return true;
+}
+
+void VirtualTimers::set(int id, const struct timespec& value, const struct timespec& interval, bool absolute,
+         struct timespec* old_value, struct timespec* old_interval)
+{
+    TimeHolder now = detTimer.getTicks();
+
+    std::lock_guard<std::mutex> lock(timers_mutex);
+    VirtualTimer* timer = getTimer(id);
+    if (!timer)
+        return;
+
+    if (old_value) {
+        if (timer->armed && (timer->next > now))
+            *old_value = timer->next - now;
+        else
+            *old_value = {0, 0};
+    }
+    if (old_interval)
+        *old_interval = timer->interval;
+
+    timer->interval = interval;
+    timer->overrun = 0;
+
+    /* Setting a timerfd clears its expirations */
+    if (timer->type == NOTIFY_FD)
+        takePendingFd(*timer);
+
+    if ((value.tv_sec == 0) && (value.tv_nsec == 0)) {
+        timer->armed = false;
+        return;
+    }
+
+    timer->armed = true;
+    timer->next = absolute ? TimeHolder(value) : (now + value);
+    debuglog(LCF_TIMERS, "Timer ", id, " armed to expire at ", timer->next.tv_sec, ".", timer->next.tv_nsec/1000000, " s");
+}
+
+void VirtualTimers::get(int id, struct timespec* value, struct timespec* interval)
+{
+    TimeHolder now = detTimer.getTicks();
+
+    std::lock_guard<std::mutex> lock(timers_mutex);
+    VirtualTimer* timer = getTimer(id);
+    if (!timer)
+        return;
+
+    if (value) {
+        if (timer->armed && (timer->next > now))
+            *value = timer->next - now;
+        else if (timer->armed)
+            /* Expired but not yet delivered, report the smallest value */
+            *value = {0, 1};
+        else
+            *value = {0, 0};
+    }
+    if (interval)
+        *interval = timer->interval;
+}
+
+int VirtualTimers::getOverrun(int id)
+{
+    std::lock_guard<std::mutex> lock(timers_mutex);
+    VirtualTimer* timer = getTimer(id);
+    return timer ? timer->overrun : 0;
+}
+
+/* Add expirations to the counter stored in the timer pipe */
+static void notifyFd(const VirtualTimer& timer, uint64_t count)
+{
+    /* Merge with the expirations not yet read by the game */
+    count += takePendingFd(timer);
+
+    if (write(timer.fds[1], &count, sizeof(uint64_t)) != sizeof(uint64_t))
+        debuglog(LCF_TIMERS | LCF_ERROR, "Could not write timer expirations");
+}
+
+static void notifySignal(const VirtualTimer& timer, int id, uint64_t count)
+{
+    siginfo_t si;
+    memset(&si, 0, sizeof(siginfo_t));
+    si.si_signo = timer.signo;
+
+    if (id <= ITIMER_PROF + 1) {
+        si.si_code = SI_KERNEL;
+    }
+    else {
+        si.si_code = SI_TIMER;
+        si.si_timerid = id;
+        si.si_overrun = timer.overrun;
+        si.si_value = timer.value;
+    }
+
+    pid_t pid = getpid();
+    pid_t tid = timer.tid;
+    if (!tid) {
+        /* The signal is directed to the process. Deliver it to the main
+         * thread so that the handler runs at a deterministic point, unless
+         * the main thread blocks it. */
+        sigset_t mask;
+        NATIVECALL(pthread_sigmask(SIG_BLOCK, nullptr, &mask));
+        if (sigismember(&mask, timer.signo)) {
+            syscall(SYS_rt_sigqueueinfo, pid, timer.signo, &si);
+            return;
+        }
+        tid = syscall(SYS_gettid);
+    }
+    syscall(SYS_rt_tgsigqueueinfo, pid, tid, timer.signo, &si);
+}
+
+void VirtualTimers::update(bool frame_boundary)
+{
+    if (!ThreadManager::isMainThread() || GlobalState::isNative())
+        return;
+
+    /* A signal handler may sleep and advance time again */
+    static bool updating = false;
+    if (updating)
+        return;
+    updating = true;
+
+    TimeHolder now = detTimer.getTicks();
+
+    while (true) {
+        std::unique_lock<std::mutex> lock(timers_mutex);
+
+        /* Find the next timer to expire, ties are broken by id */
+        int index = -1;
+        for (int i = 0; i < MAX_TIMERS; i++) {
+            VirtualTimer& timer = timers[i];
+            if (!timer.used || !timer.armed || (timer.next > now))
+                continue;
+            if (!frame_boundary && ((timer.type == NOTIFY_THREAD) || (timer.type == NOTIFY_SDL)))
+                continue;
+            if ((index == -1) || (timers[index].next > timer.next))
+                index = i;
+        }
+
+        if (index == -1)
+            break;
+
+        VirtualTimer& timer = timers[index];
+        int id = index + 1;
+
+        /* Compute the number of expirations and schedule the next one */
+        uint64_t count = 1;
+        int64_t interval = toNsec(timer.interval);
+        if ((timer.type != NOTIFY_SDL) && (interval > 0)) {
+            count += toNsec(now - timer.next) / interval;
+            timer.next = fromNsec(toNsec(timer.next) + count * interval);
+        }
+        else {
+            timer.armed = false;
+        }
+
+        debuglog(LCF_TIMERS, "Timer ", id, " expired ", count, " time(s)");
+
+        VirtualTimer copy = timer;
+        switch (timer.type) {
+            case NOTIFY_NONE:
+                break;
+            case NOTIFY_FD:
+                notifyFd(timer, count);
+                break;
+            case NOTIFY_SIGNAL:
+            case NOTIFY_THREAD_ID:
+                timer.overrun = count - 1;
+                copy.overrun = timer.overrun;
+                lock.unlock();
+                notifySignal(copy, id, count);
+                break;
+            case NOTIFY_THREAD:
+                lock.unlock();
+                job_type = NOTIFY_THREAD;
+                job_function = copy.function;
+                job_value = copy.value;
+                runJob();
+                break;
+            case NOTIFY_SDL:
+                lock.unlock();
+                job_type = NOTIFY_SDL;
+                job_sdl_callback = copy.sdl_callback;
+                job_sdl_param = copy.sdl_param;
+                job_sdl_interval = copy.interval.tv_sec * 1000 + copy.interval.tv_nsec / 1000000;
+                runJob();
+
+                /* Reschedule with the returned interval, unless the timer
+                 * was removed by the callback */
+                lock.lock();
+                if (timer.used && !timer.armed) {
+                    if (job_sdl_interval == 0) {
+                        timer.used = false;
+                    }
+                    else {
+                        timer.interval = fromNsec(static_cast<int64_t>(job_sdl_interval) * 1000000);
+                        timer.next = now + timer.interval;
+                        timer.armed = true;
+                    }
+                }
+                break;
+        }
+    }
+
+    updating = false;
+}
+
+}
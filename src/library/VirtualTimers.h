@@ -0,0 +1,108 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LIBTAS_VIRTUALTIMERS_H_INCL
+#define LIBTAS_VIRTUALTIMERS_H_INCL
+
+#include "TimeHolder.h"
+#include <signal.h>
+#include <stdint.h>
+
+namespace libtas {
+/* Timers created by the game (POSIX timers, itimers, timerfd and SDL timers)
+ * are not backed by kernel timers. They are scheduled against the
+ * deterministic timer, and expirations are delivered by the main thread,
+ * either at the end of a frame boundary or when the main thread advances
+ * time by sleeping or waiting. This makes them deterministic, follow
+ * fast-forward, and because all their state is stored in our memory,
+ * they are saved and restored with savestates.
+ *
+ * Callbacks that must run in a separate thread (SDL timers and SIGEV_THREAD
+ * notifications) are executed by a dedicated thread, while the main thread
+ * waits for them to complete. They are only delivered at frame boundaries,
+ * because the main thread may hold game locks when advancing time.
+ */
+namespace VirtualTimers {
+
+enum NotifyType {
+    NOTIFY_NONE,     // No notification, only the timer value can be read
+    NOTIFY_SIGNAL,   // Send a signal to the process
+    NOTIFY_THREAD_ID,// Send a signal to a specific thread
+    NOTIFY_THREAD,   // Call a function from a separate thread
+    NOTIFY_FD,       // Make a file descriptor readable
+    NOTIFY_SDL,      // Call an SDL timer callback from a separate thread
+};
+
+typedef uint32_t (*SDLCallback)(uint32_t interval, void *param);
+
+/* Get the timer used by setitimer() for the type `which`, creating it if
+ * needed. Returns -1 if `which` is invalid. */
+int getITimer(int which);
+
+/* Create a new timer, returns its id (strictly positive), or -1 if the
+ * maximum number of timers was reached. */
+int create(NotifyType type);
+
+/* Configure the notification of a timer */
+void setSignal(int id, int signo, union sigval value, pid_t tid = 0);
+void setThread(int id, void (*function)(union sigval), union sigval value);
+void setSDL(int id, SDLCallback callback, void *param);
+
+/* Create a timer notifying through a file descriptor, returns the read end
+ * of the file descriptor, or -1 on error. */
+int createFd(int flags);
+
+/* Get the timer id associated with a file descriptor, or -1 */
+int fromFd(int fd);
+
+/* Called when a file descriptor is closed, to delete the associated timer */
+void closeFd(int fd);
+
+/* Returns if the id corresponds to an existing timer */
+bool exists(int id);
+
+/* Delete a timer, returns if the timer existed */
+bool remove(int id);
+
+/* Delete a timer only if it notifies using `type`, returns if it was deleted */
+bool remove(int id, NotifyType type);
+
+/* Arm or disarm a timer. A null `value` disarms the timer. If `absolute` is
+ * set, `value` is a deterministic time, otherwise it is relative to the
+ * current time. The previous remaining time and interval are stored in
+ * `old_value` and `old_interval` if not null. */
+void set(int id, const struct timespec& value, const struct timespec& interval, bool absolute,
+         struct timespec* old_value = nullptr, struct timespec* old_interval = nullptr);
+
+/* Get the remaining time before the next expiration and the interval */
+void get(int id, struct timespec* value, struct timespec* interval);
+
+/* Get the overrun count of the last signal notification */
+int getOverrun(int id);
+
+/* Deliver all timer expirations up to the current deterministic time.
+ * Only the main thread delivers expirations. Thread callbacks are only
+ * delivered if `frame_boundary` is set. */
+void update(bool frame_boundary);
+
+}
+}
+
+#endif
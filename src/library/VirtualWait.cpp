@@ -0,0 +1,160 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "VirtualWait.h"
+#include "DeterministicTimer.h"
+#include "GlobalState.h"
+#include "timewrappers.h" // clock_gettime
+#include "logging.h"
+#include "global.h" // shared_config
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <stdint.h>
+
+namespace libtas {
+
+static std::map<pthread_cond_t*, clockid_t> cond_clocks;
+static std::mutex cond_clocks_mutex;
+
+/* Condition variable that the main thread is currently waiting on */
+static std::atomic<pthread_cond_t*> waiting_cond(nullptr);
+static std::atomic<bool> notified(false);
+
+static int64_t toNsec(const TimeHolder& th)
+{
+    return static_cast<int64_t>(th.tv_sec) * 1000000000 + th.tv_nsec;
+}
+
+void VirtualWait::setCondClock(pthread_cond_t* cond, clockid_t clock_id)
+{
+    std::lock_guard<std::mutex> lock(cond_clocks_mutex);
+
+    /* Don't store the default clock, so that the map only grows with
+     * condition variables that need it. */
+    if (clock_id == CLOCK_REALTIME)
+        cond_clocks.erase(cond);
+    else
+        cond_clocks[cond] = clock_id;
+}
+
+clockid_t VirtualWait::getCondClock(pthread_cond_t* cond)
+{
+    std::lock_guard<std::mutex> lock(cond_clocks_mutex);
+
+    auto it = cond_clocks.find(cond);
+    if (it != cond_clocks.end())
+        return it->second;
+    return CLOCK_REALTIME;
+}
+
+void VirtualWait::removeCond(pthread_cond_t* cond)
+{
+    std::lock_guard<std::mutex> lock(cond_clocks_mutex);
+    cond_clocks.erase(cond);
+}
+
+TimeHolder VirtualWait::toDeterministic(clockid_t clock_id, const struct timespec* abstime)
+{
+    TimeHolder abs_timeout = *abstime;
+    TimeHolder fake_time = detTimer.getTicks();
+    TimeHolder real_time;
+    NATIVECALL(clock_gettime(clock_id, &real_time));
+
+    int64_t fake_dist = toNsec(abs_timeout - fake_time);
+    int64_t real_dist = toNsec(abs_timeout - real_time);
+    if (fake_dist < 0) fake_dist = -fake_dist;
+    if (real_dist < 0) real_dist = -real_dist;
+
+    if (fake_dist <= real_dist)
+        return abs_timeout;
+
+    /* The deadline was built from the real clock */
+    TimeHolder rel_timeout = abs_timeout - real_time;
+    debuglog(LCF_WAIT, "  Deadline is based on the real clock, rel time is ", toNsec(rel_timeout)/1000000, " ms.");
+    return fake_time + rel_timeout;
+}
+
+TimeHolder VirtualWait::toReal(clockid_t clock_id, const TimeHolder& deadline)
+{
+    TimeHolder det_deadline = deadline;
+    TimeHolder fake_time = detTimer.getTicks();
+    TimeHolder real_time;
+    NATIVECALL(clock_gettime(clock_id, &real_time));
+    return real_time + (det_deadline - fake_time);
+}
+
+void VirtualWait::beginCondWait(pthread_cond_t* cond)
+{
+    notified = false;
+    waiting_cond = cond;
+}
+
+void VirtualWait::endCondWait()
+{
+    waiting_cond = nullptr;
+}
+
+void VirtualWait::notify(pthread_cond_t* cond)
+{
+    /* We don't know which waiter is woken by a signal, so this may cause
+     * a spurious wakeup of the main thread, which is allowed. */
+    if (cond && (waiting_cond == cond))
+        notified = true;
+}
+
+bool VirtualWait::isNotified()
+{
+    return notified;
+}
+
+bool VirtualWait::nextSlice(clockid_t clock_id, const TimeHolder& deadline, TimeHolder& real_end, TimeHolder& slice)
+{
+    TimeHolder det_deadline = deadline;
+    TimeHolder remaining = det_deadline - detTimer.getTicks();
+    if (toNsec(remaining) <= 0)
+        return false;
+
+    /* Never wait more than one frame at once */
+    TimeHolder frame_length;
+    frame_length.tv_sec = 0;
+    frame_length.tv_nsec = 1000000000 / 60;
+    if (shared_config.framerate_num > 0) {
+        frame_length.tv_sec = shared_config.framerate_den / shared_config.framerate_num;
+        frame_length.tv_nsec = 1000000000 * (uint64_t)(shared_config.framerate_den % shared_config.framerate_num) / shared_config.framerate_num;
+    }
+
+    slice = (remaining > frame_length) ? frame_length : remaining;
+
+    NATIVECALL(clock_gettime(clock_id, &real_end));
+    if (!(shared_config.fastforward && (shared_config.fastforward_mode & SharedConfig::FF_SLEEP))) {
+        real_end += slice * shared_config.speed_divisor;
+    }
+
+    return true;
+}
+
+void VirtualWait::advance(const TimeHolder& slice)
+{
+    detTimer.addDelay(slice);
+}
+
+}
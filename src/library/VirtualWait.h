@@ -0,0 +1,85 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LIBTAS_VIRTUALWAIT_H_INCL
+#define LIBTAS_VIRTUALWAIT_H_INCL
+
+#include "TimeHolder.h"
+#include <pthread.h>
+#include <time.h>
+
+namespace libtas {
+/* Timed waits (condition variables, semaphores) performed by the main thread
+ * are expressed in deterministic time. The main thread cannot reach a frame
+ * boundary while it is blocked, so instead of sleeping for an arbitrary real
+ * duration, the wait is split into slices of at most one frame. Each slice
+ * is a real wait, scaled by the current speed (or empty when fast-forwarding),
+ * that returns early if the object is signaled. When a slice expires, its
+ * length is transferred to the deterministic timer, which triggers non-draw
+ * frame boundaries as needed, until the deterministic time reaches the
+ * deadline.
+ */
+namespace VirtualWait {
+
+/* Store the clock used by a condition variable for its timed waits */
+void setCondClock(pthread_cond_t* cond, clockid_t clock_id);
+
+/* Get the clock used by a condition variable, CLOCK_REALTIME by default */
+clockid_t getCondClock(pthread_cond_t* cond);
+
+/* Forget about a destroyed condition variable */
+void removeCond(pthread_cond_t* cond);
+
+/* Convert an absolute deadline given by the game into deterministic time.
+ * The game usually builds the deadline from our deterministic clock, but
+ * some runtimes query the real clock directly, so we use the reference
+ * clock which is the closest to the deadline. */
+TimeHolder toDeterministic(clockid_t clock_id, const struct timespec* abstime);
+
+/* Convert a deadline in deterministic time into a deadline on the real
+ * clock `clock_id`, keeping the same remaining duration. */
+TimeHolder toReal(clockid_t clock_id, const TimeHolder& deadline);
+
+/* Register the main thread as waiting on a condition variable */
+void beginCondWait(pthread_cond_t* cond);
+
+/* Unregister the main thread wait */
+void endCondWait();
+
+/* Called when a condition variable is signaled or broadcasted */
+void notify(pthread_cond_t* cond);
+
+/* Returns if the condition variable the main thread is waiting on was
+ * signaled since the wait started */
+bool isNotified();
+
+/* Compute the next wait slice before the deterministic `deadline`.
+ * Returns false if the deadline was reached. Otherwise, fills `real_end`
+ * with the end of the real wait on clock `clock_id`, and `slice` with the
+ * deterministic duration of the slice. */
+bool nextSlice(clockid_t clock_id, const TimeHolder& deadline, TimeHolder& real_end, TimeHolder& slice);
+
+/* Transfer an expired slice to the deterministic timer */
+void advance(const TimeHolder& slice);
+
+}
+}
+
+#endif
@@ -0,0 +1,249 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Watchpoints.h"
+#include "logging.h"
+#include "frame.h" // framecount
+#include "checkpoint/ThreadManager.h"
+#include "checkpoint/ThreadInfo.h"
+#include "../shared/sockethelpers.h"
+#include "../shared/messages.h"
+
+#include <linux/perf_event.h>
+#include <linux/hw_breakpoint.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+#include <string>
+
+namespace libtas {
+
+/* Breakpoint event attached to one thread */
+struct WatchEvent {
+    pid_t tid;
+    int fd;
+    struct perf_event_mmap_page* page;
+};
+
+struct WatchState {
+    Watchpoint wp;
+    std::vector<WatchEvent> events;
+    bool failed = false; // error was already reported
+};
+
+static std::vector<WatchState> watches;
+
+/* Are events closed because of a savestate operation? */
+static bool suspended = false;
+
+/* Errors to report to the program on the next frame boundary */
+static std::string error_msg;
+
+/* One page for the header and one page for samples, which is enough for
+ * around 170 accesses per frame. Further accesses are dropped. */
+static size_t pageSize()
+{
+    static size_t page_size = sysconf(_SC_PAGESIZE);
+    return page_size;
+}
+
+static bool openEvent(WatchState& ws, pid_t tid)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_BREAKPOINT;
+    attr.size = sizeof(attr);
+    attr.bp_type = (ws.wp.type == Watchpoint::ACCESS) ? HW_BREAKPOINT_RW : HW_BREAKPOINT_W;
+    attr.bp_addr = ws.wp.addr;
+    attr.bp_len = ws.wp.size; // HW_BREAKPOINT_LEN_* match the size in bytes
+    attr.sample_period = 1;
+    attr.sample_type = PERF_SAMPLE_IP;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    int fd = syscall(SYS_perf_event_open, &attr, tid, -1, -1, PERF_FLAG_FD_CLOEXEC);
+    if (fd < 0) {
+        /* The thread may have exited in the meantime */
+        if (errno == ESRCH)
+            return true;
+
+        if (!ws.failed) {
+            debuglogstdio(LCF_ERROR, "Could not set watchpoint on %p: %s", reinterpret_cast<void*>(static_cast<uintptr_t>(ws.wp.addr)), strerror(errno));
+            error_msg += "Could not set hardware watchpoint on address ";
+            char addr_str[32];
+            snprintf(addr_str, sizeof(addr_str), "%p", reinterpret_cast<void*>(static_cast<uintptr_t>(ws.wp.addr)));
+            error_msg += addr_str;
+            error_msg += ": ";
+            error_msg += strerror(errno);
+            error_msg += "\n";
+            ws.failed = true;
+        }
+        return false;
+    }
+
+    void* page = mmap(nullptr, 2*pageSize(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (page == MAP_FAILED) {
+        debuglogstdio(LCF_ERROR, "Could not map watchpoint buffer: %s", strerror(errno));
+        close(fd);
+        return false;
+    }
+
+    ws.events.push_back({tid, fd, static_cast<struct perf_event_mmap_page*>(page)});
+    return true;
+}
+
+static void closeEvent(WatchEvent& ev)
+{
+    munmap(ev.page, 2*pageSize());
+    close(ev.fd);
+}
+
+/* Attach events to new threads and detach them from threads that are gone */
+static void syncThreads()
+{
+    if (suspended || watches.empty())
+        return;
+
+    std::vector<pid_t> tids;
+    ThreadManager::lockList();
+    for (ThreadInfo *thread = ThreadManager::getThreadList(); thread != nullptr; thread = thread->next) {
+        if ((thread->tid != 0) && (thread->state != ThreadInfo::ST_ZOMBIE))
+            tids.push_back(thread->tid);
+    }
+    ThreadManager::unlockList();
+
+    for (WatchState& ws : watches) {
+        for (auto it = ws.events.begin(); it != ws.events.end();) {
+            bool alive = false;
+            for (pid_t tid : tids)
+                alive |= (tid == it->tid);
+
+            if (alive) {
+                ++it;
+            }
+            else {
+                closeEvent(*it);
+                it = ws.events.erase(it);
+            }
+        }
+
+        for (pid_t tid : tids) {
+            bool attached = false;
+            for (const WatchEvent& ev : ws.events)
+                attached |= (ev.tid == tid);
+
+            if (!attached)
+                openEvent(ws, tid);
+        }
+    }
+}
+
+/* Copy data from the ring buffer, which may wrap around */
+static void readRing(const uint8_t* data, size_t data_size, uint64_t pos, void* dest, size_t len)
+{
+    uint8_t* out = static_cast<uint8_t*>(dest);
+    for (size_t i = 0; i < len; i++)
+        out[i] = data[(pos + i) % data_size];
+}
+
+void Watchpoints::set(const std::vector<Watchpoint>& list)
+{
+    for (WatchState& ws : watches)
+        for (WatchEvent& ev : ws.events)
+            closeEvent(ev);
+
+    watches.clear();
+    for (const Watchpoint& wp : list) {
+        WatchState ws;
+        ws.wp = wp;
+        watches.push_back(ws);
+    }
+
+    syncThreads();
+}
+
+void Watchpoints::sendHits()
+{
+    if (!error_msg.empty()) {
+        sendMessage(MSGB_ALERT_MSG);
+        sendString(error_msg);
+        error_msg.clear();
+    }
+
+    if (suspended)
+        return;
+
+    size_t data_size = pageSize();
+
+    for (WatchState& ws : watches) {
+        for (WatchEvent& ev : ws.events) {
+            const uint8_t* data = reinterpret_cast<const uint8_t*>(ev.page) + pageSize();
+            uint64_t head = __atomic_load_n(&ev.page->data_head, __ATOMIC_ACQUIRE);
+            uint64_t tail = ev.page->data_tail;
+
+            while (tail < head) {
+                struct perf_event_header header;
+                readRing(data, data_size, tail, &header, sizeof(header));
+
+                if (header.type == PERF_RECORD_SAMPLE) {
+                    uint64_t ip;
+                    readRing(data, data_size, tail + sizeof(header), &ip, sizeof(ip));
+
+                    WatchpointHit hit;
+                    hit.addr = ws.wp.addr;
+                    hit.frame = framecount;
+                    hit.ip = ip;
+                    sendMessage(MSGB_WATCHPOINT_HIT);
+                    sendData(&hit, sizeof(hit));
+                }
+
+                tail += header.size;
+            }
+
+            __atomic_store_n(&ev.page->data_tail, tail, __ATOMIC_RELEASE);
+        }
+    }
+
+    /* Threads may have been created during the frame */
+    syncThreads();
+}
+
+void Watchpoints::suspend()
+{
+    if (suspended)
+        return;
+
+    for (WatchState& ws : watches) {
+        for (WatchEvent& ev : ws.events)
+            closeEvent(ev);
+        ws.events.clear();
+    }
+
+    suspended = true;
+}
+
+void Watchpoints::resume()
+{
+    suspended = false;
+    syncThreads();
+}
+
+}
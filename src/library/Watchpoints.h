@@ -0,0 +1,62 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBTAS_WATCHPOINTS_H_INCL
+#define LIBTAS_WATCHPOINTS_H_INCL
+
+#include "../shared/Watchpoint.h"
+#include <vector>
+
+/* Hardware watchpoints requested by the program (ram watches, lua scripts).
+ *
+ * Each watchpoint is implemented with a perf_event_open breakpoint event
+ * attached to every game thread, which uses one debug register per thread.
+ * Each event samples every access into its own ring buffer, which we drain at
+ * the frame boundary, so watching an address has no cost until it is
+ * accessed, and we know the exact instruction that accessed it.
+ *
+ * Events are attached to threads when the list is set and at each frame
+ * boundary, so accesses from a thread created during the current frame are
+ * only caught from the next frame.
+ *
+ * Ring buffers are mapped memory that must not be part of savestates, so
+ * events are closed before saving or loading a state, and opened again
+ * afterwards from the list, which is itself restored by loading.
+ */
+
+namespace libtas {
+namespace Watchpoints {
+
+/* Replace the list of watchpoints */
+void set(const std::vector<Watchpoint>& list);
+
+/* Send all accesses that happened since the last call, as well as errors
+ * when setting watchpoints. Must be called with the socket locked. */
+void sendHits();
+
+/* Close all events, before a savestate operation */
+void suspend();
+
+/* Open the events again, after a savestate operation */
+void resume();
+
+}
+}
+
+#endif
@@ -26,6 +26,9 @@
 
 #define MAXBUFFERS 2048 // Max I've seen so far: 960
 #define MAXSOURCES 256 // Max I've seen so far: 112
+#define MAXEFFECTS 256
+#define MAXFILTERS 256
+#define MAXEFFECTSLOTS 64
 
 namespace libtas {
 
@@ -146,6 +149,7 @@ int AudioContext::createSource(void)
         sources.push_front(sources_pool.front());
         sources_pool.pop_front();
         sources.front()->init();
+        sources.front()->initEffects();
         return sources.front()->id;
     }
 
@@ -192,6 +196,182 @@ std::shared_ptr<AudioSource> AudioContext::getSource(int id)
     return nullptr;
 }
 
+int AudioContext::createEffect(void)
+{
+    if (effects.size() >= MAXEFFECTS)
+        return -1;
+
+    /* Check if we can recycle a deleted effect */
+    if (!effects_pool.empty()) {
+        effects.push_front(effects_pool.front());
+        effects_pool.pop_front();
+        effects.front()->init(AudioEffect::EFFECT_NULL);
+        return effects.front()->id;
+    }
+
+    /* If not, we create a new effect.
+     * The next available id equals the size of the effect list + 1
+     * (ids must start by 1, because 0 is reserved for no effect)
+     */
+    auto newae = std::make_shared<AudioEffect>();
+    newae->id = effects.size() + 1;
+    effects.push_front(newae);
+    return newae->id;
+}
+
+void AudioContext::deleteEffect(int id)
+{
+    effects.remove_if([id,this](std::shared_ptr<AudioEffect> const& effect)
+        {
+            if (effect->id == id) {
+                /* Push the deleted effect into the pool */
+                effects_pool.push_front(effect);
+                return true;
+            }
+            return false;
+        });
+}
+
+bool AudioContext::isEffect(int id)
+{
+    for (auto& effect : effects) {
+        if (effect->id == id)
+            return true;
+    }
+
+    return false;
+}
+
+std::shared_ptr<AudioEffect> AudioContext::getEffect(int id)
+{
+    for (auto& effect : effects) {
+        if (effect->id == id)
+            return effect;
+    }
+
+    return nullptr;
+}
+
+int AudioContext::createFilter(void)
+{
+    if (filters.size() >= MAXFILTERS)
+        return -1;
+
+    /* Check if we can recycle a deleted filter */
+    if (!filters_pool.empty()) {
+        filters.push_front(filters_pool.front());
+        filters_pool.pop_front();
+        filters.front()->init();
+        return filters.front()->id;
+    }
+
+    /* If not, we create a new filter.
+     * The next available id equals the size of the filter list + 1
+     * (ids must start by 1, because 0 is reserved for no filter)
+     */
+    auto newaf = std::make_shared<AudioFilter>();
+    newaf->id = filters.size() + 1;
+    filters.push_front(newaf);
+    return newaf->id;
+}
+
+void AudioContext::deleteFilter(int id)
+{
+    filters.remove_if([id,this](std::shared_ptr<AudioFilter> const& filter)
+        {
+            if (filter->id == id) {
+                /* Push the deleted filter into the pool */
+                filters_pool.push_front(filter);
+                return true;
+            }
+            return false;
+        });
+}
+
+bool AudioContext::isFilter(int id)
+{
+    for (auto& filter : filters) {
+        if (filter->id == id)
+            return true;
+    }
+
+    return false;
+}
+
+std::shared_ptr<AudioFilter> AudioContext::getFilter(int id)
+{
+    for (auto& filter : filters) {
+        if (filter->id == id)
+            return filter;
+    }
+
+    return nullptr;
+}
+
+int AudioContext::createEffectSlot(void)
+{
+    if (effectslots.size() >= MAXEFFECTSLOTS)
+        return -1;
+
+    /* Check if we can recycle a deleted effect slot */
+    if (!effectslots_pool.empty()) {
+        effectslots.push_front(effectslots_pool.front());
+        effectslots_pool.pop_front();
+        effectslots.front()->init();
+        return effectslots.front()->id;
+    }
+
+    /* If not, we create a new effect slot.
+     * The next available id equals the size of the slot list + 1
+     * (ids must start by 1, because 0 is reserved for no slot)
+     */
+    auto newaes = std::make_shared<AudioEffectSlot>();
+    newaes->id = effectslots.size() + 1;
+    effectslots.push_front(newaes);
+    return newaes->id;
+}
+
+void AudioContext::deleteEffectSlot(int id)
+{
+    effectslots.remove_if([id,this](std::shared_ptr<AudioEffectSlot> const& slot)
+        {
+            if (slot->id == id) {
+                /* Disconnect the sources that send to this slot */
+                for (auto& source : sources) {
+                    for (int i = 0; i < AudioSource::MAX_SENDS; i++) {
+                        if (source->sends[i].slot == slot)
+                            source->sends[i].slot = nullptr;
+                    }
+                }
+
+                /* Push the deleted slot into the pool */
+                effectslots_pool.push_front(slot);
+                return true;
+            }
+            return false;
+        });
+}
+
+bool AudioContext::isEffectSlot(int id)
+{
+    for (auto& slot : effectslots) {
+        if (slot->id == id)
+            return true;
+    }
+
+    return false;
+}
+
+std::shared_ptr<AudioEffectSlot> AudioContext::getEffectSlot(int id)
+{
+    for (auto& slot : effectslots) {
+        if (slot->id == id)
+            return slot;
+    }
+
+    return nullptr;
+}
+
 void AudioContext::mixAllSources(int nbSamples)
 {
     return mixAllSources(samplesToTicks(nbSamples, outFrequency));
@@ -218,6 +398,13 @@ void AudioContext::mixAllSources(struct timespec ticks)
     if (outBitDepth == 16) // Signed 16-bit samples
         outSamples.assign(outBytes, 0);
 
+    /* Silent the input of effect slots */
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& slot : effectslots)
+            slot->clearInput(outNbSamples);
+    }
+
     pthread_t mix_thread = ThreadManager::getThreadId();
 
     for (auto& source : sources) {
@@ -252,6 +439,20 @@ void AudioContext::mixAllSources(struct timespec ticks)
         source->mixWith(ticks, &outSamples[0], outBytes, outBitDepth, outNbChannels, outFrequency, outVolume);
     }
 
+    /* Run the effects on the samples sent by the sources. Effects keep
+     * producing their tail after sources stopped sending. We skip them in
+     * the same conditions as mixing sources. */
+    bool skipEffects = !shared_config.av_dumping &&
+                        (shared_config.audio_mute ||
+                            (shared_config.fastforward &&
+                                (shared_config.fastforward_mode & SharedConfig::FF_MIXING)));
+
+    if (!skipEffects) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& slot : effectslots)
+            slot->mixWith(&outSamples[0], outNbSamples, outBitDepth, outNbChannels, outFrequency);
+    }
+
     if (!audiocontext.isLoopback && !shared_config.audio_mute) {
         /* Play the music */
         AudioPlayer::play(*this);
@@ -26,6 +26,9 @@
 #include <mutex>
 #include "AudioBuffer.h"
 #include "AudioSource.h"
+#include "AudioEffect.h"
+#include "AudioFilter.h"
+#include "AudioEffectSlot.h"
 
 namespace libtas {
 /* This class stores a set of audio sources and audio buffers, and
@@ -96,6 +99,43 @@ class AudioContext
         /* Return the source of requested id, or nullptr if not exists */
         std::shared_ptr<AudioSource> getSource(int id);
 
+        /* Create a new effect object and return an id of the effect or -1 if it failed */
+        int createEffect(void);
+
+        /* Delete effect that have a corresponding id */
+        void deleteEffect(int id);
+
+        /* Returns if an effect id correspond to an existing effect */
+        bool isEffect(int id);
+
+        /* Return the effect of requested id, or nullptr if not exists */
+        std::shared_ptr<AudioEffect> getEffect(int id);
+
+        /* Create a new filter object and return an id of the filter or -1 if it failed */
+        int createFilter(void);
+
+        /* Delete filter that have a corresponding id */
+        void deleteFilter(int id);
+
+        /* Returns if a filter id correspond to an existing filter */
+        bool isFilter(int id);
+
+        /* Return the filter of requested id, or nullptr if not exists */
+        std::shared_ptr<AudioFilter> getFilter(int id);
+
+        /* Create a new effect slot object and return an id of the slot or -1 if it failed */
+        int createEffectSlot(void);
+
+        /* Delete effect slot that have a corresponding id.
+         * Sources that send to this slot are disconnected from it. */
+        void deleteEffectSlot(int id);
+
+        /* Returns if an effect slot id correspond to an existing slot */
+        bool isEffectSlot(int id);
+
+        /* Return the effect slot of requested id, or nullptr if not exists */
+        std::shared_ptr<AudioEffectSlot> getEffectSlot(int id);
+
         /* Mix all source that are playing */
         void mixAllSources(struct timespec ticks);
         void mixAllSources(int nbSamples);
@@ -109,10 +149,16 @@ class AudioContext
     private:
         std::list<std::shared_ptr<AudioBuffer>> buffers;
         std::list<std::shared_ptr<AudioSource>> sources;
+        std::list<std::shared_ptr<AudioEffect>> effects;
+        std::list<std::shared_ptr<AudioFilter>> filters;
+        std::list<std::shared_ptr<AudioEffectSlot>> effectslots;
 
-        /* Extra buffers and sources that have been deleted and can be recycled */
+        /* Extra objects that have been deleted and can be recycled */
         std::list<std::shared_ptr<AudioBuffer>> buffers_pool;
         std::list<std::shared_ptr<AudioSource>> sources_pool;
+        std::list<std::shared_ptr<AudioEffect>> effects_pool;
+        std::list<std::shared_ptr<AudioFilter>> filters_pool;
+        std::list<std::shared_ptr<AudioEffectSlot>> effectslots_pool;
 };
 
 extern AudioContext audiocontext;
@@ -0,0 +1,72 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "AudioEffect.h"
+
+namespace libtas {
+
+AudioEffect::AudioEffect(void)
+{
+    id = 0;
+    init(EFFECT_NULL);
+}
+
+void AudioEffect::init(EffectType t)
+{
+    type = t;
+
+    /* Default values from the EFX specification (generic preset) */
+    density = 1.0f;
+    diffusion = 1.0f;
+    gain = 0.32f;
+    gainHF = 0.89f;
+    gainLF = 1.0f;
+    decayTime = 1.49f;
+    decayHFRatio = 0.83f;
+    decayLFRatio = 1.0f;
+    reflectionsGain = 0.05f;
+    reflectionsDelay = 0.007f;
+    reflectionsPan[0] = reflectionsPan[1] = reflectionsPan[2] = 0.0f;
+    lateReverbGain = 1.26f;
+    lateReverbDelay = 0.011f;
+    lateReverbPan[0] = lateReverbPan[1] = lateReverbPan[2] = 0.0f;
+    echoTime = 0.25f;
+    echoDepth = 0.0f;
+    modulationTime = 0.25f;
+    modulationDepth = 0.0f;
+    airAbsorptionGainHF = 0.994f;
+    hfReference = 5000.0f;
+    lfReference = 250.0f;
+    roomRolloffFactor = 0.0f;
+    decayHFLimit = 1.0f;
+
+    echoDelay = 0.1f;
+    echoLRDelay = 0.1f;
+    echoDamping = 0.5f;
+    echoFeedback = 0.5f;
+    echoSpread = -1.0f;
+}
+
+bool AudioEffect::isSupported() const
+{
+    return (type == EFFECT_REVERB) || (type == EFFECT_EAXREVERB) || (type == EFFECT_ECHO);
+}
+
+}
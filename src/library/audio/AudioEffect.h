@@ -0,0 +1,101 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LIBTAS_AUDIOEFFECT_H_INCL
+#define LIBTAS_AUDIOEFFECT_H_INCL
+
+namespace libtas {
+/* Class storing the parameters of an effect, following the openAL EFX
+ * effect model. An effect does not process anything by itself: its parameters
+ * are copied into an effect slot, which runs the effect on the sum of the
+ * sources that send audio to it.
+ *
+ * Only reverb and echo effects are rendered, other effect types are stored
+ * but produce no output.
+ */
+class AudioEffect
+{
+    public:
+        AudioEffect();
+
+        /* Identifier of the effect */
+        int id;
+
+        enum EffectType {
+            EFFECT_NULL,
+            EFFECT_REVERB,
+            EFFECT_CHORUS,
+            EFFECT_DISTORTION,
+            EFFECT_ECHO,
+            EFFECT_FLANGER,
+            EFFECT_FREQUENCY_SHIFTER,
+            EFFECT_VOCAL_MORPHER,
+            EFFECT_PITCH_SHIFTER,
+            EFFECT_RING_MODULATOR,
+            EFFECT_AUTOWAH,
+            EFFECT_COMPRESSOR,
+            EFFECT_EQUALIZER,
+            EFFECT_EAXREVERB,
+        };
+        EffectType type;
+
+        /*** Reverb parameters, shared by the standard and EAX reverb ***/
+
+        float density;
+        float diffusion;
+        float gain;
+        float gainHF;
+        float gainLF;
+        float decayTime;
+        float decayHFRatio;
+        float decayLFRatio;
+        float reflectionsGain;
+        float reflectionsDelay;
+        float reflectionsPan[3];
+        float lateReverbGain;
+        float lateReverbDelay;
+        float lateReverbPan[3];
+        float echoTime;
+        float echoDepth;
+        float modulationTime;
+        float modulationDepth;
+        float airAbsorptionGainHF;
+        float hfReference;
+        float lfReference;
+        float roomRolloffFactor;
+        float decayHFLimit;
+
+        /*** Echo parameters ***/
+
+        float echoDelay;
+        float echoLRDelay;
+        float echoDamping;
+        float echoFeedback;
+        float echoSpread;
+
+        /* Set the effect type and reset all parameters to their default */
+        void init(EffectType t);
+
+        /* Returns if the effect type is rendered by the mixer */
+        bool isSupported() const;
+};
+}
+
+#endif
@@ -0,0 +1,288 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "AudioEffectSlot.h"
+#include <math.h>
+#include <algorithm> // std::min, std::max
+
+namespace libtas {
+
+/* Lengths in seconds of the late reverb delay lines at full density.
+ * They are chosen mutually prime so that echoes do not pile up. */
+static const float lineTimes[4] = {0.0297f, 0.0371f, 0.0411f, 0.0437f};
+
+/* Lengths in seconds of the diffusion allpass filters */
+static const float allpassTimes[2] = {0.0050f, 0.0017f};
+
+/* Maximum values of the reflection + late reverb delays and of the
+ * echo delay + left/right delay, from the EFX specification */
+#define REVERB_MAX_PREDELAY (0.3f + 0.1f)
+#define ECHO_MAX_DELAY (0.207f + 0.404f)
+
+AudioEffectSlot::AudioEffectSlot(void)
+{
+    id = 0;
+    frequency = 0;
+    init();
+}
+
+void AudioEffectSlot::init(void)
+{
+    effectId = 0;
+    effect.init(AudioEffect::EFFECT_NULL);
+    gain = 1.0f;
+    sendAuto = true;
+    input.clear();
+
+    /* Free the delay lines, they will be built on the next mixing */
+    frequency = 0;
+    preDelay.clear();
+    allpass[0].clear();
+    allpass[1].clear();
+    for (int l = 0; l < 4; l++)
+        lines[l].clear();
+    echoLine.clear();
+}
+
+void AudioEffectSlot::setEffect(const AudioEffect& newEffect)
+{
+    bool changedType = (effect.type != newEffect.type);
+    effect = newEffect;
+
+    /* A new effect starts without any tail */
+    if (changedType && (frequency != 0))
+        setup(frequency);
+    else
+        updateParameters();
+}
+
+void AudioEffectSlot::setup(int newFrequency)
+{
+    frequency = newFrequency;
+
+    preDelay.assign(static_cast<int>(REVERB_MAX_PREDELAY * frequency) + 1, 0.0f);
+    preDelayPos = 0;
+    inputLowpass = 0.0f;
+
+    for (int a = 0; a < 2; a++) {
+        allpass[a].assign(std::max(1, static_cast<int>(allpassTimes[a] * frequency)), 0.0f);
+        allpassPos[a] = 0;
+    }
+
+    for (int l = 0; l < 4; l++) {
+        lines[l].assign(static_cast<int>(lineTimes[l] * frequency) + 1, 0.0f);
+        linePos[l] = 0;
+        lineLowpass[l] = 0.0f;
+    }
+
+    echoLine.assign(static_cast<int>(ECHO_MAX_DELAY * frequency) + 2, 0.0f);
+    echoPos = 0;
+    echoLowpass = 0.0f;
+
+    updateParameters();
+}
+
+void AudioEffectSlot::updateParameters(void)
+{
+    if (frequency == 0)
+        return;
+
+    /* Reverb */
+    reflectionsTap = std::max(1, static_cast<int>(effect.reflectionsDelay * frequency));
+    lateTap = reflectionsTap + static_cast<int>(effect.lateReverbDelay * frequency);
+    inputCoef = 1.0f - expf(-2.0f * static_cast<float>(M_PI) * effect.hfReference / frequency);
+    allpassCoef = 0.625f * effect.diffusion;
+
+    /* We do not boost high frequencies */
+    float hfRatio = std::min(effect.decayHFRatio, 1.0f);
+
+    for (int l = 0; l < 4; l++) {
+        int length = static_cast<int>(lineTimes[l] * (0.5f + 0.5f * effect.density) * frequency);
+        lineLength[l] = std::max(1, length);
+        if (linePos[l] >= lineLength[l])
+            linePos[l] = 0;
+
+        /* Gain of each loop so that the level decreases by 60 dB after the
+         * decay time, and the high frequencies after decay time * ratio */
+        float seconds = static_cast<float>(lineLength[l]) / frequency;
+        lineGain[l] = powf(10.0f, -3.0f * seconds / effect.decayTime);
+        float ratio = powf(10.0f, -3.0f * seconds / (effect.decayTime * hfRatio)) / lineGain[l];
+
+        /* Pole of a one-pole low-pass filter of gain 1 at DC and ratio at
+         * Nyquist frequency */
+        lineDamping[l] = (1.0f - ratio) / (1.0f + ratio);
+    }
+
+    /* Echo */
+    echoTap1 = std::max(1, static_cast<int>(effect.echoDelay * frequency));
+    echoTap2 = echoTap1 + static_cast<int>(effect.echoLRDelay * frequency);
+}
+
+void AudioEffectSlot::clearInput(int nbFrames)
+{
+    input.assign(nbFrames, 0.0f);
+}
+
+void AudioEffectSlot::addInput(const float* samples, int nbFrames, int nbChannels, float inGain)
+{
+    /* Effects are processed in mono, like most implementations do */
+    int n = std::min(nbFrames, static_cast<int>(input.size()));
+    if (nbChannels == 2) {
+        float g = 0.5f * inGain;
+        for (int f = 0; f < n; f++)
+            input[f] += (samples[2*f] + samples[2*f+1]) * g;
+    }
+    else {
+        for (int f = 0; f < n; f++)
+            input[f] += samples[f] * inGain;
+    }
+}
+
+void AudioEffectSlot::processReverb(int nbFrames)
+{
+    const int preSize = preDelay.size();
+    const float lateGain = 0.5f * effect.lateReverbGain;
+
+    for (int f = 0; f < nbFrames; f++) {
+        /* Input gain and high-frequency attenuation */
+        float x = input[f] * effect.gain;
+        inputLowpass += inputCoef * (x - inputLowpass);
+        x = inputLowpass + effect.gainHF * (x - inputLowpass);
+
+        /* Pre-delay */
+        preDelay[preDelayPos] = x;
+        int r = preDelayPos - reflectionsTap;
+        if (r < 0) r += preSize;
+        int l = preDelayPos - lateTap;
+        if (l < 0) l += preSize;
+        float early = preDelay[r] * effect.reflectionsGain;
+        float late = preDelay[l];
+        if (++preDelayPos == preSize)
+            preDelayPos = 0;
+
+        /* Diffusion */
+        for (int a = 0; a < 2; a++) {
+            float d = allpass[a][allpassPos[a]];
+            float v = late + allpassCoef * d;
+            allpass[a][allpassPos[a]] = v;
+            late = d - allpassCoef * v;
+            if (++allpassPos[a] == static_cast<int>(allpass[a].size()))
+                allpassPos[a] = 0;
+        }
+
+        /* Feedback delay network. The four lines are processed as lanes of
+         * fixed-size loops, which the compiler turns into vector operations.
+         * Lines are mixed with a Householder matrix, which keeps the
+         * network stable (I - 2/N * ones, here N = 4). */
+        float out[4];
+        for (int k = 0; k < 4; k++)
+            out[k] = lines[k][linePos[k]];
+
+        float sum = 0.5f * (out[0] + out[1] + out[2] + out[3]);
+
+        float feedback[4];
+        for (int k = 0; k < 4; k++) {
+            feedback[k] = (out[k] - sum) * lineGain[k];
+            lineLowpass[k] = feedback[k] + lineDamping[k] * (lineLowpass[k] - feedback[k]);
+        }
+
+        for (int k = 0; k < 4; k++) {
+            lines[k][linePos[k]] = late + lineLowpass[k];
+            if (++linePos[k] == lineLength[k])
+                linePos[k] = 0;
+        }
+
+        wet[2*f] = early + (out[0] + out[2]) * lateGain;
+        wet[2*f+1] = early + (out[1] + out[3]) * lateGain;
+    }
+}
+
+void AudioEffectSlot::processEcho(int nbFrames)
+{
+    const int size = echoLine.size();
+
+    /* With the default spread of -1, first tap is on the left channel
+     * and second tap on the right channel */
+    const float panFirst = 0.5f * (1.0f - effect.echoSpread);
+    const float panSecond = 0.5f * (1.0f + effect.echoSpread);
+
+    for (int f = 0; f < nbFrames; f++) {
+        int t1 = echoPos - echoTap1;
+        if (t1 < 0) t1 += size;
+        int t2 = echoPos - echoTap2;
+        if (t2 < 0) t2 += size;
+        float tap1 = echoLine[t1];
+        float tap2 = echoLine[t2];
+
+        /* Damping is a low-pass filter in the feedback loop */
+        echoLowpass = tap2 + effect.echoDamping * (echoLowpass - tap2);
+        echoLine[echoPos] = input[f] + echoLowpass * effect.echoFeedback;
+        if (++echoPos == size)
+            echoPos = 0;
+
+        wet[2*f] = tap1 * panFirst + tap2 * panSecond;
+        wet[2*f+1] = tap1 * panSecond + tap2 * panFirst;
+    }
+}
+
+void AudioEffectSlot::mixWith(uint8_t* outSamples, int outNbSamples, int outBitDepth, int outNbChannels, int outFrequency)
+{
+    if (!effect.isSupported())
+        return;
+
+    if (frequency != outFrequency)
+        setup(outFrequency);
+
+    int nbFrames = std::min(outNbSamples, static_cast<int>(input.size()));
+    wet.resize(2*nbFrames);
+
+    if (effect.type == AudioEffect::EFFECT_ECHO)
+        processEcho(nbFrames);
+    else
+        processReverb(nbFrames);
+
+    if (outNbChannels == 1) {
+        for (int f = 0; f < nbFrames; f++)
+            wet[f] = 0.5f * (wet[2*f] + wet[2*f+1]);
+    }
+
+    /* Add the effect output to the output buffer. These loops have no
+     * dependency between samples, so they are vectorized. */
+    int nbSamples = nbFrames * outNbChannels;
+
+    if (outBitDepth == 8) {
+        const float scale = gain * 128.0f;
+        for (int s = 0; s < nbSamples; s++) {
+            int sum = outSamples[s] + static_cast<int>(wet[s] * scale);
+            outSamples[s] = std::min(std::max(sum, 0), static_cast<int>(UINT8_MAX));
+        }
+    }
+
+    if (outBitDepth == 16) {
+        int16_t* outSamples16 = reinterpret_cast<int16_t*>(outSamples);
+        const float scale = gain * 32768.0f;
+        for (int s = 0; s < nbSamples; s++) {
+            int sum = outSamples16[s] + static_cast<int>(wet[s] * scale);
+            outSamples16[s] = std::min(std::max(sum, static_cast<int>(INT16_MIN)), static_cast<int>(INT16_MAX));
+        }
+    }
+}
+
+}
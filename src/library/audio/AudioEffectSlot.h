@@ -0,0 +1,128 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LIBTAS_AUDIOEFFECTSLOT_H_INCL
+#define LIBTAS_AUDIOEFFECTSLOT_H_INCL
+
+#include <vector>
+#include <stdint.h>
+#include "AudioEffect.h"
+
+namespace libtas {
+/* Class storing an auxiliary effect slot, following the openAL EFX model.
+ * Sources send a copy of their samples to the slot, which sums them, runs
+ * its effect on the sum and adds the result to the output buffer.
+ *
+ * All the state of the effect (delay lines, filters) is stored here, so that
+ * the effect tail is restored with savestates. Processing only uses float
+ * operations in a fixed order, so that the output is deterministic.
+ */
+class AudioEffectSlot
+{
+    public:
+        AudioEffectSlot();
+
+        /* Identifier of the effect slot */
+        int id;
+
+        /* Identifier of the effect attached to the slot, or 0 */
+        int effectId;
+
+        /* Copy of the parameters of the attached effect */
+        AudioEffect effect;
+
+        /* Gain of the effect output */
+        float gain;
+
+        /* Does the slot automatically adjust sends from the source position.
+         * Stored only, because we do not support positional audio. */
+        bool sendAuto;
+
+        /* Init parameters */
+        void init();
+
+        /* Attach the parameters of an effect to the slot */
+        void setEffect(const AudioEffect& newEffect);
+
+        /* Silent the input of the slot for a new mixing of nbFrames samples */
+        void clearInput(int nbFrames);
+
+        /* Add interleaved samples sent by a source to the input of the slot */
+        void addInput(const float* samples, int nbFrames, int nbChannels, float inGain);
+
+        /* Run the effect on the input of the slot, and mix the result with
+         * an extern sample buffer of the given format. */
+        void mixWith(uint8_t* outSamples, int outNbSamples, int outBitDepth, int outNbChannels, int outFrequency);
+
+    private:
+        /* Frequency used to build the delay lines, or 0 if not built */
+        int frequency;
+
+        /* Sum of the samples sent by sources (mono) */
+        std::vector<float> input;
+
+        /* Output of the effect (stereo) */
+        std::vector<float> wet;
+
+        /* Allocate and clear the delay lines for a frequency */
+        void setup(int newFrequency);
+
+        /* Compute the filter coefficients and delays from the effect */
+        void updateParameters();
+
+        void processReverb(int nbFrames);
+        void processEcho(int nbFrames);
+
+        /*** Reverb state ***/
+
+        /* Pre-delay line, with taps for early reflections and late reverb */
+        std::vector<float> preDelay;
+        int preDelayPos;
+        int reflectionsTap;
+        int lateTap;
+
+        /* High-shelf filter of the reverb input */
+        float inputLowpass;
+        float inputCoef;
+
+        /* Allpass filters that diffuse the late reverb input */
+        std::vector<float> allpass[2];
+        int allpassPos[2];
+        float allpassCoef;
+
+        /* Feedback delay network for the late reverb */
+        std::vector<float> lines[4];
+        int linePos[4];
+        int lineLength[4];
+        float lineGain[4];
+        float lineDamping[4];
+        float lineLowpass[4];
+
+        /*** Echo state ***/
+
+        std::vector<float> echoLine;
+        int echoPos;
+        int echoTap1;
+        int echoTap2;
+        float echoLowpass;
+};
+}
+
+#endif
@@ -0,0 +1,102 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "AudioFilter.h"
+#include <math.h>
+
+namespace libtas {
+
+/* Reference frequencies of the EFX filters */
+#define FILTER_HF_REFERENCE 5000.0f
+#define FILTER_LF_REFERENCE 250.0f
+
+AudioFilter::AudioFilter(void)
+{
+    id = 0;
+    init();
+}
+
+void AudioFilter::init(void)
+{
+    type = FILTER_NULL;
+    gain = 1.0f;
+    gainHF = 1.0f;
+    gainLF = 1.0f;
+    reset();
+}
+
+void AudioFilter::setParameters(const AudioFilter& filter)
+{
+    type = filter.type;
+    gain = filter.gain;
+    gainHF = filter.gainHF;
+    gainLF = filter.gainLF;
+}
+
+void AudioFilter::reset(void)
+{
+    historyHF[0] = historyHF[1] = 0.0f;
+    historyLF[0] = historyLF[1] = 0.0f;
+}
+
+/* Coefficient of a one-pole low-pass filter for a cutoff frequency */
+static float lowpassCoef(float cutoff, int frequency)
+{
+    return 1.0f - expf(-2.0f * static_cast<float>(M_PI) * cutoff / frequency);
+}
+
+void AudioFilter::process(float* samples, int nbFrames, int nbChannels, int frequency)
+{
+    if (type == FILTER_NULL)
+        return;
+
+    const float coefHF = lowpassCoef(FILTER_HF_REFERENCE, frequency);
+    const float coefLF = lowpassCoef(FILTER_LF_REFERENCE, frequency);
+
+    /* A shelving filter is built by splitting the signal with a low-pass
+     * filter, and recombining both parts with different gains. The recursion
+     * prevents vectorizing over time, so we keep the loop simple and only
+     * process each channel in turn. */
+    for (int c = 0; c < nbChannels; c++) {
+        float lpHF = historyHF[c];
+        float lpLF = historyLF[c];
+        for (int f = 0; f < nbFrames; f++) {
+            float x = samples[f*nbChannels + c];
+            float y = x;
+            if (type != FILTER_HIGHPASS) {
+                lpHF += coefHF * (x - lpHF);
+                y = lpHF + gainHF * (y - lpHF);
+            }
+            if (type != FILTER_LOWPASS) {
+                lpLF += coefLF * (x - lpLF);
+                y = (y - lpLF) + gainLF * lpLF;
+            }
+            samples[f*nbChannels + c] = y;
+        }
+        historyHF[c] = lpHF;
+        historyLF[c] = lpLF;
+    }
+
+    /* Apply the overall gain */
+    for (int s = 0; s < nbFrames*nbChannels; s++)
+        samples[s] *= gain;
+}
+
+}
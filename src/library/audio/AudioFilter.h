@@ -0,0 +1,78 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LIBTAS_AUDIOFILTER_H_INCL
+#define LIBTAS_AUDIOFILTER_H_INCL
+
+namespace libtas {
+/* Class storing a filter that can be applied to the direct path of a source,
+ * or to one of its auxiliary sends. It follows the openAL EFX filter model:
+ * a filter only attenuates frequencies above and/or below a fixed reference
+ * frequency, which we implement with one-pole shelving filters.
+ *
+ * A filter object is copied into the source when attached, so each copy
+ * keeps its own history of samples.
+ */
+class AudioFilter
+{
+    public:
+        AudioFilter();
+
+        /* Identifier of the filter */
+        int id;
+
+        enum FilterType {
+            FILTER_NULL,
+            FILTER_LOWPASS,
+            FILTER_HIGHPASS,
+            FILTER_BANDPASS,
+        };
+        FilterType type;
+
+        /* Overall gain of the filter */
+        float gain;
+
+        /* Gain of the frequencies above the high reference */
+        float gainHF;
+
+        /* Gain of the frequencies below the low reference */
+        float gainLF;
+
+        /* Reset the filter to a null filter */
+        void init();
+
+        /* Copy the parameters of another filter, keeping our history */
+        void setParameters(const AudioFilter& filter);
+
+        /* Clear the history of samples */
+        void reset();
+
+        /* Apply the filter in place on interleaved float samples */
+        void process(float* samples, int nbFrames, int nbChannels, int frequency);
+
+    private:
+        /* Last low-passed samples for each channel (at most stereo),
+         * at the high and low reference frequencies */
+        float historyHF[2];
+        float historyLF[2];
+};
+}
+
+#endif
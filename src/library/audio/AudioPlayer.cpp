@@ -22,20 +22,53 @@
 #include "../logging.h"
 #include "../global.h" // shared_config
 #include "../GlobalState.h"
+#include "../checkpoint/ReservedMemory.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
 //#include "../hook.h"
 
 namespace libtas {
 
 snd_pcm_t *AudioPlayer::phandle;
 AudioPlayer::APStatus AudioPlayer::status = STATUS_UNINIT;
+int AudioPlayer::sink = SharedConfig::AUDIO_SINK_ALSA;
 std::vector<char> AudioPlayer::silence;
+AudioRingBuffer AudioPlayer::ring;
+int AudioPlayer::bitDepth;
+int AudioPlayer::nbChannels;
+int AudioPlayer::alignSize;
+int AudioPlayer::frequency;
+size_t AudioPlayer::periodBytes;
+size_t AudioPlayer::frameBytes;
+pthread_t AudioPlayer::output_thread;
+std::atomic<bool> AudioPlayer::running(false);
+uint32_t AudioPlayer::wav_bytes = 0;
+
+/* The descriptor is stored plus one, so that the zeroed reserved memory
+ * means that no file was opened */
+int AudioPlayer::getWavFd()
+{
+    ReservedMemory::init();
+    return *static_cast<int*>(ReservedMemory::getAddr(ReservedMemory::WAV_FD_ADDR)) - 1;
+}
+
+void AudioPlayer::setWavFd(int fd)
+{
+    ReservedMemory::init();
+    *static_cast<int*>(ReservedMemory::getAddr(ReservedMemory::WAV_FD_ADDR)) = fd + 1;
+}
 
-bool AudioPlayer::init(snd_pcm_format_t format, int nbChannels, unsigned int frequency)
+bool AudioPlayer::initAlsa(snd_pcm_format_t format, int nbChannels, unsigned int frequency)
 {
     debuglogstdio(LCF_SOUND, "Init audio player");
 
     GlobalNative gn;
 
+    phandle = nullptr;
     if (snd_pcm_open(&phandle, "default", SND_PCM_STREAM_PLAYBACK, 0) < 0) {
         debuglogstdio(LCF_SOUND | LCF_ERROR, "  Cannot open default audio device");
         return false;
@@ -97,69 +130,249 @@ bool AudioPlayer::init(snd_pcm_format_t format, int nbChannels, unsigned int fre
     return true;
 }
 
-bool AudioPlayer::play(AudioContext& ac)
+bool AudioPlayer::initWav()
 {
-    if (status == STATUS_UNINIT) {
-        snd_pcm_format_t format;
-        if (ac.outBitDepth == 8)
-            format = SND_PCM_FORMAT_U8;
-        if (ac.outBitDepth == 16)
-            format = SND_PCM_FORMAT_S16_LE;
-        if (!init(format, ac.outNbChannels, static_cast<unsigned int>(ac.outFrequency))) {
-            status = STATUS_ERROR;
+    GlobalNative gn;
+
+    if (getWavFd() < 0) {
+        const char* path = getenv("LIBTAS_AUDIO_WAV");
+        if (!path)
+            path = "libtas_audio.wav";
+
+        int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            debuglogstdio(LCF_SOUND | LCF_ERROR, "  Cannot open WAV file %s", path);
             return false;
         }
+        setWavFd(fd);
+        wav_bytes = 0;
+        debuglogstdio(LCF_SOUND, "  Writing audio to %s", path);
+    }
+    else {
+        /* The player was closed for a savestate operation. Discard the
+         * samples written after the current state, so that the file matches
+         * the current timeline. */
+        if (ftruncate(getWavFd(), 44 + wav_bytes) < 0) {
+            debuglogstdio(LCF_SOUND | LCF_ERROR, "  Cannot truncate WAV file");
+        }
+    }
+
+    writeWavHeader();
+    return true;
+}
+
+void AudioPlayer::writeWavHeader()
+{
+    uint8_t header[44];
+    auto put16 = [&header](int off, uint16_t v) {
+        header[off] = v & 0xff;
+        header[off+1] = v >> 8;
+    };
+    auto put32 = [&header](int off, uint32_t v) {
+        for (int i=0; i<4; i++)
+            header[off+i] = (v >> (8*i)) & 0xff;
+    };
+
+    memcpy(header, "RIFF", 4);
+    put32(4, 36 + wav_bytes);
+    memcpy(header+8, "WAVEfmt ", 8);
+    put32(16, 16); // fmt chunk size
+    put16(20, 1); // PCM
+    put16(22, nbChannels);
+    put32(24, frequency);
+    put32(28, frequency * alignSize);
+    put16(32, alignSize);
+    put16(34, bitDepth);
+    memcpy(header+36, "data", 4);
+    put32(40, wav_bytes);
+
+    NATIVECALL(pwrite(getWavFd(), header, 44, 0));
+}
+
+bool AudioPlayer::writeAlsa(const char* buf, size_t size)
+{
+    snd_pcm_uframes_t frames = size / alignSize;
+    snd_pcm_sframes_t err = snd_pcm_writei(phandle, buf, frames);
+
+    if (err == -EPIPE) {
+        debuglogstdio(LCF_SOUND, "  Underrun");
+        err = snd_pcm_prepare(phandle);
+        if (err < 0) {
+            debuglogstdio(LCF_SOUND | LCF_ERROR, "  Can't recovery from underrun, prepare failed: %s", snd_strerror(err));
+            return false;
+        }
+
+        /* Send silence bytes first */
+        snd_pcm_writei(phandle, silence.data(), silence.size()/alignSize);
+        err = snd_pcm_writei(phandle, buf, frames);
+    }
+
+    if (err < 0) {
+        debuglogstdio(LCF_SOUND | LCF_ERROR, "  snd_pcm_writei() failed: %s", snd_strerror(err));
+        return false;
+    }
+
+    return true;
+}
+
+void* AudioPlayer::outputLoop(void* arg)
+{
+    /* This thread is not known to the thread manager, and only sends
+     * samples to the sink */
+    GlobalNative gn;
+
+    std::vector<char> chunk(periodBytes);
+    int loop_sink = sink;
+
+    /* The ring is expected to hold about one frame of samples. If it gets
+     * much larger, the game produces frames faster than the sink consumes
+     * samples, so we drop the excess to keep the latency bounded. If it gets
+     * empty, the sink plays silence. */
+    size_t targetBytes = frameBytes;
+    size_t highBytes = 3*frameBytes;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+    /* The file sink writes everything that was pushed before closing */
+    while (running.load() || ((loop_sink == SharedConfig::AUDIO_SINK_WAV) && ring.readable())) {
+
+        if (loop_sink != SharedConfig::AUDIO_SINK_WAV) {
+            size_t avail = ring.readable();
+            if (avail > highBytes) {
+                size_t drop = avail - targetBytes;
+                drop -= drop % alignSize;
+                ring.skip(drop);
+                debuglogstdio(LCF_SOUND, "Audio output is behind, dropping %zu bytes", drop);
+            }
+        }
+
+        size_t size = ring.read(chunk.data(), periodBytes);
+
+        switch (loop_sink) {
+            case SharedConfig::AUDIO_SINK_ALSA:
+                if (!writeAlsa(size?chunk.data():silence.data(), size?size:periodBytes)) {
+                    debuglogstdio(LCF_SOUND | LCF_ERROR, "Audio device failed, discarding samples from now on");
+                    loop_sink = SharedConfig::AUDIO_SINK_NULL;
+                    clock_gettime(CLOCK_MONOTONIC, &deadline);
+                }
+                break;
+            case SharedConfig::AUDIO_SINK_NULL: {
+                /* Consume samples at the rate of a real device */
+                if (size == 0)
+                    size = periodBytes;
+                uint64_t ns = static_cast<uint64_t>(size / alignSize) * 1000000000ULL / frequency;
+                deadline.tv_nsec += ns;
+                deadline.tv_sec += deadline.tv_nsec / 1000000000;
+                deadline.tv_nsec %= 1000000000;
+                clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr);
+                break;
+            }
+            case SharedConfig::AUDIO_SINK_WAV:
+                if (size == 0) {
+                    usleep(1000);
+                    break;
+                }
+                if (pwrite(getWavFd(), chunk.data(), size, 44 + wav_bytes) == static_cast<ssize_t>(size)) {
+                    wav_bytes += size;
+                    writeWavHeader();
+                }
+                break;
+        }
+    }
+
+    return nullptr;
+}
+
+bool AudioPlayer::play(AudioContext& ac)
+{
+    if (status == STATUS_UNINIT) {
+        bitDepth = ac.outBitDepth;
+        nbChannels = ac.outNbChannels;
+        alignSize = ac.outAlignSize;
+        frequency = ac.outFrequency;
+        sink = shared_config.audio_sink;
 
         /* Build a 50 ms silence buffer */
-        int sil_bytes = static_cast<int>(0.05 * ac.outFrequency) * ac.outAlignSize;
+        int sil_bytes = static_cast<int>(0.05 * frequency) * alignSize;
 
-        if (ac.outBitDepth == 8) {
+        if (bitDepth == 8) {
             silence.assign(sil_bytes, -128);
         }
-        if (ac.outBitDepth == 16) {
+        if (bitDepth == 16) {
             silence.assign(sil_bytes, 0x00);
         }
-        
+
+        /* Send samples by blocks of 10 ms */
+        periodBytes = (frequency / 100) * alignSize;
+
+        if (shared_config.framerate_num > 0)
+            frameBytes = (static_cast<uint64_t>(frequency) * shared_config.framerate_den / shared_config.framerate_num) * alignSize;
+        else
+            frameBytes = (frequency / 30) * alignSize;
+
+        /* The ring only overflows if the sink is stalled */
+        ring.reset(std::max(8*frameBytes, static_cast<size_t>(frequency / 2) * alignSize));
+
+        if (sink == SharedConfig::AUDIO_SINK_ALSA) {
+            snd_pcm_format_t format;
+            if (bitDepth == 8)
+                format = SND_PCM_FORMAT_U8;
+            if (bitDepth == 16)
+                format = SND_PCM_FORMAT_S16_LE;
+            if (!initAlsa(format, nbChannels, static_cast<unsigned int>(frequency))) {
+                debuglogstdio(LCF_SOUND | LCF_WARNING, "Could not open the audio device, using the null sink");
+                if (phandle)
+                    NATIVECALL(snd_pcm_close(phandle));
+                sink = SharedConfig::AUDIO_SINK_NULL;
+            }
+        }
+
+        if (sink == SharedConfig::AUDIO_SINK_WAV) {
+            if (!initWav()) {
+                status = STATUS_ERROR;
+                return false;
+            }
+        }
+
+        running = true;
+        int ret;
+        NATIVECALL(ret = pthread_create(&output_thread, nullptr, outputLoop, nullptr));
+        if (ret != 0) {
+            debuglogstdio(LCF_SOUND | LCF_ERROR, "Could not create the audio output thread");
+            if (sink == SharedConfig::AUDIO_SINK_ALSA)
+                NATIVECALL(snd_pcm_close(phandle));
+            status = STATUS_ERROR;
+            return false;
+        }
+
         status = STATUS_OK;
     }
 
     if (status == STATUS_ERROR)
         return false;
 
-    if (shared_config.fastforward)
+    /* Samples sent to a device are skipped when fast-forwarding, but the file
+     * sink keeps all of them */
+    if (shared_config.fastforward && (sink != SharedConfig::AUDIO_SINK_WAV))
         return true;
 
     debuglogstdio(LCF_SOUND, "Play an audio frame");
-    int err;
-    {
-        GlobalNative gn;
-        err = snd_pcm_writei(phandle, ac.outSamples.data(), ac.outNbSamples);
-    }
-	if (err < 0) {
-		if (err == -EPIPE) {
-			debuglogstdio(LCF_SOUND, "  Underrun");
-            {
-                GlobalNative gn;
-	            err = snd_pcm_prepare(phandle);
-            }
-			if (err < 0) {
-				debuglogstdio(LCF_SOUND | LCF_ERROR, "  Can't recovery from underrun, prepare failed: %s", snd_strerror(err));
-			    return false;
-            }
-            else {
-                {
-                    GlobalNative gn;
-                    /* Send silence bytes first */
-                    snd_pcm_writei(phandle, silence.data(), silence.size()/ac.outAlignSize);
-                    snd_pcm_writei(phandle, ac.outSamples.data(), ac.outNbSamples);
-                }
-            }
-		}
-		else {
-			debuglogstdio(LCF_SOUND | LCF_ERROR, "  snd_pcm_writei() failed: %s", snd_strerror (err));
-			return false;
-		}
-	}
+
+    const char* buf = reinterpret_cast<const char*>(ac.outSamples.data());
+    size_t size = static_cast<size_t>(ac.outNbSamples) * alignSize;
+    size_t written = ring.write(buf, size);
+
+    if (sink == SharedConfig::AUDIO_SINK_WAV) {
+        /* Don't lose any sample in the file */
+        while (written < size) {
+            NATIVECALL(usleep(1000));
+            written += ring.write(buf + written, size - written);
+        }
+    }
+    else if (written < size) {
+        debuglogstdio(LCF_SOUND | LCF_WARNING, "Audio output is stalled, dropping %zu bytes", size - written);
+    }
 
     return true;
 }
@@ -167,7 +380,11 @@ bool AudioPlayer::play(AudioContext& ac)
 void AudioPlayer::close()
 {
     if (status == STATUS_OK) {
-        MYASSERT(snd_pcm_close(phandle) == 0)
+        running = false;
+        NATIVECALL(pthread_join(output_thread, nullptr));
+        if (sink == SharedConfig::AUDIO_SINK_ALSA) {
+            MYASSERT(snd_pcm_close(phandle) == 0)
+        }
         status = STATUS_UNINIT;
     }
 }
@@ -21,10 +21,18 @@
 #define LIBTAS_AUDIOPLAYER_H_INCL
 
 #include "AudioContext.h"
+#include "AudioRingBuffer.h"
 #include <alsa/asoundlib.h>
+#include <pthread.h>
+#include <atomic>
+#include <stdint.h>
 
 namespace libtas {
-/* Class in charge of sending the mixed samples to the audio device */
+/* Class in charge of sending the mixed samples to the audio sink.
+ * Samples are pushed into a ring buffer by the mixing thread, and an output
+ * thread sends them to the sink, so that the game thread never blocks on
+ * the audio device.
+ */
 class AudioPlayer
 {
     /* Status */
@@ -36,24 +44,66 @@ class AudioPlayer
 
     static APStatus status;
 
+    /* Sink in use, which can differ from the one in the config if the audio
+     * device could not be opened */
+    static int sink;
+
     /* Connection to the sound system */
     static snd_pcm_t *phandle;
 
     static std::vector<char> silence;
-    
-    public:
-        // AudioPlayer();
-        // ~AudioPlayer();
 
-        /* Init the connection to the server.
-         * Return if the connection was successful
-         */
-		static bool init(snd_pcm_format_t format, int nbChannels, unsigned int frequency);
+    /* Samples waiting to be sent by the output thread */
+    static AudioRingBuffer ring;
+
+    /* Format of the samples */
+    static int bitDepth;
+    static int nbChannels;
+    static int alignSize;
+    static int frequency;
+
+    /* Number of bytes that the output thread sends at once */
+    static size_t periodBytes;
+
+    /* Number of bytes in one frame of audio */
+    static size_t frameBytes;
+
+    static pthread_t output_thread;
+    static std::atomic<bool> running;
+
+    /* Output file of the WAV sink. The descriptor is stored in the reserved
+     * memory, so that it is not overwritten when loading a savestate */
+    static int getWavFd();
+    static void setWavFd(int fd);
 
-        /* Play the audio buffer stored in the audio context */
+    /* Number of sample bytes written in the WAV file. It is restored with
+     * savestates, so that loading a state rewinds the file */
+    static uint32_t wav_bytes;
+
+    /* Init the connection to the server.
+     * Return if the connection was successful
+     */
+    static bool initAlsa(snd_pcm_format_t format, int nbChannels, unsigned int frequency);
+
+    /* Open the WAV file, or rewind it if it was already opened */
+    static bool initWav();
+
+    /* Update the sizes in the WAV header */
+    static void writeWavHeader();
+
+    /* Send samples to the audio device, recovering from underruns.
+     * Return false on unrecoverable errors */
+    static bool writeAlsa(const char* buf, size_t size);
+
+    /* Main function of the output thread */
+    static void* outputLoop(void* arg);
+
+    public:
+        /* Push the audio buffer stored in the audio context to the sink,
+         * initializing it on first call */
 		static bool play(AudioContext& ac);
 
-        /* Close the connection to the server */
+        /* Stop the output thread and close the connection to the server */
         static void close();
 };
 }
@@ -0,0 +1,88 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "AudioRingBuffer.h"
+#include <cstring>
+#include <algorithm>
+
+namespace libtas {
+
+void AudioRingBuffer::reset(size_t capacity)
+{
+    data.assign(capacity, 0);
+    write_count.store(0);
+    read_count.store(0);
+}
+
+size_t AudioRingBuffer::readable() const
+{
+    return write_count.load(std::memory_order_acquire) - read_count.load(std::memory_order_acquire);
+}
+
+size_t AudioRingBuffer::writable() const
+{
+    return data.size() - readable();
+}
+
+size_t AudioRingBuffer::write(const char* src, size_t size)
+{
+    size_t w = write_count.load(std::memory_order_relaxed);
+    size_t r = read_count.load(std::memory_order_acquire);
+    size = std::min(size, data.size() - (w - r));
+    if (size == 0)
+        return 0;
+
+    /* Copy in at most two parts if we wrap around */
+    size_t pos = w % data.size();
+    size_t first = std::min(size, data.size() - pos);
+    memcpy(&data[pos], src, first);
+    memcpy(&data[0], src + first, size - first);
+
+    write_count.store(w + size, std::memory_order_release);
+    return size;
+}
+
+size_t AudioRingBuffer::read(char* dst, size_t size)
+{
+    size_t r = read_count.load(std::memory_order_relaxed);
+    size_t w = write_count.load(std::memory_order_acquire);
+    size = std::min(size, w - r);
+    if (size == 0)
+        return 0;
+
+    size_t pos = r % data.size();
+    size_t first = std::min(size, data.size() - pos);
+    memcpy(dst, &data[pos], first);
+    memcpy(dst + first, &data[0], size - first);
+
+    read_count.store(r + size, std::memory_order_release);
+    return size;
+}
+
+size_t AudioRingBuffer::skip(size_t size)
+{
+    size_t r = read_count.load(std::memory_order_relaxed);
+    size_t w = write_count.load(std::memory_order_acquire);
+    size = std::min(size, w - r);
+    read_count.store(r + size, std::memory_order_release);
+    return size;
+}
+
+}
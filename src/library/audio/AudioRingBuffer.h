@@ -0,0 +1,70 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LIBTAS_AUDIORINGBUFFER_H_INCL
+#define LIBTAS_AUDIORINGBUFFER_H_INCL
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+
+namespace libtas {
+/* Lock-free byte ring buffer with a single producer (the thread that mixes
+ * audio sources) and a single consumer (the audio output thread).
+ */
+class AudioRingBuffer
+{
+    std::vector<char> data;
+
+    /* Total number of bytes written and read since the last reset. Each
+     * index is only modified by one side. */
+    std::atomic<size_t> write_count;
+    std::atomic<size_t> read_count;
+
+    public:
+        AudioRingBuffer() : write_count(0), read_count(0) {}
+
+        /* Allocate the buffer and discard its content. Must not be called
+         * while the consumer is running */
+        void reset(size_t capacity);
+
+        size_t capacity() const {return data.size();}
+
+        /* Number of bytes that can be read */
+        size_t readable() const;
+
+        /* Number of bytes that can be written */
+        size_t writable() const;
+
+        /* Producer side: write up to size bytes, return the number of bytes
+         * actually written */
+        size_t write(const char* src, size_t size);
+
+        /* Consumer side: read up to size bytes, return the number of bytes
+         * actually read */
+        size_t read(char* dst, size_t size);
+
+        /* Consumer side: discard up to size bytes, return the number of
+         * bytes actually discarded */
+        size_t skip(size_t size);
+};
+}
+
+#endif
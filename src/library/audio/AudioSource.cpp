@@ -19,7 +19,7 @@
 
 #include "AudioSource.h"
 #include <iterator>     // std::back_inserter
-#include <algorithm>    // std::copy
+#include <algorithm>    // std::copy, std::min, std::max
 #include "../logging.h"
 #include "../global.h" // shared_config
 #include "hook.h"
@@ -78,6 +78,7 @@ AudioSource::AudioSource(void)
     }
 
     init();
+    initEffects();
 }
 
 AudioSource::~AudioSource(void)
@@ -97,6 +98,27 @@ void AudioSource::init(void)
     rewind();
 }
 
+void AudioSource::initEffects(void)
+{
+    directFilter.init();
+    for (int i = 0; i < MAX_SENDS; i++) {
+        sends[i].slot = nullptr;
+        sends[i].filter.init();
+    }
+}
+
+bool AudioSource::hasEffects(void)
+{
+    if (directFilter.type != AudioFilter::FILTER_NULL)
+        return true;
+
+    for (int i = 0; i < MAX_SENDS; i++) {
+        if (sends[i].slot)
+            return true;
+    }
+    return false;
+}
+
 void AudioSource::rewind(void)
 {
     position = 0;
@@ -429,6 +451,10 @@ int AudioSource::mixWith( struct timespec ticks, uint8_t* outSamples, int outByt
 
     }
 
+    if (!skipMixing && hasEffects()) {
+        applyEffects(convOutSamples, outBitDepth, outNbChannels, outFrequency, resultVolume);
+    }
+
     if (!skipMixing) {
         #define clamptofullsignedrange(x,lo,hi) ((static_cast<unsigned int>((x)-(lo))<=static_cast<unsigned int>((hi)-(lo)))?(x):(((x)<0)?(lo):(hi)))
 
@@ -480,4 +506,53 @@ int AudioSource::mixWith( struct timespec ticks, uint8_t* outSamples, int outByt
     return convOutSamples;
 }
 
+void AudioSource::applyEffects(int nbSamples, int outBitDepth, int outNbChannels, int outFrequency, float sendVolume)
+{
+    int n = nbSamples * outNbChannels;
+    if (n <= 0)
+        return;
+
+    /* Convert the samples into floats */
+    drySamples.resize(n);
+    if (outBitDepth == 8) {
+        for (int s = 0; s < n; s++)
+            drySamples[s] = (mixedSamples[s] - 128) * (1.0f / 128.0f);
+    }
+    if (outBitDepth == 16) {
+        int16_t* mixedSamples16 = reinterpret_cast<int16_t*>(mixedSamples.data());
+        for (int s = 0; s < n; s++)
+            drySamples[s] = mixedSamples16[s] * (1.0f / 32768.0f);
+    }
+
+    /* Sends take the unfiltered signal, with their own filter */
+    for (int i = 0; i < MAX_SENDS; i++) {
+        if (!sends[i].slot)
+            continue;
+
+        sendSamples.assign(drySamples.begin(), drySamples.end());
+        sends[i].filter.process(sendSamples.data(), nbSamples, outNbChannels, outFrequency);
+        sends[i].slot->addInput(sendSamples.data(), nbSamples, outNbChannels, sendVolume);
+    }
+
+    if (directFilter.type == AudioFilter::FILTER_NULL)
+        return;
+
+    /* Filter and convert back the samples, which are then mixed as usual */
+    directFilter.process(drySamples.data(), nbSamples, outNbChannels, outFrequency);
+
+    if (outBitDepth == 8) {
+        for (int s = 0; s < n; s++) {
+            int v = static_cast<int>(drySamples[s] * 128.0f) + 128;
+            mixedSamples[s] = std::min(std::max(v, 0), static_cast<int>(UINT8_MAX));
+        }
+    }
+    if (outBitDepth == 16) {
+        int16_t* mixedSamples16 = reinterpret_cast<int16_t*>(mixedSamples.data());
+        for (int s = 0; s < n; s++) {
+            int v = static_cast<int>(drySamples[s] * 32768.0f);
+            mixedSamples16[s] = std::min(std::max(v, static_cast<int>(INT16_MIN)), static_cast<int>(INT16_MAX));
+        }
+    }
+}
+
 }
@@ -24,6 +24,8 @@
 #include <memory>
 #include <functional>
 #include "AudioBuffer.h"
+#include "AudioFilter.h"
+#include "AudioEffectSlot.h"
 extern "C" {
 #include <libswresample/swresample.h>
 }
@@ -122,6 +124,23 @@ class AudioSource
          */
         std::function<void(AudioBuffer&)> callback;
 
+        /* Filter applied to the samples that are directly mixed */
+        AudioFilter directFilter;
+
+        /* Maximum number of auxiliary sends of a source */
+        static const int MAX_SENDS = 2;
+
+        /* Auxiliary sends to effect slots, with a filter on each send */
+        struct AuxiliarySend {
+            std::shared_ptr<AudioEffectSlot> slot;
+            AudioFilter filter;
+        };
+        AuxiliarySend sends[MAX_SENDS];
+
+        /* Temporary arrays of samples for filters and sends */
+        std::vector<float> drySamples;
+        std::vector<float> sendSamples;
+
         /* Helper function to convert ticks into a number of samples
          * in the audio buffer
          */
@@ -130,6 +149,12 @@ class AudioSource
         /* Init parameters */
         void init();
 
+        /* Remove the direct filter and all auxiliary sends */
+        void initEffects();
+
+        /* Does the source use a filter or an auxiliary send? */
+        bool hasEffects();
+
         /* Rewind source to the beginning of the first buffer */
         void rewind();
 
@@ -170,6 +195,11 @@ class AudioSource
          * The function returns the number of samples written in the output buffer.
          */
         int mixWith( struct timespec ticks, uint8_t* outSamples, int outBytes, int outBitDepth, int outNbChannels, int outFrequency, float outVolume);
+
+    private:
+        /* Feed the auxiliary sends with the converted samples, and apply the
+         * direct filter on them before they are mixed */
+        void applyEffects(int nbSamples, int outBitDepth, int outNbChannels, int outFrequency, float sendVolume);
 };
 }
 
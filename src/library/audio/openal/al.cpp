@@ -656,7 +656,20 @@ void alSourcei(ALuint source, ALenum param, ALint value)
             debuglogstdio(LCF_SOUND, "Operation not supported: %d", param);
             break;
         case AL_DIRECT_FILTER:
-        debuglogstdio(LCF_SOUND, "Operation not supported: %d", param);
+            if (value == AL_FILTER_NULL) {
+                debuglogstdio(LCF_SOUND, "  Remove direct filter");
+                as->directFilter.init();
+            }
+            else {
+                /* Filter parameters are copied into the source */
+                auto af = audiocontext.getFilter(value);
+                if (!af) {
+                    alSetError(AL_INVALID_VALUE);
+                    return;
+                }
+                debuglogstdio(LCF_SOUND, "  Set direct filter %d", value);
+                as->directFilter.setParameters(*af);
+            }
             break;
         case AL_DIRECT_FILTER_GAINHF_AUTO:
             CHECKVAL(value == AL_FALSE || value == AL_TRUE);
@@ -680,12 +693,39 @@ void alSourcei(ALuint source, ALenum param, ALint value)
 void alSource3i(ALuint source, ALenum param, ALint v1, ALint v2, ALint v3)
 {
     debuglogstdio(LCF_SOUND, "%s called with source %d", __func__, source);
-    switch(param) {
-        case AL_AUXILIARY_SEND_FILTER:
-            debuglogstdio(LCF_SOUND, "Operation not supported");
-            return;
+    if (param != AL_AUXILIARY_SEND_FILTER) {
+        debuglogstdio(LCF_SOUND, "Operation not supported");
+        return;
     }
-    debuglogstdio(LCF_SOUND, "Operation not supported");
+
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    auto as = audiocontext.getSource(source);
+    if (!as) {
+        alSetError(AL_INVALID_NAME);
+        return;
+    }
+
+    /* Parameters are the effect slot, the send index and the filter */
+    CHECKVAL(v2 >= 0 && v2 < AudioSource::MAX_SENDS);
+
+    std::shared_ptr<AudioEffectSlot> aes;
+    if (v1 != AL_EFFECTSLOT_NULL) {
+        aes = audiocontext.getEffectSlot(v1);
+        CHECKVAL(aes);
+    }
+
+    std::shared_ptr<AudioFilter> af;
+    if (v3 != AL_FILTER_NULL) {
+        af = audiocontext.getFilter(v3);
+        CHECKVAL(af);
+    }
+
+    debuglogstdio(LCF_SOUND, "  Set send %d to effect slot %d with filter %d", v2, v1, v3);
+    as->sends[v2].slot = aes;
+    if (af)
+        as->sends[v2].filter.setParameters(*af);
+    else
+        as->sends[v2].filter.init();
 }
 
 void alSourceiv(ALuint source, ALenum param, ALint *values)
@@ -695,6 +735,11 @@ void alSourceiv(ALuint source, ALenum param, ALint *values)
         alSetError(AL_INVALID_VALUE);
         return;
     }
+
+    if (param == AL_AUXILIARY_SEND_FILTER) {
+        alSource3i(source, param, values[0], values[1], values[2]);
+        return;
+    }
     alSourcei(source, param, *values);
 }
 
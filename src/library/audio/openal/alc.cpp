@@ -367,7 +367,7 @@ void alcGetIntegerv(ALCdevice *device, ALCenum param, ALCsizei size, ALCint *val
             values[0] = 0;
             return;
         case ALC_MAX_AUXILIARY_SENDS:
-            debuglogstdio(LCF_SOUND | LCF_TODO, "Request max auxiliary sends");
+            debuglogstdio(LCF_SOUND, "Request max auxiliary sends");
             values[0] = 2;
             return;
         case ALC_NUM_HRTF_SPECIFIERS_SOFT:
@@ -17,180 +17,712 @@
     along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+
 #include "efx.h"
 #include "al.h"
 #include "../../logging.h"
+#include "../AudioContext.h"
+#include "../AudioEffect.h"
+#include "../AudioFilter.h"
+#include "../AudioEffectSlot.h"
 
 namespace libtas {
 
+/* Description of an effect parameter: which effect type it belongs to,
+ * where it is stored and its valid range */
+struct EffectParameter {
+    AudioEffect::EffectType type;
+    ALenum param;
+    float AudioEffect::* value;
+    float min;
+    float max;
+};
+
+static const EffectParameter effectParameters[] = {
+    {AudioEffect::EFFECT_REVERB, AL_REVERB_DENSITY, &AudioEffect::density, 0.0f, 1.0f},
+    {AudioEffect::EFFECT_REVERB, AL_REVERB_DIFFUSION, &AudioEffect::diffusion, 0.0f, 1.0f},
+    {AudioEffect::EFFECT_REVERB, AL_REVERB_GAIN, &AudioEffect::gain, 0.0f, 1.0f},
+    {AudioEffect::EFFECT_REVERB, AL_REVERB_GAINHF, &AudioEffect::gainHF, 0.0f, 1.0f},
+    {AudioEffect::EFFECT_REVERB, AL_REVERB_DECAY_TIME, &AudioEffect::decayTime, 0.1f, 20.0f},
+    {AudioEffect::EFFECT_REVERB, AL_REVERB_DECAY_HFRATIO, &AudioEffect::decayHFRatio, 0.1f, 2.0f},
+    {AudioEffect::EFFECT_REVERB, AL_REVERB_REFLECTIONS_GAIN, &AudioEffect::reflectionsGain, 0.0f, 3.16f},
+    {AudioEffect::EFFECT_REVERB, AL_REVERB_REFLECTIONS_DELAY, &AudioEffect::reflectionsDelay, 0.0f, 0.3f},
+    {AudioEffect::EFFECT_REVERB, AL_REVERB_LATE_REVERB_GAIN, &AudioEffect::lateReverbGain, 0.0f, 10.0f},
+    {AudioEffect::EFFECT_REVERB, AL_REVERB_LATE_REVERB_DELAY, &AudioEffect::lateReverbDelay, 0.0f, 0.1f},
+    {AudioEffect::EFFECT_REVERB, AL_REVERB_AIR_ABSORPTION_GAINHF, &AudioEffect::airAbsorptionGainHF, 0.892f, 1.0f},
+    {AudioEffect::EFFECT_REVERB, AL_REVERB_ROOM_ROLLOFF_FACTOR, &AudioEffect::roomRolloffFactor, 0.0f, 10.0f},
+    {AudioEffect::EFFECT_REVERB, AL_REVERB_DECAY_HFLIMIT, &AudioEffect::decayHFLimit, 0.0f, 1.0f},
+
+    {AudioEffect::EFFECT_EAXREVERB, AL_EAXREVERB_DENSITY, &AudioEffect::density, 0.0f, 1.0f},
+    {AudioEffect::EFFECT_EAXREVERB, AL_EAXREVERB_DIFFUSION, &AudioEffect::diffusion, 0.0f, 1.0f},
+    {AudioEffect::EFFECT_EAXREVERB, AL_EAXREVERB_GAIN, &AudioEffect::gain, 0.0f, 1.0f},
+    {AudioEffect::EFFECT_EAXREVERB, AL_EAXREVERB_GAINHF, &AudioEffect::gainHF, 0.0f, 1.0f},
+    {AudioEffect::EFFECT_EAXREVERB, AL_EAXREVERB_GAINLF, &AudioEffect::gainLF, 0.0f, 1.0f},
+    {AudioEffect::EFFECT_EAXREVERB, AL_EAXREVERB_DECAY_TIME, &AudioEffect::decayTime, 0.1f, 20.0f},
+    {AudioEffect::EFFECT_EAXREVERB, AL_EAXREVERB_DECAY_HFRATIO, &AudioEffect::decayHFRatio, 0.1f, 2.0f},
+    {AudioEffect::EFFECT_EAXREVERB, AL_EAXREVERB_DECAY_LFRATIO, &AudioEffect::decayLFRatio, 0.1f, 2.0f},
+    {AudioEffect::EFFECT_EAXREVERB, AL_EAXREVERB_REFLECTIONS_GAIN, &AudioEffect::reflectionsGain, 0.0f, 3.16f},
+    {AudioEffect::EFFECT_EAXREVERB, AL_EAXREVERB_REFLECTIONS_DELAY, &AudioEffect::reflectionsDelay, 0.0f, 0.3f},
+    {AudioEffect::EFFECT_EAXREVERB, AL_EAXREVERB_LATE_REVERB_GAIN, &AudioEffect::lateReverbGain, 0.0f, 10.0f},
+    {AudioEffect::EFFECT_EAXREVERB, AL_EAXREVERB_LATE_REVERB_DELAY, &AudioEffect::lateReverbDelay, 0.0f, 0.1f},
+    {AudioEffect::EFFECT_EAXREVERB, AL_EAXREVERB_ECHO_TIME, &AudioEffect::echoTime, 0.075f, 0.25f},
+    {AudioEffect::EFFECT_EAXREVERB, AL_EAXREVERB_ECHO_DEPTH, &AudioEffect::echoDepth, 0.0f, 1.0f},
+    {AudioEffect::EFFECT_EAXREVERB, AL_EAXREVERB_MODULATION_TIME, &AudioEffect::modulationTime, 0.04f, 4.0f},
+    {AudioEffect::EFFECT_EAXREVERB, AL_EAXREVERB_MODULATION_DEPTH, &AudioEffect::modulationDepth, 0.0f, 1.0f},
+    {AudioEffect::EFFECT_EAXREVERB, AL_EAXREVERB_AIR_ABSORPTION_GAINHF, &AudioEffect::airAbsorptionGainHF, 0.892f, 1.0f},
+    {AudioEffect::EFFECT_EAXREVERB, AL_EAXREVERB_HFREFERENCE, &AudioEffect::hfReference, 1000.0f, 20000.0f},
+    {AudioEffect::EFFECT_EAXREVERB, AL_EAXREVERB_LFREFERENCE, &AudioEffect::lfReference, 20.0f, 1000.0f},
+    {AudioEffect::EFFECT_EAXREVERB, AL_EAXREVERB_ROOM_ROLLOFF_FACTOR, &AudioEffect::roomRolloffFactor, 0.0f, 10.0f},
+    {AudioEffect::EFFECT_EAXREVERB, AL_EAXREVERB_DECAY_HFLIMIT, &AudioEffect::decayHFLimit, 0.0f, 1.0f},
+
+    {AudioEffect::EFFECT_ECHO, AL_ECHO_DELAY, &AudioEffect::echoDelay, 0.0f, 0.207f},
+    {AudioEffect::EFFECT_ECHO, AL_ECHO_LRDELAY, &AudioEffect::echoLRDelay, 0.0f, 0.404f},
+    {AudioEffect::EFFECT_ECHO, AL_ECHO_DAMPING, &AudioEffect::echoDamping, 0.0f, 0.99f},
+    {AudioEffect::EFFECT_ECHO, AL_ECHO_FEEDBACK, &AudioEffect::echoFeedback, 0.0f, 1.0f},
+    {AudioEffect::EFFECT_ECHO, AL_ECHO_SPREAD, &AudioEffect::echoSpread, -1.0f, 1.0f},
+};
+
+/* Same for filter parameters */
+struct FilterParameter {
+    AudioFilter::FilterType type;
+    ALenum param;
+    float AudioFilter::* value;
+};
+
+static const FilterParameter filterParameters[] = {
+    {AudioFilter::FILTER_LOWPASS, AL_LOWPASS_GAIN, &AudioFilter::gain},
+    {AudioFilter::FILTER_LOWPASS, AL_LOWPASS_GAINHF, &AudioFilter::gainHF},
+    {AudioFilter::FILTER_HIGHPASS, AL_HIGHPASS_GAIN, &AudioFilter::gain},
+    {AudioFilter::FILTER_HIGHPASS, AL_HIGHPASS_GAINLF, &AudioFilter::gainLF},
+    {AudioFilter::FILTER_BANDPASS, AL_BANDPASS_GAIN, &AudioFilter::gain},
+    {AudioFilter::FILTER_BANDPASS, AL_BANDPASS_GAINLF, &AudioFilter::gainLF},
+    {AudioFilter::FILTER_BANDPASS, AL_BANDPASS_GAINHF, &AudioFilter::gainHF},
+};
+
+/* Find the parameter of an effect, or nullptr if the effect has no such
+ * parameter. Set an error if the effect type is rendered, as we know all
+ * its parameters. */
+static const EffectParameter* findEffectParameter(const AudioEffect& effect, ALenum param)
+{
+    for (const auto& ep : effectParameters) {
+        if ((ep.type == effect.type) && (ep.param == param))
+            return &ep;
+    }
+
+    if (effect.isSupported() || (effect.type == AudioEffect::EFFECT_NULL))
+        alSetError(AL_INVALID_ENUM);
+    else
+        debuglogstdio(LCF_SOUND | LCF_TODO, "  Parameter %d of effect type %d is not supported", param, effect.type);
+    return nullptr;
+}
+
+static const FilterParameter* findFilterParameter(const AudioFilter& filter, ALenum param)
+{
+    for (const auto& fp : filterParameters) {
+        if ((fp.type == filter.type) && (fp.param == param))
+            return &fp;
+    }
+
+    alSetError(AL_INVALID_ENUM);
+    return nullptr;
+}
+
+static bool effectTypeFromAL(ALint value, AudioEffect::EffectType& type)
+{
+    /* Effect types up to the equalizer have the same order in openAL */
+    if ((value >= AL_EFFECT_NULL) && (value <= AL_EFFECT_EQUALIZER)) {
+        type = static_cast<AudioEffect::EffectType>(value);
+        return true;
+    }
+    if (value == AL_EFFECT_EAXREVERB) {
+        type = AudioEffect::EFFECT_EAXREVERB;
+        return true;
+    }
+    return false;
+}
+
+static ALint effectTypeToAL(AudioEffect::EffectType type)
+{
+    if (type == AudioEffect::EFFECT_EAXREVERB)
+        return AL_EFFECT_EAXREVERB;
+    return static_cast<ALint>(type);
+}
+
 ALvoid myalGenEffects(ALsizei n, ALuint *effects)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    debuglogstdio(LCF_SOUND, "%s call - generate %d effects", __func__, n);
+
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    for (int i=0; i<n; i++) {
+        int id = audiocontext.createEffect();
+        if (id > 0)
+            effects[i] = (ALuint) id;
+        else {
+            alSetError(AL_OUT_OF_MEMORY);
+            return;
+        }
+    }
 }
 
 ALvoid myalDeleteEffects(ALsizei n, const ALuint *effects)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    debuglogstdio(LCF_SOUND, "%s call - delete %d effects", __func__, n);
+
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    for (int i=0; i<n; i++) {
+        /* Check if all effects exist before removing any. */
+        if ((effects[i] != 0) && !audiocontext.isEffect(effects[i])) {
+            alSetError(AL_INVALID_NAME);
+            return;
+        }
+    }
+    for (int i=0; i<n; i++) {
+        audiocontext.deleteEffect(effects[i]);
+    }
 }
 
 ALboolean myalIsEffect(ALuint effect)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
-    return AL_TRUE;
+    DEBUGLOGCALL(LCF_SOUND);
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    return (effect == 0) || audiocontext.isEffect(effect);
 }
 
 ALvoid myalEffecti(ALuint effect, ALenum param, ALint iValue)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    debuglogstdio(LCF_SOUND, "%s called with effect %d", __func__, effect);
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    auto ae = audiocontext.getEffect(effect);
+    if (!ae) {
+        alSetError(AL_INVALID_NAME);
+        return;
+    }
+
+    if (param == AL_EFFECT_TYPE) {
+        AudioEffect::EffectType type;
+        if (!effectTypeFromAL(iValue, type)) {
+            alSetError(AL_INVALID_VALUE);
+            return;
+        }
+        debuglogstdio(LCF_SOUND, "  Set effect type %d", iValue);
+        if (type != ae->type)
+            ae->init(type);
+        return;
+    }
+
+    /* Integer parameters are stored as floats */
+    const EffectParameter* ep = findEffectParameter(*ae, param);
+    if (!ep)
+        return;
+    if ((iValue < ep->min) || (iValue > ep->max)) {
+        alSetError(AL_INVALID_VALUE);
+        return;
+    }
+    (*ae).*(ep->value) = static_cast<float>(iValue);
 }
 
 ALvoid myalEffectiv(ALuint effect, ALenum param, const ALint *piValues)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    debuglogstdio(LCF_SOUND, "%s called with effect %d", __func__, effect);
+    if (piValues == nullptr) {
+        alSetError(AL_INVALID_VALUE);
+        return;
+    }
+    myalEffecti(effect, param, *piValues);
 }
 
 ALvoid myalEffectf(ALuint effect, ALenum param, ALfloat flValue)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    debuglogstdio(LCF_SOUND, "%s called with effect %d, param %d and value %f", __func__, effect, param, flValue);
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    auto ae = audiocontext.getEffect(effect);
+    if (!ae) {
+        alSetError(AL_INVALID_NAME);
+        return;
+    }
+
+    const EffectParameter* ep = findEffectParameter(*ae, param);
+    if (!ep)
+        return;
+    if (!(flValue >= ep->min && flValue <= ep->max)) {
+        alSetError(AL_INVALID_VALUE);
+        return;
+    }
+    (*ae).*(ep->value) = flValue;
 }
 
 ALvoid myalEffectfv(ALuint effect, ALenum param, const ALfloat *pflValues)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    debuglogstdio(LCF_SOUND, "%s called with effect %d", __func__, effect);
+    if (pflValues == nullptr) {
+        alSetError(AL_INVALID_VALUE);
+        return;
+    }
+
+    if ((param == AL_EAXREVERB_REFLECTIONS_PAN) || (param == AL_EAXREVERB_LATE_REVERB_PAN)) {
+        std::lock_guard<std::mutex> lock(audiocontext.mutex);
+        auto ae = audiocontext.getEffect(effect);
+        if (!ae) {
+            alSetError(AL_INVALID_NAME);
+            return;
+        }
+        if (ae->type != AudioEffect::EFFECT_EAXREVERB) {
+            alSetError(AL_INVALID_ENUM);
+            return;
+        }
+
+        /* Panning is stored only, because we do not support positional audio */
+        float* pan = (param == AL_EAXREVERB_REFLECTIONS_PAN) ? ae->reflectionsPan : ae->lateReverbPan;
+        for (int i=0; i<3; i++)
+            pan[i] = pflValues[i];
+        return;
+    }
+
+    myalEffectf(effect, param, *pflValues);
 }
 
 ALvoid myalGetEffecti(ALuint effect, ALenum param, ALint *piValue)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    debuglogstdio(LCF_SOUND, "%s called with effect %d", __func__, effect);
+    if (piValue == nullptr) {
+        alSetError(AL_INVALID_VALUE);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    auto ae = audiocontext.getEffect(effect);
+    if (!ae) {
+        alSetError(AL_INVALID_NAME);
+        return;
+    }
+
+    if (param == AL_EFFECT_TYPE) {
+        *piValue = effectTypeToAL(ae->type);
+        return;
+    }
+
+    const EffectParameter* ep = findEffectParameter(*ae, param);
+    if (ep)
+        *piValue = static_cast<ALint>((*ae).*(ep->value));
 }
 
 ALvoid myalGetEffectiv(ALuint effect, ALenum param, ALint *piValues)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    myalGetEffecti(effect, param, piValues);
 }
 
 ALvoid myalGetEffectf(ALuint effect, ALenum param, ALfloat *pflValue)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    debuglogstdio(LCF_SOUND, "%s called with effect %d", __func__, effect);
+    if (pflValue == nullptr) {
+        alSetError(AL_INVALID_VALUE);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    auto ae = audiocontext.getEffect(effect);
+    if (!ae) {
+        alSetError(AL_INVALID_NAME);
+        return;
+    }
+
+    const EffectParameter* ep = findEffectParameter(*ae, param);
+    if (ep)
+        *pflValue = (*ae).*(ep->value);
 }
 
 ALvoid myalGetEffectfv(ALuint effect, ALenum param, ALfloat *pflValues)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    debuglogstdio(LCF_SOUND, "%s called with effect %d", __func__, effect);
+    if (pflValues == nullptr) {
+        alSetError(AL_INVALID_VALUE);
+        return;
+    }
+
+    if ((param == AL_EAXREVERB_REFLECTIONS_PAN) || (param == AL_EAXREVERB_LATE_REVERB_PAN)) {
+        std::lock_guard<std::mutex> lock(audiocontext.mutex);
+        auto ae = audiocontext.getEffect(effect);
+        if (!ae) {
+            alSetError(AL_INVALID_NAME);
+            return;
+        }
+        if (ae->type != AudioEffect::EFFECT_EAXREVERB) {
+            alSetError(AL_INVALID_ENUM);
+            return;
+        }
+
+        const float* pan = (param == AL_EAXREVERB_REFLECTIONS_PAN) ? ae->reflectionsPan : ae->lateReverbPan;
+        for (int i=0; i<3; i++)
+            pflValues[i] = pan[i];
+        return;
+    }
+
+    myalGetEffectf(effect, param, pflValues);
 }
 
 
 ALvoid myalGenFilters(ALsizei n, ALuint *filters)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    debuglogstdio(LCF_SOUND, "%s call - generate %d filters", __func__, n);
+
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    for (int i=0; i<n; i++) {
+        int id = audiocontext.createFilter();
+        if (id > 0)
+            filters[i] = (ALuint) id;
+        else {
+            alSetError(AL_OUT_OF_MEMORY);
+            return;
+        }
+    }
 }
 
 ALvoid myalDeleteFilters(ALsizei n, const ALuint *filters)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    debuglogstdio(LCF_SOUND, "%s call - delete %d filters", __func__, n);
+
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    for (int i=0; i<n; i++) {
+        /* Check if all filters exist before removing any. */
+        if ((filters[i] != 0) && !audiocontext.isFilter(filters[i])) {
+            alSetError(AL_INVALID_NAME);
+            return;
+        }
+    }
+    for (int i=0; i<n; i++) {
+        audiocontext.deleteFilter(filters[i]);
+    }
 }
 
 ALboolean myalIsFilter(ALuint filter)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
-    return AL_TRUE;
+    DEBUGLOGCALL(LCF_SOUND);
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    return (filter == 0) || audiocontext.isFilter(filter);
 }
 
 ALvoid myalFilteri(ALuint filter, ALenum param, ALint iValue)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    debuglogstdio(LCF_SOUND, "%s called with filter %d", __func__, filter);
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    auto af = audiocontext.getFilter(filter);
+    if (!af) {
+        alSetError(AL_INVALID_NAME);
+        return;
+    }
+
+    if (param != AL_FILTER_TYPE) {
+        /* Filters do not have integer parameters */
+        alSetError(AL_INVALID_ENUM);
+        return;
+    }
+
+    switch (iValue) {
+        case AL_FILTER_NULL:
+            af->type = AudioFilter::FILTER_NULL;
+            break;
+        case AL_FILTER_LOWPASS:
+            af->type = AudioFilter::FILTER_LOWPASS;
+            break;
+        case AL_FILTER_HIGHPASS:
+            af->type = AudioFilter::FILTER_HIGHPASS;
+            break;
+        case AL_FILTER_BANDPASS:
+            af->type = AudioFilter::FILTER_BANDPASS;
+            break;
+        default:
+            alSetError(AL_INVALID_VALUE);
+            return;
+    }
+    debuglogstdio(LCF_SOUND, "  Set filter type %d", iValue);
+
+    /* Changing the type resets the parameters to their default */
+    af->gain = 1.0f;
+    af->gainHF = 1.0f;
+    af->gainLF = 1.0f;
 }
 
 ALvoid myalFilteriv(ALuint filter, ALenum param, const ALint *piValues)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    debuglogstdio(LCF_SOUND, "%s called with filter %d", __func__, filter);
+    if (piValues == nullptr) {
+        alSetError(AL_INVALID_VALUE);
+        return;
+    }
+    myalFilteri(filter, param, *piValues);
 }
 
 ALvoid myalFilterf(ALuint filter, ALenum param, ALfloat flValue)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    debuglogstdio(LCF_SOUND, "%s called with filter %d, param %d and value %f", __func__, filter, param, flValue);
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    auto af = audiocontext.getFilter(filter);
+    if (!af) {
+        alSetError(AL_INVALID_NAME);
+        return;
+    }
+
+    const FilterParameter* fp = findFilterParameter(*af, param);
+    if (!fp)
+        return;
+
+    /* All filter parameters are gains between 0 and 1 */
+    if (!(flValue >= 0.0f && flValue <= 1.0f)) {
+        alSetError(AL_INVALID_VALUE);
+        return;
+    }
+    (*af).*(fp->value) = flValue;
 }
 
 ALvoid myalFilterfv(ALuint filter, ALenum param, const ALfloat *pflValues)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    debuglogstdio(LCF_SOUND, "%s called with filter %d", __func__, filter);
+    if (pflValues == nullptr) {
+        alSetError(AL_INVALID_VALUE);
+        return;
+    }
+    myalFilterf(filter, param, *pflValues);
 }
 
 ALvoid myalGetFilteri(ALuint filter, ALenum param, ALint *piValue)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    debuglogstdio(LCF_SOUND, "%s called with filter %d", __func__, filter);
+    if (piValue == nullptr) {
+        alSetError(AL_INVALID_VALUE);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    auto af = audiocontext.getFilter(filter);
+    if (!af) {
+        alSetError(AL_INVALID_NAME);
+        return;
+    }
+
+    if (param != AL_FILTER_TYPE) {
+        alSetError(AL_INVALID_ENUM);
+        return;
+    }
+
+    /* Filter types have the same order in openAL */
+    *piValue = static_cast<ALint>(af->type);
 }
 
 ALvoid myalGetFilteriv(ALuint filter, ALenum param, ALint *piValues)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    myalGetFilteri(filter, param, piValues);
 }
 
 ALvoid myalGetFilterf(ALuint filter, ALenum param, ALfloat *pflValue)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    debuglogstdio(LCF_SOUND, "%s called with filter %d", __func__, filter);
+    if (pflValue == nullptr) {
+        alSetError(AL_INVALID_VALUE);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    auto af = audiocontext.getFilter(filter);
+    if (!af) {
+        alSetError(AL_INVALID_NAME);
+        return;
+    }
+
+    const FilterParameter* fp = findFilterParameter(*af, param);
+    if (fp)
+        *pflValue = (*af).*(fp->value);
 }
 
 ALvoid myalGetFilterfv(ALuint filter, ALenum param, ALfloat *pflValues)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    myalGetFilterf(filter, param, pflValues);
 }
 
 
 ALvoid myalGenAuxiliaryEffectSlots(ALsizei n, ALuint *effectslots)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    debuglogstdio(LCF_SOUND, "%s call - generate %d effect slots", __func__, n);
+
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    for (int i=0; i<n; i++) {
+        int id = audiocontext.createEffectSlot();
+        if (id > 0)
+            effectslots[i] = (ALuint) id;
+        else {
+            alSetError(AL_OUT_OF_MEMORY);
+            return;
+        }
+    }
 }
 
 ALvoid myalDeleteAuxiliaryEffectSlots(ALsizei n, const ALuint *effectslots)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    debuglogstdio(LCF_SOUND, "%s call - delete %d effect slots", __func__, n);
+
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    for (int i=0; i<n; i++) {
+        /* Check if all slots exist before removing any. */
+        if ((effectslots[i] != 0) && !audiocontext.isEffectSlot(effectslots[i])) {
+            alSetError(AL_INVALID_NAME);
+            return;
+        }
+    }
+    for (int i=0; i<n; i++) {
+        audiocontext.deleteEffectSlot(effectslots[i]);
+    }
 }
 
 ALboolean myalIsAuxiliaryEffectSlot(ALuint effectslot)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
-    return AL_TRUE;
+    DEBUGLOGCALL(LCF_SOUND);
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    return audiocontext.isEffectSlot(effectslot);
 }
 
 ALvoid myalAuxiliaryEffectSloti(ALuint effectslot, ALenum param, ALint iValue)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    debuglogstdio(LCF_SOUND, "%s called with effect slot %d", __func__, effectslot);
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    auto aes = audiocontext.getEffectSlot(effectslot);
+    if (!aes) {
+        alSetError(AL_INVALID_NAME);
+        return;
+    }
+
+    switch (param) {
+        case AL_EFFECTSLOT_EFFECT:
+            if (iValue == 0) {
+                debuglogstdio(LCF_SOUND, "  Detach effect");
+                aes->setEffect(AudioEffect());
+            }
+            else {
+                /* The effect parameters are copied into the slot, so further
+                 * changes to the effect object are not applied until the
+                 * effect is attached again. */
+                auto ae = audiocontext.getEffect(iValue);
+                if (!ae) {
+                    alSetError(AL_INVALID_VALUE);
+                    return;
+                }
+                debuglogstdio(LCF_SOUND, "  Attach effect %d of type %d", iValue, ae->type);
+                aes->setEffect(*ae);
+            }
+            aes->effectId = iValue;
+            break;
+        case AL_EFFECTSLOT_AUXILIARY_SEND_AUTO:
+            if ((iValue != AL_FALSE) && (iValue != AL_TRUE)) {
+                alSetError(AL_INVALID_VALUE);
+                return;
+            }
+            aes->sendAuto = (iValue == AL_TRUE);
+            break;
+        default:
+            alSetError(AL_INVALID_ENUM);
+            return;
+    }
 }
 
 ALvoid myalAuxiliaryEffectSlotiv(ALuint effectslot, ALenum param, const ALint *piValues)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    debuglogstdio(LCF_SOUND, "%s called with effect slot %d", __func__, effectslot);
+    if (piValues == nullptr) {
+        alSetError(AL_INVALID_VALUE);
+        return;
+    }
+    myalAuxiliaryEffectSloti(effectslot, param, *piValues);
 }
 
 ALvoid myalAuxiliaryEffectSlotf(ALuint effectslot, ALenum param, ALfloat flValue)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    debuglogstdio(LCF_SOUND, "%s called with effect slot %d", __func__, effectslot);
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    auto aes = audiocontext.getEffectSlot(effectslot);
+    if (!aes) {
+        alSetError(AL_INVALID_NAME);
+        return;
+    }
+
+    if (param != AL_EFFECTSLOT_GAIN) {
+        alSetError(AL_INVALID_ENUM);
+        return;
+    }
+
+    if (!(flValue >= 0.0f && flValue <= 1.0f)) {
+        alSetError(AL_INVALID_VALUE);
+        return;
+    }
+    debuglogstdio(LCF_SOUND, "  Set gain of %f", flValue);
+    aes->gain = flValue;
 }
 
 ALvoid myalAuxiliaryEffectSlotfv(ALuint effectslot, ALenum param, const ALfloat *pflValues)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    debuglogstdio(LCF_SOUND, "%s called with effect slot %d", __func__, effectslot);
+    if (pflValues == nullptr) {
+        alSetError(AL_INVALID_VALUE);
+        return;
+    }
+    myalAuxiliaryEffectSlotf(effectslot, param, *pflValues);
 }
 
 ALvoid myalGetAuxiliaryEffectSloti(ALuint effectslot, ALenum param, ALint *piValue)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    debuglogstdio(LCF_SOUND, "%s called with effect slot %d", __func__, effectslot);
+    if (piValue == nullptr) {
+        alSetError(AL_INVALID_VALUE);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    auto aes = audiocontext.getEffectSlot(effectslot);
+    if (!aes) {
+        alSetError(AL_INVALID_NAME);
+        return;
+    }
+
+    switch (param) {
+        case AL_EFFECTSLOT_EFFECT:
+            *piValue = aes->effectId;
+            break;
+        case AL_EFFECTSLOT_AUXILIARY_SEND_AUTO:
+            *piValue = aes->sendAuto ? AL_TRUE : AL_FALSE;
+            break;
+        default:
+            alSetError(AL_INVALID_ENUM);
+            return;
+    }
 }
 
 ALvoid myalGetAuxiliaryEffectSlotiv(ALuint effectslot, ALenum param, ALint *piValues)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    myalGetAuxiliaryEffectSloti(effectslot, param, piValues);
 }
 
 ALvoid myalGetAuxiliaryEffectSlotf(ALuint effectslot, ALenum param, ALfloat *pflValue)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    debuglogstdio(LCF_SOUND, "%s called with effect slot %d", __func__, effectslot);
+    if (pflValue == nullptr) {
+        alSetError(AL_INVALID_VALUE);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    auto aes = audiocontext.getEffectSlot(effectslot);
+    if (!aes) {
+        alSetError(AL_INVALID_NAME);
+        return;
+    }
+
+    if (param != AL_EFFECTSLOT_GAIN) {
+        alSetError(AL_INVALID_ENUM);
+        return;
+    }
+    *pflValue = aes->gain;
 }
 
 ALvoid myalGetAuxiliaryEffectSlotfv(ALuint effectslot, ALenum param, ALfloat *pflValues)
 {
-    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    myalGetAuxiliaryEffectSlotf(effectslot, param, pflValues);
 }
 
 }
@@ -0,0 +1,468 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "context.h"
+#include "stream.h"
+#include "../../logging.h"
+#include "../../global.h" // shared_config, game_info
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <strings.h>
+
+namespace libtas {
+
+static void context_set_state(pa_context *c, pa_context_state_t state)
+{
+    c->state = state;
+    if (c->state_callback)
+        c->state_callback(c, c->state_userdata);
+}
+
+pa_context *pa_context_new(pa_mainloop_api *mainloop, const char *name)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+
+    pa_context *c = new pa_context;
+    c->refcount = 1;
+    c->loop = pulse_loop_from_api(mainloop);
+    c->state = PA_CONTEXT_UNCONNECTED;
+    c->error = PA_OK;
+    c->state_callback = nullptr;
+    c->state_userdata = nullptr;
+    c->subscribe_callback = nullptr;
+    c->subscribe_userdata = nullptr;
+    c->loop->contexts.push_back(c);
+    return c;
+}
+
+pa_context *pa_context_new_with_proplist(pa_mainloop_api *mainloop, const char *name, const pa_proplist *proplist)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return pa_context_new(mainloop, name);
+}
+
+void pa_context_unref(pa_context *c)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (--c->refcount > 0)
+        return;
+
+    auto& contexts = c->loop->contexts;
+    contexts.erase(std::remove(contexts.begin(), contexts.end(), c), contexts.end());
+    delete c;
+}
+
+pa_context* pa_context_ref(pa_context *c)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    c->refcount++;
+    return c;
+}
+
+void pa_context_set_state_callback(pa_context *c, pa_context_notify_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    c->state_callback = cb;
+    c->state_userdata = userdata;
+}
+
+int pa_context_errno(const pa_context *c)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return c->error;
+}
+
+int pa_context_is_pending(const pa_context *c)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return !c->loop->pending.empty();
+}
+
+pa_context_state_t pa_context_get_state(const pa_context *c)
+{
+    DEBUGLOGCALL(LCF_SOUND | LCF_FREQUENT);
+    return c->state;
+}
+
+int pa_context_connect(pa_context *c, const char *server, pa_context_flags_t flags, const pa_spawn_api *api)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+
+    if (c->state != PA_CONTEXT_UNCONNECTED) {
+        c->error = PA_ERR_BADSTATE;
+        return -PA_ERR_BADSTATE;
+    }
+
+    if (shared_config.audio_disabled) {
+        c->error = PA_ERR_CONNECTIONREFUSED;
+        context_set_state(c, PA_CONTEXT_FAILED);
+        return -PA_ERR_CONNECTIONREFUSED;
+    }
+
+    if (!(game_info.audio & GameInfo::PULSEAUDIO)) {
+        game_info.audio |= GameInfo::PULSEAUDIO;
+        game_info.tosend = true;
+    }
+
+    context_set_state(c, PA_CONTEXT_CONNECTING);
+
+    pa_context_ref(c);
+    pulse_defer(c->loop, [c]() {
+        if (c->state == PA_CONTEXT_CONNECTING)
+            context_set_state(c, PA_CONTEXT_READY);
+        pa_context_unref(c);
+    });
+
+    return 0;
+}
+
+void pa_context_disconnect(pa_context *c)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+
+    /* Streams are terminated with their context */
+    std::vector<pa_stream*> streams = c->streams;
+    for (pa_stream *s : streams)
+        pa_stream_disconnect(s);
+
+    context_set_state(c, PA_CONTEXT_TERMINATED);
+}
+
+pa_operation* pulse_context_operation(pa_context *c, std::function<void()> callback)
+{
+    /* One reference for the client and one for the loop */
+    pa_operation *o = new pa_operation;
+    o->refcount = 2;
+    o->state = PA_OPERATION_RUNNING;
+
+    pa_context_ref(c);
+    pulse_defer(c->loop, [c, o, callback]() {
+        if (o->state == PA_OPERATION_RUNNING) {
+            o->state = PA_OPERATION_DONE;
+            if (callback)
+                callback();
+        }
+        pa_operation_unref(o);
+        pa_context_unref(c);
+    });
+    return o;
+}
+
+/* Create an operation that reports success on the next iteration */
+static pa_operation* context_success_operation(pa_context *c, pa_context_success_cb_t cb, void *userdata)
+{
+    return pulse_context_operation(c, [c, cb, userdata]() {
+        if (cb)
+            cb(c, 1, userdata);
+    });
+}
+
+pa_operation* pa_context_drain(pa_context *c, pa_context_notify_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    c->error = PA_ERR_BADSTATE;
+    return nullptr;
+}
+
+const char* pa_context_get_server(const pa_context *c)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return "libtas";
+}
+
+uint32_t pa_context_get_protocol_version(const pa_context *c)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return 35;
+}
+
+uint32_t pa_context_get_server_protocol_version(const pa_context *c)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (c->state != PA_CONTEXT_READY)
+        return PA_INVALID_INDEX;
+    return 35;
+}
+
+int pa_context_is_local(const pa_context *c)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (c->state != PA_CONTEXT_READY)
+        return -1;
+    return 1;
+}
+
+uint32_t pa_context_get_index(const pa_context *c)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (c->state != PA_CONTEXT_READY)
+        return PA_INVALID_INDEX;
+    return 0;
+}
+
+pa_operation* pa_context_set_name(pa_context *c, const char *name, pa_context_success_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return context_success_operation(c, cb, userdata);
+}
+
+pa_operation* pa_context_proplist_update(pa_context *c, pa_update_mode_t mode, const pa_proplist *p, pa_context_success_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return context_success_operation(c, cb, userdata);
+}
+
+pa_operation* pa_context_proplist_remove(pa_context *c, const char *const keys[], pa_context_success_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return context_success_operation(c, cb, userdata);
+}
+
+void pa_context_set_event_callback(pa_context *p, pa_context_event_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    /* There is no server to send events */
+}
+
+static const char* const error_strings[PA_ERR_MAX] = {
+    "OK",
+    "Access denied",
+    "Unknown command",
+    "Invalid argument",
+    "Entity exists",
+    "No such entity",
+    "Connection refused",
+    "Protocol error",
+    "Timeout",
+    "No authentication key",
+    "Internal error",
+    "Connection terminated",
+    "Entity killed",
+    "Invalid server",
+    "Module initialization failed",
+    "Bad state",
+    "No data",
+    "Incompatible protocol version",
+    "Too large",
+    "Not supported",
+    "Unknown error code",
+    "No such extension",
+    "Obsolete functionality",
+    "Missing implementation",
+    "Client forked",
+    "Input/Output error",
+    "Device or resource busy"
+};
+
+const char *pa_strerror(int error)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (error < 0)
+        error = -error;
+    if (error >= PA_ERR_MAX)
+        return nullptr;
+    return error_strings[error];
+}
+
+const char *pa_get_library_version(void)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return "13.0.0";
+}
+
+size_t pa_sample_size(const pa_sample_spec *spec)
+{
+    DEBUGLOGCALL(LCF_SOUND | LCF_FREQUENT);
+    switch (spec->format) {
+        case PA_SAMPLE_U8:
+        case PA_SAMPLE_ALAW:
+        case PA_SAMPLE_ULAW:
+            return 1;
+        case PA_SAMPLE_S16LE:
+        case PA_SAMPLE_S16BE:
+            return 2;
+        case PA_SAMPLE_S24LE:
+        case PA_SAMPLE_S24BE:
+            return 3;
+        case PA_SAMPLE_FLOAT32LE:
+        case PA_SAMPLE_FLOAT32BE:
+        case PA_SAMPLE_S32LE:
+        case PA_SAMPLE_S32BE:
+        case PA_SAMPLE_S24_32LE:
+        case PA_SAMPLE_S24_32BE:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+size_t pa_frame_size(const pa_sample_spec *spec)
+{
+    DEBUGLOGCALL(LCF_SOUND | LCF_FREQUENT);
+    return pa_sample_size(spec) * spec->channels;
+}
+
+size_t pa_bytes_per_second(const pa_sample_spec *spec)
+{
+    DEBUGLOGCALL(LCF_SOUND | LCF_FREQUENT);
+    return spec->rate * pa_frame_size(spec);
+}
+
+pa_usec_t pa_bytes_to_usec(uint64_t length, const pa_sample_spec *spec)
+{
+    DEBUGLOGCALL(LCF_SOUND | LCF_FREQUENT);
+    size_t frame_size = pa_frame_size(spec);
+    if (frame_size == 0 || spec->rate == 0)
+        return 0;
+    return ((length / frame_size) * 1000000) / spec->rate;
+}
+
+size_t pa_usec_to_bytes(pa_usec_t t, const pa_sample_spec *spec)
+{
+    DEBUGLOGCALL(LCF_SOUND | LCF_FREQUENT);
+    return ((t * spec->rate) / 1000000) * pa_frame_size(spec);
+}
+
+int pa_sample_spec_valid(const pa_sample_spec *spec)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return spec && (spec->format >= 0) && (spec->format < PA_SAMPLE_MAX) &&
+        (spec->rate > 0) && (spec->channels > 0) && (spec->channels <= PA_CHANNELS_MAX);
+}
+
+int pa_sample_spec_equal(const pa_sample_spec *a, const pa_sample_spec *b)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return (a->format == b->format) && (a->rate == b->rate) && (a->channels == b->channels);
+}
+
+static const char* const format_strings[PA_SAMPLE_MAX] = {
+    "u8",
+    "aLaw",
+    "uLaw",
+    "s16le",
+    "s16be",
+    "float32le",
+    "float32be",
+    "s32le",
+    "s32be",
+    "s24le",
+    "s24be",
+    "s24-32le",
+    "s24-32be"
+};
+
+const char *pa_sample_format_to_string(pa_sample_format_t f)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (f < 0 || f >= PA_SAMPLE_MAX)
+        return nullptr;
+    return format_strings[f];
+}
+
+pa_sample_format_t pa_parse_sample_format(const char *format)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    for (int f = 0; f < PA_SAMPLE_MAX; f++)
+        if (strcasecmp(format, format_strings[f]) == 0)
+            return static_cast<pa_sample_format_t>(f);
+
+    /* Native endianness aliases */
+    if (strcasecmp(format, "s16") == 0 || strcasecmp(format, "s16ne") == 0)
+        return PA_SAMPLE_S16LE;
+    if (strcasecmp(format, "s32") == 0 || strcasecmp(format, "s32ne") == 0)
+        return PA_SAMPLE_S32LE;
+    if (strcasecmp(format, "float32") == 0 || strcasecmp(format, "float32ne") == 0)
+        return PA_SAMPLE_FLOAT32LE;
+    return PA_SAMPLE_INVALID;
+}
+
+char *pa_sample_spec_snprint(char *s, size_t l, const pa_sample_spec *spec)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (!pa_sample_spec_valid(spec))
+        snprintf(s, l, "(invalid)");
+    else
+        snprintf(s, l, "%s %uch %uHz", pa_sample_format_to_string(spec->format), spec->channels, spec->rate);
+    return s;
+}
+
+void* pa_xmalloc(size_t l)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    void *p = malloc(l ? l : 1);
+    if (!p)
+        abort();
+    return p;
+}
+
+void* pa_xmalloc0(size_t l)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    void *p = calloc(1, l ? l : 1);
+    if (!p)
+        abort();
+    return p;
+}
+
+void* pa_xrealloc(void *ptr, size_t size)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    void *p = realloc(ptr, size ? size : 1);
+    if (!p)
+        abort();
+    return p;
+}
+
+void pa_xfree(void *p)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    free(p);
+}
+
+char* pa_xstrdup(const char *s)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (!s)
+        return nullptr;
+    size_t l = strlen(s);
+    char *r = static_cast<char*>(pa_xmalloc(l + 1));
+    memcpy(r, s, l + 1);
+    return r;
+}
+
+char* pa_xstrndup(const char *s, size_t l)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (!s)
+        return nullptr;
+    const char *e = static_cast<const char*>(memchr(s, 0, l));
+    if (e)
+        l = e - s;
+    char *r = static_cast<char*>(pa_xmalloc(l + 1));
+    memcpy(r, s, l);
+    r[l] = '\0';
+    return r;
+}
+
+}
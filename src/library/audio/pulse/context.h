@@ -0,0 +1,80 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LIBTAS_PULSE_CONTEXT_H_INCL
+#define LIBTAS_PULSE_CONTEXT_H_INCL
+
+#include "../../global.h"
+#include "pulsetypes.h"
+
+namespace libtas {
+
+OVERRIDE pa_context *pa_context_new(pa_mainloop_api *mainloop, const char *name);
+OVERRIDE pa_context *pa_context_new_with_proplist(pa_mainloop_api *mainloop, const char *name, const pa_proplist *proplist);
+OVERRIDE void pa_context_unref(pa_context *c);
+OVERRIDE pa_context* pa_context_ref(pa_context *c);
+OVERRIDE void pa_context_set_state_callback(pa_context *c, pa_context_notify_cb_t cb, void *userdata);
+OVERRIDE int pa_context_errno(const pa_context *c);
+OVERRIDE int pa_context_is_pending(const pa_context *c);
+OVERRIDE pa_context_state_t pa_context_get_state(const pa_context *c);
+
+/* Connect the context to the specified server. There is no server, so the
+ * context becomes ready on the next iteration of the main loop */
+OVERRIDE int pa_context_connect(pa_context *c, const char *server, pa_context_flags_t flags, const pa_spawn_api *api);
+OVERRIDE void pa_context_disconnect(pa_context *c);
+
+/* Drain the context. There is no pending request to the server, so this
+ * returns NULL as libpulse does in that case */
+OVERRIDE pa_operation* pa_context_drain(pa_context *c, pa_context_notify_cb_t cb, void *userdata);
+OVERRIDE const char* pa_context_get_server(const pa_context *c);
+OVERRIDE uint32_t pa_context_get_protocol_version(const pa_context *c);
+OVERRIDE uint32_t pa_context_get_server_protocol_version(const pa_context *c);
+OVERRIDE int pa_context_is_local(const pa_context *c);
+OVERRIDE uint32_t pa_context_get_index(const pa_context *c);
+OVERRIDE pa_operation* pa_context_set_name(pa_context *c, const char *name, pa_context_success_cb_t cb, void *userdata);
+OVERRIDE pa_operation* pa_context_proplist_update(pa_context *c, pa_update_mode_t mode, const pa_proplist *p, pa_context_success_cb_t cb, void *userdata);
+OVERRIDE pa_operation* pa_context_proplist_remove(pa_context *c, const char *const keys[], pa_context_success_cb_t cb, void *userdata);
+OVERRIDE void pa_context_set_event_callback(pa_context *p, pa_context_event_cb_t cb, void *userdata);
+
+OVERRIDE const char *pa_strerror(int error);
+OVERRIDE const char *pa_get_library_version(void);
+
+OVERRIDE size_t pa_sample_size(const pa_sample_spec *spec);
+OVERRIDE size_t pa_frame_size(const pa_sample_spec *spec);
+OVERRIDE size_t pa_bytes_per_second(const pa_sample_spec *spec);
+OVERRIDE pa_usec_t pa_bytes_to_usec(uint64_t length, const pa_sample_spec *spec);
+OVERRIDE size_t pa_usec_to_bytes(pa_usec_t t, const pa_sample_spec *spec);
+OVERRIDE int pa_sample_spec_valid(const pa_sample_spec *spec);
+OVERRIDE int pa_sample_spec_equal(const pa_sample_spec *a, const pa_sample_spec *b);
+OVERRIDE const char *pa_sample_format_to_string(pa_sample_format_t f);
+OVERRIDE pa_sample_format_t pa_parse_sample_format(const char *format);
+OVERRIDE char *pa_sample_spec_snprint(char *s, size_t l, const pa_sample_spec *spec);
+
+/* Memory functions, so that clients can free the strings that we return */
+OVERRIDE void* pa_xmalloc(size_t l);
+OVERRIDE void* pa_xmalloc0(size_t l);
+OVERRIDE void* pa_xrealloc(void *ptr, size_t size);
+OVERRIDE void pa_xfree(void *p);
+OVERRIDE char* pa_xstrdup(const char *s);
+OVERRIDE char* pa_xstrndup(const char *s, size_t l);
+
+}
+
+#endif
@@ -0,0 +1,216 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "introspect.h"
+#include "context.h"
+#include "volume.h"
+#include "../../logging.h"
+#include "../AudioContext.h"
+#include "../AudioSource.h"
+
+#include <cstring>
+
+namespace libtas {
+
+static const char* const sink_name = "libtas";
+
+static pa_sample_spec mixer_sample_spec()
+{
+    pa_sample_spec ss;
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    ss.format = (audiocontext.outBitDepth == 8) ? PA_SAMPLE_U8 : PA_SAMPLE_S16LE;
+    ss.channels = audiocontext.outNbChannels;
+    ss.rate = audiocontext.outFrequency;
+    return ss;
+}
+
+pa_operation* pa_context_get_server_info(pa_context *c, pa_server_info_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+
+    return pulse_context_operation(c, [c, cb, userdata]() {
+        pa_server_info i;
+        memset(&i, 0, sizeof(i));
+        i.user_name = "libtas";
+        i.host_name = "libtas";
+        i.server_version = pa_get_library_version();
+        i.server_name = "pulseaudio";
+        i.sample_spec = mixer_sample_spec();
+        pa_channel_map_init_auto(&i.channel_map, i.sample_spec.channels, PA_CHANNEL_MAP_DEFAULT);
+        i.default_sink_name = sink_name;
+        i.default_source_name = nullptr;
+        if (cb)
+            cb(c, &i, userdata);
+    });
+}
+
+/* Send the info of our sink if it matches, followed by the end of list */
+static pa_operation* sink_info_operation(pa_context *c, const char *name, uint32_t idx, bool all, pa_sink_info_cb_t cb, void *userdata)
+{
+    bool found = all || (name && (strcmp(name, sink_name) == 0)) || (!name && (idx == 0));
+
+    return pulse_context_operation(c, [c, found, all, cb, userdata]() {
+        if (!cb)
+            return;
+
+        if (found) {
+            pa_sink_info i;
+            memset(&i, 0, sizeof(i));
+            i.name = sink_name;
+            i.index = 0;
+            i.description = "libTAS audio mixer";
+            i.sample_spec = mixer_sample_spec();
+            pa_channel_map_init_auto(&i.channel_map, i.sample_spec.channels, PA_CHANNEL_MAP_DEFAULT);
+            i.owner_module = PA_INVALID_INDEX;
+            pa_cvolume_set(&i.volume, i.sample_spec.channels, PA_VOLUME_NORM);
+            i.monitor_source = PA_INVALID_INDEX;
+            i.driver = "libtas";
+            i.flags = PA_SINK_HARDWARE;
+            i.base_volume = PA_VOLUME_NORM;
+            i.state = PA_SINK_RUNNING;
+            i.n_volume_steps = PA_VOLUME_NORM + 1;
+            i.card = PA_INVALID_INDEX;
+            cb(c, &i, 0, userdata);
+        }
+        else if (!all) {
+            c->error = PA_ERR_NOENTITY;
+            cb(c, nullptr, -1, userdata);
+            return;
+        }
+
+        cb(c, nullptr, 1, userdata);
+    });
+}
+
+pa_operation* pa_context_get_sink_info_list(pa_context *c, pa_sink_info_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return sink_info_operation(c, nullptr, 0, true, cb, userdata);
+}
+
+pa_operation* pa_context_get_sink_info_by_name(pa_context *c, const char *name, pa_sink_info_cb_t cb, void *userdata)
+{
+    debuglogstdio(LCF_SOUND, "%s call with name %s", __func__, name ? name : "<NULL>");
+    /* A null name designates the default sink */
+    if (!name)
+        name = sink_name;
+    return sink_info_operation(c, name, 0, false, cb, userdata);
+}
+
+pa_operation* pa_context_get_sink_info_by_index(pa_context *c, uint32_t idx, pa_sink_info_cb_t cb, void *userdata)
+{
+    debuglogstdio(LCF_SOUND, "%s call with index %u", __func__, idx);
+    return sink_info_operation(c, nullptr, idx, false, cb, userdata);
+}
+
+/* There is no source, so lists are empty and lookups fail */
+static pa_operation* source_info_operation(pa_context *c, bool all, pa_source_info_cb_t cb, void *userdata)
+{
+    return pulse_context_operation(c, [c, all, cb, userdata]() {
+        if (!cb)
+            return;
+
+        if (all) {
+            cb(c, nullptr, 1, userdata);
+        }
+        else {
+            c->error = PA_ERR_NOENTITY;
+            cb(c, nullptr, -1, userdata);
+        }
+    });
+}
+
+pa_operation* pa_context_get_source_info_list(pa_context *c, pa_source_info_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return source_info_operation(c, true, cb, userdata);
+}
+
+pa_operation* pa_context_get_source_info_by_name(pa_context *c, const char *name, pa_source_info_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return source_info_operation(c, false, cb, userdata);
+}
+
+pa_operation* pa_context_get_source_info_by_index(pa_context *c, uint32_t idx, pa_source_info_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return source_info_operation(c, false, cb, userdata);
+}
+
+pa_operation* pa_context_get_sink_input_info_list(pa_context *c, pa_sink_input_info_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+
+    /* We don't describe our streams, only send the end of list */
+    return pulse_context_operation(c, [c, cb, userdata]() {
+        if (cb)
+            cb(c, nullptr, 1, userdata);
+    });
+}
+
+pa_operation* pa_context_set_sink_input_volume(pa_context *c, uint32_t idx, const pa_cvolume *volume, pa_context_success_cb_t cb, void *userdata)
+{
+    debuglogstdio(LCF_SOUND, "%s call with index %u", __func__, idx);
+
+    bool success = false;
+    if (pa_cvolume_valid(volume)) {
+        std::lock_guard<std::mutex> lock(audiocontext.mutex);
+        auto source = audiocontext.getSource(idx);
+        if (source) {
+            source->volume = static_cast<float>(pa_sw_volume_to_linear(pa_cvolume_avg(volume)));
+            success = true;
+        }
+    }
+
+    return pulse_context_operation(c, [c, success, cb, userdata]() {
+        if (!success)
+            c->error = PA_ERR_NOENTITY;
+        if (cb)
+            cb(c, success, userdata);
+    });
+}
+
+pa_operation* pa_context_set_sink_input_mute(pa_context *c, uint32_t idx, int mute, pa_context_success_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    return pulse_context_operation(c, [c, cb, userdata]() {
+        if (cb)
+            cb(c, 1, userdata);
+    });
+}
+
+pa_operation* pa_context_subscribe(pa_context *c, pa_subscription_mask_t m, pa_context_success_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return pulse_context_operation(c, [c, cb, userdata]() {
+        if (cb)
+            cb(c, 1, userdata);
+    });
+}
+
+void pa_context_set_subscribe_callback(pa_context *c, pa_context_subscribe_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    c->subscribe_callback = cb;
+    c->subscribe_userdata = userdata;
+}
+
+}
@@ -0,0 +1,472 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "mainloop.h"
+#include "stream.h"
+#include "../../logging.h"
+#include "../../GlobalState.h"
+#include "../../DeterministicTimer.h"
+
+#include <time.h> // nanosleep
+#include <algorithm>
+
+namespace libtas {
+
+/* Loop used for contexts created with a mainloop api that is not ours */
+static pa_threaded_mainloop *fallback_loop = nullptr;
+
+/* There are no file descriptors to watch, because there is no server */
+static pa_io_event* api_io_new(pa_mainloop_api *a, int fd, pa_io_event_flags_t events, pa_io_event_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    debuglogstdio(LCF_SOUND | LCF_WARNING, "IO events are not supported");
+    return nullptr;
+}
+
+static void api_io_enable(pa_io_event *e, pa_io_event_flags_t events)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+}
+
+static void api_io_free(pa_io_event *e)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+}
+
+static void api_io_set_destroy(pa_io_event *e, pa_io_event_destroy_cb_t cb)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+}
+
+/* Flag set in tv_usec by libpulse for events on the monotonic clock */
+#define PA_TIMEVAL_RTCLOCK (1U << 30)
+
+static void set_time_event_tv(pa_time_event *e, const struct timeval *tv)
+{
+    if (tv) {
+        e->tv.tv_sec = tv->tv_sec;
+        e->tv.tv_usec = tv->tv_usec & ~PA_TIMEVAL_RTCLOCK;
+        e->enabled = true;
+    }
+    else {
+        e->enabled = false;
+    }
+}
+
+static pa_time_event* api_time_new(pa_mainloop_api *a, const struct timeval *tv, pa_time_event_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    pa_mainloop *loop = static_cast<pa_mainloop*>(a->userdata);
+
+    pa_time_event *e = new pa_time_event;
+    e->loop = loop;
+    set_time_event_tv(e, tv);
+    e->callback = cb;
+    e->destroy_callback = nullptr;
+    e->userdata = userdata;
+    e->dead = false;
+    loop->time_events.push_back(e);
+    return e;
+}
+
+static void api_time_restart(pa_time_event *e, const struct timeval *tv)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    set_time_event_tv(e, tv);
+}
+
+static void api_time_free(pa_time_event *e)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    /* Same as defer events */
+    e->dead = true;
+    if (e->destroy_callback)
+        e->destroy_callback(&e->loop->api, e, e->userdata);
+}
+
+static void api_time_set_destroy(pa_time_event *e, pa_time_event_destroy_cb_t cb)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    e->destroy_callback = cb;
+}
+
+static pa_defer_event* api_defer_new(pa_mainloop_api *a, pa_defer_event_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    pa_mainloop *loop = static_cast<pa_mainloop*>(a->userdata);
+
+    pa_defer_event *e = new pa_defer_event;
+    e->loop = loop;
+    e->callback = cb;
+    e->destroy_callback = nullptr;
+    e->userdata = userdata;
+    e->enabled = true;
+    e->dead = false;
+    loop->defer_events.push_back(e);
+    return e;
+}
+
+static void api_defer_enable(pa_defer_event *e, int b)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    e->enabled = b;
+}
+
+static void api_defer_free(pa_defer_event *e)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    /* The event may be freed from its own callback, so it is only removed
+     * at the end of the dispatch */
+    e->dead = true;
+    if (e->destroy_callback)
+        e->destroy_callback(&e->loop->api, e, e->userdata);
+}
+
+static void api_defer_set_destroy(pa_defer_event *e, pa_defer_event_destroy_cb_t cb)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    e->destroy_callback = cb;
+}
+
+static void api_quit(pa_mainloop_api *a, int retval)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    pa_mainloop_quit(static_cast<pa_mainloop*>(a->userdata), retval);
+}
+
+void pulse_defer(pa_mainloop *loop, std::function<void()> callback)
+{
+    loop->pending.push_back(callback);
+}
+
+int pulse_dispatch(pa_mainloop *loop)
+{
+    int count = 0;
+
+    /* Callbacks may queue other callbacks */
+    std::vector<std::function<void()>> pending;
+    pending.swap(loop->pending);
+    for (auto& callback : pending) {
+        callback();
+        count++;
+    }
+
+    for (size_t i = 0; i < loop->defer_events.size(); i++) {
+        pa_defer_event *e = loop->defer_events[i];
+        if (e->enabled && !e->dead) {
+            e->callback(&loop->api, e, e->userdata);
+            count++;
+        }
+    }
+
+    /* Time events are disabled before their callback, which can restart
+     * them. Callbacks may also add events, so we don't use iterators. */
+    struct timespec now = detTimer.getTicks();
+    for (size_t i = 0; i < loop->time_events.size(); i++) {
+        pa_time_event *e = loop->time_events[i];
+        if (!e->enabled || e->dead)
+            continue;
+        if ((e->tv.tv_sec > now.tv_sec) ||
+            ((e->tv.tv_sec == now.tv_sec) && (e->tv.tv_usec * 1000 > now.tv_nsec)))
+            continue;
+
+        e->enabled = false;
+        struct timeval tv = e->tv;
+        e->callback(&loop->api, e, &tv, e->userdata);
+        count++;
+    }
+
+    /* Contexts and streams may be removed by callbacks, so we keep a
+     * reference during the poll */
+    std::vector<pa_stream*> streams;
+    for (pa_context *c : loop->contexts) {
+        for (pa_stream *s : c->streams) {
+            pa_stream_ref(s);
+            streams.push_back(s);
+        }
+    }
+    for (pa_stream *s : streams) {
+        count += pulse_stream_poll(s);
+        pa_stream_unref(s);
+    }
+
+    auto it = std::remove_if(loop->defer_events.begin(), loop->defer_events.end(),
+        [](pa_defer_event *e) {
+            if (!e->dead)
+                return false;
+            delete e;
+            return true;
+        });
+    loop->defer_events.erase(it, loop->defer_events.end());
+
+    auto tit = std::remove_if(loop->time_events.begin(), loop->time_events.end(),
+        [](pa_time_event *e) {
+            if (!e->dead)
+                return false;
+            delete e;
+            return true;
+        });
+    loop->time_events.erase(tit, loop->time_events.end());
+
+    return count;
+}
+
+pa_mainloop *pulse_loop_from_api(pa_mainloop_api *api)
+{
+    if (api && (api->quit == api_quit))
+        return static_cast<pa_mainloop*>(api->userdata);
+
+    debuglogstdio(LCF_SOUND | LCF_WARNING, "Unknown mainloop api, using an internal loop");
+    if (!fallback_loop) {
+        fallback_loop = pa_threaded_mainloop_new();
+        pa_threaded_mainloop_start(fallback_loop);
+    }
+    return fallback_loop->loop;
+}
+
+pa_mainloop *pa_mainloop_new(void)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+
+    pa_mainloop *m = new pa_mainloop;
+    m->api.userdata = m;
+    m->api.io_new = api_io_new;
+    m->api.io_enable = api_io_enable;
+    m->api.io_free = api_io_free;
+    m->api.io_set_destroy = api_io_set_destroy;
+    m->api.time_new = api_time_new;
+    m->api.time_restart = api_time_restart;
+    m->api.time_free = api_time_free;
+    m->api.time_set_destroy = api_time_set_destroy;
+    m->api.defer_new = api_defer_new;
+    m->api.defer_enable = api_defer_enable;
+    m->api.defer_free = api_defer_free;
+    m->api.defer_set_destroy = api_defer_set_destroy;
+    m->api.quit = api_quit;
+    m->quit = false;
+    m->retval = 0;
+    return m;
+}
+
+void pa_mainloop_free(pa_mainloop *m)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    for (pa_defer_event *e : m->defer_events)
+        delete e;
+    for (pa_time_event *e : m->time_events)
+        delete e;
+    delete m;
+}
+
+pa_mainloop_api *pa_mainloop_get_api(pa_mainloop *m)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return &m->api;
+}
+
+int pa_mainloop_iterate(pa_mainloop *m, int block, int *retval)
+{
+    debuglogstdio(LCF_SOUND | LCF_FREQUENT, "%s called with block %d", __func__, block);
+
+    if (m->quit) {
+        if (retval)
+            *retval = m->retval;
+        return -2;
+    }
+
+    int count = pulse_dispatch(m);
+
+    /* There is no file descriptor to poll, so we only wait a bit for
+     * samples to be consumed by the mixer */
+    if (block && (count == 0)) {
+        struct timespec mssleep = {0, 1000*1000};
+        NATIVECALL(nanosleep(&mssleep, NULL));
+        count = pulse_dispatch(m);
+    }
+
+    if (m->quit) {
+        if (retval)
+            *retval = m->retval;
+        return -2;
+    }
+
+    return count;
+}
+
+int pa_mainloop_run(pa_mainloop *m, int *retval)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+
+    int r;
+    while (((r = pa_mainloop_iterate(m, 1, retval)) >= 0) && !is_exiting) {}
+
+    if (r == -2)
+        return 1;
+    return r;
+}
+
+void pa_mainloop_quit(pa_mainloop *m, int retval)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    m->quit = true;
+    m->retval = retval;
+}
+
+void pa_mainloop_wakeup(pa_mainloop *m)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+}
+
+static void *threaded_mainloop_run(void *arg)
+{
+    pa_threaded_mainloop *m = static_cast<pa_threaded_mainloop*>(arg);
+
+    while (!m->stop && !m->loop->quit && !is_exiting) {
+        pthread_mutex_lock(&m->mutex);
+        pulse_dispatch(m->loop);
+        pthread_mutex_unlock(&m->mutex);
+
+        struct timespec mssleep = {0, 1000*1000};
+        NATIVECALL(nanosleep(&mssleep, NULL)); // Wait 1 ms before polling again
+    }
+
+    return nullptr;
+}
+
+pa_threaded_mainloop *pa_threaded_mainloop_new(void)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+
+    pa_threaded_mainloop *m = new pa_threaded_mainloop;
+    m->loop = pa_mainloop_new();
+
+    /* Locks of the threaded mainloop are recursive */
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&m->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    pthread_cond_init(&m->cond, nullptr);
+    pthread_cond_init(&m->accept_cond, nullptr);
+    m->n_waiting_for_accept = 0;
+    m->running = false;
+    m->stop = false;
+    return m;
+}
+
+void pa_threaded_mainloop_free(pa_threaded_mainloop *m)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    pa_threaded_mainloop_stop(m);
+    pthread_cond_destroy(&m->cond);
+    pthread_cond_destroy(&m->accept_cond);
+    pthread_mutex_destroy(&m->mutex);
+    pa_mainloop_free(m->loop);
+    delete m;
+}
+
+int pa_threaded_mainloop_start(pa_threaded_mainloop *m)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (m->running)
+        return -1;
+
+    m->stop = false;
+    m->loop->quit = false;
+    if (pthread_create(&m->thread, nullptr, threaded_mainloop_run, m) != 0)
+        return -1;
+
+    m->running = true;
+    return 0;
+}
+
+void pa_threaded_mainloop_stop(pa_threaded_mainloop *m)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (!m->running)
+        return;
+
+    m->stop = true;
+    pthread_join(m->thread, nullptr);
+    m->running = false;
+}
+
+void pa_threaded_mainloop_lock(pa_threaded_mainloop *m)
+{
+    DEBUGLOGCALL(LCF_SOUND | LCF_FREQUENT);
+    pthread_mutex_lock(&m->mutex);
+}
+
+void pa_threaded_mainloop_unlock(pa_threaded_mainloop *m)
+{
+    DEBUGLOGCALL(LCF_SOUND | LCF_FREQUENT);
+    pthread_mutex_unlock(&m->mutex);
+}
+
+void pa_threaded_mainloop_wait(pa_threaded_mainloop *m)
+{
+    DEBUGLOGCALL(LCF_SOUND | LCF_FREQUENT);
+    pthread_cond_wait(&m->cond, &m->mutex);
+}
+
+void pa_threaded_mainloop_signal(pa_threaded_mainloop *m, int wait_for_accept)
+{
+    DEBUGLOGCALL(LCF_SOUND | LCF_FREQUENT);
+    pthread_cond_broadcast(&m->cond);
+
+    if (wait_for_accept) {
+        m->n_waiting_for_accept++;
+        while (m->n_waiting_for_accept > 0)
+            pthread_cond_wait(&m->accept_cond, &m->mutex);
+    }
+}
+
+void pa_threaded_mainloop_accept(pa_threaded_mainloop *m)
+{
+    DEBUGLOGCALL(LCF_SOUND | LCF_FREQUENT);
+    m->n_waiting_for_accept--;
+    pthread_cond_signal(&m->accept_cond);
+}
+
+int pa_threaded_mainloop_get_retval(pa_threaded_mainloop *m)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return m->loop->retval;
+}
+
+pa_mainloop_api *pa_threaded_mainloop_get_api(pa_threaded_mainloop *m)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return &m->loop->api;
+}
+
+int pa_threaded_mainloop_in_thread(pa_threaded_mainloop *m)
+{
+    DEBUGLOGCALL(LCF_SOUND | LCF_FREQUENT);
+    return m->running && pthread_equal(m->thread, pthread_self());
+}
+
+void pa_threaded_mainloop_set_name(pa_threaded_mainloop *m, const char *name)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+}
+
+}
@@ -0,0 +1,73 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LIBTAS_PULSE_MAINLOOP_H_INCL
+#define LIBTAS_PULSE_MAINLOOP_H_INCL
+
+#include "../../global.h"
+#include "pulsetypes.h"
+
+namespace libtas {
+
+OVERRIDE pa_mainloop *pa_mainloop_new(void);
+OVERRIDE void pa_mainloop_free(pa_mainloop *m);
+OVERRIDE pa_mainloop_api *pa_mainloop_get_api(pa_mainloop *m);
+
+/* Run a single iteration of the main loop */
+OVERRIDE int pa_mainloop_iterate(pa_mainloop *m, int block, int *retval);
+
+/* Run unlimited iterations of the main loop object until the main loop's
+ * quit() routine is called */
+OVERRIDE int pa_mainloop_run(pa_mainloop *m, int *retval);
+
+OVERRIDE void pa_mainloop_quit(pa_mainloop *m, int retval);
+OVERRIDE void pa_mainloop_wakeup(pa_mainloop *m);
+
+OVERRIDE pa_threaded_mainloop *pa_threaded_mainloop_new(void);
+OVERRIDE void pa_threaded_mainloop_free(pa_threaded_mainloop *m);
+
+/* Start the event loop thread */
+OVERRIDE int pa_threaded_mainloop_start(pa_threaded_mainloop *m);
+
+/* Terminate the event loop thread cleanly */
+OVERRIDE void pa_threaded_mainloop_stop(pa_threaded_mainloop *m);
+
+OVERRIDE void pa_threaded_mainloop_lock(pa_threaded_mainloop *m);
+OVERRIDE void pa_threaded_mainloop_unlock(pa_threaded_mainloop *m);
+
+/* Wait for an event to be signalled by the event loop thread */
+OVERRIDE void pa_threaded_mainloop_wait(pa_threaded_mainloop *m);
+
+/* Signal all threads waiting for a signalling event in
+ * pa_threaded_mainloop_wait() */
+OVERRIDE void pa_threaded_mainloop_signal(pa_threaded_mainloop *m, int wait_for_accept);
+
+/* Accept a signal from the event thread issued with
+ * pa_threaded_mainloop_signal() */
+OVERRIDE void pa_threaded_mainloop_accept(pa_threaded_mainloop *m);
+
+OVERRIDE int pa_threaded_mainloop_get_retval(pa_threaded_mainloop *m);
+OVERRIDE pa_mainloop_api *pa_threaded_mainloop_get_api(pa_threaded_mainloop *m);
+OVERRIDE int pa_threaded_mainloop_in_thread(pa_threaded_mainloop *m);
+OVERRIDE void pa_threaded_mainloop_set_name(pa_threaded_mainloop *m, const char *name);
+
+}
+
+#endif
@@ -0,0 +1,265 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "proplist.h"
+#include "context.h" // pa_xstrdup
+#include "../../logging.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <string>
+
+namespace libtas {
+
+pa_proplist* pa_proplist_new(void)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return new pa_proplist;
+}
+
+void pa_proplist_free(pa_proplist* p)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    delete p;
+}
+
+int pa_proplist_key_valid(const char *key)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (!key || !key[0])
+        return 0;
+
+    for (const char *c = key; *c; c++)
+        if (static_cast<unsigned char>(*c) < 0x20 || *c == '=' || static_cast<unsigned char>(*c) > 0x7e)
+            return 0;
+    return 1;
+}
+
+int pa_proplist_set(pa_proplist *p, const char *key, const void *data, size_t nbytes)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (!pa_proplist_key_valid(key))
+        return -1;
+
+    const uint8_t *d = static_cast<const uint8_t*>(data);
+    p->entries[key] = std::vector<uint8_t>(d, d + nbytes);
+    return 0;
+}
+
+int pa_proplist_sets(pa_proplist *p, const char *key, const char *value)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (!value)
+        return -1;
+    return pa_proplist_set(p, key, value, strlen(value) + 1);
+}
+
+int pa_proplist_setp(pa_proplist *p, const char *pair)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    const char *eq = strchr(pair, '=');
+    if (!eq)
+        return -1;
+
+    std::string key(pair, eq - pair);
+    return pa_proplist_sets(p, key.c_str(), eq + 1);
+}
+
+int pa_proplist_setf(pa_proplist *p, const char *key, const char *format, ...)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(nullptr, 0, format, args);
+    va_end(args);
+    if (len < 0)
+        return -1;
+
+    std::vector<char> value(len + 1);
+    va_start(args, format);
+    vsnprintf(value.data(), value.size(), format, args);
+    va_end(args);
+
+    return pa_proplist_sets(p, key, value.data());
+}
+
+int pa_proplist_get(const pa_proplist *p, const char *key, const void **data, size_t *nbytes)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    auto it = p->entries.find(key);
+    if (it == p->entries.end())
+        return -1;
+
+    *data = it->second.data();
+    *nbytes = it->second.size();
+    return 0;
+}
+
+const char *pa_proplist_gets(const pa_proplist *p, const char *key)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    auto it = p->entries.find(key);
+    if (it == p->entries.end())
+        return nullptr;
+
+    /* Only return values that are null-terminated strings */
+    const std::vector<uint8_t>& value = it->second;
+    if (value.empty() || value.back() != '\0' ||
+        memchr(value.data(), '\0', value.size()) != &value.back())
+        return nullptr;
+    return reinterpret_cast<const char*>(value.data());
+}
+
+void pa_proplist_update(pa_proplist *p, pa_update_mode_t mode, const pa_proplist *other)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (mode == PA_UPDATE_SET)
+        p->entries.clear();
+
+    for (const auto& entry : other->entries) {
+        if (mode == PA_UPDATE_MERGE)
+            p->entries.insert(entry);
+        else
+            p->entries[entry.first] = entry.second;
+    }
+}
+
+int pa_proplist_unset(pa_proplist *p, const char *key)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (!pa_proplist_key_valid(key))
+        return -1;
+    return p->entries.erase(key) ? 0 : -2;
+}
+
+int pa_proplist_unset_many(pa_proplist *p, const char * const keys[])
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    int n = 0;
+    for (const char * const *k = keys; *k; k++) {
+        if (!pa_proplist_key_valid(*k))
+            return -1;
+        n += p->entries.erase(*k);
+    }
+    return n;
+}
+
+const char *pa_proplist_iterate(const pa_proplist *p, void **state)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+
+    /* The state stores the index of the next entry */
+    uintptr_t index = reinterpret_cast<uintptr_t>(*state);
+    if (index >= p->entries.size())
+        return nullptr;
+
+    auto it = p->entries.begin();
+    std::advance(it, index);
+    *state = reinterpret_cast<void*>(index + 1);
+    return it->first.c_str();
+}
+
+char *pa_proplist_to_string_sep(const pa_proplist *p, const char *sep)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+
+    std::string str;
+    for (const auto& entry : p->entries) {
+        if (!str.empty())
+            str += sep;
+        str += entry.first;
+        str += " = ";
+
+        const char *value = pa_proplist_gets(p, entry.first.c_str());
+        if (value) {
+            str += "\"";
+            str += value;
+            str += "\"";
+        }
+        else {
+            char hex[3];
+            str += "hex:";
+            for (uint8_t byte : entry.second) {
+                snprintf(hex, sizeof(hex), "%02x", byte);
+                str += hex;
+            }
+        }
+    }
+
+    return pa_xstrdup(str.c_str());
+}
+
+char *pa_proplist_to_string(const pa_proplist *p)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    char *s = pa_proplist_to_string_sep(p, "\n");
+    if (p->entries.empty())
+        return s;
+
+    /* libpulse terminates the last entry with a newline */
+    size_t l = strlen(s);
+    s = static_cast<char*>(pa_xrealloc(s, l + 2));
+    s[l] = '\n';
+    s[l+1] = '\0';
+    return s;
+}
+
+int pa_proplist_contains(const pa_proplist *p, const char *key)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (!pa_proplist_key_valid(key))
+        return -1;
+    return p->entries.count(key);
+}
+
+void pa_proplist_clear(pa_proplist *p)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    p->entries.clear();
+}
+
+pa_proplist* pa_proplist_copy(const pa_proplist *p)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return new pa_proplist(*p);
+}
+
+unsigned pa_proplist_size(const pa_proplist *p)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return p->entries.size();
+}
+
+int pa_proplist_isempty(const pa_proplist *p)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return p->entries.empty();
+}
+
+int pa_proplist_equal(const pa_proplist *a, const pa_proplist *b)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return a->entries == b->entries;
+}
+
+}
@@ -0,0 +1,54 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LIBTAS_PULSE_PROPLIST_H_INCL
+#define LIBTAS_PULSE_PROPLIST_H_INCL
+
+#include "../../global.h"
+#include "pulsetypes.h"
+
+namespace libtas {
+
+/* Property lists are only stored, they are never used by our server */
+OVERRIDE pa_proplist* pa_proplist_new(void);
+OVERRIDE void pa_proplist_free(pa_proplist* p);
+OVERRIDE int pa_proplist_key_valid(const char *key);
+OVERRIDE int pa_proplist_sets(pa_proplist *p, const char *key, const char *value);
+OVERRIDE int pa_proplist_setp(pa_proplist *p, const char *pair);
+OVERRIDE int pa_proplist_setf(pa_proplist *p, const char *key, const char *format, ...) __attribute__((format(printf, 3, 4)));
+OVERRIDE int pa_proplist_set(pa_proplist *p, const char *key, const void *data, size_t nbytes);
+OVERRIDE const char *pa_proplist_gets(const pa_proplist *p, const char *key);
+OVERRIDE int pa_proplist_get(const pa_proplist *p, const char *key, const void **data, size_t *nbytes);
+OVERRIDE void pa_proplist_update(pa_proplist *p, pa_update_mode_t mode, const pa_proplist *other);
+OVERRIDE int pa_proplist_unset(pa_proplist *p, const char *key);
+OVERRIDE int pa_proplist_unset_many(pa_proplist *p, const char * const keys[]);
+OVERRIDE const char *pa_proplist_iterate(const pa_proplist *p, void **state);
+OVERRIDE char *pa_proplist_to_string(const pa_proplist *p);
+OVERRIDE char *pa_proplist_to_string_sep(const pa_proplist *p, const char *sep);
+OVERRIDE int pa_proplist_contains(const pa_proplist *p, const char *key);
+OVERRIDE void pa_proplist_clear(pa_proplist *p);
+OVERRIDE pa_proplist* pa_proplist_copy(const pa_proplist *p);
+OVERRIDE unsigned pa_proplist_size(const pa_proplist *p);
+OVERRIDE int pa_proplist_isempty(const pa_proplist *p);
+OVERRIDE int pa_proplist_equal(const pa_proplist *a, const pa_proplist *b);
+
+}
+
+#endif
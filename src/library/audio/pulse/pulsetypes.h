@@ -0,0 +1,499 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LIBTAS_PULSETYPES_H_INCL
+#define LIBTAS_PULSETYPES_H_INCL
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <vector>
+#include <map>
+#include <string>
+#include <functional>
+
+/* PulseAudio headers are not required to build libTAS, so we declare here
+ * the part of the client API that we implement. Public structures and enums
+ * follow the libpulse ABI. Objects that are opaque to the client are our own.
+ */
+
+typedef uint64_t pa_usec_t;
+
+#define PA_CHANNELS_MAX 32U
+#define PA_VOLUME_MUTED 0U
+#define PA_VOLUME_NORM 0x10000U
+#define PA_VOLUME_MAX (UINT32_MAX/2)
+#define PA_VOLUME_INVALID UINT32_MAX
+#define PA_INVALID_INDEX UINT32_MAX
+
+typedef enum pa_sample_format {
+    PA_SAMPLE_U8,
+    PA_SAMPLE_ALAW,
+    PA_SAMPLE_ULAW,
+    PA_SAMPLE_S16LE,
+    PA_SAMPLE_S16BE,
+    PA_SAMPLE_FLOAT32LE,
+    PA_SAMPLE_FLOAT32BE,
+    PA_SAMPLE_S32LE,
+    PA_SAMPLE_S32BE,
+    PA_SAMPLE_S24LE,
+    PA_SAMPLE_S24BE,
+    PA_SAMPLE_S24_32LE,
+    PA_SAMPLE_S24_32BE,
+    PA_SAMPLE_MAX,
+    PA_SAMPLE_INVALID = -1
+} pa_sample_format_t;
+
+typedef struct pa_sample_spec {
+    pa_sample_format_t format;
+    uint32_t rate;
+    uint8_t channels;
+} pa_sample_spec;
+
+typedef struct pa_buffer_attr {
+    uint32_t maxlength;
+    uint32_t tlength;
+    uint32_t prebuf;
+    uint32_t minreq;
+    uint32_t fragsize;
+} pa_buffer_attr;
+
+typedef struct pa_channel_map {
+    uint8_t channels;
+    int map[PA_CHANNELS_MAX];
+} pa_channel_map;
+
+typedef enum pa_channel_position {
+    PA_CHANNEL_POSITION_INVALID = -1,
+    PA_CHANNEL_POSITION_MONO = 0,
+    PA_CHANNEL_POSITION_FRONT_LEFT,
+    PA_CHANNEL_POSITION_FRONT_RIGHT,
+    PA_CHANNEL_POSITION_FRONT_CENTER,
+    PA_CHANNEL_POSITION_REAR_CENTER,
+    PA_CHANNEL_POSITION_REAR_LEFT,
+    PA_CHANNEL_POSITION_REAR_RIGHT,
+    PA_CHANNEL_POSITION_LFE,
+    PA_CHANNEL_POSITION_FRONT_LEFT_OF_CENTER,
+    PA_CHANNEL_POSITION_FRONT_RIGHT_OF_CENTER,
+    PA_CHANNEL_POSITION_SIDE_LEFT,
+    PA_CHANNEL_POSITION_SIDE_RIGHT,
+    PA_CHANNEL_POSITION_AUX0,
+    PA_CHANNEL_POSITION_TOP_CENTER = PA_CHANNEL_POSITION_AUX0 + 32,
+    PA_CHANNEL_POSITION_TOP_FRONT_LEFT,
+    PA_CHANNEL_POSITION_TOP_FRONT_RIGHT,
+    PA_CHANNEL_POSITION_TOP_FRONT_CENTER,
+    PA_CHANNEL_POSITION_TOP_REAR_LEFT,
+    PA_CHANNEL_POSITION_TOP_REAR_RIGHT,
+    PA_CHANNEL_POSITION_TOP_REAR_CENTER,
+    PA_CHANNEL_POSITION_MAX
+} pa_channel_position_t;
+
+typedef enum pa_channel_map_def {
+    PA_CHANNEL_MAP_AIFF,
+    PA_CHANNEL_MAP_ALSA,
+    PA_CHANNEL_MAP_AUX,
+    PA_CHANNEL_MAP_WAVEEX,
+    PA_CHANNEL_MAP_OSS,
+    PA_CHANNEL_MAP_DEF_MAX,
+    PA_CHANNEL_MAP_DEFAULT = PA_CHANNEL_MAP_AIFF
+} pa_channel_map_def_t;
+
+typedef uint32_t pa_volume_t;
+
+typedef struct pa_cvolume {
+    uint8_t channels;
+    pa_volume_t values[PA_CHANNELS_MAX];
+} pa_cvolume;
+
+typedef enum pa_context_state {
+    PA_CONTEXT_UNCONNECTED,
+    PA_CONTEXT_CONNECTING,
+    PA_CONTEXT_AUTHORIZING,
+    PA_CONTEXT_SETTING_NAME,
+    PA_CONTEXT_READY,
+    PA_CONTEXT_FAILED,
+    PA_CONTEXT_TERMINATED
+} pa_context_state_t;
+
+typedef enum pa_stream_state {
+    PA_STREAM_UNCONNECTED,
+    PA_STREAM_CREATING,
+    PA_STREAM_READY,
+    PA_STREAM_FAILED,
+    PA_STREAM_TERMINATED
+} pa_stream_state_t;
+
+typedef enum pa_operation_state {
+    PA_OPERATION_RUNNING,
+    PA_OPERATION_DONE,
+    PA_OPERATION_CANCELLED
+} pa_operation_state_t;
+
+typedef enum pa_stream_direction {
+    PA_STREAM_NODIRECTION,
+    PA_STREAM_PLAYBACK,
+    PA_STREAM_RECORD,
+    PA_STREAM_UPLOAD
+} pa_stream_direction_t;
+
+typedef enum pa_update_mode {
+    PA_UPDATE_SET,
+    PA_UPDATE_MERGE,
+    PA_UPDATE_REPLACE
+} pa_update_mode_t;
+
+typedef enum pa_seek_mode {
+    PA_SEEK_RELATIVE = 0,
+    PA_SEEK_ABSOLUTE = 1,
+    PA_SEEK_RELATIVE_ON_READ = 2,
+    PA_SEEK_RELATIVE_END = 3
+} pa_seek_mode_t;
+
+/* Flags are passed as enums in libpulse, which have the size of an int */
+typedef int pa_context_flags_t;
+typedef int pa_stream_flags_t;
+typedef int pa_io_event_flags_t;
+typedef int pa_subscription_mask_t;
+typedef int pa_subscription_event_type_t;
+typedef int pa_sink_flags_t;
+typedef int pa_sink_state_t;
+
+#define PA_SINK_HARDWARE 0x0004
+#define PA_SINK_RUNNING 0
+
+#define PA_STREAM_START_CORKED 0x0001
+
+enum {
+    PA_OK = 0,
+    PA_ERR_ACCESS,
+    PA_ERR_COMMAND,
+    PA_ERR_INVALID,
+    PA_ERR_EXIST,
+    PA_ERR_NOENTITY,
+    PA_ERR_CONNECTIONREFUSED,
+    PA_ERR_PROTOCOL,
+    PA_ERR_TIMEOUT,
+    PA_ERR_AUTHKEY,
+    PA_ERR_INTERNAL,
+    PA_ERR_CONNECTIONTERMINATED,
+    PA_ERR_KILLED,
+    PA_ERR_INVALIDSERVER,
+    PA_ERR_MODINITFAILED,
+    PA_ERR_BADSTATE,
+    PA_ERR_NODATA,
+    PA_ERR_VERSION,
+    PA_ERR_TOOLARGE,
+    PA_ERR_NOTSUPPORTED,
+    PA_ERR_UNKNOWN,
+    PA_ERR_NOEXTENSION,
+    PA_ERR_OBSOLETE,
+    PA_ERR_NOTIMPLEMENTED,
+    PA_ERR_FORKED,
+    PA_ERR_IO,
+    PA_ERR_BUSY,
+    PA_ERR_MAX
+};
+
+typedef struct pa_mainloop pa_mainloop;
+typedef struct pa_threaded_mainloop pa_threaded_mainloop;
+typedef struct pa_mainloop_api pa_mainloop_api;
+typedef struct pa_context pa_context;
+typedef struct pa_stream pa_stream;
+typedef struct pa_operation pa_operation;
+typedef struct pa_simple pa_simple;
+typedef struct pa_proplist pa_proplist;
+typedef struct pa_spawn_api pa_spawn_api;
+typedef struct pa_io_event pa_io_event;
+typedef struct pa_time_event pa_time_event;
+typedef struct pa_defer_event pa_defer_event;
+typedef struct pa_source_info pa_source_info;
+typedef struct pa_sink_input_info pa_sink_input_info;
+typedef struct pa_format_info pa_format_info;
+typedef struct pa_sink_port_info pa_sink_port_info;
+
+typedef struct pa_server_info {
+    const char *user_name;
+    const char *host_name;
+    const char *server_version;
+    const char *server_name;
+    pa_sample_spec sample_spec;
+    const char *default_sink_name;
+    const char *default_source_name;
+    uint32_t cookie;
+    pa_channel_map channel_map;
+} pa_server_info;
+
+typedef struct pa_sink_info {
+    const char *name;
+    uint32_t index;
+    const char *description;
+    pa_sample_spec sample_spec;
+    pa_channel_map channel_map;
+    uint32_t owner_module;
+    pa_cvolume volume;
+    int mute;
+    uint32_t monitor_source;
+    const char *monitor_source_name;
+    pa_usec_t latency;
+    const char *driver;
+    pa_sink_flags_t flags;
+    pa_proplist *proplist;
+    pa_usec_t configured_latency;
+    pa_volume_t base_volume;
+    pa_sink_state_t state;
+    uint32_t n_volume_steps;
+    uint32_t card;
+    uint32_t n_ports;
+    pa_sink_port_info** ports;
+    pa_sink_port_info* active_port;
+    uint8_t n_formats;
+    pa_format_info **formats;
+} pa_sink_info;
+
+typedef struct pa_timing_info {
+    struct timeval timestamp;
+    int synchronized_clocks;
+    pa_usec_t sink_usec;
+    pa_usec_t source_usec;
+    pa_usec_t transport_usec;
+    int playing;
+    int write_index_corrupt;
+    int64_t write_index;
+    int read_index_corrupt;
+    int64_t read_index;
+    pa_usec_t configured_sink_usec;
+    pa_usec_t configured_source_usec;
+    int64_t since_underrun;
+} pa_timing_info;
+
+typedef void (*pa_free_cb_t)(void *p);
+typedef void (*pa_context_notify_cb_t)(pa_context *c, void *userdata);
+typedef void (*pa_context_success_cb_t)(pa_context *c, int success, void *userdata);
+typedef void (*pa_stream_notify_cb_t)(pa_stream *s, void *userdata);
+typedef void (*pa_stream_request_cb_t)(pa_stream *s, size_t nbytes, void *userdata);
+typedef void (*pa_stream_success_cb_t)(pa_stream *s, int success, void *userdata);
+typedef void (*pa_stream_event_cb_t)(pa_stream *p, const char *name, pa_proplist *pl, void *userdata);
+typedef void (*pa_context_event_cb_t)(pa_context *c, const char *name, pa_proplist *p, void *userdata);
+typedef void (*pa_context_subscribe_cb_t)(pa_context *c, pa_subscription_event_type_t t, uint32_t idx, void *userdata);
+typedef void (*pa_server_info_cb_t)(pa_context *c, const pa_server_info *i, void *userdata);
+typedef void (*pa_sink_info_cb_t)(pa_context *c, const pa_sink_info *i, int eol, void *userdata);
+typedef void (*pa_source_info_cb_t)(pa_context *c, const pa_source_info *i, int eol, void *userdata);
+typedef void (*pa_sink_input_info_cb_t)(pa_context *c, const pa_sink_input_info *i, int eol, void *userdata);
+
+typedef void (*pa_io_event_cb_t)(pa_mainloop_api *a, pa_io_event *e, int fd, pa_io_event_flags_t events, void *userdata);
+typedef void (*pa_io_event_destroy_cb_t)(pa_mainloop_api *a, pa_io_event *e, void *userdata);
+typedef void (*pa_time_event_cb_t)(pa_mainloop_api *a, pa_time_event *e, const struct timeval *tv, void *userdata);
+typedef void (*pa_time_event_destroy_cb_t)(pa_mainloop_api *a, pa_time_event *e, void *userdata);
+typedef void (*pa_defer_event_cb_t)(pa_mainloop_api *a, pa_defer_event *e, void *userdata);
+typedef void (*pa_defer_event_destroy_cb_t)(pa_mainloop_api *a, pa_defer_event *e, void *userdata);
+
+struct pa_mainloop_api {
+    void *userdata;
+
+    pa_io_event* (*io_new)(pa_mainloop_api *a, int fd, pa_io_event_flags_t events, pa_io_event_cb_t cb, void *userdata);
+    void (*io_enable)(pa_io_event *e, pa_io_event_flags_t events);
+    void (*io_free)(pa_io_event *e);
+    void (*io_set_destroy)(pa_io_event *e, pa_io_event_destroy_cb_t cb);
+
+    pa_time_event* (*time_new)(pa_mainloop_api *a, const struct timeval *tv, pa_time_event_cb_t cb, void *userdata);
+    void (*time_restart)(pa_time_event *e, const struct timeval *tv);
+    void (*time_free)(pa_time_event *e);
+    void (*time_set_destroy)(pa_time_event *e, pa_time_event_destroy_cb_t cb);
+
+    pa_defer_event* (*defer_new)(pa_mainloop_api *a, pa_defer_event_cb_t cb, void *userdata);
+    void (*defer_enable)(pa_defer_event *e, int b);
+    void (*defer_free)(pa_defer_event *e);
+    void (*defer_set_destroy)(pa_defer_event *e, pa_defer_event_destroy_cb_t cb);
+
+    void (*quit)(pa_mainloop_api *a, int retval);
+};
+
+/*** Our implementation of the opaque objects ***/
+
+struct pa_defer_event {
+    pa_mainloop *loop;
+    pa_defer_event_cb_t callback;
+    pa_defer_event_destroy_cb_t destroy_callback;
+    void *userdata;
+    bool enabled;
+    bool dead;
+};
+
+/* Time events fire when the deterministic time reaches tv. All clocks
+ * return the deterministic time, so we don't distinguish wall-clock events
+ * from monotonic ones. */
+struct pa_time_event {
+    pa_mainloop *loop;
+    struct timeval tv;
+    pa_time_event_cb_t callback;
+    pa_time_event_destroy_cb_t destroy_callback;
+    void *userdata;
+    bool enabled;
+    bool dead;
+};
+
+/* Event loop. Events are dispatched from pa_mainloop_iterate() or from the
+ * thread of a threaded mainloop. There is no server, so the only events are
+ * state changes and operation completions queued by our own functions,
+ * defer and time events, and write requests of streams. Streams are
+ * consumed by the audio mixer at each frame, so write requests and time
+ * events follow the deterministic time. IO events are not supported.
+ */
+struct pa_mainloop {
+    pa_mainloop_api api;
+
+    /* Callbacks queued by our functions, to be executed by the loop */
+    std::vector<std::function<void()>> pending;
+
+    std::vector<pa_defer_event*> defer_events;
+
+    std::vector<pa_time_event*> time_events;
+
+    std::vector<pa_context*> contexts;
+
+    bool quit;
+    int retval;
+};
+
+struct pa_threaded_mainloop {
+    pa_mainloop *loop;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    pthread_cond_t accept_cond;
+    int n_waiting_for_accept;
+
+    pthread_t thread;
+    bool running;
+    bool stop;
+};
+
+struct pa_context {
+    int refcount;
+    pa_mainloop *loop;
+    pa_context_state_t state;
+    int error;
+
+    pa_context_notify_cb_t state_callback;
+    void *state_userdata;
+    pa_context_subscribe_cb_t subscribe_callback;
+    void *subscribe_userdata;
+
+    std::vector<pa_stream*> streams;
+};
+
+/* Property list, with values stored as raw bytes. String values include
+ * their terminating null character */
+struct pa_proplist {
+    std::map<std::string, std::vector<uint8_t>> entries;
+};
+
+struct pa_operation {
+    int refcount;
+    pa_operation_state_t state;
+};
+
+struct pa_stream {
+    int refcount;
+    pa_context *context;
+    pa_stream_state_t state;
+
+    /* Identifier of the audio source */
+    int sourceId;
+
+    pa_sample_spec sample_spec;
+    pa_channel_map channel_map;
+    pa_buffer_attr buffer_attr;
+    pa_timing_info timing_info;
+
+    pa_stream_notify_cb_t state_callback;
+    void *state_userdata;
+    pa_stream_request_cb_t write_callback;
+    void *write_userdata;
+    pa_stream_notify_cb_t underflow_callback;
+    void *underflow_userdata;
+
+    /* Number of bytes requested to the client and not written yet */
+    size_t requested;
+
+    /* Number of samples written since the creation of the stream */
+    uint64_t written_samples;
+
+    bool corked;
+    bool underflow_notified;
+
+    /* Pending drain operation */
+    pa_operation *drain_operation;
+    pa_stream_success_cb_t drain_callback;
+    void *drain_userdata;
+
+    /* Buffer returned by pa_stream_begin_write() */
+    std::vector<uint8_t> write_buffer;
+};
+
+struct pa_simple {
+    int sourceId;
+    pa_sample_spec sample_spec;
+
+    /* Number of bytes that can be queued before writes are blocking */
+    size_t tlength;
+};
+
+namespace libtas {
+
+/* Queue a callback to be executed by the event loop */
+void pulse_defer(pa_mainloop *loop, std::function<void()> callback);
+
+/* Execute all pending events of a loop, and return the number of events */
+int pulse_dispatch(pa_mainloop *loop);
+
+/* Get the loop from an api structure. If the api does not come from us,
+ * an internal threaded mainloop is used */
+pa_mainloop *pulse_loop_from_api(pa_mainloop_api *api);
+
+/* Create an operation on a context, that completes on the next iteration of
+ * the loop by calling a function */
+pa_operation* pulse_context_operation(pa_context *c, std::function<void()> callback);
+
+/* Send write requests, underflow and drain notifications of a stream.
+ * Return the number of callbacks that were called */
+int pulse_stream_poll(pa_stream *s);
+
+/* Create an audio source from a sample spec. Return the source id, or -1 if
+ * the format is not supported */
+int pulse_create_source(const pa_sample_spec *ss);
+
+/* Delete an audio source and its buffers */
+void pulse_delete_source(int sourceId);
+
+/* Push samples to an audio source, and start playing it if play is true.
+ * Return the number of samples written */
+size_t pulse_write_source(int sourceId, const void *data, size_t nbytes, bool play);
+
+/* Number of queued samples that were not played yet */
+int pulse_source_latency(int sourceId);
+
+/* Default target length of the buffers, in bytes */
+size_t pulse_default_tlength(const pa_sample_spec *ss);
+
+}
+
+#endif
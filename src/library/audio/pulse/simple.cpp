@@ -0,0 +1,165 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "simple.h"
+#include "context.h"
+#include "../../logging.h"
+#include "../../GlobalState.h"
+#include "../AudioContext.h"
+#include "../AudioSource.h"
+#include "../../checkpoint/ThreadManager.h"
+
+#include <time.h> // nanosleep
+#include <algorithm>
+
+namespace libtas {
+
+pa_simple* pa_simple_new(const char *server, const char *name, pa_stream_direction_t dir, const char *dev, const char *stream_name, const pa_sample_spec *ss, const pa_channel_map *map, const pa_buffer_attr *attr, int *error)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+
+    int err = PA_OK;
+    if (shared_config.audio_disabled)
+        err = PA_ERR_CONNECTIONREFUSED;
+    else if (dir != PA_STREAM_PLAYBACK) {
+        debuglogstdio(LCF_SOUND | LCF_WARNING, "    Unsupported stream direction %d", dir);
+        err = PA_ERR_NOTSUPPORTED;
+    }
+    else if (!pa_sample_spec_valid(ss))
+        err = PA_ERR_INVALID;
+
+    int sourceId = -1;
+    if (err == PA_OK) {
+        sourceId = pulse_create_source(ss);
+        if (sourceId < 0)
+            err = PA_ERR_NOTSUPPORTED;
+    }
+
+    if (err != PA_OK) {
+        if (error)
+            *error = err;
+        return nullptr;
+    }
+
+    if (!(game_info.audio & GameInfo::PULSEAUDIO)) {
+        game_info.audio |= GameInfo::PULSEAUDIO;
+        game_info.tosend = true;
+    }
+
+    pa_simple *s = new pa_simple;
+    s->sourceId = sourceId;
+    s->sample_spec = *ss;
+
+    size_t frame_size = pa_frame_size(ss);
+    if (attr && (attr->tlength != static_cast<uint32_t>(-1)) && (attr->tlength >= frame_size))
+        s->tlength = (attr->tlength / frame_size) * frame_size;
+    else
+        s->tlength = pulse_default_tlength(ss);
+
+    return s;
+}
+
+void pa_simple_free(pa_simple *s)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    pulse_delete_source(s->sourceId);
+    delete s;
+}
+
+int pa_simple_write(pa_simple *s, const void *data, size_t bytes, int *error)
+{
+    debuglogstdio(LCF_SOUND, "%s call with %zu bytes", __func__, bytes);
+
+    /* Fill audio thread id */
+    audiocontext.audio_thread = ThreadManager::getThreadId();
+
+    /* Samples are consumed at frame boundaries, so the main thread must not
+     * wait for room in the buffer */
+    bool blocking = !ThreadManager::isMainThread();
+
+    size_t frame_size = pa_frame_size(&s->sample_spec);
+    int max_samples = s->tlength / frame_size;
+    const uint8_t *samples = static_cast<const uint8_t*>(data);
+
+    while (bytes >= frame_size) {
+        size_t chunk = bytes;
+
+        if (blocking) {
+            struct timespec mssleep = {0, 1000*1000};
+            while (!is_exiting && (pulse_source_latency(s->sourceId) >= max_samples)) {
+                NATIVECALL(nanosleep(&mssleep, NULL)); // Wait 1 ms before trying again
+            }
+
+            if (is_exiting) return 0;
+
+            /* Only write a portion of the buffer if no room for the whole buffer */
+            chunk = std::min(chunk, (max_samples - pulse_source_latency(s->sourceId)) * frame_size);
+        }
+
+        size_t written = pulse_write_source(s->sourceId, samples, chunk, true) * frame_size;
+        if (written == 0)
+            break;
+        samples += written;
+        bytes -= written;
+    }
+
+    return 0;
+}
+
+int pa_simple_drain(pa_simple *s, int *error)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+
+    if (ThreadManager::isMainThread())
+        return 0;
+
+    struct timespec mssleep = {0, 1000*1000};
+    while (!is_exiting && (pulse_source_latency(s->sourceId) > 0)) {
+        NATIVECALL(nanosleep(&mssleep, NULL));
+    }
+    return 0;
+}
+
+int pa_simple_read(pa_simple *s, void *data, size_t bytes, int *error)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (error)
+        *error = PA_ERR_NOTSUPPORTED;
+    return -1;
+}
+
+pa_usec_t pa_simple_get_latency(pa_simple *s, int *error)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    uint64_t latency = pulse_source_latency(s->sourceId);
+    return (latency * 1000000) / s->sample_spec.rate;
+}
+
+int pa_simple_flush(pa_simple *s, int *error)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    auto source = audiocontext.getSource(s->sourceId);
+    if (source)
+        source->setPosition(source->queueSize());
+    return 0;
+}
+
+}
@@ -0,0 +1,47 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LIBTAS_PULSE_SIMPLE_H_INCL
+#define LIBTAS_PULSE_SIMPLE_H_INCL
+
+#include "../../global.h"
+#include "pulsetypes.h"
+
+namespace libtas {
+
+/* Create a new connection to the server. Only playback is supported */
+OVERRIDE pa_simple* pa_simple_new(const char *server, const char *name, pa_stream_direction_t dir, const char *dev, const char *stream_name, const pa_sample_spec *ss, const pa_channel_map *map, const pa_buffer_attr *attr, int *error);
+
+OVERRIDE void pa_simple_free(pa_simple *s);
+
+/* Write some data to the server. Blocks while the buffer is full, except
+ * on the main thread */
+OVERRIDE int pa_simple_write(pa_simple *s, const void *data, size_t bytes, int *error);
+
+/* Wait until all data already written is played by the mixer */
+OVERRIDE int pa_simple_drain(pa_simple *s, int *error);
+
+OVERRIDE int pa_simple_read(pa_simple *s, void *data, size_t bytes, int *error);
+OVERRIDE pa_usec_t pa_simple_get_latency(pa_simple *s, int *error);
+OVERRIDE int pa_simple_flush(pa_simple *s, int *error);
+
+}
+
+#endif
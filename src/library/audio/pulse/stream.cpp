@@ -0,0 +1,755 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "stream.h"
+#include "context.h"
+#include "volume.h"
+#include "../../logging.h"
+#include "../AudioContext.h"
+#include "../AudioSource.h"
+#include "../AudioBuffer.h"
+#include "../../checkpoint/ThreadManager.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace libtas {
+
+int pulse_create_source(const pa_sample_spec *ss)
+{
+    AudioBuffer::SampleFormat format;
+    switch (ss->format) {
+        case PA_SAMPLE_U8:
+            format = AudioBuffer::SAMPLE_FMT_U8;
+            break;
+        case PA_SAMPLE_S16LE:
+            format = AudioBuffer::SAMPLE_FMT_S16;
+            break;
+        case PA_SAMPLE_S32LE:
+            format = AudioBuffer::SAMPLE_FMT_S32;
+            break;
+        case PA_SAMPLE_FLOAT32LE:
+            format = AudioBuffer::SAMPLE_FMT_FLT;
+            break;
+        default:
+            debuglogstdio(LCF_SOUND | LCF_ERROR, "   Unsupported audio format %d", ss->format);
+            return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+
+    /* We create an empty buffer that holds the audio parameters, which are
+     * copied into the buffers of future writes */
+    int bufferId = audiocontext.createBuffer();
+    auto buffer = audiocontext.getBuffer(bufferId);
+    buffer->format = format;
+    buffer->nbChannels = ss->channels;
+    buffer->frequency = ss->rate;
+    buffer->update();
+    debuglogstdio(LCF_SOUND, "   Format %d bits, %d channels, %d Hz", buffer->bitDepth, buffer->nbChannels, buffer->frequency);
+
+    int sourceId = audiocontext.createSource();
+    auto source = audiocontext.getSource(sourceId);
+    source->buffer_queue.push_back(buffer);
+    source->source = AudioSource::SOURCE_STREAMING_CONTINUOUS;
+
+    return sourceId;
+}
+
+void pulse_delete_source(int sourceId)
+{
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    auto source = audiocontext.getSource(sourceId);
+
+    if (source) {
+        for (auto& buffer : source->buffer_queue)
+            audiocontext.deleteBuffer(buffer->id);
+
+        audiocontext.deleteSource(sourceId);
+    }
+}
+
+size_t pulse_write_source(int sourceId, const void *data, size_t nbytes, bool play)
+{
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    auto source = audiocontext.getSource(sourceId);
+    if (!source || source->buffer_queue.empty())
+        return 0;
+
+    /* We try to reuse a buffer that has been processed from the source */
+    std::shared_ptr<AudioBuffer> ab;
+    if (source->nbQueueProcessed() > 0) {
+        /* Removing first buffer */
+        ab = source->buffer_queue[0];
+        source->buffer_queue.erase(source->buffer_queue.begin());
+        source->queue_index--;
+    }
+    else {
+        /* Building a new buffer */
+        int bufferId = audiocontext.createBuffer();
+        ab = audiocontext.getBuffer(bufferId);
+
+        auto ref = source->buffer_queue[0];
+        ab->format = ref->format;
+        ab->nbChannels = ref->nbChannels;
+        ab->frequency = ref->frequency;
+    }
+
+    /* Filling buffer */
+    ab->update(); // Compute alignSize
+    ab->sampleSize = nbytes / ab->alignSize;
+    ab->size = ab->sampleSize * ab->alignSize;
+    ab->samples.clear();
+    ab->samples.insert(ab->samples.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + ab->size);
+
+    source->buffer_queue.push_back(ab);
+
+    if (play && (source->state != AudioSource::SOURCE_PAUSED))
+        source->state = AudioSource::SOURCE_PLAYING;
+
+    return ab->sampleSize;
+}
+
+int pulse_source_latency(int sourceId)
+{
+    std::lock_guard<std::mutex> lock(audiocontext.mutex);
+    auto source = audiocontext.getSource(sourceId);
+    if (!source)
+        return 0;
+    return source->queueSize() - source->getPosition();
+}
+
+size_t pulse_default_tlength(const pa_sample_spec *ss)
+{
+    /* Same buffer size as our ALSA pcm */
+    return 4096 * pa_frame_size(ss);
+}
+
+static void stream_set_state(pa_stream *s, pa_stream_state_t state)
+{
+    s->state = state;
+    if (s->state_callback)
+        s->state_callback(s, s->state_userdata);
+}
+
+/* Apply buffer attributes, keeping our values for fields set to -1 */
+static void stream_apply_buffer_attr(pa_stream *s, const pa_buffer_attr *attr)
+{
+    size_t frame_size = pa_frame_size(&s->sample_spec);
+    if ((attr->tlength != static_cast<uint32_t>(-1)) && (attr->tlength >= frame_size))
+        s->buffer_attr.tlength = (attr->tlength / frame_size) * frame_size;
+    if ((attr->minreq != static_cast<uint32_t>(-1)) && (attr->minreq >= frame_size))
+        s->buffer_attr.minreq = (attr->minreq / frame_size) * frame_size;
+    if (attr->prebuf != static_cast<uint32_t>(-1))
+        s->buffer_attr.prebuf = attr->prebuf;
+    if (attr->maxlength != static_cast<uint32_t>(-1))
+        s->buffer_attr.maxlength = attr->maxlength;
+    s->buffer_attr.minreq = std::min(s->buffer_attr.minreq, s->buffer_attr.tlength);
+    debuglogstdio(LCF_SOUND, "   Target length %u bytes, minimum request %u bytes", s->buffer_attr.tlength, s->buffer_attr.minreq);
+}
+
+/* Create an operation that completes on the next iteration of the loop */
+static pa_operation* stream_operation(pa_stream *s, pa_stream_success_cb_t cb, void *userdata)
+{
+    /* One reference for the client and one for the loop */
+    pa_operation *o = new pa_operation;
+    o->refcount = 2;
+    o->state = PA_OPERATION_RUNNING;
+
+    pa_stream_ref(s);
+    pulse_defer(s->context->loop, [s, o, cb, userdata]() {
+        if (o->state == PA_OPERATION_RUNNING) {
+            o->state = PA_OPERATION_DONE;
+            if (cb)
+                cb(s, 1, userdata);
+        }
+        pa_operation_unref(o);
+        pa_stream_unref(s);
+    });
+    return o;
+}
+
+int pulse_stream_poll(pa_stream *s)
+{
+    if (s->state != PA_STREAM_READY)
+        return 0;
+
+    int count = 0;
+    int latency = pulse_source_latency(s->sourceId);
+
+    if (s->drain_operation && (latency == 0)) {
+        pa_operation *o = s->drain_operation;
+        s->drain_operation = nullptr;
+        if (o->state == PA_OPERATION_RUNNING) {
+            o->state = PA_OPERATION_DONE;
+            if (s->drain_callback)
+                s->drain_callback(s, 1, s->drain_userdata);
+        }
+        pa_operation_unref(o);
+        count++;
+    }
+
+    if (s->corked)
+        return count;
+
+    if (s->underflow_callback && !s->underflow_notified && (s->written_samples > 0) && (latency == 0)) {
+        s->underflow_notified = true;
+        s->underflow_callback(s, s->underflow_userdata);
+        count++;
+    }
+
+    /* Request samples when enough room has been freed by the mixer */
+    if (s->write_callback) {
+        size_t writable = pa_stream_writable_size(s);
+        if ((writable >= s->buffer_attr.minreq) && (writable > s->requested)) {
+            s->requested = writable;
+            s->write_callback(s, writable, s->write_userdata);
+            count++;
+        }
+    }
+
+    return count;
+}
+
+pa_stream* pa_stream_new(pa_context *c, const char *name, const pa_sample_spec *ss, const pa_channel_map *map)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+
+    if (!pa_sample_spec_valid(ss)) {
+        c->error = PA_ERR_INVALID;
+        return nullptr;
+    }
+
+    int sourceId = pulse_create_source(ss);
+    if (sourceId < 0) {
+        c->error = PA_ERR_NOTSUPPORTED;
+        return nullptr;
+    }
+
+    pa_stream *s = new pa_stream;
+    s->refcount = 1;
+    s->context = pa_context_ref(c);
+    s->state = PA_STREAM_UNCONNECTED;
+    s->sourceId = sourceId;
+    s->sample_spec = *ss;
+
+    if (map && (map->channels == ss->channels))
+        s->channel_map = *map;
+    else
+        pa_channel_map_init_auto(&s->channel_map, ss->channels, PA_CHANNEL_MAP_DEFAULT);
+
+    memset(&s->timing_info, 0, sizeof(pa_timing_info));
+    s->timing_info.synchronized_clocks = 1;
+
+    size_t frame_size = pa_frame_size(ss);
+    s->buffer_attr.tlength = pulse_default_tlength(ss);
+    s->buffer_attr.maxlength = 4 * s->buffer_attr.tlength;
+    s->buffer_attr.prebuf = s->buffer_attr.tlength;
+    s->buffer_attr.minreq = (s->buffer_attr.tlength / 4 / frame_size) * frame_size;
+    s->buffer_attr.fragsize = static_cast<uint32_t>(-1);
+
+    s->state_callback = nullptr;
+    s->state_userdata = nullptr;
+    s->write_callback = nullptr;
+    s->write_userdata = nullptr;
+    s->underflow_callback = nullptr;
+    s->underflow_userdata = nullptr;
+    s->requested = 0;
+    s->written_samples = 0;
+    s->corked = false;
+    s->underflow_notified = false;
+    s->drain_operation = nullptr;
+    s->drain_callback = nullptr;
+    s->drain_userdata = nullptr;
+
+    c->streams.push_back(s);
+    return s;
+}
+
+pa_stream* pa_stream_new_with_proplist(pa_context *c, const char *name, const pa_sample_spec *ss, const pa_channel_map *map, pa_proplist *p)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return pa_stream_new(c, name, ss, map);
+}
+
+void pa_stream_unref(pa_stream *s)
+{
+    DEBUGLOGCALL(LCF_SOUND | LCF_FREQUENT);
+    if (--s->refcount > 0)
+        return;
+
+    if (s->drain_operation) {
+        s->drain_operation->state = PA_OPERATION_CANCELLED;
+        pa_operation_unref(s->drain_operation);
+    }
+
+    auto& streams = s->context->streams;
+    streams.erase(std::remove(streams.begin(), streams.end(), s), streams.end());
+    pa_context_unref(s->context);
+
+    pulse_delete_source(s->sourceId);
+    delete s;
+}
+
+pa_stream *pa_stream_ref(pa_stream *s)
+{
+    DEBUGLOGCALL(LCF_SOUND | LCF_FREQUENT);
+    s->refcount++;
+    return s;
+}
+
+pa_stream_state_t pa_stream_get_state(const pa_stream *p)
+{
+    DEBUGLOGCALL(LCF_SOUND | LCF_FREQUENT);
+    return p->state;
+}
+
+pa_context* pa_stream_get_context(const pa_stream *p)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return p->context;
+}
+
+int pa_stream_connect_playback(pa_stream *s, const char *dev, const pa_buffer_attr *attr, pa_stream_flags_t flags, const pa_cvolume *volume, pa_stream *sync_stream)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+
+    if ((s->state != PA_STREAM_UNCONNECTED) || (s->context->state != PA_CONTEXT_READY)) {
+        s->context->error = PA_ERR_BADSTATE;
+        return -PA_ERR_BADSTATE;
+    }
+
+    if (attr)
+        stream_apply_buffer_attr(s, attr);
+
+    s->corked = flags & PA_STREAM_START_CORKED;
+
+    if (volume && pa_cvolume_valid(volume)) {
+        std::lock_guard<std::mutex> lock(audiocontext.mutex);
+        auto source = audiocontext.getSource(s->sourceId);
+        source->volume = static_cast<float>(pa_sw_volume_to_linear(pa_cvolume_avg(volume)));
+    }
+
+    stream_set_state(s, PA_STREAM_CREATING);
+
+    pa_stream_ref(s);
+    pulse_defer(s->context->loop, [s]() {
+        if (s->state == PA_STREAM_CREATING)
+            stream_set_state(s, PA_STREAM_READY);
+        pa_stream_unref(s);
+    });
+
+    return 0;
+}
+
+int pa_stream_connect_record(pa_stream *s, const char *dev, const pa_buffer_attr *attr, pa_stream_flags_t flags)
+{
+    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    s->context->error = PA_ERR_NOTSUPPORTED;
+    return -PA_ERR_NOTSUPPORTED;
+}
+
+int pa_stream_disconnect(pa_stream *s)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+
+    if ((s->state != PA_STREAM_CREATING) && (s->state != PA_STREAM_READY)) {
+        s->context->error = PA_ERR_BADSTATE;
+        return -PA_ERR_BADSTATE;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(audiocontext.mutex);
+        auto source = audiocontext.getSource(s->sourceId);
+        if (source)
+            source->state = AudioSource::SOURCE_STOPPED;
+    }
+
+    pa_stream_ref(s);
+    stream_set_state(s, PA_STREAM_TERMINATED);
+    pa_stream_unref(s);
+    return 0;
+}
+
+int pa_stream_begin_write(pa_stream *p, void **data, size_t *nbytes)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+
+    if (*nbytes == static_cast<size_t>(-1) || *nbytes == 0) {
+        *nbytes = pa_stream_writable_size(p);
+        if (*nbytes == 0)
+            *nbytes = p->buffer_attr.tlength;
+    }
+
+    p->write_buffer.resize(*nbytes);
+    *data = p->write_buffer.data();
+    return 0;
+}
+
+int pa_stream_cancel_write(pa_stream *p)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return 0;
+}
+
+int pa_stream_write(pa_stream *p, const void *data, size_t nbytes, pa_free_cb_t free_cb, int64_t offset, pa_seek_mode_t seek)
+{
+    debuglogstdio(LCF_SOUND, "%s call with %zu bytes", __func__, nbytes);
+
+    if (p->state != PA_STREAM_READY) {
+        p->context->error = PA_ERR_BADSTATE;
+        return -PA_ERR_BADSTATE;
+    }
+
+    if ((offset != 0) || (seek != PA_SEEK_RELATIVE)) {
+        debuglogstdio(LCF_SOUND | LCF_TODO, "   Seeking in the stream is not supported");
+    }
+
+    /* Fill audio thread id */
+    audiocontext.audio_thread = ThreadManager::getThreadId();
+
+    p->written_samples += pulse_write_source(p->sourceId, data, nbytes, !p->corked);
+    p->requested -= std::min(p->requested, nbytes);
+    p->underflow_notified = false;
+
+    if (free_cb && (data != p->write_buffer.data()))
+        free_cb(const_cast<void*>(data));
+
+    return 0;
+}
+
+size_t pa_stream_writable_size(const pa_stream *p)
+{
+    DEBUGLOGCALL(LCF_SOUND | LCF_FREQUENT);
+
+    if (p->state != PA_STREAM_READY)
+        return static_cast<size_t>(-1);
+
+    size_t frame_size = pa_frame_size(&p->sample_spec);
+    size_t queued = pulse_source_latency(p->sourceId) * frame_size;
+    if (queued >= p->buffer_attr.tlength)
+        return 0;
+    return p->buffer_attr.tlength - queued;
+}
+
+int pa_stream_peek(pa_stream *p, const void **data, size_t *nbytes)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    p->context->error = PA_ERR_BADSTATE;
+    return -PA_ERR_BADSTATE;
+}
+
+int pa_stream_drop(pa_stream *p)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    p->context->error = PA_ERR_BADSTATE;
+    return -PA_ERR_BADSTATE;
+}
+
+size_t pa_stream_readable_size(const pa_stream *p)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return static_cast<size_t>(-1);
+}
+
+pa_operation* pa_stream_drain(pa_stream *s, pa_stream_success_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+
+    if ((s->state != PA_STREAM_READY) || s->drain_operation) {
+        s->context->error = PA_ERR_BADSTATE;
+        return nullptr;
+    }
+
+    /* Samples are only consumed at frame boundaries, so the main thread
+     * cannot wait for them to be played */
+    if (ThreadManager::isMainThread() || (pulse_source_latency(s->sourceId) == 0))
+        return stream_operation(s, cb, userdata);
+
+    pa_operation *o = new pa_operation;
+    o->refcount = 2;
+    o->state = PA_OPERATION_RUNNING;
+    s->drain_operation = o;
+    s->drain_callback = cb;
+    s->drain_userdata = userdata;
+    return o;
+}
+
+pa_operation* pa_stream_update_timing_info(pa_stream *p, pa_stream_success_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return stream_operation(p, cb, userdata);
+}
+
+void pa_stream_set_state_callback(pa_stream *s, pa_stream_notify_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    s->state_callback = cb;
+    s->state_userdata = userdata;
+}
+
+void pa_stream_set_write_callback(pa_stream *p, pa_stream_request_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    p->write_callback = cb;
+    p->write_userdata = userdata;
+}
+
+void pa_stream_set_underflow_callback(pa_stream *p, pa_stream_notify_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    p->underflow_callback = cb;
+    p->underflow_userdata = userdata;
+}
+
+void pa_stream_set_read_callback(pa_stream *p, pa_stream_request_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+}
+
+void pa_stream_set_overflow_callback(pa_stream *p, pa_stream_notify_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+}
+
+void pa_stream_set_started_callback(pa_stream *p, pa_stream_notify_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+}
+
+void pa_stream_set_latency_update_callback(pa_stream *p, pa_stream_notify_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+}
+
+void pa_stream_set_moved_callback(pa_stream *p, pa_stream_notify_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+}
+
+void pa_stream_set_suspended_callback(pa_stream *p, pa_stream_notify_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+}
+
+void pa_stream_set_event_callback(pa_stream *p, pa_stream_event_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+}
+
+void pa_stream_set_buffer_attr_callback(pa_stream *p, pa_stream_notify_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+}
+
+pa_operation* pa_stream_cork(pa_stream *s, int b, pa_stream_success_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+
+    s->corked = b;
+    {
+        std::lock_guard<std::mutex> lock(audiocontext.mutex);
+        auto source = audiocontext.getSource(s->sourceId);
+        if (b)
+            source->state = AudioSource::SOURCE_PAUSED;
+        else if (source->state == AudioSource::SOURCE_PAUSED)
+            source->state = AudioSource::SOURCE_PLAYING;
+    }
+
+    return stream_operation(s, cb, userdata);
+}
+
+int pa_stream_is_corked(const pa_stream *s)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return s->corked;
+}
+
+pa_operation* pa_stream_flush(pa_stream *s, pa_stream_success_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+
+    {
+        std::lock_guard<std::mutex> lock(audiocontext.mutex);
+        auto source = audiocontext.getSource(s->sourceId);
+        source->setPosition(source->queueSize());
+    }
+    s->requested = 0;
+
+    return stream_operation(s, cb, userdata);
+}
+
+pa_operation* pa_stream_trigger(pa_stream *s, pa_stream_success_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+
+    /* We don't wait for the prebuffer to be filled, so there is nothing to
+     * trigger */
+    return stream_operation(s, cb, userdata);
+}
+
+pa_operation* pa_stream_prebuf(pa_stream *s, pa_stream_success_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return stream_operation(s, cb, userdata);
+}
+
+pa_operation* pa_stream_set_name(pa_stream *s, const char *name, pa_stream_success_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return stream_operation(s, cb, userdata);
+}
+
+pa_operation* pa_stream_set_buffer_attr(pa_stream *s, const pa_buffer_attr *attr, pa_stream_success_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+
+    if (s->state != PA_STREAM_READY) {
+        s->context->error = PA_ERR_BADSTATE;
+        return nullptr;
+    }
+
+    stream_apply_buffer_attr(s, attr);
+    return stream_operation(s, cb, userdata);
+}
+
+pa_operation* pa_stream_update_sample_rate(pa_stream *s, uint32_t rate, pa_stream_success_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND | LCF_TODO);
+    s->context->error = PA_ERR_NOTSUPPORTED;
+    return nullptr;
+}
+
+pa_operation* pa_stream_proplist_update(pa_stream *s, pa_update_mode_t mode, pa_proplist *p, pa_stream_success_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return stream_operation(s, cb, userdata);
+}
+
+pa_operation* pa_stream_proplist_remove(pa_stream *s, const char *const keys[], pa_stream_success_cb_t cb, void *userdata)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return stream_operation(s, cb, userdata);
+}
+
+int pa_stream_get_time(pa_stream *s, pa_usec_t *r_usec)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+
+    uint64_t played = s->written_samples - pulse_source_latency(s->sourceId);
+    *r_usec = (played * 1000000) / s->sample_spec.rate;
+    return 0;
+}
+
+int pa_stream_get_latency(pa_stream *s, pa_usec_t *r_usec, int *negative)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+
+    uint64_t latency = pulse_source_latency(s->sourceId);
+    *r_usec = (latency * 1000000) / s->sample_spec.rate;
+    if (negative)
+        *negative = 0;
+    return 0;
+}
+
+const pa_timing_info* pa_stream_get_timing_info(pa_stream *s)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+
+    uint64_t latency = pulse_source_latency(s->sourceId);
+    size_t frame_size = pa_frame_size(&s->sample_spec);
+    s->timing_info.playing = (s->state == PA_STREAM_READY) && !s->corked && (latency > 0);
+    s->timing_info.sink_usec = (latency * 1000000) / s->sample_spec.rate;
+    s->timing_info.write_index = s->written_samples * frame_size;
+    s->timing_info.read_index = (s->written_samples - latency) * frame_size;
+    s->timing_info.configured_sink_usec = pa_bytes_to_usec(s->buffer_attr.tlength, &s->sample_spec);
+    return &s->timing_info;
+}
+
+const pa_sample_spec* pa_stream_get_sample_spec(pa_stream *s)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return &s->sample_spec;
+}
+
+const pa_buffer_attr* pa_stream_get_buffer_attr(pa_stream *s)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return &s->buffer_attr;
+}
+
+const pa_channel_map* pa_stream_get_channel_map(pa_stream *s)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return &s->channel_map;
+}
+
+uint32_t pa_stream_get_index(const pa_stream *s)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return s->sourceId;
+}
+
+uint32_t pa_stream_get_device_index(const pa_stream *s)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return 0;
+}
+
+const char *pa_stream_get_device_name(const pa_stream *s)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return "libtas";
+}
+
+int pa_stream_is_suspended(const pa_stream *s)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return 0;
+}
+
+pa_operation *pa_operation_ref(pa_operation *o)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    o->refcount++;
+    return o;
+}
+
+void pa_operation_unref(pa_operation *o)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (--o->refcount == 0)
+        delete o;
+}
+
+void pa_operation_cancel(pa_operation *o)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (o->state == PA_OPERATION_RUNNING)
+        o->state = PA_OPERATION_CANCELLED;
+}
+
+pa_operation_state_t pa_operation_get_state(const pa_operation *o)
+{
+    DEBUGLOGCALL(LCF_SOUND | LCF_FREQUENT);
+    return o->state;
+}
+
+}
@@ -0,0 +1,104 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LIBTAS_PULSE_STREAM_H_INCL
+#define LIBTAS_PULSE_STREAM_H_INCL
+
+#include "../../global.h"
+#include "pulsetypes.h"
+
+namespace libtas {
+
+OVERRIDE pa_stream* pa_stream_new(pa_context *c, const char *name, const pa_sample_spec *ss, const pa_channel_map *map);
+OVERRIDE pa_stream* pa_stream_new_with_proplist(pa_context *c, const char *name, const pa_sample_spec *ss, const pa_channel_map *map, pa_proplist *p);
+OVERRIDE void pa_stream_unref(pa_stream *s);
+OVERRIDE pa_stream *pa_stream_ref(pa_stream *s);
+OVERRIDE pa_stream_state_t pa_stream_get_state(const pa_stream *p);
+OVERRIDE pa_context* pa_stream_get_context(const pa_stream *p);
+
+/* Connect the stream to a sink. Only playback streams are supported */
+OVERRIDE int pa_stream_connect_playback(pa_stream *s, const char *dev, const pa_buffer_attr *attr, pa_stream_flags_t flags, const pa_cvolume *volume, pa_stream *sync_stream);
+OVERRIDE int pa_stream_connect_record(pa_stream *s, const char *dev, const pa_buffer_attr *attr, pa_stream_flags_t flags);
+OVERRIDE int pa_stream_disconnect(pa_stream *s);
+
+OVERRIDE int pa_stream_begin_write(pa_stream *p, void **data, size_t *nbytes);
+OVERRIDE int pa_stream_cancel_write(pa_stream *p);
+OVERRIDE int pa_stream_write(pa_stream *p, const void *data, size_t nbytes, pa_free_cb_t free_cb, int64_t offset, pa_seek_mode_t seek);
+
+/* Return the number of bytes requested by the server that have not yet
+ * been written */
+OVERRIDE size_t pa_stream_writable_size(const pa_stream *p);
+
+/* Recording is not supported, so there is never data to read */
+OVERRIDE int pa_stream_peek(pa_stream *p, const void **data, size_t *nbytes);
+OVERRIDE int pa_stream_drop(pa_stream *p);
+OVERRIDE size_t pa_stream_readable_size(const pa_stream *p);
+
+/* Drain a playback stream. The operation completes when the mixer has
+ * played all queued samples */
+OVERRIDE pa_operation* pa_stream_drain(pa_stream *s, pa_stream_success_cb_t cb, void *userdata);
+OVERRIDE pa_operation* pa_stream_update_timing_info(pa_stream *p, pa_stream_success_cb_t cb, void *userdata);
+
+OVERRIDE void pa_stream_set_state_callback(pa_stream *s, pa_stream_notify_cb_t cb, void *userdata);
+OVERRIDE void pa_stream_set_write_callback(pa_stream *p, pa_stream_request_cb_t cb, void *userdata);
+OVERRIDE void pa_stream_set_underflow_callback(pa_stream *p, pa_stream_notify_cb_t cb, void *userdata);
+
+/* Events that are never sent by our implementation. Callbacks are ignored */
+OVERRIDE void pa_stream_set_read_callback(pa_stream *p, pa_stream_request_cb_t cb, void *userdata);
+OVERRIDE void pa_stream_set_overflow_callback(pa_stream *p, pa_stream_notify_cb_t cb, void *userdata);
+OVERRIDE void pa_stream_set_started_callback(pa_stream *p, pa_stream_notify_cb_t cb, void *userdata);
+OVERRIDE void pa_stream_set_latency_update_callback(pa_stream *p, pa_stream_notify_cb_t cb, void *userdata);
+OVERRIDE void pa_stream_set_moved_callback(pa_stream *p, pa_stream_notify_cb_t cb, void *userdata);
+OVERRIDE void pa_stream_set_suspended_callback(pa_stream *p, pa_stream_notify_cb_t cb, void *userdata);
+OVERRIDE void pa_stream_set_event_callback(pa_stream *p, pa_stream_event_cb_t cb, void *userdata);
+OVERRIDE void pa_stream_set_buffer_attr_callback(pa_stream *p, pa_stream_notify_cb_t cb, void *userdata);
+
+OVERRIDE pa_operation* pa_stream_cork(pa_stream *s, int b, pa_stream_success_cb_t cb, void *userdata);
+OVERRIDE int pa_stream_is_corked(const pa_stream *s);
+OVERRIDE pa_operation* pa_stream_flush(pa_stream *s, pa_stream_success_cb_t cb, void *userdata);
+OVERRIDE pa_operation* pa_stream_trigger(pa_stream *s, pa_stream_success_cb_t cb, void *userdata);
+OVERRIDE pa_operation* pa_stream_prebuf(pa_stream *s, pa_stream_success_cb_t cb, void *userdata);
+OVERRIDE pa_operation* pa_stream_set_name(pa_stream *s, const char *name, pa_stream_success_cb_t cb, void *userdata);
+OVERRIDE pa_operation* pa_stream_set_buffer_attr(pa_stream *s, const pa_buffer_attr *attr, pa_stream_success_cb_t cb, void *userdata);
+OVERRIDE pa_operation* pa_stream_update_sample_rate(pa_stream *s, uint32_t rate, pa_stream_success_cb_t cb, void *userdata);
+OVERRIDE pa_operation* pa_stream_proplist_update(pa_stream *s, pa_update_mode_t mode, pa_proplist *p, pa_stream_success_cb_t cb, void *userdata);
+OVERRIDE pa_operation* pa_stream_proplist_remove(pa_stream *s, const char *const keys[], pa_stream_success_cb_t cb, void *userdata);
+
+/* Time and latency are computed from the samples consumed by the mixer */
+OVERRIDE int pa_stream_get_time(pa_stream *s, pa_usec_t *r_usec);
+OVERRIDE int pa_stream_get_latency(pa_stream *s, pa_usec_t *r_usec, int *negative);
+OVERRIDE const pa_timing_info* pa_stream_get_timing_info(pa_stream *s);
+
+OVERRIDE const pa_sample_spec* pa_stream_get_sample_spec(pa_stream *s);
+OVERRIDE const pa_buffer_attr* pa_stream_get_buffer_attr(pa_stream *s);
+OVERRIDE const pa_channel_map* pa_stream_get_channel_map(pa_stream *s);
+OVERRIDE uint32_t pa_stream_get_index(const pa_stream *s);
+OVERRIDE uint32_t pa_stream_get_device_index(const pa_stream *s);
+OVERRIDE const char *pa_stream_get_device_name(const pa_stream *s);
+OVERRIDE int pa_stream_is_suspended(const pa_stream *s);
+
+OVERRIDE pa_operation *pa_operation_ref(pa_operation *o);
+OVERRIDE void pa_operation_unref(pa_operation *o);
+OVERRIDE void pa_operation_cancel(pa_operation *o);
+OVERRIDE pa_operation_state_t pa_operation_get_state(const pa_operation *o);
+
+}
+
+#endif
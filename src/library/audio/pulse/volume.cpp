@@ -0,0 +1,378 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "volume.h"
+#include "../../logging.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace libtas {
+
+pa_cvolume* pa_cvolume_init(pa_cvolume *a)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    a->channels = 0;
+    for (unsigned c = 0; c < PA_CHANNELS_MAX; c++)
+        a->values[c] = PA_VOLUME_INVALID;
+    return a;
+}
+
+pa_cvolume* pa_cvolume_set(pa_cvolume *a, unsigned channels, pa_volume_t v)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (channels > PA_CHANNELS_MAX)
+        return nullptr;
+
+    a->channels = channels;
+    for (unsigned c = 0; c < channels; c++)
+        a->values[c] = v;
+    return a;
+}
+
+int pa_cvolume_valid(const pa_cvolume *v)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (v->channels <= 0 || v->channels > PA_CHANNELS_MAX)
+        return 0;
+
+    for (unsigned c = 0; c < v->channels; c++)
+        if (v->values[c] > PA_VOLUME_MAX)
+            return 0;
+    return 1;
+}
+
+int pa_cvolume_equal(const pa_cvolume *a, const pa_cvolume *b)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (a->channels != b->channels)
+        return 0;
+
+    for (unsigned c = 0; c < a->channels; c++)
+        if (a->values[c] != b->values[c])
+            return 0;
+    return 1;
+}
+
+int pa_cvolume_channels_equal_to(const pa_cvolume *a, pa_volume_t v)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    for (unsigned c = 0; c < a->channels; c++)
+        if (a->values[c] != v)
+            return 0;
+    return 1;
+}
+
+pa_volume_t pa_cvolume_avg(const pa_cvolume *a)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (a->channels == 0)
+        return PA_VOLUME_MUTED;
+
+    uint64_t sum = 0;
+    for (unsigned c = 0; c < a->channels; c++)
+        sum += a->values[c];
+    return static_cast<pa_volume_t>(sum / a->channels);
+}
+
+pa_volume_t pa_cvolume_max(const pa_cvolume *a)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    pa_volume_t m = PA_VOLUME_MUTED;
+    for (unsigned c = 0; c < a->channels; c++)
+        if (a->values[c] > m)
+            m = a->values[c];
+    return m;
+}
+
+pa_volume_t pa_cvolume_min(const pa_cvolume *a)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    pa_volume_t m = PA_VOLUME_MAX;
+    for (unsigned c = 0; c < a->channels; c++)
+        if (a->values[c] < m)
+            m = a->values[c];
+    return m;
+}
+
+pa_cvolume* pa_cvolume_scale(pa_cvolume *v, pa_volume_t max)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    pa_volume_t t = pa_cvolume_max(v);
+    if (t <= PA_VOLUME_MUTED)
+        return pa_cvolume_set(v, v->channels, max);
+
+    for (unsigned c = 0; c < v->channels; c++)
+        v->values[c] = static_cast<pa_volume_t>((static_cast<uint64_t>(v->values[c]) * max) / t);
+    return v;
+}
+
+int pa_cvolume_compatible(const pa_cvolume *v, const pa_sample_spec *ss)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return pa_cvolume_valid(v) && (v->channels == ss->channels);
+}
+
+char *pa_cvolume_snprint(char *s, size_t l, const pa_cvolume *c)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (!pa_cvolume_valid(c)) {
+        snprintf(s, l, "(invalid)");
+        return s;
+    }
+
+    size_t pos = 0;
+    s[0] = '\0';
+    for (unsigned i = 0; (i < c->channels) && (pos < l); i++) {
+        pos += snprintf(s + pos, l - pos, "%s%u: %3u%%", i == 0 ? "" : " ", i,
+            static_cast<unsigned>((static_cast<uint64_t>(c->values[i]) * 100 + PA_VOLUME_NORM / 2) / PA_VOLUME_NORM));
+    }
+    return s;
+}
+
+pa_volume_t pa_sw_volume_from_linear(double v)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (v <= 0)
+        return PA_VOLUME_MUTED;
+
+    double r = std::cbrt(v) * PA_VOLUME_NORM;
+    if (r >= PA_VOLUME_MAX)
+        return PA_VOLUME_MAX;
+    return static_cast<pa_volume_t>(std::lround(r));
+}
+
+double pa_sw_volume_to_linear(pa_volume_t v)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (v <= PA_VOLUME_MUTED)
+        return 0;
+    if (v == PA_VOLUME_NORM)
+        return 1;
+
+    double f = static_cast<double>(v) / PA_VOLUME_NORM;
+    return f * f * f;
+}
+
+pa_volume_t pa_sw_volume_from_dB(double f)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (std::isinf(f) && (f < 0))
+        return PA_VOLUME_MUTED;
+    return pa_sw_volume_from_linear(std::pow(10.0, f / 20.0));
+}
+
+double pa_sw_volume_to_dB(pa_volume_t v)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (v <= PA_VOLUME_MUTED)
+        return -INFINITY;
+    return 20.0 * std::log10(pa_sw_volume_to_linear(v));
+}
+
+pa_volume_t pa_sw_volume_multiply(pa_volume_t a, pa_volume_t b)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    uint64_t r = (static_cast<uint64_t>(a) * b + PA_VOLUME_NORM / 2) / PA_VOLUME_NORM;
+    if (r > PA_VOLUME_MAX)
+        return PA_VOLUME_MAX;
+    return static_cast<pa_volume_t>(r);
+}
+
+pa_channel_map* pa_channel_map_init(pa_channel_map *m)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    m->channels = 0;
+    for (unsigned c = 0; c < PA_CHANNELS_MAX; c++)
+        m->map[c] = PA_CHANNEL_POSITION_INVALID;
+    return m;
+}
+
+pa_channel_map* pa_channel_map_init_mono(pa_channel_map *m)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    pa_channel_map_init(m);
+    m->channels = 1;
+    m->map[0] = PA_CHANNEL_POSITION_MONO;
+    return m;
+}
+
+pa_channel_map* pa_channel_map_init_stereo(pa_channel_map *m)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    pa_channel_map_init(m);
+    m->channels = 2;
+    m->map[0] = PA_CHANNEL_POSITION_FRONT_LEFT;
+    m->map[1] = PA_CHANNEL_POSITION_FRONT_RIGHT;
+    return m;
+}
+
+/* Standard layouts from one to eight channels, following the WAVEEX order
+ * which is also the order of ALSA and of our mixer */
+static const int waveex_positions[8] = {
+    PA_CHANNEL_POSITION_FRONT_LEFT,
+    PA_CHANNEL_POSITION_FRONT_RIGHT,
+    PA_CHANNEL_POSITION_FRONT_CENTER,
+    PA_CHANNEL_POSITION_LFE,
+    PA_CHANNEL_POSITION_REAR_LEFT,
+    PA_CHANNEL_POSITION_REAR_RIGHT,
+    PA_CHANNEL_POSITION_SIDE_LEFT,
+    PA_CHANNEL_POSITION_SIDE_RIGHT
+};
+
+pa_channel_map* pa_channel_map_init_auto(pa_channel_map *m, unsigned channels, pa_channel_map_def_t def)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (channels == 0 || channels > PA_CHANNELS_MAX)
+        return nullptr;
+
+    pa_channel_map_init(m);
+    m->channels = channels;
+
+    if (def == PA_CHANNEL_MAP_AUX) {
+        for (unsigned c = 0; c < channels; c++)
+            m->map[c] = PA_CHANNEL_POSITION_AUX0 + c;
+        return m;
+    }
+
+    if (channels == 1) {
+        m->map[0] = PA_CHANNEL_POSITION_MONO;
+        return m;
+    }
+
+    /* We don't distinguish between the other layouts */
+    if (channels > 8)
+        return nullptr;
+
+    for (unsigned c = 0; c < channels; c++)
+        m->map[c] = waveex_positions[c];
+    return m;
+}
+
+pa_channel_map* pa_channel_map_init_extend(pa_channel_map *m, unsigned channels, pa_channel_map_def_t def)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (channels == 0 || channels > PA_CHANNELS_MAX)
+        return nullptr;
+
+    if (pa_channel_map_init_auto(m, channels, def))
+        return m;
+
+    /* Fill the remaining channels with auxiliary positions */
+    pa_channel_map_init_auto(m, 8, def);
+    m->channels = channels;
+    for (unsigned c = 8; c < channels; c++)
+        m->map[c] = PA_CHANNEL_POSITION_AUX0 + c - 8;
+    return m;
+}
+
+int pa_channel_map_valid(const pa_channel_map *map)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (map->channels <= 0 || map->channels > PA_CHANNELS_MAX)
+        return 0;
+
+    for (unsigned c = 0; c < map->channels; c++)
+        if (map->map[c] < 0 || map->map[c] >= PA_CHANNEL_POSITION_MAX)
+            return 0;
+    return 1;
+}
+
+int pa_channel_map_equal(const pa_channel_map *a, const pa_channel_map *b)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (a->channels != b->channels)
+        return 0;
+
+    for (unsigned c = 0; c < a->channels; c++)
+        if (a->map[c] != b->map[c])
+            return 0;
+    return 1;
+}
+
+int pa_channel_map_compatible(const pa_channel_map *map, const pa_sample_spec *ss)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    return pa_channel_map_valid(map) && (map->channels == ss->channels);
+}
+
+static const char* const position_strings[PA_CHANNEL_POSITION_AUX0] = {
+    "mono",
+    "front-left",
+    "front-right",
+    "front-center",
+    "rear-center",
+    "rear-left",
+    "rear-right",
+    "lfe",
+    "front-left-of-center",
+    "front-right-of-center",
+    "side-left",
+    "side-right"
+};
+
+static const char* const aux_strings[32] = {
+    "aux0", "aux1", "aux2", "aux3", "aux4", "aux5", "aux6", "aux7",
+    "aux8", "aux9", "aux10", "aux11", "aux12", "aux13", "aux14", "aux15",
+    "aux16", "aux17", "aux18", "aux19", "aux20", "aux21", "aux22", "aux23",
+    "aux24", "aux25", "aux26", "aux27", "aux28", "aux29", "aux30", "aux31"
+};
+
+static const char* const top_strings[PA_CHANNEL_POSITION_MAX - PA_CHANNEL_POSITION_TOP_CENTER] = {
+    "top-center",
+    "top-front-left",
+    "top-front-right",
+    "top-front-center",
+    "top-rear-left",
+    "top-rear-right",
+    "top-rear-center"
+};
+
+const char* pa_channel_position_to_string(pa_channel_position_t pos)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (pos < 0 || pos >= PA_CHANNEL_POSITION_MAX)
+        return nullptr;
+    if (pos < PA_CHANNEL_POSITION_AUX0)
+        return position_strings[pos];
+    if (pos < PA_CHANNEL_POSITION_TOP_CENTER)
+        return aux_strings[pos - PA_CHANNEL_POSITION_AUX0];
+    return top_strings[pos - PA_CHANNEL_POSITION_TOP_CENTER];
+}
+
+char* pa_channel_map_snprint(char *s, size_t l, const pa_channel_map *map)
+{
+    DEBUGLOGCALL(LCF_SOUND);
+    if (!pa_channel_map_valid(map)) {
+        snprintf(s, l, "(invalid)");
+        return s;
+    }
+
+    size_t pos = 0;
+    s[0] = '\0';
+    for (unsigned c = 0; (c < map->channels) && (pos < l); c++) {
+        pos += snprintf(s + pos, l - pos, "%s%s", c == 0 ? "" : ",",
+            pa_channel_position_to_string(static_cast<pa_channel_position_t>(map->map[c])));
+    }
+    return s;
+}
+
+}
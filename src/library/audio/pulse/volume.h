@@ -0,0 +1,61 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LIBTAS_PULSE_VOLUME_H_INCL
+#define LIBTAS_PULSE_VOLUME_H_INCL
+
+#include "../../global.h"
+#include "pulsetypes.h"
+
+namespace libtas {
+
+OVERRIDE pa_cvolume* pa_cvolume_init(pa_cvolume *a);
+OVERRIDE pa_cvolume* pa_cvolume_set(pa_cvolume *a, unsigned channels, pa_volume_t v);
+OVERRIDE int pa_cvolume_valid(const pa_cvolume *v);
+OVERRIDE int pa_cvolume_equal(const pa_cvolume *a, const pa_cvolume *b);
+OVERRIDE int pa_cvolume_channels_equal_to(const pa_cvolume *a, pa_volume_t v);
+OVERRIDE pa_volume_t pa_cvolume_avg(const pa_cvolume *a);
+OVERRIDE pa_volume_t pa_cvolume_max(const pa_cvolume *a);
+OVERRIDE pa_volume_t pa_cvolume_min(const pa_cvolume *a);
+OVERRIDE pa_cvolume* pa_cvolume_scale(pa_cvolume *v, pa_volume_t max);
+OVERRIDE int pa_cvolume_compatible(const pa_cvolume *v, const pa_sample_spec *ss);
+OVERRIDE char *pa_cvolume_snprint(char *s, size_t l, const pa_cvolume *c);
+
+/* Software volumes use the same cubic mapping as libpulse */
+OVERRIDE pa_volume_t pa_sw_volume_from_linear(double v);
+OVERRIDE double pa_sw_volume_to_linear(pa_volume_t v);
+OVERRIDE pa_volume_t pa_sw_volume_from_dB(double f);
+OVERRIDE double pa_sw_volume_to_dB(pa_volume_t v);
+OVERRIDE pa_volume_t pa_sw_volume_multiply(pa_volume_t a, pa_volume_t b);
+
+OVERRIDE pa_channel_map* pa_channel_map_init(pa_channel_map *m);
+OVERRIDE pa_channel_map* pa_channel_map_init_mono(pa_channel_map *m);
+OVERRIDE pa_channel_map* pa_channel_map_init_stereo(pa_channel_map *m);
+OVERRIDE pa_channel_map* pa_channel_map_init_auto(pa_channel_map *m, unsigned channels, pa_channel_map_def_t def);
+OVERRIDE pa_channel_map* pa_channel_map_init_extend(pa_channel_map *m, unsigned channels, pa_channel_map_def_t def);
+OVERRIDE int pa_channel_map_valid(const pa_channel_map *map);
+OVERRIDE int pa_channel_map_equal(const pa_channel_map *a, const pa_channel_map *b);
+OVERRIDE int pa_channel_map_compatible(const pa_channel_map *map, const pa_sample_spec *ss);
+OVERRIDE char* pa_channel_map_snprint(char *s, size_t l, const pa_channel_map *map);
+OVERRIDE const char* pa_channel_position_to_string(pa_channel_position_t pos);
+
+}
+
+#endif
@@ -144,6 +144,38 @@ static void setPagesFd(int index, int fd)
     pages[index] = fd;
 }
 
+void Checkpoint::release()
+{
+    if (ss_index < 0)
+        return;
+
+    /* The parent state is read when saving the next incremental state */
+    if ((shared_config.savestate_settings & SharedConfig::SS_INCREMENTAL) &&
+        (ss_index == parent_ss_index)) {
+        debuglogstdio(LCF_CHECKPOINT | LCF_WARNING, "Savestate %d is the parent of the next state, keeping it", ss_index);
+        return;
+    }
+
+    if (shared_config.savestate_settings & SharedConfig::SS_RAM) {
+        int pmfd = getPagemapFd(ss_index);
+        if (pmfd) {
+            NATIVECALL(close(pmfd));
+            setPagemapFd(ss_index, 0);
+        }
+        int pfd = getPagesFd(ss_index);
+        if (pfd) {
+            NATIVECALL(close(pfd));
+            setPagesFd(ss_index, 0);
+        }
+    }
+    else {
+        NATIVECALL(unlink(pagemappath));
+        NATIVECALL(unlink(pagespath));
+    }
+
+    debuglogstdio(LCF_CHECKPOINT, "Released savestate %d", ss_index);
+}
+
 int Checkpoint::checkCheckpoint()
 {
     if (shared_config.savestate_settings & SharedConfig::SS_RAM)
@@ -37,6 +37,9 @@ namespace Checkpoint
 
     int checkCheckpoint();
     int checkRestore();
+
+    /* Free the memory or files of the current savestate */
+    void release();
     void handler(int signum);
 }
 }
@@ -0,0 +1,98 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ProcMapsCache.h"
+#include "ProcSelfMaps.h"
+#include "ProcMapsArea.h"
+#include "../logging.h"
+#include <vector>
+#include <algorithm> // std::upper_bound
+
+namespace libtas {
+
+struct MapRange {
+    uintptr_t start;
+    uintptr_t end;
+};
+
+static std::vector<MapRange> ranges;
+
+/* Generation of the mappings, and generation of the cached ranges */
+static uint64_t current_gen = 1;
+static uint64_t cached_gen = 0;
+
+static void rebuild()
+{
+    ranges.clear();
+
+    ProcSelfMaps procSelfMaps;
+    Area area;
+    while (procSelfMaps.getNextArea(&area)) {
+        ranges.push_back({reinterpret_cast<uintptr_t>(area.addr), reinterpret_cast<uintptr_t>(area.endAddr)});
+    }
+
+    cached_gen = current_gen;
+    debuglogstdio(LCF_CHECKPOINT, "Memory map cache rebuilt with %zu areas", ranges.size());
+}
+
+/* Binary search inside the cached ranges, which are sorted by address as in
+ * /proc/self/maps */
+static bool lookup(uintptr_t addr, uintptr_t* start, uintptr_t* end)
+{
+    auto it = std::upper_bound(ranges.begin(), ranges.end(), addr,
+        [](uintptr_t a, const MapRange& r) { return a < r.start; });
+
+    if (it == ranges.begin())
+        return false;
+
+    --it;
+    if (addr >= it->end)
+        return false;
+
+    *start = it->start;
+    *end = it->end;
+    return true;
+}
+
+bool ProcMapsCache::findArea(uintptr_t addr, uintptr_t* start, uintptr_t* end)
+{
+    bool rebuilt = false;
+    if (cached_gen != current_gen) {
+        rebuild();
+        rebuilt = true;
+    }
+
+    if (lookup(addr, start, end))
+        return true;
+
+    /* The area may have been mapped during this generation */
+    if (!rebuilt) {
+        rebuild();
+        return lookup(addr, start, end);
+    }
+
+    return false;
+}
+
+void ProcMapsCache::invalidate()
+{
+    current_gen++;
+}
+
+}
@@ -0,0 +1,53 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBTAS_PROCMAPSCACHE_H
+#define LIBTAS_PROCMAPSCACHE_H
+
+#include <cstdint>
+
+/* Cached model of the memory mapping bounds of the process, for code that
+ * needs to find which area contains an address without reparsing
+ * /proc/self/maps each time (stack growing, busy loop detection).
+ *
+ * Not every mapping change goes through our hooks (libc internals call mmap
+ * directly, the kernel grows the stack), so the cache cannot be updated
+ * incrementally. Instead, it is tagged with a generation, which is bumped on
+ * events that are known to change the mappings (frame boundary, savestate),
+ * and it is rebuilt lazily on the next lookup. A lookup that misses in a
+ * valid cache also triggers a single rebuild, to catch mappings created
+ * during the current generation.
+ *
+ * It is only accessed from the main thread.
+ */
+
+namespace libtas {
+namespace ProcMapsCache {
+
+/* Find the memory area containing the address. Returns false if the address
+ * is not mapped. */
+bool findArea(uintptr_t addr, uintptr_t* start, uintptr_t* end);
+
+/* Mark the cache as outdated */
+void invalidate();
+
+}
+}
+
+#endif
@@ -24,6 +24,7 @@
 
 #include <cstdint> // intptr_t
 #include <cstddef> // size_t
+#include "../../shared/SharedConfig.h"
 
 #define ONE_MB 1024 * 1024
 #define RESTORE_TOTAL_SIZE 5 * ONE_MB
@@ -32,15 +33,19 @@ namespace libtas {
 namespace ReservedMemory {
     enum Addresses {
         PAGEMAPS_ADDR = 0,
-        PAGES_ADDR = 11*sizeof(int),
-        SS_SLOTS_ADDR = 22*sizeof(int),
-        PSM_ADDR = 22*sizeof(int)+11*sizeof(bool),
+        PAGES_ADDR = SharedConfig::SS_SLOT_COUNT*sizeof(int),
+        SS_SLOTS_ADDR = 2*SharedConfig::SS_SLOT_COUNT*sizeof(int),
+        SIGNALS_ADDR = (SS_SLOTS_ADDR+SharedConfig::SS_SLOT_COUNT*sizeof(bool)+7) & ~7,
+        WAV_FD_ADDR = SIGNALS_ADDR+sizeof(uint64_t),
+        PSM_ADDR = WAV_FD_ADDR+sizeof(int),
         STACK_ADDR = ONE_MB,
     };
     enum Sizes {
         PAGEMAPS_SIZE = PAGES_ADDR - PAGEMAPS_ADDR,
         PAGES_SIZE = SS_SLOTS_ADDR - PAGES_ADDR,
-        SS_SLOTS_SIZE = PSM_ADDR - SS_SLOTS_ADDR,
+        SS_SLOTS_SIZE = SIGNALS_ADDR - SS_SLOTS_ADDR,
+        SIGNALS_SIZE = WAV_FD_ADDR - SIGNALS_ADDR,
+        WAV_FD_SIZE = PSM_ADDR - WAV_FD_ADDR,
         PSM_SIZE = STACK_ADDR - PSM_ADDR,
         STACK_SIZE = RESTORE_TOTAL_SIZE - STACK_ADDR,
     };
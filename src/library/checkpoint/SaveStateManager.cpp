@@ -35,8 +35,11 @@
 #include "../audio/AudioPlayer.h"
 #include "AltStack.h"
 #include "ReservedMemory.h"
+#include "ProcMapsCache.h"
 #include "../fileio/FileHandleList.h"
 #include "../fileio/URandom.h"
+#include "../VirtualSignals.h"
+#include "../TimeTrap.h"
 
 namespace libtas {
 
@@ -67,7 +70,19 @@ void SaveStateManager::init()
     ReservedMemory::init();
 
     state_dirty = static_cast<bool*>(ReservedMemory::getAddr(ReservedMemory::SS_SLOTS_ADDR));
-    memset(state_dirty, 0, 11*sizeof(bool));
+    memset(state_dirty, 0, SharedConfig::SS_SLOT_COUNT*sizeof(bool));
+}
+
+/* The checkpoint signal is shared with the seccomp filter of raw time
+ * syscalls, which raises SIGSYS */
+static void checkpointHandler(int signum, siginfo_t* info, void* ucontext)
+{
+    if (TimeTrap::isTrappedSyscall(info)) {
+        TimeTrap::handleSyscall(signum, info, ucontext);
+        return;
+    }
+
+    Checkpoint::handler(signum);
 }
 
 void SaveStateManager::initCheckpointThread()
@@ -79,8 +94,8 @@ void SaveStateManager::initCheckpointThread()
 
     struct sigaction sigcheckpoint;
     sigfillset(&sigcheckpoint.sa_mask);
-    sigcheckpoint.sa_flags = SA_ONSTACK;
-    sigcheckpoint.sa_handler = Checkpoint::handler;
+    sigcheckpoint.sa_flags = SA_ONSTACK | SA_SIGINFO;
+    sigcheckpoint.sa_sigaction = checkpointHandler;
     {
         GlobalNative gn;
         MYASSERT(sigaction(sig_checkpoint, &sigcheckpoint, nullptr) == 0)
@@ -131,7 +146,7 @@ int SaveStateManager::waitChild()
         return -1;
     }
     status = WEXITSTATUS(status);
-    if ((status < 0) && (status > 10)) {
+    if ((status < 0) || (status >= SharedConfig::SS_SLOT_COUNT)) {
         debuglogstdio(LCF_THREAD | LCF_CHECKPOINT | LCF_ERROR, "Got unknown status code %d from pid %d", status, pid);
         return -1;
     }
@@ -149,7 +164,7 @@ bool SaveStateManager::stateReady(int slot)
     if (!(shared_config.savestate_settings & SharedConfig::SS_FORK))
         return true;
 
-    if ((slot < 0) && (slot > 10)) {
+    if ((slot < 0) || (slot >= SharedConfig::SS_SLOT_COUNT)) {
         debuglogstdio(LCF_THREAD | LCF_CHECKPOINT | LCF_ERROR, "Wrong slot number");
         return false;
     }
@@ -219,6 +234,13 @@ int SaveStateManager::checkpoint(int slot)
     /* Restoring the game alternate stack (if any) */
     AltStack::restoreStack();
 
+    /* Signal handlers are kernel state and were not loaded with the memory */
+    if (isLoading())
+        VirtualSignals::restoreHandlers();
+
+    /* Memory mappings may have been modified by loading a state */
+    ProcMapsCache::invalidate();
+
     /* We recover the offset of all opened files. This must also be done BEFORE
      * resuming threads.
      */
@@ -243,6 +265,24 @@ int SaveStateManager::checkpoint(int slot)
     return ESTATE_OK;
 }
 
+void SaveStateManager::release(int slot)
+{
+    /* Wait for the forked process to finish writing the state, so that it
+     * does not recreate the files afterwards */
+    for (int i = 0; !stateReady(slot); i++) {
+        if (i == 10000) {
+            debuglogstdio(LCF_CHECKPOINT | LCF_ERROR, "State %d is still being saved, could not release it", slot);
+            return;
+        }
+        if (waitChild() < 0) {
+            struct timespec mssleep = {0, 1000*1000};
+            NATIVECALL(nanosleep(&mssleep, NULL));
+        }
+    }
+
+    Checkpoint::release();
+}
+
 int SaveStateManager::restore(int slot)
 {
     if (!stateReady(slot))
@@ -441,7 +481,7 @@ void SaveStateManager::suspendThreads()
     ThreadManager::unlockList();
 
     for (int i = 0; i < numThreads; i++) {
-        sem_wait(&semNotifyCkptThread);
+        NATIVECALL(sem_wait(&semNotifyCkptThread));
     }
 
     debuglogstdio(LCF_THREAD | LCF_CHECKPOINT, "%d threads were suspended", numThreads);
@@ -516,6 +556,10 @@ void SaveStateManager::stopThisThread(int signum)
         }
         else {
             ThreadLocalStorage::restoreTLSState(&current_thread->tlsInfo); // restore thread local storage
+
+            /* We are still running on our altstack, so the game altstack
+             * will be registered again on the next signal-related call */
+            VirtualSignals::invalidateAltStack();
         }
 
         MYASSERT(ThreadManager::updateState(current_thread, current_thread->orig_state, ThreadInfo::ST_SUSPENDED))
@@ -533,7 +577,7 @@ void SaveStateManager::waitForAllRestored(ThreadInfo *thread)
 {
     if (thread->state == ThreadInfo::ST_CKPNTHREAD) {
         for (int i = 0; i < numThreads; i++) {
-            sem_wait(&semNotifyCkptThread);
+            NATIVECALL(sem_wait(&semNotifyCkptThread));
         }
 
         /* If this was last of all, wake everyone up */
@@ -543,7 +587,7 @@ void SaveStateManager::waitForAllRestored(ThreadInfo *thread)
     }
     else {
         sem_post(&semNotifyCkptThread);
-        sem_wait(&semWaitForCkptThreadSignal);
+        NATIVECALL(sem_wait(&semWaitForCkptThreadSignal));
     }
 }
 
@@ -65,6 +65,9 @@ int checkpoint(int slot);
 /* Restore a savestate */
 int restore(int slot);
 
+/* Free the storage of a savestate that the program dropped */
+void release(int slot);
+
 /* Send a signal to suspend all threads before checkpointing */
 void suspendThreads();
 
@@ -68,6 +68,9 @@ struct ThreadInfo {
     bool initial_nolog = false; // initial value of the global nolog state
 
     stack_t altstack = {nullptr, 0, 0}; // altstack to be used when suspending threads
+    stack_t game_altstack = {nullptr, 0, 0}; // altstack registered by the game
+    bool game_altstack_set = false; // the game registered an altstack
+    bool altstack_invalid = false; // altstack must be registered again after loading a state
 
     std::mutex mutex; // mutex to notify a thread for a new routing
     std::condition_variable cv; // associated conditional variable
@@ -77,6 +80,8 @@ struct ThreadInfo {
     bool syncEnabled = false; // main thread needs to wait for this thread
     bool syncGo = false; // main thread can advance for now
 
+    bool loader = false; // thread only loads resources, from the engine profile
+
     ThreadInfo *next = nullptr; // next thread info in the linked list
     ThreadInfo *prev = nullptr; // previous thread info in the linked list
 };
@@ -209,6 +209,7 @@ bool ThreadManager::initThreadFromParent(ThreadInfo* thread, void * (* start_rou
     thread->state = ThreadInfo::ST_RUNNING;
     thread->routine_id = (char *)start_routine - (char *)from;
     thread->detached = false;
+    thread->loader = false;
     thread->initial_native = GlobalState::isNative();
     thread->initial_owncode = GlobalState::isOwnCode();
     thread->initial_nolog = GlobalState::isNoLog();
@@ -327,6 +328,7 @@ void ThreadManager::threadExit(void* retval)
     ThreadSync::detSignal(true);
 
     lockList();
+    current_thread->loader = false;
     current_thread->retval = retval;
     MYASSERT(updateState(current_thread, ThreadInfo::ST_ZOMBIE, ThreadInfo::ST_RUNNING) ||
              updateState(current_thread, ThreadInfo::ST_ZOMBIE, ThreadInfo::ST_CKPNTHREAD))
@@ -24,6 +24,10 @@
 #include "wine/wined3d.h"
 #include "wine/user32.h"
 #include "wine/kernel32.h"
+#include "wine/kernelbase.h"
+#include "wine/winmm.h"
+#include "wine/xinput1_3.h"
+#include "wine/dinput8.h"
 #include <cstring>
 #include <set>
 #include "backtrace.h"
@@ -77,8 +81,17 @@ void *dlopen(const char *file, int mode) throw() {
     }
 
     if (file != nullptr && std::string(file).find("libpulse") != std::string::npos) {
-        debuglogstdio(LCF_HOOK, "%s blocked access to library %s", __func__, file);
-        return nullptr;
+        if (shared_config.audio_disabled) {
+            debuglogstdio(LCF_HOOK, "%s blocked access to library %s", __func__, file);
+            return nullptr;
+        }
+
+        /* We implement the PulseAudio client API ourselves, including the
+         * introspection, property list, volume and channel map helpers.
+         * Return the global handle, so that our functions are found by
+         * dlsym, and the real library is never loaded */
+        debuglogstdio(LCF_HOOK, "%s redirected library %s to our implementation", __func__, file);
+        return orig::dlopen(nullptr, mode);
     }
 
     if (file != nullptr && std::string(file).find("ScreenSelector.so") != std::string::npos) {
@@ -93,6 +106,9 @@ void *dlopen(const char *file, int mode) throw() {
     if (result)
         add_lib(file);
 
+    if (result)
+        GameHacks::detectLibrary(file);
+
     if (result && file && std::string(file).find("wined3d.dll.so") != std::string::npos) {
         /* Hook wine wined3d functions */
         hook_wined3d();
@@ -108,6 +124,30 @@ void *dlopen(const char *file, int mode) throw() {
         hook_kernel32();
     }
 
+    if (result && file && std::string(file).find("kernelbase.dll.so") != std::string::npos) {
+        /* Hook wine kernelbase functions */
+        hook_kernelbase();
+    }
+
+    if (result && file && std::string(file).find("winmm.dll.so") != std::string::npos) {
+        /* Hook wine winmm functions */
+        hook_winmm();
+    }
+
+    if (result && file) {
+        /* Hook wine xinput functions, each version being a separate library */
+        static const char* xinput_libs[] = {"xinput1_3.dll.so", "xinput1_4.dll.so", "xinput9_1_0.dll.so"};
+        for (const char* xinput_lib : xinput_libs) {
+            if (std::string(file).find(xinput_lib) != std::string::npos)
+                hook_xinput(xinput_lib);
+        }
+    }
+
+    if (result && file && std::string(file).find("dinput8.dll.so") != std::string::npos) {
+        /* Hook wine dinput8 functions */
+        hook_dinput8();
+    }
+
     return result;
 }
 
@@ -201,9 +241,8 @@ void *dlsym(void *handle, const char *name) throw() {
         }
     }
 
-    /* Detect a Unity game when it loads a specific function */
-    if (strcmp(name, "mono_unity_liveness_allocate_struct") == 0)
-        GameHacks::setUnity();
+    /* Detect the game engine from some specific functions */
+    GameHacks::detectSymbol(name);
 
     /* FIXME: This design is not good enough.
      * This idea is to link to our defined function when there is one, instead
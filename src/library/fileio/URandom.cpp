@@ -21,31 +21,37 @@
 
 #include "FileHandleList.h"
 #include "../logging.h"
+#include "../DeterministicEntropy.h"
 #include <fcntl.h>
 #include <unistd.h> // getpid()
+#include <sys/ioctl.h> // FIONREAD
 
 namespace libtas {
 
 static int readfd = -1;
 static int writefd = -1;
-static char* datestr = nullptr;
 static FILE* stream = nullptr;
 
+/* Number of bytes that were still in the pipe when the handler was disabled.
+ * Because this variable is saved in savestates, we can regenerate the exact
+ * pipe content after loading a state. */
+static int pipe_pending = 0;
+
 static void urandom_handler(int signum)
 {
-    /* TODO: write a simple PRNG which is seeded by shared_config.initial_time_sec
-     * instead of outputting it directly as a string.
-     */
     debuglogstdio(LCF_FILEIO | LCF_RANDOM, "Filling urandom fd");
-    if (!datestr) {
-        time_t tsec = static_cast<time_t>(shared_config.initial_time_sec);
-        datestr = asctime(gmtime(&tsec));
-    }
 
-    /* Fill the pipe with data from initial time */
-    int err = write(writefd, datestr, strlen(datestr));
-    while (err != -1) {
-        err = write(writefd, datestr, strlen(datestr));
+    /* Fill the pipe with the next bytes of the entropy stream, until it is full.
+     * Bytes that could not be written are given back to the stream. */
+    char buf[512];
+    while (true) {
+        uint64_t pos = DeterministicEntropy::tell(DeterministicEntropy::STREAM_URANDOM_FD);
+        DeterministicEntropy::getBytes(DeterministicEntropy::STREAM_URANDOM_FD, buf, sizeof(buf));
+        ssize_t ret = write(writefd, buf, sizeof(buf));
+        if (ret < static_cast<ssize_t>(sizeof(buf))) {
+            DeterministicEntropy::seek(DeterministicEntropy::STREAM_URANDOM_FD, pos + ((ret > 0) ? ret : 0));
+            break;
+        }
     }
 }
 
@@ -96,11 +102,20 @@ int urandom_get_fd() {
     return readfd;
 }
 
+/* Read function of the FILE stream, which directly serves bytes from the
+ * entropy stream, without any syscall */
+static ssize_t urandom_file_read(void *cookie, char *buf, size_t size)
+{
+    DeterministicEntropy::getBytes(DeterministicEntropy::STREAM_URANDOM_FILE, buf, size);
+    return size;
+}
+
 FILE* urandom_create_file() {
     if (!stream) {
-        int readfd = urandom_create_fd();
-        stream = fdopen(readfd, "r");
-        setvbuf(stream, nullptr, _IONBF, 0);
+        debuglogstdio(LCF_FILEIO | LCF_RANDOM, "Open /dev/urandom stream");
+
+        cookie_io_functions_t funcs = {urandom_file_read, nullptr, nullptr, nullptr};
+        stream = fopencookie(nullptr, "r", funcs);
     }
     return stream;
 }
@@ -114,6 +129,9 @@ void urandom_disable_handler() {
 
     if (writefd != -1) {
         MYASSERT(fcntl(writefd, F_SETFL, O_NONBLOCK) != -1);
+
+        /* Store how many bytes of the stream are still in the pipe */
+        MYASSERT(ioctl(readfd, FIONREAD, &pipe_pending) != -1);
     }
 }
 
@@ -121,6 +139,16 @@ void urandom_enable_handler() {
     GlobalNative gn;
 
     if (writefd != -1) {
+        /* The pipe content is not part of the savestate, so we empty it and
+         * refill it from the stream position of its first unread byte. This
+         * gives the same content as when the handler was disabled. */
+        char buf[512];
+        while (read(readfd, buf, sizeof(buf)) > 0) {}
+
+        uint64_t pos = DeterministicEntropy::tell(DeterministicEntropy::STREAM_URANDOM_FD);
+        DeterministicEntropy::seek(DeterministicEntropy::STREAM_URANDOM_FD, pos - pipe_pending);
+        urandom_handler(0);
+
         MYASSERT(fcntl(writefd, F_SETFL, O_ASYNC | O_NONBLOCK) != -1);
     }
 }
@@ -25,6 +25,7 @@
 #include "FileHandleList.h"
 #include "URandom.h"
 #include "../GlobalState.h"
+#include "../VirtualTimers.h"
 #include "../inputs/jsdev.h"
 #include "../inputs/evdev.h"
 
@@ -364,6 +365,9 @@ int close (int fd)
         return 0;
     }
 
+    /* Delete the timer if this is a timerfd */
+    VirtualTimers::closeFd(fd);
+
     /* Check if we must actually close the file */
     bool doClose = FileHandleList::closeFile(fd);
 
@@ -44,6 +44,11 @@
 #include "xlib/xatom.h"
 #include "xlib/XlibEventQueueList.h"
 #include "BusyLoopDetection.h"
+#include "Watchpoints.h"
+#include "FrameProfiler.h"
+#include "VirtualTimers.h"
+#include "VirtualSignals.h"
+#include "TimeTrap.h"
 #include "audio/AudioContext.h"
 
 namespace libtas {
@@ -187,6 +192,8 @@ void frameBoundary(std::function<void()> draw)
     ThreadManager::setCheckpointThread();
     ThreadManager::setMainThread();
 
+    FrameProfiler::begin();
+
     /* Reset the busy loop detector */
     BusyLoopDetection::reset();
 
@@ -204,14 +211,20 @@ void frameBoundary(std::function<void()> draw)
         ThreadSync::detWait();
     }
 
+    FrameProfiler::mark(FrameProfile::INPUTS);
+
     /* Update the deterministic timer, sleep if necessary */
     TimeHolder timeIncrement = detTimer.enterFrameBoundary();
 
+    FrameProfiler::mark(FrameProfile::TIMER);
+
     /* Mix audio, except if the game opened a loopback context */
     if (! audiocontext.isLoopback) {
         audiocontext.mixAllSources(timeIncrement);
     }
 
+    FrameProfiler::mark(FrameProfile::AUDIO);
+
     /* If the game is exiting, dont process the frame boundary, just draw and exit */
     if (is_exiting) {
         detTimer.flushDelay();
@@ -262,6 +275,9 @@ void frameBoundary(std::function<void()> draw)
     ticks_val = ticks.tv_nsec;
     sendData(&ticks_val, sizeof(uint64_t));
 
+    /* Report low-level time sources used by the game */
+    TimeTrap::report();
+
     /* Send GameInfo struct if needed */
     if (game_info.tosend) {
         sendMessage(MSGB_GAMEINFO);
@@ -291,6 +307,12 @@ void frameBoundary(std::function<void()> draw)
         sendMessage(MSGB_NONDRAW_FRAME);
     }
 
+    /* Send accesses to watched addresses */
+    Watchpoints::sendHits();
+
+    /* Send time spent in the previous frame boundary */
+    FrameProfiler::send();
+
     /* Last message to send */
     sendMessage(MSGB_START_FRAMEBOUNDARY);
 
@@ -314,6 +336,16 @@ void frameBoundary(std::function<void()> draw)
 #endif
             break;
         }
+        case MSGN_WATCHPOINTS:
+        {
+            int count;
+            receiveData(&count, sizeof(int));
+            std::vector<Watchpoint> list(count);
+            for (int i = 0; i < count; i++)
+                receiveData(&list[i], sizeof(Watchpoint));
+            Watchpoints::set(list);
+            break;
+        }
         case MSGN_LUA_RESOLUTION:
         {
             int w, h;
@@ -369,6 +401,8 @@ void frameBoundary(std::function<void()> draw)
         message = receiveMessage();
     }
 
+    FrameProfiler::mark(FrameProfile::MESSAGES);
+
     /*** Rendering ***/
     if (!draw)
         nondraw_framecount++;
@@ -386,6 +420,8 @@ void frameBoundary(std::function<void()> draw)
         }
     }
 
+    FrameProfiler::mark(FrameProfile::CAPTURE);
+
 #ifdef LIBTAS_ENABLE_HUD
     if (!skipping_draw && shared_config.osd_encode) {
         AllInputs preview_ai;
@@ -394,6 +430,8 @@ void frameBoundary(std::function<void()> draw)
     }
 #endif
 
+    FrameProfiler::mark(FrameProfile::HUD);
+
     /* Audio mixing is done above, so encode must be called after */
     /* Dumping audio and video */
     if (shared_config.av_dumping) {
@@ -417,6 +455,8 @@ void frameBoundary(std::function<void()> draw)
         }
     }
 
+    FrameProfiler::mark(FrameProfile::ENCODE);
+
 #ifdef LIBTAS_ENABLE_HUD
     if (!skipping_draw && !shared_config.osd_encode) {
         AllInputs preview_ai;
@@ -425,12 +465,16 @@ void frameBoundary(std::function<void()> draw)
     }
 #endif
 
+    FrameProfiler::mark(FrameProfile::HUD);
+
     /* Actual draw command */
     if (!skipping_draw && draw) {
         GlobalNoLog gnl;
         NATIVECALL(draw());
     }
 
+    FrameProfiler::mark(FrameProfile::DRAW);
+
     /* Receive messages from the program */
     #ifdef LIBTAS_ENABLE_HUD
         receive_messages(draw, hud);
@@ -441,6 +485,8 @@ void frameBoundary(std::function<void()> draw)
     /* No more socket messages here, unlocking the socket. */
     unlockSocket();
 
+    FrameProfiler::mark(FrameProfile::MESSAGES);
+
     /* Some methods of drawing on screen don't always update the full screen.
      * Our current screen may be dirty with OSD, so in that case, we must
      * restore the screen to its original content so that the next frame will
@@ -452,6 +498,8 @@ void frameBoundary(std::function<void()> draw)
         ScreenCapture::restoreScreenState();
     }
 
+    FrameProfiler::mark(FrameProfile::CAPTURE);
+
     /*** Process inputs and events ***/
 
     /* This part may disappear entirely if we manage to completely emulate
@@ -513,6 +561,8 @@ void frameBoundary(std::function<void()> draw)
     if (shared_config.async_events & SharedConfig::ASYNC_SDLEVENTS_BEG)
         sdlEventQueue.waitForEmpty();
 
+    FrameProfiler::mark(FrameProfile::INPUTS);
+
     // ThreadSync::detSignalGlobal(0);
     // ThreadSync::detWaitGlobal(1);
 
@@ -522,6 +572,14 @@ void frameBoundary(std::function<void()> draw)
     skipping_draw = skipDraw(fps);
 
     detTimer.exitFrameBoundary();
+
+    FrameProfiler::mark(FrameProfile::TIMER);
+
+    /* Deliver the expirations of game timers */
+    VirtualTimers::update(true);
+
+    /* Deliver the signals that the game sent to other threads */
+    VirtualSignals::deliver();
 }
 
 static void pushQuitEvent(void)
@@ -692,7 +750,9 @@ static void receive_messages(std::function<void()> draw)
                 break;
 
             case MSGN_SAVESTATE:
+                Watchpoints::suspend();
                 status = SaveStateManager::checkpoint(slot);
+                Watchpoints::resume();
 
                 if (status == 0) {
                     /* Current savestate is now the parent savestate */
@@ -732,6 +792,9 @@ static void receive_messages(std::function<void()> draw)
                     ticks_val = ticks.tv_nsec;
                     sendData(&ticks_val, sizeof(uint64_t));
 
+                    /* Don't count the time between saving and loading */
+                    FrameProfiler::restart();
+
                     /* Screen should have changed after loading */
 #ifdef LIBTAS_ENABLE_HUD
                     screen_redraw(draw, hud, preview_ai);
@@ -766,7 +829,9 @@ static void receive_messages(std::function<void()> draw)
                 break;
 
             case MSGN_LOADSTATE:
+                Watchpoints::suspend();
                 status = SaveStateManager::restore(slot);
+                Watchpoints::resume();
 
                 SaveStateManager::printError(status);
 
@@ -786,6 +851,10 @@ static void receive_messages(std::function<void()> draw)
 
                 break;
 
+            case MSGN_RELEASESTATE:
+                SaveStateManager::release(slot);
+                break;
+
             case MSGN_STOP_ENCODE:
                 if (avencoder) {
                     debuglog(LCF_DUMP, "Stop AV dumping");
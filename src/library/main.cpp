@@ -40,6 +40,9 @@
 #include "steam/isteamuser.h" // SteamSetUserDataFolder
 #include "steam/isteamremotestorage/isteamremotestorage.h" // SteamSetRemoteStorageFolder
 #include "Stack.h"
+#include "LaunchTemplate.h"
+#include "TimeTrap.h"
+#include "GameHacks.h"
 
 
 extern char**environ;
@@ -77,6 +80,10 @@ void __attribute__((constructor)) init(void)
         }
     }
 
+    /* Wait here if we are a launch template. Everything after this is done
+     * in each game process forked from the template. */
+    LaunchTemplate::serve();
+
     ThreadManager::init();
     SaveStateManager::init();
     Stack::grow();
@@ -173,6 +180,12 @@ void __attribute__((constructor)) init(void)
     nonDetTimer.initialize();
     detTimer.initialize();
 
+    /* Intercept low-level time sources if enabled */
+    TimeTrap::init();
+
+    /* Detect the game engine from the files that are already there */
+    GameHacks::detectAtStartup();
+
     /* Initialize sound parameters */
     audiocontext.init();
 
@@ -23,6 +23,9 @@
 #include "checkpoint/ThreadManager.h"
 #include "checkpoint/ThreadSync.h"
 #include "DeterministicTimer.h"
+#include "VirtualWait.h"
+#include "VirtualSignals.h"
+#include "GameHacks.h"
 #include "tlswrappers.h"
 #include "backtrace.h"
 #include "hook.h"
@@ -43,6 +46,7 @@ DEFINE_ORIG_POINTER(pthread_detach)
 DEFINE_ORIG_POINTER(pthread_tryjoin_np)
 DEFINE_ORIG_POINTER(pthread_timedjoin_np)
 DEFINE_ORIG_POINTER(pthread_cond_init)
+DEFINE_ORIG_POINTER(pthread_cond_destroy)
 DEFINE_ORIG_POINTER(pthread_cond_wait)
 DEFINE_ORIG_POINTER(pthread_cond_timedwait)
 DEFINE_ORIG_POINTER(pthread_cond_signal)
@@ -252,6 +256,9 @@ static void *pthread_start(void *arg)
 
     ThreadSync::waitForThreadsToFinishInitialization();
 
+    /* The thread is about to block, deliver the signals it sent */
+    VirtualSignals::flush();
+
     debuglog(LCF_THREAD, "Joining thread id ", pthread_id, " tid " , ThreadManager::getThreadTid(pthread_id));
 
     ThreadInfo* thread = ThreadManager::getThread(pthread_id);
@@ -425,11 +432,6 @@ static void *pthread_start(void *arg)
     return ETIMEDOUT;
 }
 
-static std::map<pthread_cond_t*, clockid_t>& getCondClock() {
-    static std::map<pthread_cond_t*, clockid_t> condClocks;
-    return condClocks;
-}
-
 /* Override */ int pthread_cond_init (pthread_cond_t *cond, const pthread_condattr_t *cond_attr) throw()
 {
     LINK_NAMESPACE_VERSION(pthread_cond_init, "pthread", "GLIBC_2.3.2");
@@ -438,19 +440,30 @@ static std::map<pthread_cond_t*, clockid_t>& getCondClock() {
 
     debuglog(LCF_WAIT, __func__, " call with cond ", static_cast<void*>(cond));
 
-    /* Store the clock if one is set for `pthread_cond_timedwait()` */
-    if (cond_attr) {        
-        clockid_t clock_id;
+    /* Store the clock used by `pthread_cond_timedwait()`. A new condition
+     * variable may reuse the address of a destroyed one, so always update. */
+    clockid_t clock_id = CLOCK_REALTIME;
+    if (cond_attr) {
         LINK_NAMESPACE(pthread_condattr_getclock, "pthread");
         orig::pthread_condattr_getclock(cond_attr, &clock_id);
-        
-        std::map<pthread_cond_t*, clockid_t>& condClocks = getCondClock();
-        condClocks[cond] = clock_id;
     }
+    VirtualWait::setCondClock(cond, clock_id);
 
     return orig::pthread_cond_init(cond, cond_attr);
 }
 
+/* Override */ int pthread_cond_destroy (pthread_cond_t *cond) throw()
+{
+    LINK_NAMESPACE_VERSION(pthread_cond_destroy, "pthread", "GLIBC_2.3.2");
+    if (GlobalState::isNative())
+        return orig::pthread_cond_destroy(cond);
+
+    debuglog(LCF_WAIT, __func__, " call with cond ", static_cast<void*>(cond));
+
+    VirtualWait::removeCond(cond);
+    return orig::pthread_cond_destroy(cond);
+}
+
 /* Override */ int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex)
 {
     LINK_NAMESPACE_VERSION(pthread_cond_wait, "pthread", "GLIBC_2.3.2");
@@ -462,6 +475,10 @@ static std::map<pthread_cond_t*, clockid_t>& getCondClock() {
     }
 
     debuglog(LCF_WAIT | LCF_TODO, __func__, " call with cond ", static_cast<void*>(cond), " and mutex ", static_cast<void*>(mutex));
+
+    /* The thread is about to block, deliver the signals it sent */
+    VirtualSignals::flush();
+
     return orig::pthread_cond_wait(cond, mutex);
 }
 
@@ -473,74 +490,57 @@ static std::map<pthread_cond_t*, clockid_t>& getCondClock() {
 
     debuglog(LCF_WAIT | LCF_TODO, __func__, " call with cond ", static_cast<void*>(cond), " and mutex ", static_cast<void*>(mutex), " and timeout ", 1000*abstime->tv_sec + abstime->tv_nsec/1000000, " ms.");
 
-    /* Get clock_id of cond */
-    clockid_t clock_id = CLOCK_REALTIME;
-    const std::map<pthread_cond_t*, clockid_t>& condClocks = getCondClock();
-
-    auto it = condClocks.find(cond);
-    if (it != condClocks.end())
-        clock_id = it->second;
-
-    /* Convert the abstime variable because pthread_cond_timedwait() is using
-     * the real system time. */
-    struct timespec new_abstime = *abstime;
-    TimeHolder abs_timeout = *abstime;
-    TimeHolder real_time;
-    NATIVECALL(clock_gettime(clock_id, &real_time));
-    TimeHolder rel_timeout = abs_timeout - real_time;
-    /* We presume that the game won't call pthread_cond_timedwait() with
-     * a negative time, or more than 10 seconds.
-     */
-    if ((rel_timeout.tv_sec < -1) || (rel_timeout.tv_sec > 10)) {
-        /* Change the reference time to real system time */
-        TimeHolder fake_time = detTimer.getTicks();
-        TimeHolder new_rel_timeout = abs_timeout - fake_time;
-        TimeHolder new_abs_timeout = real_time + new_rel_timeout;
-        new_abstime = new_abs_timeout;
-        debuglog(LCF_WAIT, " Rel time was ", 1000*new_rel_timeout.tv_sec + new_rel_timeout.tv_nsec/1000000, " ms.");
-        debuglog(LCF_WAIT, " New abs time is ", new_abstime.tv_sec, ".", new_abstime.tv_nsec/1000000, " s");
-    }
+    VirtualSignals::flush();
 
-    /* If not main thread, do not change the behavior */
-    if (!ThreadManager::isMainThread())
-        return orig::pthread_cond_timedwait(cond, mutex, &new_abstime);
+    clockid_t clock_id = VirtualWait::getCondClock(cond);
+    TimeHolder deadline = VirtualWait::toDeterministic(clock_id, abstime);
 
-    if (shared_config.wait_timeout == SharedConfig::WAIT_NATIVE)
+    /* If not main thread, do not change the behavior */
+    if (!ThreadManager::isMainThread() || (GameHacks::waitTimeout() == SharedConfig::WAIT_NATIVE)) {
+        TimeHolder new_abstime = VirtualWait::toReal(clock_id, deadline);
         return orig::pthread_cond_timedwait(cond, mutex, &new_abstime);
+    }
 
-    if (shared_config.wait_timeout == SharedConfig::WAIT_FINITE) {
-        /* Wait for 0.1 sec, arbitrary */
-        TimeHolder delta_time;
-        delta_time.tv_sec = 0;
-        delta_time.tv_nsec = 100*1000*1000;
-        TimeHolder new_end_time = real_time + delta_time;
-        int ret = orig::pthread_cond_timedwait(cond, mutex, &new_end_time);
-        if (ret == 0)
-            return ret;
+    if (GameHacks::waitTimeout() == SharedConfig::WAIT_FINITE) {
+        /* Wait in deterministic time, by slices of at most one frame, until
+         * the condition is signaled or the deadline is reached. */
+        VirtualWait::beginCondWait(cond);
+        int ret = ETIMEDOUT;
+        TimeHolder real_end, slice;
+        while (VirtualWait::nextSlice(clock_id, deadline, real_end, slice)) {
+            ret = orig::pthread_cond_timedwait(cond, mutex, &real_end);
+            if (ret != ETIMEDOUT)
+                break;
+
+            /* Release the mutex while advancing time, because it may
+             * trigger a frame boundary. */
+            pthread_mutex_unlock(mutex);
+            VirtualWait::advance(slice);
+            pthread_mutex_lock(mutex);
+
+            if (VirtualWait::isNotified()) {
+                ret = 0;
+                break;
+            }
+            ret = ETIMEDOUT;
+        }
+        VirtualWait::endCondWait();
+        return ret;
     }
 
-    if ((shared_config.wait_timeout == SharedConfig::WAIT_FULL_INFINITE) ||
-        (shared_config.wait_timeout == SharedConfig::WAIT_FINITE) ||
-        (shared_config.wait_timeout == SharedConfig::WAIT_FULL))
+    if ((GameHacks::waitTimeout() == SharedConfig::WAIT_FULL_INFINITE) ||
+        (GameHacks::waitTimeout() == SharedConfig::WAIT_FULL))
         {
         /* Transfer time to our deterministic timer */
         TimeHolder now = detTimer.getTicks();
-        TimeHolder delay = abs_timeout - now;
+        TimeHolder delay = deadline - now;
         detTimer.addDelay(delay);
     }
 
-    if (shared_config.wait_timeout == SharedConfig::WAIT_FINITE) {
-        /* Wait again for 0.1 sec, arbitrary */
-        NATIVECALL(clock_gettime(CLOCK_MONOTONIC, &real_time));
-        TimeHolder delta_time;
-        delta_time.tv_sec = 0;
-        delta_time.tv_nsec = 100*1000*1000;
-        TimeHolder new_end_time = real_time + delta_time;
-        return orig::pthread_cond_timedwait(cond, mutex, &new_end_time);
-    }
-
-    if ((shared_config.wait_timeout == SharedConfig::NO_WAIT) ||
-        (shared_config.wait_timeout == SharedConfig::WAIT_FULL)) {
+    if ((GameHacks::waitTimeout() == SharedConfig::NO_WAIT) ||
+        (GameHacks::waitTimeout() == SharedConfig::WAIT_FULL)) {
+        TimeHolder real_time;
+        NATIVECALL(clock_gettime(clock_id, &real_time));
         return orig::pthread_cond_timedwait(cond, mutex, &real_time);
     }
 
@@ -556,6 +556,7 @@ static std::map<pthread_cond_t*, clockid_t>& getCondClock() {
         return orig::pthread_cond_signal(cond);
 
     debuglog(LCF_WAIT | LCF_TODO, __func__, " call with cond ", static_cast<void*>(cond));
+    VirtualWait::notify(cond);
     return orig::pthread_cond_signal(cond);
 }
 
@@ -566,6 +567,7 @@ static std::map<pthread_cond_t*, clockid_t>& getCondClock() {
         return orig::pthread_cond_broadcast(cond);
 
     debuglog(LCF_WAIT | LCF_TODO, __func__, " call with cond ", static_cast<void*>(cond));
+    VirtualWait::notify(cond);
     return orig::pthread_cond_broadcast(cond);
 }
 
@@ -597,15 +599,19 @@ static std::map<pthread_cond_t*, clockid_t>& getCondClock() {
     return orig::pthread_testcancel();
 }
 
-// /* Override */ int sem_wait (sem_t *sem)
-// {
-//     LINK_NAMESPACE(sem_wait, "pthread");
-//     if (GlobalState::isNative())
-//         return orig::sem_wait(sem);
-//
-//     debuglogstdio(LCF_THREAD | LCF_WAIT, "sem_wait call with %p", sem);
-//     return orig::sem_wait(sem);
-// }
+/* Override */ int sem_wait (sem_t *sem)
+{
+    LINK_NAMESPACE(sem_wait, "pthread");
+    if (GlobalState::isNative())
+        return orig::sem_wait(sem);
+
+    debuglogstdio(LCF_THREAD | LCF_WAIT, "sem_wait call with %p", sem);
+
+    /* The thread may wait for an acknowledgement of the signals it sent */
+    VirtualSignals::flush();
+
+    return orig::sem_wait(sem);
+}
 
 /* Override */ int sem_timedwait (sem_t * sem, const struct timespec *abstime)
 {
@@ -615,27 +621,33 @@ static std::map<pthread_cond_t*, clockid_t>& getCondClock() {
 
     debuglog(LCF_WAIT | LCF_TODO, __func__, " call with sem ", static_cast<void*>(sem), " and timeout ", 1000*abstime->tv_sec + abstime->tv_nsec/1000000, " ms.");
 
-    /* Convert the abstime variable because sem_timedwait() is using
-     * the real system time. */
-    struct timespec new_abstime = *abstime;
-    TimeHolder abs_timeout = *abstime;
-    TimeHolder real_time;
-    NATIVECALL(clock_gettime(CLOCK_REALTIME, &real_time));
-    TimeHolder rel_timeout = abs_timeout - real_time;
-    /* We presume that the game won't call sem_timedwait() with
-     * a negative time, or more than 10 seconds.
-     */
-    if ((rel_timeout.tv_sec < -1) || (rel_timeout.tv_sec > 10)) {
-        /* Change the reference time to real system time */
-        TimeHolder fake_time = detTimer.getTicks();
-        TimeHolder new_rel_timeout = abs_timeout - fake_time;
-        TimeHolder new_abs_timeout = real_time + new_rel_timeout;
-        new_abstime = new_abs_timeout;
-        debuglog(LCF_WAIT, " Rel time was ", 1000*new_rel_timeout.tv_sec + new_rel_timeout.tv_nsec/1000000, " ms.");
-        debuglog(LCF_WAIT, " New abs time is ", new_abstime.tv_sec, ".", new_abstime.tv_nsec/1000000, " s");
+    VirtualSignals::flush();
+
+    TimeHolder deadline = VirtualWait::toDeterministic(CLOCK_REALTIME, abstime);
+
+    if (!ThreadManager::isMainThread() || (GameHacks::waitTimeout() != SharedConfig::WAIT_FINITE)) {
+        TimeHolder new_abstime = VirtualWait::toReal(CLOCK_REALTIME, deadline);
+        return orig::sem_timedwait(sem, &new_abstime);
+    }
+
+    /* Same as `pthread_cond_timedwait()`. A post is never lost between two
+     * slices, because it is stored in the semaphore value. */
+    TimeHolder real_end, slice;
+    while (VirtualWait::nextSlice(CLOCK_REALTIME, deadline, real_end, slice)) {
+        int ret = orig::sem_timedwait(sem, &real_end);
+        if ((ret == 0) || (errno != ETIMEDOUT))
+            return ret;
+
+        VirtualWait::advance(slice);
     }
 
-    return orig::sem_timedwait(sem, &new_abstime);
+    /* Deadline reached, the semaphore may still have been posted */
+    LINK_NAMESPACE(sem_trywait, "pthread");
+    if (orig::sem_trywait(sem) == 0)
+        return 0;
+
+    errno = ETIMEDOUT;
+    return -1;
 }
 
 /* Override */ int sem_trywait (sem_t *sem) throw()
@@ -684,6 +696,8 @@ int pthread_setname_np (pthread_t target_thread, const char *name) throw()
         GlobalState::setNoLog(true);
     }
 
+    GameHacks::checkLoaderThread(target_thread, name);
+
     if (shared_config.game_specific_sync & SharedConfig::GC_SYNC_CELESTE) {
         if ((strcmp(name, "OVERWORLD_LOADE") == 0) ||
             (strcmp(name, "LEVEL_LOADER") == 0) ||
@@ -67,6 +67,9 @@ OVERRIDE int pthread_timedjoin_np(pthread_t thread, void **retval, const struct
    the default values if later is NULL.  */
 OVERRIDE int pthread_cond_init (pthread_cond_t *cond, const pthread_condattr_t *cond_attr) throw();
 
+/* Destroy condition variable COND.  */
+OVERRIDE int pthread_cond_destroy (pthread_cond_t *cond) throw();
+
 /* Wake up one thread waiting for condition variable COND.  */
 OVERRIDE int pthread_cond_signal (pthread_cond_t *cond) throw();
 
@@ -109,7 +112,7 @@ OVERRIDE void pthread_testcancel (void);
 
    This function is a cancellation point and therefore not marked with
    __THROW.  */
-// OVERRIDE int sem_wait (sem_t *sem);
+OVERRIDE int sem_wait (sem_t *sem);
 
 /* Similar to `sem_wait' but wait only until ABSTIME.
 
@@ -20,6 +20,8 @@
 #include "randomwrappers.h"
 #include "logging.h"
 #include "hook.h"
+#include "DeterministicEntropy.h"
+#include <errno.h>
 
 namespace libtas {
 
@@ -52,6 +54,11 @@ DEFINE_ORIG_POINTER(jrand48_r)
 DEFINE_ORIG_POINTER(srand48_r)
 DEFINE_ORIG_POINTER(seed48_r)
 DEFINE_ORIG_POINTER(lcong48_r)
+DEFINE_ORIG_POINTER(getrandom)
+DEFINE_ORIG_POINTER(getentropy)
+DEFINE_ORIG_POINTER(arc4random)
+DEFINE_ORIG_POINTER(arc4random_buf)
+DEFINE_ORIG_POINTER(arc4random_uniform)
 
 /* Override */ long int random (void) throw()
 {
@@ -268,4 +275,81 @@ DEFINE_ORIG_POINTER(lcong48_r)
     return orig::lcong48_r(param, buffer);
 }
 
+/* Override */ ssize_t getrandom (void *buffer, size_t length, unsigned int flags)
+{
+    if (GlobalState::isNative()) {
+        LINK_NAMESPACE_GLOBAL(getrandom);
+        return orig::getrandom(buffer, length, flags);
+    }
+
+    debuglog(LCF_RANDOM, __func__, " call with length ", length);
+
+    /* The GRND_RANDOM and GRND_NONBLOCK flags are meaningless here: our
+     * entropy source never blocks. */
+    DeterministicEntropy::getBytes(DeterministicEntropy::STREAM_GETRANDOM, buffer, length);
+    return length;
+}
+
+/* Override */ int getentropy (void *buffer, size_t length)
+{
+    if (GlobalState::isNative()) {
+        LINK_NAMESPACE_GLOBAL(getentropy);
+        return orig::getentropy(buffer, length);
+    }
+
+    debuglog(LCF_RANDOM, __func__, " call with length ", length);
+
+    if (length > 256) {
+        errno = EIO;
+        return -1;
+    }
+
+    DeterministicEntropy::getBytes(DeterministicEntropy::STREAM_GETRANDOM, buffer, length);
+    return 0;
+}
+
+/* Override */ uint32_t arc4random (void) throw()
+{
+    if (GlobalState::isNative()) {
+        LINK_NAMESPACE_GLOBAL(arc4random);
+        return orig::arc4random();
+    }
+
+    DEBUGLOGCALL(LCF_RANDOM);
+    return DeterministicEntropy::getUInt32(DeterministicEntropy::STREAM_GETRANDOM);
+}
+
+/* Override */ void arc4random_buf (void *buf, size_t size) throw()
+{
+    if (GlobalState::isNative()) {
+        LINK_NAMESPACE_GLOBAL(arc4random_buf);
+        return orig::arc4random_buf(buf, size);
+    }
+
+    debuglog(LCF_RANDOM, __func__, " call with size ", size);
+    DeterministicEntropy::getBytes(DeterministicEntropy::STREAM_GETRANDOM, buf, size);
+}
+
+/* Override */ uint32_t arc4random_uniform (uint32_t upper_bound) throw()
+{
+    if (GlobalState::isNative()) {
+        LINK_NAMESPACE_GLOBAL(arc4random_uniform);
+        return orig::arc4random_uniform(upper_bound);
+    }
+
+    DEBUGLOGCALL(LCF_RANDOM);
+
+    if (upper_bound < 2)
+        return 0;
+
+    /* Reject values below 2**32 % upper_bound to avoid modulo bias */
+    uint32_t min = -upper_bound % upper_bound;
+    uint32_t r;
+    do {
+        r = DeterministicEntropy::getUInt32(DeterministicEntropy::STREAM_GETRANDOM);
+    } while (r < min);
+
+    return r % upper_bound;
+}
+
 }
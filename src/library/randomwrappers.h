@@ -23,6 +23,7 @@
 #include "global.h"
 #include <cstdint>
 #include <cstddef>
+#include <sys/types.h>
 
 namespace libtas {
 
@@ -131,6 +132,24 @@ OVERRIDE int seed48_r (unsigned short int seed16v[3],
 OVERRIDE int lcong48_r (unsigned short int param[7],
               struct drand48_data *buffer) throw();
 
+/* Write LENGTH bytes of randomness starting at BUFFER.  Return the
+   number of bytes written, or -1 on error.  */
+OVERRIDE ssize_t getrandom (void *buffer, size_t length, unsigned int flags);
+
+/* Write LENGTH bytes of randomness starting at BUFFER.  Return 0 on
+   success or -1 on error.  */
+OVERRIDE int getentropy (void *buffer, size_t length);
+
+/* Return a random 32-bit number.  */
+OVERRIDE uint32_t arc4random (void) throw();
+
+/* Fill the buffer with random data.  */
+OVERRIDE void arc4random_buf (void *buf, size_t size) throw();
+
+/* Return a random number between zero (inclusive) and the specified
+   limit (exclusive).  */
+OVERRIDE uint32_t arc4random_uniform (uint32_t upper_bound) throw();
+
 }
 
 #endif
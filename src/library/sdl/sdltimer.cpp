@@ -21,6 +21,8 @@
 #include "../logging.h"
 #include "../DeterministicTimer.h"
 #include "../hook.h"
+#include "../GlobalState.h"
+#include "../VirtualTimers.h"
 
 namespace libtas {
 
@@ -29,16 +31,40 @@ DECLARE_ORIG_POINTER(SDL_RemoveTimer)
 
 /* Override */ SDL_TimerID SDL_AddTimer(Uint32 interval, SDL_NewTimerCallback callback, void *param)
 {
-    debuglog(LCF_TIMERS | LCF_SDL | LCF_TODO, "Add SDL Timer with call after ", interval, " ms");
-    LINK_NAMESPACE_SDLX(SDL_AddTimer);
-    return orig::SDL_AddTimer(interval, callback, param);
+    debuglog(LCF_TIMERS | LCF_SDL, "Add SDL Timer with call after ", interval, " ms");
+    if (GlobalState::isNative()) {
+        LINK_NAMESPACE_SDLX(SDL_AddTimer);
+        return orig::SDL_AddTimer(interval, callback, param);
+    }
+
+    /* The timer is driven by our deterministic timer, and the callback is
+     * executed in a dedicated thread like SDL does */
+    int id = VirtualTimers::create(VirtualTimers::NOTIFY_SDL);
+    if (id < 0)
+        return 0;
+
+    VirtualTimers::setSDL(id, callback, param);
+    struct timespec ts;
+    ts.tv_sec = interval / 1000;
+    ts.tv_nsec = (interval % 1000) * 1000000;
+    struct timespec value = ts;
+    if (interval == 0)
+        value.tv_nsec = 1;
+    VirtualTimers::set(id, value, ts, false);
+
+    return id;
 }
 
 /* Override */ SDL_bool SDL_RemoveTimer(SDL_TimerID id)
 {
-    debuglog(LCF_TIMERS | LCF_SDL | LCF_TODO, "Remove SDL Timer.");
-    LINK_NAMESPACE_SDLX(SDL_RemoveTimer);
-    return orig::SDL_RemoveTimer(id);
+    debuglog(LCF_TIMERS | LCF_SDL, "Remove SDL Timer.");
+    if (GlobalState::isNative()) {
+        LINK_NAMESPACE_SDLX(SDL_RemoveTimer);
+        return orig::SDL_RemoveTimer(id);
+    }
+
+    /* The id may belong to a timer of another kind */
+    return VirtualTimers::remove(id, VirtualTimers::NOTIFY_SDL) ? SDL_TRUE : SDL_FALSE;
 }
 
 }
@@ -23,9 +23,13 @@
 #include "hook.h"
 #include "checkpoint/ThreadSync.h"
 #include "checkpoint/SaveStateManager.h" // checkpoint signals
+#include "TimeTrap.h"
+#include "VirtualSignals.h"
+#include "checkpoint/ThreadManager.h"
 
 #include <cstring>
 #include <csignal>
+#include <unistd.h>
 
 namespace libtas {
 
@@ -44,6 +48,8 @@ DEFINE_ORIG_POINTER(sigaltstack)
 DEFINE_ORIG_POINTER(pthread_sigmask)
 DEFINE_ORIG_POINTER(pthread_kill)
 DEFINE_ORIG_POINTER(pthread_sigqueue)
+DEFINE_ORIG_POINTER(kill)
+DEFINE_ORIG_POINTER(sigqueue)
 
 static int origUsrMaskProcess = 0;
 static thread_local int origUsrMaskThread = 0;
@@ -62,11 +68,27 @@ static thread_local int origUsrMaskThread = 0;
         " for signal ", strsignal(sig));
 
     if ((sig == SaveStateManager::sigSuspend()) || (sig == SaveStateManager::sigCheckpoint())) {
+        ThreadSync::wrapperExecutionLockUnlock();
         return SIG_IGN;
     }
 
+    /* Keep our SIGSEGV handler used for rdtsc emulation, and call the game
+     * handler from it */
+    if ((sig == SIGSEGV) && TimeTrap::handlesSegv()) {
+        struct sigaction act, oact;
+        memset(&act, 0, sizeof(struct sigaction));
+        act.sa_handler = handler;
+        TimeTrap::setGameSegvHandler(&act, &oact);
+        ThreadSync::wrapperExecutionLockUnlock();
+        return oact.sa_handler;
+    }
+
     sighandler_t ret = orig::signal(sig, handler);
 
+    /* Handlers are not stored in savestates, keep a copy */
+    if (ret != SIG_ERR)
+        VirtualSignals::setHandler(sig);
+
     ThreadSync::wrapperExecutionLockUnlock();
 
     return ret;
@@ -171,6 +193,12 @@ static thread_local int origUsrMaskThread = 0;
     DEBUGLOGCALL(LCF_SIGNAL | LCF_TODO);
     LINK_NAMESPACE_GLOBAL(sigsuspend);
 
+    if (!GlobalState::isNative()) {
+        /* The thread is waiting for a signal, deliver the ones we queued */
+        VirtualSignals::flush();
+        VirtualSignals::deliverToCurrentThread();
+    }
+
     sigset_t tmp;
     if (set) {
         tmp = *set;
@@ -211,7 +239,25 @@ static thread_local int origUsrMaskThread = 0;
             " for signal ", sig, " (", strsignal(sig), ")");
     }
 
-    int ret = orig::sigaction(sig, act, oact);
+    int ret;
+    if ((sig == SIGSEGV) && TimeTrap::handlesSegv()) {
+        /* Keep our SIGSEGV handler used for rdtsc emulation, and call the
+         * game handler from it */
+        TimeTrap::setGameSegvHandler(act, oact);
+        ret = 0;
+    }
+    else if (sig == SaveStateManager::sigCheckpoint()) {
+        /* Don't let the game replace our checkpoint handler, which also
+         * handles raw time syscalls */
+        ret = orig::sigaction(sig, nullptr, oact);
+    }
+    else {
+        ret = orig::sigaction(sig, act, oact);
+
+        /* Handlers are not stored in savestates, keep a copy */
+        if ((ret == 0) && act)
+            VirtualSignals::setHandler(sig);
+    }
 
     ThreadSync::wrapperExecutionLockUnlock();
 
@@ -220,22 +266,53 @@ static thread_local int origUsrMaskThread = 0;
 
 /* Override */ int sigpending (sigset_t *set) throw()
 {
-    DEBUGLOGCALL(LCF_SIGNAL | LCF_TODO);
+    DEBUGLOGCALL(LCF_SIGNAL);
     LINK_NAMESPACE_GLOBAL(sigpending);
-    return orig::sigpending(set);
+
+    int ret = orig::sigpending(set);
+
+    /* Add the signals that we queued */
+    if ((ret == 0) && !GlobalState::isNative())
+        VirtualSignals::addPending(set);
+
+    return ret;
 }
 
 /* Override */ int sigwait (const sigset_t *set, int *sig)
 {
-    DEBUGLOGCALL(LCF_SIGNAL | LCF_TODO);
+    DEBUGLOGCALL(LCF_SIGNAL);
     LINK_NAMESPACE_GLOBAL(sigwait);
+
+    if (!GlobalState::isNative()) {
+        /* Return a signal that we queued first */
+        siginfo_t info;
+        if (VirtualSignals::take(set, &info)) {
+            if (sig)
+                *sig = info.si_signo;
+            return 0;
+        }
+        VirtualSignals::flush();
+    }
+
     return orig::sigwait(set, sig);
 }
 
 /* Override */ int sigwaitinfo (const sigset_t *set, siginfo_t *info)
 {
-    DEBUGLOGCALL(LCF_SIGNAL | LCF_TODO);
+    DEBUGLOGCALL(LCF_SIGNAL);
     LINK_NAMESPACE_GLOBAL(sigwaitinfo);
+
+    if (!GlobalState::isNative()) {
+        /* Return a signal that we queued first */
+        siginfo_t queued_info;
+        if (VirtualSignals::take(set, &queued_info)) {
+            if (info)
+                *info = queued_info;
+            return queued_info.si_signo;
+        }
+        VirtualSignals::flush();
+    }
+
     return orig::sigwaitinfo(set, info);
 }
 
@@ -244,6 +321,18 @@ static thread_local int origUsrMaskThread = 0;
 {
     DEBUGLOGCALL(LCF_SIGNAL | LCF_TODO);
     LINK_NAMESPACE_GLOBAL(sigtimedwait);
+
+    if (!GlobalState::isNative()) {
+        /* Return a signal that we queued first */
+        siginfo_t queued_info;
+        if (VirtualSignals::take(set, &queued_info)) {
+            if (info)
+                *info = queued_info;
+            return queued_info.si_signo;
+        }
+        VirtualSignals::flush();
+    }
+
     return orig::sigtimedwait(set, info, timeout);
 }
 
@@ -264,8 +353,15 @@ static thread_local int origUsrMaskThread = 0;
         debuglog(LCF_SIGNAL, "    Getting altstack with base address ", oss->ss_sp, " and size ", oss->ss_size);
     }
 
+    /* Register again the altstack if we just loaded a state */
+    VirtualSignals::flush();
+
     int ret = orig::sigaltstack(ss, oss);
 
+    /* Altstacks are not stored in savestates, keep a copy */
+    if ((ret == 0) && ss)
+        VirtualSignals::setAltStack(ss);
+
     return ret;
 }
 
@@ -355,6 +451,25 @@ static thread_local int origUsrMaskThread = 0;
      */
     ThreadSync::wrapperExecutionLockLock();
 
+    /* Signals to other threads are delivered at deterministic points */
+    if ((signo != 0) && !pthread_equal(threadid, pthread_self()) &&
+        (signo != SaveStateManager::sigSuspend()) &&
+        (signo != SaveStateManager::sigCheckpoint())) {
+        pid_t tid = ThreadManager::getThreadTid(threadid);
+        if (tid) {
+            siginfo_t si;
+            memset(&si, 0, sizeof(si));
+            si.si_signo = signo;
+            si.si_code = SI_TKILL;
+            si.si_pid = getpid();
+            si.si_uid = getuid();
+            if (VirtualSignals::queue(tid, &si)) {
+                ThreadSync::wrapperExecutionLockUnlock();
+                return 0;
+            }
+        }
+    }
+
     int ret = orig::pthread_kill(threadid, signo);
 
     ThreadSync::wrapperExecutionLockUnlock();
@@ -367,7 +482,90 @@ static thread_local int origUsrMaskThread = 0;
 {
     DEBUGLOGCALL(LCF_SIGNAL | LCF_THREAD);
     LINK_NAMESPACE_GLOBAL(pthread_sigqueue);
-    return orig::pthread_sigqueue(threadid, signo, value);
+
+    if (GlobalState::isNative())
+        return orig::pthread_sigqueue(threadid, signo, value);
+
+    ThreadSync::wrapperExecutionLockLock();
+
+    /* Signals to other threads are delivered at deterministic points */
+    if ((signo != 0) && !pthread_equal(threadid, pthread_self()) &&
+        (signo != SaveStateManager::sigSuspend()) &&
+        (signo != SaveStateManager::sigCheckpoint())) {
+        pid_t tid = ThreadManager::getThreadTid(threadid);
+        if (tid) {
+            siginfo_t si;
+            memset(&si, 0, sizeof(si));
+            si.si_signo = signo;
+            si.si_code = SI_QUEUE;
+            si.si_pid = getpid();
+            si.si_uid = getuid();
+            si.si_value = value;
+            if (VirtualSignals::queue(tid, &si)) {
+                ThreadSync::wrapperExecutionLockUnlock();
+                return 0;
+            }
+        }
+    }
+
+    int ret = orig::pthread_sigqueue(threadid, signo, value);
+
+    ThreadSync::wrapperExecutionLockUnlock();
+
+    return ret;
+}
+
+/* Override */ int kill (pid_t pid, int sig) throw()
+{
+    LINK_NAMESPACE_GLOBAL(kill);
+
+    if (GlobalState::isNative())
+        return orig::kill(pid, sig);
+
+    debuglog(LCF_SIGNAL, __func__, " called with pid ", pid, " and sig ", sig);
+
+    /* Signals sent to our own process by a secondary thread are handled by
+     * the main thread at the frame boundary. Signals to the process group
+     * (pid 0) also reach other processes, such as the libTAS program, so
+     * they are sent right away. */
+    if ((sig != 0) && (pid == getpid()) && !ThreadManager::isMainThread()) {
+        siginfo_t si;
+        memset(&si, 0, sizeof(si));
+        si.si_signo = sig;
+        si.si_code = SI_USER;
+        si.si_pid = getpid();
+        si.si_uid = getuid();
+        if (VirtualSignals::queue(0, &si))
+            return 0;
+    }
+
+    return orig::kill(pid, sig);
+}
+
+/* Override */ int sigqueue (pid_t pid, int sig, const union sigval val) throw()
+{
+    LINK_NAMESPACE_GLOBAL(sigqueue);
+
+    if (GlobalState::isNative())
+        return orig::sigqueue(pid, sig, val);
+
+    debuglog(LCF_SIGNAL, __func__, " called with pid ", pid, " and sig ", sig);
+
+    /* Signals sent to our own process by a secondary thread are handled by
+     * the main thread at the frame boundary. */
+    if ((sig != 0) && (pid == getpid()) && !ThreadManager::isMainThread()) {
+        siginfo_t si;
+        memset(&si, 0, sizeof(si));
+        si.si_signo = sig;
+        si.si_code = SI_QUEUE;
+        si.si_pid = getpid();
+        si.si_uid = getuid();
+        si.si_value = val;
+        if (VirtualSignals::queue(0, &si))
+            return 0;
+    }
+
+    return orig::sigqueue(pid, sig, val);
 }
 
 }
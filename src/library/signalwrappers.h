@@ -92,6 +92,14 @@ OVERRIDE int sigaltstack (const stack_t *ss, stack_t *oss) throw();
 OVERRIDE int pthread_sigmask (int how, const sigset_t *newmask,
                 sigset_t *oldmask) throw();
 
+/* Send signal SIG to process number PID.  If PID is zero,
+   send SIG to all processes in the current process's process group. */
+OVERRIDE int kill (pid_t pid, int sig) throw();
+
+/* Send signal SIG to the process PID.  Associate data in VAL with the
+   signal.  */
+OVERRIDE int sigqueue (pid_t pid, int sig, const union sigval val) throw();
+
 /* Send signal SIGNO to the given thread. */
 OVERRIDE int pthread_kill (pthread_t threadid, int signo) throw();
 
@@ -27,6 +27,7 @@
 #include "GlobalState.h"
 #include "hook.h"
 #include "GameHacks.h"
+#include "VirtualSignals.h"
 #include <execinfo.h>
 
 namespace libtas {
@@ -118,8 +119,7 @@ DEFINE_ORIG_POINTER(sched_yield)
      */
     if (mainT && (requested_time->tv_sec || requested_time->tv_nsec)) {
 
-        if (GameHacks::isUnity() &&
-            (requested_time->tv_sec == 0) && (requested_time->tv_nsec == 9999000)) {
+        if (GameHacks::isPassthroughSleep(*requested_time)) {
             /* Don't add to the timer, because it is sleep for loading threads */
         }
         else {
@@ -130,6 +130,9 @@ DEFINE_ORIG_POINTER(sched_yield)
         return 0;
     }
 
+    /* The thread is about to block, deliver the signals it sent */
+    VirtualSignals::flush();
+
     return orig::nanosleep(requested_time, remaining);
 }
 
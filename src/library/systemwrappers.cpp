@@ -22,12 +22,17 @@
 #include "GlobalState.h"
 #include "../shared/SharedConfig.h"
 #include "backtrace.h"
+#include "TimeTrap.h"
 #include <execinfo.h>
 
 namespace libtas {
 
 DEFINE_ORIG_POINTER(getpid)
 DEFINE_ORIG_POINTER(fork)
+DEFINE_ORIG_POINTER(popen)
+DEFINE_ORIG_POINTER(system)
+DEFINE_ORIG_POINTER(posix_spawn)
+DEFINE_ORIG_POINTER(posix_spawnp)
 
 /* Override */ pid_t getpid (void) throw()
 {
@@ -82,4 +87,91 @@ DEFINE_ORIG_POINTER(fork)
     return pid;
 }
 
+/* The following functions spawn a process from a thread without our seccomp
+ * filter, which would kill the child process on its first time syscall.
+ * This is also done for our own calls, like the ffmpeg pipe. */
+
+struct SpawnArgs {
+    const char *path;
+    const posix_spawn_file_actions_t *file_actions;
+    const posix_spawnattr_t *attrp;
+    char *const *argv;
+    char *const *envp;
+    pid_t *pid;
+    const char *modes;
+    FILE *stream;
+    int ret;
+};
+
+static void popenUntrapped(void* arg)
+{
+    SpawnArgs* sa = static_cast<SpawnArgs*>(arg);
+    sa->stream = orig::popen(sa->path, sa->modes);
+}
+
+/* Override */ FILE *popen (const char *command, const char *modes)
+{
+    LINK_NAMESPACE_GLOBAL(popen);
+    DEBUGLOGCALL(LCF_SYSTEM);
+
+    SpawnArgs sa;
+    sa.path = command;
+    sa.modes = modes;
+    TimeTrap::runUntrapped(popenUntrapped, &sa);
+    return sa.stream;
+}
+
+static void systemUntrapped(void* arg)
+{
+    SpawnArgs* sa = static_cast<SpawnArgs*>(arg);
+    sa->ret = orig::system(sa->path);
+}
+
+/* Override */ int system (const char *line)
+{
+    LINK_NAMESPACE_GLOBAL(system);
+    DEBUGLOGCALL(LCF_SYSTEM);
+
+    SpawnArgs sa;
+    sa.path = line;
+    TimeTrap::runUntrapped(systemUntrapped, &sa);
+    return sa.ret;
+}
+
+static void posixSpawnUntrapped(void* arg)
+{
+    SpawnArgs* sa = static_cast<SpawnArgs*>(arg);
+    sa->ret = orig::posix_spawn(sa->pid, sa->path, sa->file_actions, sa->attrp, sa->argv, sa->envp);
+}
+
+/* Override */ int posix_spawn (pid_t *pid, const char *path,
+    const posix_spawn_file_actions_t *file_actions,
+    const posix_spawnattr_t *attrp, char *const argv[], char *const envp[])
+{
+    LINK_NAMESPACE_GLOBAL(posix_spawn);
+    DEBUGLOGCALL(LCF_SYSTEM);
+
+    SpawnArgs sa = {path, file_actions, attrp, argv, envp, pid, nullptr, nullptr, 0};
+    TimeTrap::runUntrapped(posixSpawnUntrapped, &sa);
+    return sa.ret;
+}
+
+static void posixSpawnpUntrapped(void* arg)
+{
+    SpawnArgs* sa = static_cast<SpawnArgs*>(arg);
+    sa->ret = orig::posix_spawnp(sa->pid, sa->path, sa->file_actions, sa->attrp, sa->argv, sa->envp);
+}
+
+/* Override */ int posix_spawnp (pid_t *pid, const char *file,
+    const posix_spawn_file_actions_t *file_actions,
+    const posix_spawnattr_t *attrp, char *const argv[], char *const envp[])
+{
+    LINK_NAMESPACE_GLOBAL(posix_spawnp);
+    DEBUGLOGCALL(LCF_SYSTEM);
+
+    SpawnArgs sa = {file, file_actions, attrp, argv, envp, pid, nullptr, nullptr, 0};
+    TimeTrap::runUntrapped(posixSpawnpUntrapped, &sa);
+    return sa.ret;
+}
+
 }
@@ -21,6 +21,8 @@
 #define LIBTAS_SYSTEM_H_INCL
 
 #include <unistd.h>
+#include <cstdio>
+#include <spawn.h>
 #include "hook.h"
 #include "global.h"
 
@@ -34,6 +36,23 @@ OVERRIDE pid_t getpid (void) __THROWNL;
    and the process ID of the new process to the old process.  */
 OVERRIDE pid_t fork(void) __THROWNL;
 
+/* Create a new stream connected to a pipe running the given command.  */
+OVERRIDE FILE *popen (const char *command, const char *modes);
+
+/* Execute the given line as a shell command.  */
+OVERRIDE int system (const char *line);
+
+/* Spawn a new process executing PATH with the attributes describes in *ATTRP.
+   Before running the process perform the actions described in FILE-ACTIONS. */
+OVERRIDE int posix_spawn (pid_t *pid, const char *path,
+    const posix_spawn_file_actions_t *file_actions,
+    const posix_spawnattr_t *attrp, char *const argv[], char *const envp[]);
+
+/* Similar to `posix_spawn' but search for FILE in the PATH.  */
+OVERRIDE int posix_spawnp (pid_t *pid, const char *file,
+    const posix_spawn_file_actions_t *file_actions,
+    const posix_spawnattr_t *attrp, char *const argv[], char *const envp[]);
+
 }
 
 #endif
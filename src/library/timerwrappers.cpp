@@ -0,0 +1,309 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "timerwrappers.h"
+#include "VirtualTimers.h"
+#include "logging.h"
+#include "hook.h"
+#include "GlobalState.h"
+
+#include <errno.h>
+#include <stdint.h>
+
+namespace libtas {
+
+DEFINE_ORIG_POINTER(timer_create)
+DEFINE_ORIG_POINTER(timer_delete)
+DEFINE_ORIG_POINTER(timer_settime)
+DEFINE_ORIG_POINTER(timer_gettime)
+DEFINE_ORIG_POINTER(timer_getoverrun)
+DEFINE_ORIG_POINTER(setitimer)
+DEFINE_ORIG_POINTER(getitimer)
+DEFINE_ORIG_POINTER(alarm)
+DEFINE_ORIG_POINTER(timerfd_create)
+DEFINE_ORIG_POINTER(timerfd_settime)
+DEFINE_ORIG_POINTER(timerfd_gettime)
+
+/* Our timer ids are stored directly inside timer_t */
+static int toTimerId(timer_t timerid)
+{
+    return static_cast<int>(reinterpret_cast<intptr_t>(timerid));
+}
+
+static struct timespec fromTimeval(const struct timeval& tv)
+{
+    struct timespec ts;
+    ts.tv_sec = tv.tv_sec;
+    ts.tv_nsec = tv.tv_usec * 1000;
+    return ts;
+}
+
+static struct timeval toTimeval(const struct timespec& ts)
+{
+    struct timeval tv;
+    tv.tv_sec = ts.tv_sec;
+    tv.tv_usec = ts.tv_nsec / 1000;
+    return tv;
+}
+
+/* Override */ int timer_create (clockid_t clock_id, struct sigevent *evp, timer_t *timerid) throw()
+{
+    LINK_NAMESPACE_GLOBAL(timer_create);
+    if (GlobalState::isNative())
+        return orig::timer_create(clock_id, evp, timerid);
+
+    debuglog(LCF_TIMERS, __func__, " call with clock ", clock_id);
+
+    int notify = evp ? evp->sigev_notify : SIGEV_SIGNAL;
+    int id;
+
+    switch (notify) {
+        case SIGEV_NONE:
+            id = VirtualTimers::create(VirtualTimers::NOTIFY_NONE);
+            break;
+        case SIGEV_SIGNAL:
+        case SIGEV_THREAD_ID:
+            id = VirtualTimers::create((notify == SIGEV_SIGNAL) ? VirtualTimers::NOTIFY_SIGNAL : VirtualTimers::NOTIFY_THREAD_ID);
+            if (id > 0) {
+                if (evp) {
+                    VirtualTimers::setSignal(id, evp->sigev_signo, evp->sigev_value,
+                        (notify == SIGEV_THREAD_ID) ? evp->_sigev_un._tid : 0);
+                }
+                else {
+                    /* Default is SIGALRM with the timer id as value */
+                    union sigval value;
+                    value.sival_int = id;
+                    VirtualTimers::setSignal(id, SIGALRM, value);
+                }
+            }
+            break;
+        case SIGEV_THREAD:
+            id = VirtualTimers::create(VirtualTimers::NOTIFY_THREAD);
+            if (id > 0)
+                VirtualTimers::setThread(id, evp->sigev_notify_function, evp->sigev_value);
+            break;
+        default:
+            errno = EINVAL;
+            return -1;
+    }
+
+    if (id < 0) {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    *timerid = reinterpret_cast<timer_t>(static_cast<intptr_t>(id));
+    return 0;
+}
+
+/* Override */ int timer_delete (timer_t timerid) throw()
+{
+    LINK_NAMESPACE_GLOBAL(timer_delete);
+    if (GlobalState::isNative())
+        return orig::timer_delete(timerid);
+
+    debuglog(LCF_TIMERS, __func__, " call with timer ", toTimerId(timerid));
+
+    if (!VirtualTimers::remove(toTimerId(timerid))) {
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+/* Override */ int timer_settime (timer_t timerid, int flags,
+                            const struct itimerspec *value,
+                            struct itimerspec *ovalue) throw()
+{
+    LINK_NAMESPACE_GLOBAL(timer_settime);
+    if (GlobalState::isNative())
+        return orig::timer_settime(timerid, flags, value, ovalue);
+
+    debuglog(LCF_TIMERS, __func__, " call with timer ", toTimerId(timerid), " and value ", value->it_value.tv_sec, ".", value->it_value.tv_nsec/1000000, " s");
+
+    int id = toTimerId(timerid);
+    if (!VirtualTimers::exists(id)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    VirtualTimers::set(id, value->it_value, value->it_interval, flags & TIMER_ABSTIME,
+        ovalue ? &ovalue->it_value : nullptr, ovalue ? &ovalue->it_interval : nullptr);
+    return 0;
+}
+
+/* Override */ int timer_gettime (timer_t timerid, struct itimerspec *value) throw()
+{
+    LINK_NAMESPACE_GLOBAL(timer_gettime);
+    if (GlobalState::isNative())
+        return orig::timer_gettime(timerid, value);
+
+    DEBUGLOGCALL(LCF_TIMERS);
+
+    int id = toTimerId(timerid);
+    if (!VirtualTimers::exists(id)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    VirtualTimers::get(id, &value->it_value, &value->it_interval);
+    return 0;
+}
+
+/* Override */ int timer_getoverrun (timer_t timerid) throw()
+{
+    LINK_NAMESPACE_GLOBAL(timer_getoverrun);
+    if (GlobalState::isNative())
+        return orig::timer_getoverrun(timerid);
+
+    DEBUGLOGCALL(LCF_TIMERS);
+
+    int id = toTimerId(timerid);
+    if (!VirtualTimers::exists(id)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    return VirtualTimers::getOverrun(id);
+}
+
+/* Override */ int setitimer (__itimer_which_t which,
+                        const struct itimerval *nvalue,
+                        struct itimerval *ovalue) throw()
+{
+    LINK_NAMESPACE_GLOBAL(setitimer);
+    if (GlobalState::isNative())
+        return orig::setitimer(which, nvalue, ovalue);
+
+    debuglog(LCF_TIMERS, __func__, " call with timer ", which, " and value ", nvalue->it_value.tv_sec, ".", nvalue->it_value.tv_usec/1000, " s");
+
+    int id = VirtualTimers::getITimer(which);
+    if (id < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    struct timespec old_value, old_interval;
+    VirtualTimers::set(id, fromTimeval(nvalue->it_value), fromTimeval(nvalue->it_interval), false,
+        &old_value, &old_interval);
+
+    if (ovalue) {
+        ovalue->it_value = toTimeval(old_value);
+        ovalue->it_interval = toTimeval(old_interval);
+    }
+    return 0;
+}
+
+/* Override */ int getitimer (__itimer_which_t which, struct itimerval *value) throw()
+{
+    LINK_NAMESPACE_GLOBAL(getitimer);
+    if (GlobalState::isNative())
+        return orig::getitimer(which, value);
+
+    DEBUGLOGCALL(LCF_TIMERS);
+
+    int id = VirtualTimers::getITimer(which);
+    if (id < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    struct timespec cur_value, cur_interval;
+    VirtualTimers::get(id, &cur_value, &cur_interval);
+    value->it_value = toTimeval(cur_value);
+    value->it_interval = toTimeval(cur_interval);
+    return 0;
+}
+
+/* Override */ unsigned int alarm (unsigned int seconds) throw()
+{
+    LINK_NAMESPACE_GLOBAL(alarm);
+    if (GlobalState::isNative())
+        return orig::alarm(seconds);
+
+    debuglog(LCF_TIMERS, __func__, " call with ", seconds, " seconds");
+
+    /* alarm() shares the timer of setitimer(ITIMER_REAL) */
+    int id = VirtualTimers::getITimer(ITIMER_REAL);
+
+    struct timespec value = {static_cast<time_t>(seconds), 0};
+    struct timespec interval = {0, 0};
+    struct timespec old_value;
+    VirtualTimers::set(id, value, interval, false, &old_value);
+
+    /* Round to the nearest second, but don't return 0 for a pending alarm */
+    unsigned int remaining = old_value.tv_sec + (old_value.tv_nsec >= 500000000);
+    if ((remaining == 0) && (old_value.tv_nsec > 0))
+        remaining = 1;
+    return remaining;
+}
+
+/* Override */ int timerfd_create (clockid_t clock_id, int flags) throw()
+{
+    LINK_NAMESPACE_GLOBAL(timerfd_create);
+    if (GlobalState::isNative())
+        return orig::timerfd_create(clock_id, flags);
+
+    debuglog(LCF_TIMERS, __func__, " call with clock ", clock_id);
+
+    int fd = VirtualTimers::createFd(flags);
+    if (fd < 0) {
+        errno = EMFILE;
+        return -1;
+    }
+    return fd;
+}
+
+/* Override */ int timerfd_settime (int ufd, int flags,
+                              const struct itimerspec *utmr,
+                              struct itimerspec *otmr) throw()
+{
+    LINK_NAMESPACE_GLOBAL(timerfd_settime);
+    if (GlobalState::isNative())
+        return orig::timerfd_settime(ufd, flags, utmr, otmr);
+
+    int id = VirtualTimers::fromFd(ufd);
+    if (id < 0)
+        return orig::timerfd_settime(ufd, flags, utmr, otmr);
+
+    debuglog(LCF_TIMERS, __func__, " call with fd ", ufd, " and value ", utmr->it_value.tv_sec, ".", utmr->it_value.tv_nsec/1000000, " s");
+
+    VirtualTimers::set(id, utmr->it_value, utmr->it_interval, flags & TFD_TIMER_ABSTIME,
+        otmr ? &otmr->it_value : nullptr, otmr ? &otmr->it_interval : nullptr);
+    return 0;
+}
+
+/* Override */ int timerfd_gettime (int ufd, struct itimerspec *otmr) throw()
+{
+    LINK_NAMESPACE_GLOBAL(timerfd_gettime);
+    if (GlobalState::isNative())
+        return orig::timerfd_gettime(ufd, otmr);
+
+    int id = VirtualTimers::fromFd(ufd);
+    if (id < 0)
+        return orig::timerfd_gettime(ufd, otmr);
+
+    DEBUGLOGCALL(LCF_TIMERS);
+
+    VirtualTimers::get(id, &otmr->it_value, &otmr->it_interval);
+    return 0;
+}
+
+}
@@ -0,0 +1,81 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LIBTAS_TIMERWRAPPERS_H_INCL
+#define LIBTAS_TIMERWRAPPERS_H_INCL
+
+#include <time.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <sys/timerfd.h>
+#include "global.h"
+
+namespace libtas {
+
+/* Create new per-process timer using CLOCK_ID.  */
+OVERRIDE int timer_create (clockid_t clock_id, struct sigevent *evp, timer_t *timerid) throw();
+
+/* Delete timer TIMERID.  */
+OVERRIDE int timer_delete (timer_t timerid) throw();
+
+/* Set timer TIMERID to VALUE, returning old value in OVALUE.  */
+OVERRIDE int timer_settime (timer_t timerid, int flags,
+                            const struct itimerspec *value,
+                            struct itimerspec *ovalue) throw();
+
+/* Get current value of timer TIMERID and store it in VALUE.  */
+OVERRIDE int timer_gettime (timer_t timerid, struct itimerspec *value) throw();
+
+/* Get expiration overrun for timer TIMERID.  */
+OVERRIDE int timer_getoverrun (timer_t timerid) throw();
+
+/* Set the timer WHICH to *NEW.  If OLD is not NULL,
+   set *OLD to the old value of timer WHICH.
+   Returns 0 on success, -1 on errors.  */
+OVERRIDE int setitimer (__itimer_which_t which,
+                        const struct itimerval *nvalue,
+                        struct itimerval *ovalue) throw();
+
+/* Set *VALUE to the current setting of timer WHICH.
+   Return 0 on success, -1 on errors.  */
+OVERRIDE int getitimer (__itimer_which_t which, struct itimerval *value) throw();
+
+/* Schedule an alarm.  In SECONDS seconds, the process will get a SIGALRM.
+   If SECONDS is zero, any currently scheduled alarm will be cancelled.
+   The function returns the number of seconds remaining until the last
+   alarm scheduled would have signaled, or zero if there wasn't one.  */
+OVERRIDE unsigned int alarm (unsigned int seconds) throw();
+
+/* Return file descriptor for new interval timer source.  */
+OVERRIDE int timerfd_create (clockid_t clock_id, int flags) throw();
+
+/* Set next expiration time of interval timer source UFD to UTMR.  If
+   FLAGS has the TFD_TIMER_ABSTIME flag set the timeout value is
+   absolute.  Optionally return the old expiration time in OTMR.  */
+OVERRIDE int timerfd_settime (int ufd, int flags,
+                              const struct itimerspec *utmr,
+                              struct itimerspec *otmr) throw();
+
+/* Return the next expiration time of UFD.  */
+OVERRIDE int timerfd_gettime (int ufd, struct itimerspec *otmr) throw();
+
+}
+
+#endif
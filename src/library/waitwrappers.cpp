@@ -25,6 +25,7 @@
 #include "GlobalState.h"
 #include "hook.h"
 #include "audio/alsa/pcm.h"
+#include "VirtualSignals.h"
 
 namespace libtas {
 
@@ -43,6 +44,9 @@ DEFINE_ORIG_POINTER(epoll_wait)
 
     debuglog(LCF_WAIT, __func__, " call with ", nfds, " fds and timeout ", timeout);
 
+    /* The thread is about to block, deliver the signals it sent */
+    VirtualSignals::flush();
+
     /* Check for the fd used by ALSA */
     for (nfds_t i = 0; i < nfds; i++) {
         if (fds[i].fd == 0xa15a) {
@@ -90,6 +94,8 @@ DEFINE_ORIG_POINTER(epoll_wait)
      */
     if ((nfds != 0) || (readfds != nullptr) || (writefds != nullptr) || (exceptfds != nullptr))
     {
+        if (!GlobalState::isNative())
+            VirtualSignals::flush();
         return orig::select(nfds, readfds, writefds, exceptfds, timeout);
     }
 
@@ -127,6 +133,8 @@ DEFINE_ORIG_POINTER(epoll_wait)
      */
     if ((nfds != 0) || (readfds != nullptr) || (writefds != nullptr) || (exceptfds != nullptr))
     {
+        if (!GlobalState::isNative())
+            VirtualSignals::flush();
         return orig::pselect(nfds, readfds, writefds, exceptfds, timeout, sigmask);
     }
 
@@ -160,6 +168,9 @@ DEFINE_ORIG_POINTER(epoll_wait)
 
     debuglog(LCF_SLEEP, __func__, " call with timeout ", timeout, " msec");
 
+    /* The thread is about to block, deliver the signals it sent */
+    VirtualSignals::flush();
+
     int ret = orig::epoll_wait(epfd, events, maxevents, timeout);
 
     /* If the function was called from the main thread and the function timed out,
@@ -0,0 +1,424 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "dinput8.h"
+#include "winehook.h"
+#include "../hookpatch.h"
+#include "../logging.h"
+#include "../inputs/inputs.h"
+#include "../../shared/SharedConfig.h"
+#include "../../shared/SingleInput.h"
+#include "../../shared/AllInputs.h"
+
+#include <cstring>
+#include <mutex>
+#include <stdint.h>
+
+namespace libtas {
+
+#define DI_OK 0
+#define DIERR_INVALIDPARAM static_cast<int32_t>(0x80070057)
+
+#define DI8DEVTYPE_JOYSTICK 0x14
+#define DI8DEVTYPE_1STPERSON 0x18
+
+#define DIPROP_RANGE reinterpret_cast<const GUID*>(4)
+#define DIPH_BYOFFSET 1
+
+/* Offsets of axes in the DIJOYSTATE structure */
+#define DIJOFS_X 0
+#define DIJOFS_Y 4
+#define DIJOFS_Z 8
+#define DIJOFS_RX 12
+#define DIJOFS_RY 16
+#define DIJOFS_RZ 20
+
+typedef struct _GUID {
+    uint32_t Data1;
+    uint16_t Data2;
+    uint16_t Data3;
+    uint8_t Data4[8];
+} GUID;
+
+typedef struct DIDEVCAPS {
+    uint32_t dwSize;
+    uint32_t dwFlags;
+    uint32_t dwDevType;
+    uint32_t dwAxes;
+    uint32_t dwButtons;
+    uint32_t dwPOVs;
+    uint32_t dwFFSamplePeriod;
+    uint32_t dwFFMinTimeResolution;
+    uint32_t dwFirmwareRevision;
+    uint32_t dwHardwareRevision;
+    uint32_t dwFFDriverVersion;
+} DIDEVCAPS;
+
+typedef struct DIPROPHEADER {
+    uint32_t dwSize;
+    uint32_t dwHeaderSize;
+    uint32_t dwObj;
+    uint32_t dwHow;
+} DIPROPHEADER;
+
+typedef struct DIPROPRANGE {
+    DIPROPHEADER diph;
+    int32_t lMin;
+    int32_t lMax;
+} DIPROPRANGE;
+
+/* DIJOYSTATE2 shares the beginning of DIJOYSTATE, with more buttons */
+typedef struct DIJOYSTATE {
+    int32_t lX;
+    int32_t lY;
+    int32_t lZ;
+    int32_t lRx;
+    int32_t lRy;
+    int32_t lRz;
+    int32_t rglSlider[2];
+    uint32_t rgdwPOV[4];
+    uint8_t rgbButtons[32];
+} DIJOYSTATE;
+
+#define DIJOYSTATE2_SIZE 272
+
+/* COM objects start with a pointer to their table of methods */
+typedef struct COMObject {
+    void** lpVtbl;
+} COMObject;
+
+/* Indices of the methods that we use or replace */
+#define IDIRECTINPUT8_VTBL_SIZE 11
+#define IDIRECTINPUT8_CREATEDEVICE 3
+
+#define IDIRECTINPUTDEVICE8_VTBL_SIZE 32
+#define IDIRECTINPUTDEVICE8_RELEASE 2
+#define IDIRECTINPUTDEVICE8_GETCAPABILITIES 3
+#define IDIRECTINPUTDEVICE8_GETPROPERTY 5
+#define IDIRECTINPUTDEVICE8_GETDEVICESTATE 9
+
+typedef int32_t (__stdcall *CreateDevice_t)(COMObject*, const GUID*, COMObject**, void*);
+typedef uint32_t (__stdcall *Release_t)(COMObject*);
+typedef int32_t (__stdcall *GetCapabilities_t)(COMObject*, DIDEVCAPS*);
+typedef int32_t (__stdcall *GetProperty_t)(COMObject*, const GUID*, DIPROPHEADER*);
+typedef int32_t (__stdcall *GetDeviceState_t)(COMObject*, uint32_t, void*);
+
+namespace orig {
+
+static int32_t __stdcall __attribute__((noinline)) DirectInput8Create(void *hinst, uint32_t dwVersion, const GUID *riidltf, void **ppvOut, void *punkOuter)
+{
+    HOOK_PLACEHOLDER_RETURN_ZERO
+}
+
+}
+
+/* We cannot patch methods of COM interfaces, because they are not exported.
+ * Instead, we replace the method table of the objects returned to the game
+ * with a copy in which some methods are ours. The ANSI and Unicode versions
+ * of the interfaces have different tables, so we keep a few copies. */
+template <int N>
+struct VtableCopy {
+    void** orig;
+    void* methods[N];
+};
+
+static const int MAX_VTABLES = 4;
+
+static VtableCopy<IDIRECTINPUT8_VTBL_SIZE> dinput_vtables[MAX_VTABLES];
+static VtableCopy<IDIRECTINPUTDEVICE8_VTBL_SIZE> device_vtables[MAX_VTABLES];
+
+/* Controller number of each joystick device object */
+static const int MAX_DEVICES = 16;
+static struct {
+    COMObject* device;
+    int joy;
+} joy_devices[MAX_DEVICES];
+
+/* Instance GUID of each controller, in the order they were created */
+static GUID joy_guids[AllInputs::MAXJOYS];
+static int nb_joy_guids = 0;
+
+static std::mutex dinput_mutex;
+
+template <int N>
+static void** wrapVtable(VtableCopy<N>* vtables, void** vtbl, const int* indices, void* const* methods, int count)
+{
+    for (int v = 0; v < MAX_VTABLES; v++) {
+        /* Already wrapped */
+        if (vtbl == vtables[v].methods)
+            return vtbl;
+
+        if (vtables[v].orig == vtbl)
+            return vtables[v].methods;
+
+        if (!vtables[v].orig) {
+            vtables[v].orig = vtbl;
+            memcpy(vtables[v].methods, vtbl, N * sizeof(void*));
+            for (int i = 0; i < count; i++)
+                vtables[v].methods[indices[i]] = methods[i];
+            return vtables[v].methods;
+        }
+    }
+
+    debuglogstdio(LCF_WINE | LCF_JOYSTICK | LCF_ERROR, "Too many DirectInput interfaces to wrap");
+    return vtbl;
+}
+
+/* Get the original method of a wrapped object */
+template <int N>
+static void* origMethod(VtableCopy<N>* vtables, COMObject* obj, int index)
+{
+    for (int v = 0; v < MAX_VTABLES; v++) {
+        if (obj->lpVtbl == vtables[v].methods)
+            return vtables[v].orig[index];
+    }
+    return obj->lpVtbl[index];
+}
+
+static int getJoy(COMObject* device)
+{
+    for (int d = 0; d < MAX_DEVICES; d++) {
+        if (joy_devices[d].device == device)
+            return joy_devices[d].joy;
+    }
+    return -1;
+}
+
+/* Scale an axis value from [in_min, in_max] to the range set by the game */
+static int32_t scaleAxis(COMObject* device, GetProperty_t getProperty, uint32_t offset, int value, int in_min, int in_max)
+{
+    DIPROPRANGE range;
+    range.diph.dwSize = sizeof(DIPROPRANGE);
+    range.diph.dwHeaderSize = sizeof(DIPROPHEADER);
+    range.diph.dwObj = offset;
+    range.diph.dwHow = DIPH_BYOFFSET;
+
+    /* Default DirectInput range */
+    if (getProperty(device, DIPROP_RANGE, &range.diph) != DI_OK) {
+        range.lMin = 0;
+        range.lMax = 65535;
+    }
+
+    if (value < in_min) value = in_min;
+    if (value > in_max) value = in_max;
+
+    return range.lMin + static_cast<int32_t>((static_cast<int64_t>(value - in_min) * (static_cast<int64_t>(range.lMax) - range.lMin)) / (in_max - in_min));
+}
+
+/* POV angle in hundredths of degrees, clockwise from north */
+static uint32_t povValue(unsigned short buttons)
+{
+    int hatx = SingleInput::toDevHatX(buttons);
+    int haty = SingleInput::toDevHatY(buttons);
+
+    if (hatx == 0 && haty == 0) return 0xFFFFFFFF;
+    if (hatx == 0 && haty == -1) return 0;
+    if (hatx == 1 && haty == -1) return 4500;
+    if (hatx == 1 && haty == 0) return 9000;
+    if (hatx == 1 && haty == 1) return 13500;
+    if (hatx == 0 && haty == 1) return 18000;
+    if (hatx == -1 && haty == 1) return 22500;
+    if (hatx == -1 && haty == 0) return 27000;
+    return 31500;
+}
+
+static int32_t __stdcall GetDeviceState(COMObject* This, uint32_t cbData, void* lpvData)
+{
+    DEBUGLOGCALL(LCF_WINE | LCF_JOYSTICK | LCF_FREQUENT);
+
+    GetDeviceState_t orig_GetDeviceState;
+    GetProperty_t orig_GetProperty;
+    int joy;
+    {
+        std::lock_guard<std::mutex> lock(dinput_mutex);
+        orig_GetDeviceState = reinterpret_cast<GetDeviceState_t>(origMethod(device_vtables, This, IDIRECTINPUTDEVICE8_GETDEVICESTATE));
+        orig_GetProperty = reinterpret_cast<GetProperty_t>(origMethod(device_vtables, This, IDIRECTINPUTDEVICE8_GETPROPERTY));
+        joy = getJoy(This);
+    }
+
+    /* Keep Wine error handling, for example when the device is not acquired */
+    int32_t ret = orig_GetDeviceState(This, cbData, lpvData);
+    if (ret != DI_OK)
+        return ret;
+
+    /* Only the standard joystick data formats are supported */
+    if ((joy < 0) || (joy >= shared_config.nb_controllers) ||
+        ((cbData != sizeof(DIJOYSTATE)) && (cbData != DIJOYSTATE2_SIZE))) {
+        return ret;
+    }
+
+    const std::array<short, AllInputs::MAXAXES>& axes = game_ai.controller_axes[joy];
+    unsigned short buttons = game_ai.controller_buttons[joy];
+
+    memset(lpvData, 0, cbData);
+    DIJOYSTATE* state = static_cast<DIJOYSTATE*>(lpvData);
+
+    /* Same axis layout as Wine gives to our emulated evdev joystick */
+    state->lX = scaleAxis(This, orig_GetProperty, DIJOFS_X, axes[SingleInput::AXIS_LEFTX], INT16_MIN, INT16_MAX);
+    state->lY = scaleAxis(This, orig_GetProperty, DIJOFS_Y, axes[SingleInput::AXIS_LEFTY], INT16_MIN, INT16_MAX);
+    state->lZ = scaleAxis(This, orig_GetProperty, DIJOFS_Z, axes[SingleInput::AXIS_TRIGGERLEFT], 0, INT16_MAX);
+    state->lRx = scaleAxis(This, orig_GetProperty, DIJOFS_RX, axes[SingleInput::AXIS_RIGHTX], INT16_MIN, INT16_MAX);
+    state->lRy = scaleAxis(This, orig_GetProperty, DIJOFS_RY, axes[SingleInput::AXIS_RIGHTY], INT16_MIN, INT16_MAX);
+    state->lRz = scaleAxis(This, orig_GetProperty, DIJOFS_RZ, axes[SingleInput::AXIS_TRIGGERRIGHT], 0, INT16_MAX);
+
+    state->rgdwPOV[0] = povValue(buttons);
+    for (int p = 1; p < 4; p++)
+        state->rgdwPOV[p] = 0xFFFFFFFF;
+
+    /* Buttons are numbered in the order of their evdev codes, as Wine does */
+    static const int button_order[] = {
+        SingleInput::BUTTON_A,
+        SingleInput::BUTTON_B,
+        SingleInput::BUTTON_X,
+        SingleInput::BUTTON_Y,
+        SingleInput::BUTTON_LEFTSHOULDER,
+        SingleInput::BUTTON_RIGHTSHOULDER,
+        SingleInput::BUTTON_BACK,
+        SingleInput::BUTTON_START,
+        SingleInput::BUTTON_GUIDE,
+        SingleInput::BUTTON_LEFTSTICK,
+        SingleInput::BUTTON_RIGHTSTICK,
+    };
+
+    for (unsigned int b = 0; b < sizeof(button_order)/sizeof(button_order[0]); b++) {
+        if (buttons & (1 << button_order[b]))
+            state->rgbButtons[b] = 0x80;
+    }
+
+    return ret;
+}
+
+static uint32_t __stdcall Release(COMObject* This)
+{
+    DEBUGLOGCALL(LCF_WINE | LCF_JOYSTICK);
+
+    Release_t orig_Release;
+    {
+        std::lock_guard<std::mutex> lock(dinput_mutex);
+        orig_Release = reinterpret_cast<Release_t>(origMethod(device_vtables, This, IDIRECTINPUTDEVICE8_RELEASE));
+    }
+
+    uint32_t ref = orig_Release(This);
+
+    if (ref == 0) {
+        std::lock_guard<std::mutex> lock(dinput_mutex);
+        for (int d = 0; d < MAX_DEVICES; d++) {
+            if (joy_devices[d].device == This)
+                joy_devices[d].device = nullptr;
+        }
+    }
+
+    return ref;
+}
+
+static int32_t __stdcall CreateDevice(COMObject* This, const GUID* rguid, COMObject** lplpDirectInputDevice, void* pUnkOuter)
+{
+    DEBUGLOGCALL(LCF_WINE | LCF_JOYSTICK);
+
+    CreateDevice_t orig_CreateDevice;
+    {
+        std::lock_guard<std::mutex> lock(dinput_mutex);
+        orig_CreateDevice = reinterpret_cast<CreateDevice_t>(origMethod(dinput_vtables, This, IDIRECTINPUT8_CREATEDEVICE));
+    }
+
+    int32_t ret = orig_CreateDevice(This, rguid, lplpDirectInputDevice, pUnkOuter);
+    if ((ret != DI_OK) || !rguid || !lplpDirectInputDevice || !*lplpDirectInputDevice)
+        return ret;
+
+    COMObject* device = *lplpDirectInputDevice;
+
+    /* Only wrap game controllers */
+    DIDEVCAPS caps;
+    memset(&caps, 0, sizeof(DIDEVCAPS));
+    caps.dwSize = sizeof(DIDEVCAPS);
+    GetCapabilities_t getCapabilities = reinterpret_cast<GetCapabilities_t>(device->lpVtbl[IDIRECTINPUTDEVICE8_GETCAPABILITIES]);
+    if (getCapabilities(device, &caps) != DI_OK)
+        return ret;
+
+    int devtype = caps.dwDevType & 0xff;
+    if ((devtype < DI8DEVTYPE_JOYSTICK) || (devtype > DI8DEVTYPE_1STPERSON))
+        return ret;
+
+    std::lock_guard<std::mutex> lock(dinput_mutex);
+
+    /* Controllers are numbered in the order the game first creates them,
+     * and creating the same device again gives the same controller. */
+    int joy = -1;
+    for (int j = 0; j < nb_joy_guids; j++) {
+        if (memcmp(&joy_guids[j], rguid, sizeof(GUID)) == 0) {
+            joy = j;
+            break;
+        }
+    }
+    if (joy == -1) {
+        if (nb_joy_guids == AllInputs::MAXJOYS) {
+            debuglogstdio(LCF_WINE | LCF_JOYSTICK | LCF_WARNING, "Too many DirectInput joysticks, not using our inputs");
+            return ret;
+        }
+        joy = nb_joy_guids;
+        joy_guids[nb_joy_guids++] = *rguid;
+    }
+
+    int d;
+    for (d = 0; d < MAX_DEVICES; d++) {
+        if (!joy_devices[d].device)
+            break;
+    }
+    if (d == MAX_DEVICES) {
+        debuglogstdio(LCF_WINE | LCF_JOYSTICK | LCF_WARNING, "Too many DirectInput devices, not using our inputs");
+        return ret;
+    }
+    joy_devices[d].device = device;
+    joy_devices[d].joy = joy;
+
+    static const int indices[] = {IDIRECTINPUTDEVICE8_RELEASE, IDIRECTINPUTDEVICE8_GETDEVICESTATE};
+    void* const methods[] = {reinterpret_cast<void*>(Release), reinterpret_cast<void*>(GetDeviceState)};
+    device->lpVtbl = wrapVtable(device_vtables, device->lpVtbl, indices, methods, 2);
+
+    debuglogstdio(LCF_WINE | LCF_JOYSTICK, "   DirectInput device mapped to controller %d", joy+1);
+    return ret;
+}
+
+int32_t __stdcall DirectInput8Create(void *hinst, uint32_t dwVersion, const GUID *riidltf, void **ppvOut, void *punkOuter)
+{
+    DEBUGLOGCALL(LCF_WINE | LCF_JOYSTICK);
+
+    int32_t ret = orig::DirectInput8Create(hinst, dwVersion, riidltf, ppvOut, punkOuter);
+    if ((ret != DI_OK) || !ppvOut || !*ppvOut)
+        return ret;
+
+    /* Devices are still enumerated by Wine, we only serve their state */
+    COMObject* dinput = static_cast<COMObject*>(*ppvOut);
+
+    std::lock_guard<std::mutex> lock(dinput_mutex);
+    static const int indices[] = {IDIRECTINPUT8_CREATEDEVICE};
+    void* const methods[] = {reinterpret_cast<void*>(CreateDevice)};
+    dinput->lpVtbl = wrapVtable(dinput_vtables, dinput->lpVtbl, indices, methods, 1);
+
+    return ret;
+}
+
+void hook_dinput8()
+{
+    HOOK_PATCH_ORIG(DirectInput8Create, "dinput8.dll.so");
+}
+
+}
@@ -27,18 +27,6 @@
 
 namespace libtas {
 
-typedef union _LARGE_INTEGER {
-    struct {
-        unsigned int LowPart;
-        int HighPart;
-    } dummy;
-    struct {
-        unsigned int LowPart;
-        int HighPart;
-    } u;
-    int64_t QuadPart;
-} LARGE_INTEGER;
-
 namespace orig {
 
 static int __stdcall __attribute__((noinline)) WaitForMultipleObjectsEx( int count, const void **handles,
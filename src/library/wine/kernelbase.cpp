@@ -0,0 +1,121 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "kernelbase.h"
+#include "winehook.h"
+#include "ntdll.h"
+#include "../hookpatch.h"
+#include "../logging.h"
+#include "../DeterministicTimer.h"
+#include "../GlobalState.h"
+#include "../checkpoint/ThreadManager.h"
+
+#include <sched.h>
+#include <stdint.h>
+
+namespace libtas {
+
+typedef struct _FILETIME {
+    unsigned int dwLowDateTime;
+    unsigned int dwHighDateTime;
+} FILETIME;
+
+namespace orig {
+
+/* Trampolines of functions returning void are declared as returning an int,
+ * so that we can use the common placeholder. The value is never used. */
+
+static int __stdcall __attribute__((noinline)) Sleep(unsigned int timeout)
+{
+    HOOK_PLACEHOLDER_RETURN_ZERO
+}
+
+static unsigned int __stdcall __attribute__((noinline)) SleepEx(unsigned int timeout, int alertable)
+{
+    HOOK_PLACEHOLDER_RETURN_ZERO
+}
+
+static int __stdcall __attribute__((noinline)) GetSystemTimeAsFileTime(FILETIME *time)
+{
+    HOOK_PLACEHOLDER_RETURN_ZERO
+}
+
+static int __stdcall __attribute__((noinline)) GetSystemTimePreciseAsFileTime(FILETIME *time)
+{
+    HOOK_PLACEHOLDER_RETURN_ZERO
+}
+
+}
+
+/* Transfer a sleep of the main thread to the timer. Returns if the sleep
+ * was handled, otherwise the original function must be called. */
+static bool sleepMainThread(unsigned int timeout)
+{
+    /* Zero timeouts only yield, and infinite timeouts must not return */
+    if ((timeout == 0) || (timeout == 0xffffffff) || !ThreadManager::isMainThread())
+        return false;
+
+    debuglog(LCF_WINE | LCF_SLEEP, "  sleep for ", timeout, " ms");
+
+    struct timespec delay;
+    delay.tv_sec = timeout / 1000;
+    delay.tv_nsec = (timeout % 1000) * 1000000;
+    detTimer.addDelay(delay);
+    NATIVECALL(sched_yield());
+    return true;
+}
+
+void __stdcall Sleep(unsigned int timeout)
+{
+    DEBUGLOGCALL(LCF_WINE | LCF_SLEEP | LCF_FREQUENT);
+    if (!sleepMainThread(timeout))
+        orig::Sleep(timeout);
+}
+
+unsigned int __stdcall SleepEx(unsigned int timeout, int alertable)
+{
+    DEBUGLOGCALL(LCF_WINE | LCF_SLEEP | LCF_FREQUENT);
+    if (sleepMainThread(timeout))
+        return 0;
+    return orig::SleepEx(timeout, alertable);
+}
+
+void __stdcall GetSystemTimeAsFileTime(FILETIME *time)
+{
+    DEBUGLOGCALL(LCF_WINE | LCF_TIMEGET | LCF_FREQUENT);
+    int64_t t = windowsSystemTime(SharedConfig::TIMETYPE_CLOCKGETTIME);
+    time->dwLowDateTime = static_cast<unsigned int>(t);
+    time->dwHighDateTime = static_cast<unsigned int>(t >> 32);
+}
+
+void __stdcall GetSystemTimePreciseAsFileTime(FILETIME *time)
+{
+    GetSystemTimeAsFileTime(time);
+}
+
+void hook_kernelbase()
+{
+    HOOK_PATCH_ORIG(Sleep, "kernelbase.dll.so");
+    HOOK_PATCH_ORIG(SleepEx, "kernelbase.dll.so");
+    HOOK_PATCH_ORIG(GetSystemTimeAsFileTime, "kernelbase.dll.so");
+    HOOK_PATCH_ORIG(GetSystemTimePreciseAsFileTime, "kernelbase.dll.so");
+}
+
+}
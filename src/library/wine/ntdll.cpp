@@ -0,0 +1,218 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "ntdll.h"
+#include "winehook.h"
+#include "../hookpatch.h"
+#include "../logging.h"
+#include "../DeterministicTimer.h"
+#include "../GlobalState.h"
+#include "../checkpoint/ThreadManager.h"
+#include "../TimeHolder.h"
+#include "../VirtualWait.h"
+#include "../GameHacks.h"
+
+#include <sched.h>
+#include <time.h>
+
+namespace libtas {
+
+#define STATUS_SUCCESS 0x00000000
+#define STATUS_TIMEOUT 0x00000102
+
+/* Seconds between January 1, 1601 and January 1, 1970 */
+#define SECS_1601_TO_1970 11644473600LL
+
+/* Frequency returned by the performance counter, same as in kernel32 */
+#define PERFORMANCE_FREQUENCY 1000000000LL
+
+namespace orig {
+
+static long __stdcall __attribute__((noinline)) NtDelayExecution(unsigned char alertable, const LARGE_INTEGER *timeout)
+{
+    HOOK_PLACEHOLDER_RETURN_ZERO
+}
+
+static long __stdcall __attribute__((noinline)) NtQuerySystemTime(LARGE_INTEGER *time)
+{
+    HOOK_PLACEHOLDER_RETURN_ZERO
+}
+
+static long __stdcall __attribute__((noinline)) NtQueryPerformanceCounter(LARGE_INTEGER *counter, LARGE_INTEGER *frequency)
+{
+    HOOK_PLACEHOLDER_RETURN_ZERO
+}
+
+static unsigned int __stdcall __attribute__((noinline)) NtGetTickCount()
+{
+    HOOK_PLACEHOLDER_RETURN_ZERO
+}
+
+static long __stdcall __attribute__((noinline)) NtWaitForSingleObject(void *handle, unsigned char alertable, const LARGE_INTEGER *timeout)
+{
+    HOOK_PLACEHOLDER_RETURN_ZERO
+}
+
+}
+
+int64_t windowsSystemTime(SharedConfig::TimeCallType type)
+{
+    struct timespec ts = detTimer.getTicks(type);
+    return (ts.tv_sec + SECS_1601_TO_1970) * 10000000LL + ts.tv_nsec / 100;
+}
+
+/* Convert a Windows timeout into a duration. Negative timeouts are relative,
+ * in 100 ns units, and positive timeouts are absolute system times. */
+static TimeHolder timeoutToDelay(const LARGE_INTEGER *timeout)
+{
+    int64_t delay100ns = timeout->QuadPart;
+    if (delay100ns > 0) {
+        delay100ns -= windowsSystemTime(SharedConfig::TIMETYPE_UNTRACKED);
+        if (delay100ns < 0)
+            delay100ns = 0;
+    }
+    else {
+        delay100ns = -delay100ns;
+    }
+
+    TimeHolder delay;
+    delay.tv_sec = delay100ns / 10000000;
+    delay.tv_nsec = (delay100ns % 10000000) * 100;
+    return delay;
+}
+
+long __stdcall NtDelayExecution(unsigned char alertable, const LARGE_INTEGER *timeout)
+{
+    if (!timeout || !ThreadManager::isMainThread()) {
+        DEBUGLOGCALL(LCF_WINE | LCF_SLEEP | LCF_FREQUENT);
+        return orig::NtDelayExecution(alertable, timeout);
+    }
+
+    TimeHolder delay = timeoutToDelay(timeout);
+    debuglog(LCF_WINE | LCF_SLEEP, __func__, " call - sleep for ", delay.tv_sec * 1000000000 + delay.tv_nsec, " nsec");
+
+    /* A zero timeout only yields */
+    if (!delay.tv_sec && !delay.tv_nsec)
+        return orig::NtDelayExecution(alertable, timeout);
+
+    /* Same as nanosleep: transfer the wait of the main thread to the timer,
+     * and do not actually wait */
+    detTimer.addDelay(delay);
+    NATIVECALL(sched_yield());
+    return STATUS_SUCCESS;
+}
+
+long __stdcall NtQuerySystemTime(LARGE_INTEGER *time)
+{
+    DEBUGLOGCALL(LCF_WINE | LCF_TIMEGET | LCF_FREQUENT);
+
+    /* Wine implements this with clock_gettime(CLOCK_REALTIME), so we keep the
+     * same time type as before this function was hooked */
+    time->QuadPart = windowsSystemTime(SharedConfig::TIMETYPE_CLOCKGETTIME);
+    debuglog(LCF_TIMEGET | LCF_FREQUENT, "  returning ", time->QuadPart);
+    return STATUS_SUCCESS;
+}
+
+long __stdcall NtQueryPerformanceCounter(LARGE_INTEGER *counter, LARGE_INTEGER *frequency)
+{
+    DEBUGLOGCALL(LCF_WINE | LCF_TIMEGET | LCF_FREQUENT);
+    struct timespec ts = detTimer.getTicks(SharedConfig::TIMETYPE_QUERYPERFORMANCECOUNTER);
+    counter->QuadPart = ts.tv_nsec + ts.tv_sec * PERFORMANCE_FREQUENCY;
+    if (frequency)
+        frequency->QuadPart = PERFORMANCE_FREQUENCY;
+    debuglog(LCF_TIMEGET | LCF_FREQUENT, "  returning ", counter->QuadPart);
+    return STATUS_SUCCESS;
+}
+
+unsigned int __stdcall NtGetTickCount()
+{
+    DEBUGLOGCALL(LCF_WINE | LCF_TIMEGET | LCF_FREQUENT);
+    struct timespec ts = detTimer.getTicks(SharedConfig::TIMETYPE_GETTICKCOUNT);
+    unsigned int msec = ts.tv_sec*1000 + ts.tv_nsec/1000000;
+    debuglog(LCF_TIMEGET | LCF_FREQUENT, "  returning ", msec);
+    return msec;
+}
+
+long __stdcall NtWaitForSingleObject(void *handle, unsigned char alertable, const LARGE_INTEGER *timeout)
+{
+    /* Infinite waits and polls are not modified */
+    if (!timeout || (timeout->QuadPart == 0) || !ThreadManager::isMainThread() ||
+        (GameHacks::waitTimeout() == SharedConfig::WAIT_NATIVE))
+        return orig::NtWaitForSingleObject(handle, alertable, timeout);
+
+    TimeHolder delay = timeoutToDelay(timeout);
+    debuglog(LCF_WINE | LCF_WAIT, __func__, " call with handle ", handle, " and timeout ", delay.tv_sec * 1000 + delay.tv_nsec / 1000000, " ms.");
+
+    LARGE_INTEGER zero_timeout;
+    zero_timeout.QuadPart = 0;
+
+    if (GameHacks::waitTimeout() == SharedConfig::WAIT_FINITE) {
+        /* Same as `sem_timedwait()`: wait by slices of at most one frame,
+         * and advance the deterministic timer when a slice expires */
+        TimeHolder deadline = detTimer.getTicks();
+        deadline += delay;
+
+        TimeHolder real_end, slice;
+        while (VirtualWait::nextSlice(CLOCK_MONOTONIC, deadline, real_end, slice)) {
+            TimeHolder real_now;
+            NATIVECALL(clock_gettime(CLOCK_MONOTONIC, &real_now));
+            TimeHolder real_delay = real_end - real_now;
+
+            LARGE_INTEGER slice_timeout;
+            slice_timeout.QuadPart = -(real_delay.tv_sec * 10000000LL + real_delay.tv_nsec / 100);
+            if (slice_timeout.QuadPart > 0)
+                slice_timeout.QuadPart = 0;
+
+            long ret = orig::NtWaitForSingleObject(handle, alertable, &slice_timeout);
+            if (ret != STATUS_TIMEOUT)
+                return ret;
+
+            VirtualWait::advance(slice);
+        }
+
+        /* Deadline reached, the object may still have been signaled */
+        return orig::NtWaitForSingleObject(handle, alertable, &zero_timeout);
+    }
+
+    if ((GameHacks::waitTimeout() == SharedConfig::WAIT_FULL_INFINITE) ||
+        (GameHacks::waitTimeout() == SharedConfig::WAIT_FULL)) {
+        /* Transfer time to our deterministic timer */
+        detTimer.addDelay(delay);
+    }
+
+    if ((GameHacks::waitTimeout() == SharedConfig::NO_WAIT) ||
+        (GameHacks::waitTimeout() == SharedConfig::WAIT_FULL)) {
+        return orig::NtWaitForSingleObject(handle, alertable, &zero_timeout);
+    }
+
+    /* Infinite wait */
+    return orig::NtWaitForSingleObject(handle, alertable, nullptr);
+}
+
+void hook_ntdll_time()
+{
+    HOOK_PATCH_ORIG(NtDelayExecution, "ntdll.dll.so");
+    HOOK_PATCH_ORIG(NtQuerySystemTime, "ntdll.dll.so");
+    HOOK_PATCH_ORIG(NtQueryPerformanceCounter, "ntdll.dll.so");
+    HOOK_PATCH_ORIG(NtGetTickCount, "ntdll.dll.so");
+    HOOK_PATCH_ORIG(NtWaitForSingleObject, "ntdll.dll.so");
+}
+
+}
@@ -0,0 +1,39 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LIBTAS_WINENTDLL_H_INCLUDED
+#define LIBTAS_WINENTDLL_H_INCLUDED
+
+#include "global.h"
+#include "../../shared/SharedConfig.h"
+#include <stdint.h>
+
+namespace libtas {
+
+/* Hook the time and wait functions of ntdll */
+void hook_ntdll_time();
+
+/* Returns the deterministic time as a Windows system time, which counts
+ * 100 ns intervals since January 1, 1601 */
+int64_t windowsSystemTime(SharedConfig::TimeCallType type);
+
+}
+
+#endif
@@ -18,6 +18,7 @@
  */
 
 #include "winehook.h"
+#include "ntdll.h"
 #include "../hookpatch.h"
 #include "../logging.h"
 // #include <sys/mman.h>
@@ -50,6 +51,7 @@ long __stdcall LdrGetProcedureAddress(void *module, const winstring *name,
 void hook_ntdll()
 {
     HOOK_PATCH_ORIG(LdrGetProcedureAddress, "ntdll.dll.so");
+    hook_ntdll_time();
 }
 
 
@@ -40,9 +40,22 @@
 
 
 #include "global.h"
+#include <stdint.h>
 
 namespace libtas {
 
+typedef union _LARGE_INTEGER {
+    struct {
+        unsigned int LowPart;
+        int HighPart;
+    } dummy;
+    struct {
+        unsigned int LowPart;
+        int HighPart;
+    } u;
+    int64_t QuadPart;
+} LARGE_INTEGER;
+
 void hook_ntdll();
 
 }
@@ -0,0 +1,54 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "winmm.h"
+#include "winehook.h"
+#include "../hookpatch.h"
+#include "../logging.h"
+#include "../DeterministicTimer.h"
+
+namespace libtas {
+
+namespace orig {
+
+static unsigned int __stdcall __attribute__((noinline)) timeGetTime()
+{
+    HOOK_PLACEHOLDER_RETURN_ZERO
+}
+
+}
+
+unsigned int __stdcall timeGetTime()
+{
+    DEBUGLOGCALL(LCF_TIMEGET | LCF_FREQUENT);
+
+    /* Same counter as GetTickCount(), which Wine uses to implement it */
+    struct timespec ts = detTimer.getTicks(SharedConfig::TIMETYPE_GETTICKCOUNT);
+    unsigned int msec = ts.tv_sec*1000 + ts.tv_nsec/1000000;
+    debuglog(LCF_TIMEGET | LCF_FREQUENT, "  returning ", msec);
+    return msec;
+}
+
+void hook_winmm()
+{
+    HOOK_PATCH_ORIG(timeGetTime, "winmm.dll.so");
+}
+
+}
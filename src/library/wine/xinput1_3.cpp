@@ -0,0 +1,277 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "xinput1_3.h"
+#include "winehook.h"
+#include "../hookpatch.h"
+#include "../logging.h"
+#include "../inputs/inputs.h"
+#include "../../shared/SharedConfig.h"
+#include "../../shared/SingleInput.h"
+#include "../../shared/AllInputs.h"
+#include <cstring>
+
+namespace libtas {
+
+#define XINPUT_ERROR_SUCCESS 0
+#define XINPUT_ERROR_BAD_ARGUMENTS 160
+#define XINPUT_ERROR_DEVICE_NOT_CONNECTED 1167
+
+#define XUSER_MAX_COUNT 4
+
+#define XINPUT_GAMEPAD_DPAD_UP          0x0001
+#define XINPUT_GAMEPAD_DPAD_DOWN        0x0002
+#define XINPUT_GAMEPAD_DPAD_LEFT        0x0004
+#define XINPUT_GAMEPAD_DPAD_RIGHT       0x0008
+#define XINPUT_GAMEPAD_START            0x0010
+#define XINPUT_GAMEPAD_BACK             0x0020
+#define XINPUT_GAMEPAD_LEFT_THUMB       0x0040
+#define XINPUT_GAMEPAD_RIGHT_THUMB      0x0080
+#define XINPUT_GAMEPAD_LEFT_SHOULDER    0x0100
+#define XINPUT_GAMEPAD_RIGHT_SHOULDER   0x0200
+#define XINPUT_GAMEPAD_GUIDE            0x0400
+#define XINPUT_GAMEPAD_A                0x1000
+#define XINPUT_GAMEPAD_B                0x2000
+#define XINPUT_GAMEPAD_X                0x4000
+#define XINPUT_GAMEPAD_Y                0x8000
+
+#define XINPUT_DEVTYPE_GAMEPAD 0x01
+#define XINPUT_DEVSUBTYPE_GAMEPAD 0x01
+
+typedef struct _XINPUT_GAMEPAD {
+    uint16_t wButtons;
+    uint8_t bLeftTrigger;
+    uint8_t bRightTrigger;
+    int16_t sThumbLX;
+    int16_t sThumbLY;
+    int16_t sThumbRX;
+    int16_t sThumbRY;
+} XINPUT_GAMEPAD;
+
+typedef struct _XINPUT_STATE {
+    uint32_t dwPacketNumber;
+    XINPUT_GAMEPAD Gamepad;
+} XINPUT_STATE;
+
+typedef struct _XINPUT_VIBRATION {
+    uint16_t wLeftMotorSpeed;
+    uint16_t wRightMotorSpeed;
+} XINPUT_VIBRATION;
+
+typedef struct _XINPUT_CAPABILITIES {
+    uint8_t Type;
+    uint8_t SubType;
+    uint16_t Flags;
+    XINPUT_GAMEPAD Gamepad;
+    XINPUT_VIBRATION Vibration;
+} XINPUT_CAPABILITIES;
+
+/* Each xinput version is a different library, but our functions never call
+ * the original ones, so all versions can share the same placeholders. */
+namespace orig {
+
+static unsigned int __stdcall __attribute__((noinline)) XInputGetState(unsigned int dwUserIndex, XINPUT_STATE *pState)
+{
+    HOOK_PLACEHOLDER_RETURN_ZERO
+}
+
+static unsigned int __stdcall __attribute__((noinline)) XInputGetStateEx(unsigned int dwUserIndex, XINPUT_STATE *pState)
+{
+    HOOK_PLACEHOLDER_RETURN_ZERO
+}
+
+static unsigned int __stdcall __attribute__((noinline)) XInputSetState(unsigned int dwUserIndex, XINPUT_VIBRATION *pVibration)
+{
+    HOOK_PLACEHOLDER_RETURN_ZERO
+}
+
+static unsigned int __stdcall __attribute__((noinline)) XInputGetCapabilities(unsigned int dwUserIndex, unsigned int dwFlags, XINPUT_CAPABILITIES *pCapabilities)
+{
+    HOOK_PLACEHOLDER_RETURN_ZERO
+}
+
+}
+
+/* Packet number and last returned state of each controller, used to
+ * increment the packet number only when the state changes */
+static uint32_t packet_numbers[XUSER_MAX_COUNT] = {};
+static XINPUT_GAMEPAD last_gamepads[XUSER_MAX_COUNT] = {};
+
+/* Check the controller index, and return the corresponding error code */
+static unsigned int checkUserIndex(unsigned int dwUserIndex)
+{
+    if (dwUserIndex >= XUSER_MAX_COUNT)
+        return XINPUT_ERROR_BAD_ARGUMENTS;
+
+    if (static_cast<int>(dwUserIndex) >= shared_config.nb_controllers)
+        return XINPUT_ERROR_DEVICE_NOT_CONNECTED;
+
+    return XINPUT_ERROR_SUCCESS;
+}
+
+/* Y axes are inverted between SDL and XInput. Negating -32768 would
+ * overflow, so clamp it. */
+static int16_t invertAxis(short value)
+{
+    if (value == INT16_MIN)
+        return INT16_MAX;
+    return -value;
+}
+
+/* Triggers are 0..32767 in our inputs and 0..255 in XInput */
+static uint8_t triggerValue(short value)
+{
+    if (value < 0)
+        return 0;
+    return value >> 7;
+}
+
+static void fillGamepad(unsigned int dwUserIndex, XINPUT_GAMEPAD *gamepad)
+{
+    const std::array<short, AllInputs::MAXAXES>& axes = game_ai.controller_axes[dwUserIndex];
+    unsigned short buttons = game_ai.controller_buttons[dwUserIndex];
+
+    gamepad->sThumbLX = axes[SingleInput::AXIS_LEFTX];
+    gamepad->sThumbLY = invertAxis(axes[SingleInput::AXIS_LEFTY]);
+    gamepad->sThumbRX = axes[SingleInput::AXIS_RIGHTX];
+    gamepad->sThumbRY = invertAxis(axes[SingleInput::AXIS_RIGHTY]);
+    gamepad->bLeftTrigger = triggerValue(axes[SingleInput::AXIS_TRIGGERLEFT]);
+    gamepad->bRightTrigger = triggerValue(axes[SingleInput::AXIS_TRIGGERRIGHT]);
+
+    static const struct {int button; uint16_t xbutton;} button_map[] = {
+        {SingleInput::BUTTON_DPAD_UP, XINPUT_GAMEPAD_DPAD_UP},
+        {SingleInput::BUTTON_DPAD_DOWN, XINPUT_GAMEPAD_DPAD_DOWN},
+        {SingleInput::BUTTON_DPAD_LEFT, XINPUT_GAMEPAD_DPAD_LEFT},
+        {SingleInput::BUTTON_DPAD_RIGHT, XINPUT_GAMEPAD_DPAD_RIGHT},
+        {SingleInput::BUTTON_START, XINPUT_GAMEPAD_START},
+        {SingleInput::BUTTON_BACK, XINPUT_GAMEPAD_BACK},
+        {SingleInput::BUTTON_LEFTSTICK, XINPUT_GAMEPAD_LEFT_THUMB},
+        {SingleInput::BUTTON_RIGHTSTICK, XINPUT_GAMEPAD_RIGHT_THUMB},
+        {SingleInput::BUTTON_LEFTSHOULDER, XINPUT_GAMEPAD_LEFT_SHOULDER},
+        {SingleInput::BUTTON_RIGHTSHOULDER, XINPUT_GAMEPAD_RIGHT_SHOULDER},
+        {SingleInput::BUTTON_GUIDE, XINPUT_GAMEPAD_GUIDE},
+        {SingleInput::BUTTON_A, XINPUT_GAMEPAD_A},
+        {SingleInput::BUTTON_B, XINPUT_GAMEPAD_B},
+        {SingleInput::BUTTON_X, XINPUT_GAMEPAD_X},
+        {SingleInput::BUTTON_Y, XINPUT_GAMEPAD_Y},
+    };
+
+    gamepad->wButtons = 0;
+    for (const auto& bm : button_map) {
+        if (buttons & (1 << bm.button))
+            gamepad->wButtons |= bm.xbutton;
+    }
+}
+
+static unsigned int getState(unsigned int dwUserIndex, XINPUT_STATE *pState, bool with_guide)
+{
+    unsigned int ret = checkUserIndex(dwUserIndex);
+    if (ret != XINPUT_ERROR_SUCCESS)
+        return ret;
+
+    if (!pState)
+        return XINPUT_ERROR_BAD_ARGUMENTS;
+
+    XINPUT_GAMEPAD gamepad;
+    fillGamepad(dwUserIndex, &gamepad);
+
+    /* Games may use the packet number to skip processing when nothing
+     * changed, so only increment it on a state change. */
+    XINPUT_GAMEPAD& last = last_gamepads[dwUserIndex];
+    if ((gamepad.wButtons != last.wButtons) ||
+        (gamepad.bLeftTrigger != last.bLeftTrigger) ||
+        (gamepad.bRightTrigger != last.bRightTrigger) ||
+        (gamepad.sThumbLX != last.sThumbLX) ||
+        (gamepad.sThumbLY != last.sThumbLY) ||
+        (gamepad.sThumbRX != last.sThumbRX) ||
+        (gamepad.sThumbRY != last.sThumbRY)) {
+        packet_numbers[dwUserIndex]++;
+        last = gamepad;
+    }
+
+    /* The guide button is only reported by the undocumented XInputGetStateEx */
+    if (!with_guide)
+        gamepad.wButtons &= ~XINPUT_GAMEPAD_GUIDE;
+
+    pState->dwPacketNumber = packet_numbers[dwUserIndex];
+    pState->Gamepad = gamepad;
+    return XINPUT_ERROR_SUCCESS;
+}
+
+unsigned int __stdcall XInputGetState(unsigned int dwUserIndex, XINPUT_STATE *pState)
+{
+    DEBUGLOGCALL(LCF_WINE | LCF_JOYSTICK | LCF_FREQUENT);
+    return getState(dwUserIndex, pState, false);
+}
+
+unsigned int __stdcall XInputGetStateEx(unsigned int dwUserIndex, XINPUT_STATE *pState)
+{
+    DEBUGLOGCALL(LCF_WINE | LCF_JOYSTICK | LCF_FREQUENT);
+    return getState(dwUserIndex, pState, true);
+}
+
+unsigned int __stdcall XInputSetState(unsigned int dwUserIndex, XINPUT_VIBRATION *pVibration)
+{
+    DEBUGLOGCALL(LCF_WINE | LCF_JOYSTICK);
+
+    /* Vibration is ignored */
+    return checkUserIndex(dwUserIndex);
+}
+
+unsigned int __stdcall XInputGetCapabilities(unsigned int dwUserIndex, unsigned int dwFlags, XINPUT_CAPABILITIES *pCapabilities)
+{
+    DEBUGLOGCALL(LCF_WINE | LCF_JOYSTICK);
+
+    unsigned int ret = checkUserIndex(dwUserIndex);
+    if (ret != XINPUT_ERROR_SUCCESS)
+        return ret;
+
+    if (!pCapabilities)
+        return XINPUT_ERROR_BAD_ARGUMENTS;
+
+    /* Report a regular gamepad with all buttons and full axis resolution */
+    pCapabilities->Type = XINPUT_DEVTYPE_GAMEPAD;
+    pCapabilities->SubType = XINPUT_DEVSUBTYPE_GAMEPAD;
+    pCapabilities->Flags = 0;
+    pCapabilities->Gamepad.wButtons = 0xf3ff;
+    pCapabilities->Gamepad.bLeftTrigger = 0xff;
+    pCapabilities->Gamepad.bRightTrigger = 0xff;
+    pCapabilities->Gamepad.sThumbLX = static_cast<int16_t>(0xffc0);
+    pCapabilities->Gamepad.sThumbLY = static_cast<int16_t>(0xffc0);
+    pCapabilities->Gamepad.sThumbRX = static_cast<int16_t>(0xffc0);
+    pCapabilities->Gamepad.sThumbRY = static_cast<int16_t>(0xffc0);
+    pCapabilities->Vibration.wLeftMotorSpeed = 0;
+    pCapabilities->Vibration.wRightMotorSpeed = 0;
+    return XINPUT_ERROR_SUCCESS;
+}
+
+void hook_xinput(const char* library)
+{
+    HOOK_PATCH_ORIG(XInputGetState, library);
+    HOOK_PATCH_ORIG(XInputSetState, library);
+    HOOK_PATCH_ORIG(XInputGetCapabilities, library);
+
+    /* xinput9_1_0 does not export XInputGetStateEx */
+    if (!strstr(library, "xinput9_1_0"))
+        HOOK_PATCH_ORIG(XInputGetStateEx, library);
+}
+
+}
@@ -0,0 +1,35 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef LIBTAS_WINEXINPUT_H_INCLUDED
+#define LIBTAS_WINEXINPUT_H_INCLUDED
+
+#include "global.h"
+
+namespace libtas {
+
+/* Hook XInput functions of the given library. All xinput versions
+ * (xinput1_3, xinput1_4, xinput9_1_0) export the same functions. */
+void hook_xinput(const char* library);
+
+}
+
+#endif
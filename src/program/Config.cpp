@@ -72,7 +72,12 @@ void Config::save(const std::string& gamepath) {
     settings.setValue("autosave_delay_sec", autosave_delay_sec);
     settings.setValue("autosave_frames", autosave_frames);
     settings.setValue("autosave_count", autosave_count);
+    settings.setValue("greenzone", greenzone);
+    settings.setValue("greenzone_interval", greenzone_interval);
+    settings.setValue("greenzone_memory", greenzone_memory);
     settings.setValue("auto_restart", auto_restart);
+    settings.setValue("launch_template", launch_template);
+    settings.setValue("hash_game_dir", hash_game_dir);
     settings.setValue("mouse_warp", mouse_warp);
     settings.setValue("use_proton", use_proton);
     settings.setValue("proton_path", proton_path.c_str());
@@ -123,9 +128,11 @@ void Config::save(const std::string& gamepath) {
     settings.setValue("osd_inputs_location", sc.osd_inputs_location);
     settings.setValue("prevent_savefiles", sc.prevent_savefiles);
     settings.setValue("recycle_threads", sc.recycle_threads);
+    settings.setValue("deferred_signals", sc.deferred_signals);
     settings.setValue("audio_bitdepth", sc.audio_bitdepth);
     settings.setValue("audio_channels", sc.audio_channels);
     settings.setValue("audio_frequency", sc.audio_frequency);
+    settings.setValue("audio_sink", sc.audio_sink);
     settings.setValue("audio_mute", sc.audio_mute);
     settings.setValue("audio_disabled", sc.audio_disabled);
     settings.setValue("video_codec", sc.video_codec);
@@ -139,8 +146,10 @@ void Config::save(const std::string& gamepath) {
     settings.setValue("opengl_performance", sc.opengl_performance);
     settings.setValue("async_events", sc.async_events);
     settings.setValue("wait_timeout", sc.wait_timeout);
+    settings.setValue("time_trap", sc.time_trap);
     settings.setValue("game_specific_timing", sc.game_specific_timing);
     settings.setValue("game_specific_sync", sc.game_specific_sync);
+    settings.setValue("engine_profile", sc.engine_profile);
     settings.setValue("variable_framerate", sc.variable_framerate);
 
     settings.beginWriteArray("main_gettimes_threshold");
@@ -196,7 +205,12 @@ void Config::load(const std::string& gamepath) {
     autosave_delay_sec = settings.value("autosave_delay_sec", autosave_delay_sec).toDouble();
     autosave_frames = settings.value("autosave_frames", autosave_frames).toInt();
     autosave_count = settings.value("autosave_count", autosave_count).toInt();
+    greenzone = settings.value("greenzone", greenzone).toBool();
+    greenzone_interval = settings.value("greenzone_interval", greenzone_interval).toInt();
+    greenzone_memory = settings.value("greenzone_memory", greenzone_memory).toInt();
     auto_restart = settings.value("auto_restart", auto_restart).toBool();
+    launch_template = settings.value("launch_template", launch_template).toBool();
+    hash_game_dir = settings.value("hash_game_dir", hash_game_dir).toBool();
     mouse_warp = settings.value("mouse_warp", mouse_warp).toBool();
     use_proton = settings.value("use_proton", use_proton).toBool();
     proton_path = settings.value("proton_path", "").toString().toStdString();
@@ -250,17 +264,21 @@ void Config::load(const std::string& gamepath) {
     sc.osd_inputs_location = settings.value("osd_inputs_location", sc.osd_inputs_location).toInt();
     sc.prevent_savefiles = settings.value("prevent_savefiles", sc.prevent_savefiles).toBool();
     sc.recycle_threads = settings.value("recycle_threads", sc.recycle_threads).toBool();
+    sc.deferred_signals = settings.value("deferred_signals", sc.deferred_signals).toBool();
     sc.audio_bitdepth = settings.value("audio_bitdepth", sc.audio_bitdepth).toInt();
     sc.audio_channels = settings.value("audio_channels", sc.audio_channels).toInt();
     sc.audio_frequency = settings.value("audio_frequency", sc.audio_frequency).toInt();
+    sc.audio_sink = settings.value("audio_sink", sc.audio_sink).toInt();
     sc.audio_mute = settings.value("audio_mute", sc.audio_mute).toBool();
     sc.audio_disabled = settings.value("audio_disabled", sc.audio_disabled).toBool();
     sc.locale = settings.value("locale", sc.locale).toInt();
     sc.virtual_steam = settings.value("virtual_steam", sc.virtual_steam).toBool();
     sc.async_events = settings.value("async_events", sc.async_events).toInt();
     sc.wait_timeout = settings.value("wait_timeout", sc.wait_timeout).toInt();
+    sc.time_trap = settings.value("time_trap", sc.time_trap).toInt();
     sc.game_specific_timing = settings.value("game_specific_timing", sc.game_specific_timing).toInt();
     sc.game_specific_sync = settings.value("game_specific_sync", sc.game_specific_sync).toInt();
+    sc.engine_profile = settings.value("engine_profile", sc.engine_profile).toBool();
     sc.variable_framerate = settings.value("variable_framerate", sc.variable_framerate).toBool();
 
     sc.video_codec = settings.value("video_codec", sc.video_codec).toInt();
@@ -102,12 +102,28 @@ public:
     /* Maximum number of autosaves for one movie */
     int autosave_count = 20;
 
+    /* Do we take greenzone states when the input editor is opened? */
+    bool greenzone = false;
+
+    /* Minimum number of frames between two greenzone states, near the
+     * current frame */
+    int greenzone_interval = 30;
+
+    /* Maximum memory used by greenzone states, in MB */
+    int greenzone_memory = 1024;
+
     /* List of recent existing gamepaths */
     std::list<std::string> recent_gamepaths;
 
     /* Do we restart the game when it exits? */
     bool auto_restart = false;
 
+    /* Keep a pre-forked game process to restart the game from */
+    bool launch_template = false;
+
+    /* Include the files of the game directory in the game hashes */
+    bool hash_game_dir = false;
+
     /* Warp the pointer at the center of the game screen after each frame */
     bool mouse_warp = false;
 
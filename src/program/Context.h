@@ -21,6 +21,7 @@
 #define LIBTAS_CONTEXT_H_INCLUDED
 
 #include <string>
+#include <map>
 #include "Config.h"
 // #include <X11/Xlib.h>
 #include <xcb/xcb.h>
@@ -54,6 +55,10 @@ struct Context {
     /* Crosshair cursor */
     xcb_cursor_t crosshair_cursor;
 
+    /* Did the X server accept detectable auto-repeat? If so, auto-repeat
+     * only generates key press events */
+    bool detectable_autorepeat = false;
+
     /* Recording status */
     enum FocusState {
         FOCUS_GAME = 0x01,
@@ -90,6 +95,12 @@ struct Context {
     /* PID of the game */
     pid_t game_pid;
 
+    /* Is the game forked from a launch template process */
+    bool use_template = false;
+
+    /* PID of the launch template, or 0 if none is running */
+    pid_t template_pid = 0;
+
     /* Attaching gdb? */
     bool attach_gdb = false;
 
@@ -120,6 +131,12 @@ struct Context {
     /* MD5 hash of the game executable that is stored in the movie */
     std::string md5_movie;
 
+    /* MD5 hashes of the game files (executable, libraries and data) */
+    std::map<std::string, std::string> game_hashes;
+
+    /* MD5 hashes of the game files that are stored in the movie */
+    std::map<std::string, std::string> movie_hashes;
+
     /* Current encoding segment. Sent when game is restarted */
     int encoding_segment = 0;
 
@@ -0,0 +1,297 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GameFingerprint.h"
+#include "utils.h"
+
+#include <QCryptographicHash>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <cstdio>
+#include <dirent.h> // opendir
+#include <sys/stat.h> // stat
+
+/* Size of each read when hashing a file */
+#define HASH_CHUNK_SIZE (1024*1024)
+
+/* Entry of the hash cache */
+struct CacheEntry {
+    ino_t inode;
+    off_t size;
+    time_t mtime_sec;
+    long mtime_nsec;
+    std::string md5;
+};
+
+static std::string cachePath(const std::string& configdir)
+{
+    return configdir + "/hashcache.txt";
+}
+
+/* Load the cache file. Each line has the format:
+ * <md5> <inode> <size> <mtime_sec> <mtime_nsec> <path> */
+static void loadCache(const std::string& configdir, std::map<std::string, CacheEntry>& cache)
+{
+    std::ifstream file(cachePath(configdir));
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+        CacheEntry entry;
+        unsigned long long inode, size;
+        long long mtime_sec;
+        iss >> entry.md5 >> inode >> size >> mtime_sec >> entry.mtime_nsec;
+        if (iss.fail())
+            continue;
+        entry.inode = inode;
+        entry.size = size;
+        entry.mtime_sec = mtime_sec;
+
+        /* The path is the remaining of the line, and may contain spaces */
+        std::string path;
+        iss.get();
+        std::getline(iss, path);
+        if (!path.empty())
+            cache[path] = entry;
+    }
+}
+
+static void saveCache(const std::string& configdir, const std::map<std::string, CacheEntry>& cache)
+{
+    /* Write in a temporary file and rename, so that two instances of libTAS
+     * cannot leave a truncated cache */
+    std::string path = cachePath(configdir);
+    std::string tmppath = path + ".tmp";
+    std::ofstream file(tmppath);
+    if (!file)
+        return;
+
+    for (auto& it : cache) {
+        file << it.second.md5 << " " << static_cast<unsigned long long>(it.second.inode)
+             << " " << static_cast<unsigned long long>(it.second.size)
+             << " " << static_cast<long long>(it.second.mtime_sec)
+             << " " << it.second.mtime_nsec << " " << it.first << "\n";
+    }
+
+    file.close();
+    if (file)
+        rename(tmppath.c_str(), path.c_str());
+}
+
+/* Compute the MD5 hash of a file, or return an empty string on error */
+static std::string hashFile(const std::string& path, std::vector<char>& buf)
+{
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f)
+        return "";
+
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    size_t n;
+    while ((n = fread(buf.data(), 1, buf.size(), f)) > 0) {
+        hash.addData(buf.data(), n);
+    }
+
+    bool error = ferror(f);
+    fclose(f);
+    if (error)
+        return "";
+
+    return hash.result().toHex().toStdString();
+}
+
+std::map<std::string, std::string> GameFingerprint::hashFiles(const std::string& configdir, const std::vector<std::string>& paths)
+{
+    std::map<std::string, std::string> hashes;
+
+    std::map<std::string, CacheEntry> cache;
+    loadCache(configdir, cache);
+
+    /* Look for files that are missing or outdated in the cache */
+    std::vector<std::pair<std::string, CacheEntry>> todo;
+    for (const std::string& path : paths) {
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+            continue;
+
+        auto it = cache.find(path);
+        if ((it != cache.end()) && (it->second.inode == st.st_ino) &&
+            (it->second.size == st.st_size) && (it->second.mtime_sec == st.st_mtim.tv_sec) &&
+            (it->second.mtime_nsec == st.st_mtim.tv_nsec)) {
+            hashes[path] = it->second.md5;
+            continue;
+        }
+
+        CacheEntry entry;
+        entry.inode = st.st_ino;
+        entry.size = st.st_size;
+        entry.mtime_sec = st.st_mtim.tv_sec;
+        entry.mtime_nsec = st.st_mtim.tv_nsec;
+        todo.emplace_back(path, entry);
+    }
+
+    if (todo.empty())
+        return hashes;
+
+    /* Hash the remaining files in parallel. Each worker picks the next file
+     * to process, so that one large file does not stall the others. */
+    std::atomic<size_t> next(0);
+    unsigned int nb_threads = std::thread::hardware_concurrency();
+    if (nb_threads == 0)
+        nb_threads = 1;
+    if (nb_threads > todo.size())
+        nb_threads = todo.size();
+
+    auto worker = [&todo, &next]() {
+        std::vector<char> buf(HASH_CHUNK_SIZE);
+        size_t i;
+        while ((i = next++) < todo.size()) {
+            todo[i].second.md5 = hashFile(todo[i].first, buf);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < nb_threads; t++)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& t : threads)
+        t.join();
+
+    for (auto& file : todo) {
+        if (file.second.md5.empty())
+            continue;
+        hashes[file.first] = file.second.md5;
+        cache[file.first] = file.second;
+    }
+
+    saveCache(configdir, cache);
+    return hashes;
+}
+
+/* Recursively list all regular files inside a directory */
+static void listFiles(const std::string& dir, std::vector<std::string>& files)
+{
+    DIR* d = opendir(dir.c_str());
+    if (!d)
+        return;
+
+    struct dirent* ent;
+    while ((ent = readdir(d)) != nullptr) {
+        std::string name = ent->d_name;
+        if (name == "." || name == "..")
+            continue;
+
+        std::string path = dir + "/" + name;
+        struct stat st;
+        if (lstat(path.c_str(), &st) != 0)
+            continue;
+
+        if (S_ISDIR(st.st_mode))
+            listFiles(path, files);
+        else if (S_ISREG(st.st_mode))
+            files.push_back(path);
+    }
+    closedir(d);
+}
+
+void GameFingerprint::compute(Context* context)
+{
+    context->md5_game.clear();
+    context->game_hashes.clear();
+
+    /* Files are stored in the movie with a name that does not depend on
+     * where the game is installed */
+    std::vector<std::string> paths;
+    std::vector<std::string> names;
+
+    paths.push_back(context->gamepath);
+    names.push_back(context->gamename);
+
+    if (!context->config.libdir.empty()) {
+        std::vector<std::string> libs;
+        listFiles(context->config.libdir, libs);
+        for (const std::string& lib : libs) {
+            paths.push_back(lib);
+            names.push_back("lib" + lib.substr(context->config.libdir.size()));
+        }
+    }
+
+    if (context->config.hash_game_dir) {
+        std::string gamedir = context->gamepath.substr(0, context->gamepath.find_last_of('/'));
+        std::vector<std::string> datafiles;
+        listFiles(gamedir, datafiles);
+        for (const std::string& data : datafiles) {
+            if (data == context->gamepath)
+                continue;
+            paths.push_back(data);
+            names.push_back("data" + data.substr(gamedir.size()));
+        }
+    }
+
+    std::map<std::string, std::string> hashes = hashFiles(context->config.configdir, paths);
+
+    for (size_t i = 0; i < paths.size(); i++) {
+        auto it = hashes.find(paths[i]);
+        if (it != hashes.end())
+            context->game_hashes[names[i]] = it->second;
+    }
+
+    auto it = hashes.find(context->gamepath);
+    if (it != hashes.end())
+        context->md5_game = it->second;
+}
+
+std::string GameFingerprint::compare(const std::map<std::string, std::string>& game_hashes, const std::map<std::string, std::string>& movie_hashes)
+{
+    std::ostringstream oss;
+    int count = 0;
+
+    /* Only report missing data files if the game directory was hashed */
+    bool has_data = false;
+    for (auto& game_hash : game_hashes) {
+        if (game_hash.first.compare(0, 5, "data/") == 0) {
+            has_data = true;
+            break;
+        }
+    }
+
+    for (auto& movie_hash : movie_hashes) {
+        auto it = game_hashes.find(movie_hash.first);
+        if (it == game_hashes.end()) {
+            if (!has_data && (movie_hash.first.compare(0, 5, "data/") == 0))
+                continue;
+            oss << "\n" << movie_hash.first << " is missing";
+        }
+        else if (it->second != movie_hash.second) {
+            oss << "\n" << movie_hash.first << " is different";
+        }
+        else {
+            continue;
+        }
+
+        /* Don't flood the message box */
+        if (++count == 10) {
+            oss << "\n...";
+            break;
+        }
+    }
+
+    return oss.str();
+}
@@ -0,0 +1,49 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBTAS_GAMEFINGERPRINT_H_INCLUDED
+#define LIBTAS_GAMEFINGERPRINT_H_INCLUDED
+
+#include "Context.h"
+
+#include <string>
+#include <vector>
+#include <map>
+
+/* Identify the game files with their MD5 hashes, without spawning external
+ * processes. Hashes are cached in the config directory, keyed by the path,
+ * inode, size and modification time of each file, so that only new or
+ * modified files are read again. Files are hashed in parallel.
+ */
+namespace GameFingerprint {
+    /* Compute the hash of the game executable into `context->md5_game`, and
+     * the hashes of the executable, the game libraries and (if enabled) the
+     * game directory into `context->game_hashes` */
+    void compute(Context* context);
+
+    /* Hash a list of files, using and updating the cache. Returns the
+     * hashes indexed by file path, files that cannot be read are omitted. */
+    std::map<std::string, std::string> hashFiles(const std::string& configdir, const std::vector<std::string>& paths);
+
+    /* Return a description of the files whose hash differ between the game
+     * and the movie, or an empty string if none */
+    std::string compare(const std::map<std::string, std::string>& game_hashes, const std::map<std::string, std::string>& movie_hashes);
+}
+
+#endif
@@ -20,16 +20,24 @@
 #include "config.h"
 #include "GameLoop.h"
 #include "GameThread.h"
+#include "GameFingerprint.h"
+#include "RawPointer.h"
 #include "utils.h"
 #include "AutoSave.h"
+#include "GreenZone.h"
 #include "SaveState.h"
 #include "SaveStateList.h"
+#include "WatchpointList.h"
 #include "lua/Input.h"
 #include "lua/Main.h"
+#include "lua/Memory.h"
+#include "lua/Movie.h"
+#include "lua/Savestate.h"
 
 #include "../shared/sockethelpers.h"
 #include "../shared/SharedConfig.h"
 #include "../shared/messages.h"
+#include "../shared/FrameProfile.h"
 
 #include <xcb/xcb.h>
 #include <xcb/xcb_keysyms.h>
@@ -52,6 +60,14 @@ void GameLoop::start()
     init();
     initProcessMessages();
 
+    Lua::Movie::registerMovie(&movie,
+        [this]() { emit inputsToBeChanged(); },
+        [this]() { emit inputsChanged(); });
+
+    Lua::Savestate::setStateFunctions(
+        [this](int slot) { return luaSaveState(slot); },
+        [this](int slot) { return luaLoadState(slot); });
+
     Lua::Main::callLua(context, "onStartup");
 
     while (1)
@@ -63,13 +79,31 @@ void GameLoop::start()
         }
 
         /* We are at a frame boundary */
+
+        /* Take a greenzone state if the input editor is opened */
+        if (context->game_window && context->config.greenzone &&
+            (context->config.sc.recording != SharedConfig::NO_RECORDING) &&
+            !context->config.sc.av_dumping) {
+            bool editorVisible = false;
+            emit isInputEditorVisible(editorVisible);
+            if (editorVisible)
+                GreenZone::update(context, movie);
+        }
+
         /* If we did not yet receive the game window id, just make the game running */
         bool endInnerLoop = false;
         if (context->game_window ) do {
 
-            /* Check if game is still running */
-            int ret = waitpid(context->fork_pid, nullptr, WNOHANG);
-            if (ret == context->fork_pid) {
+            /* Check if game is still running. Processes forked from the
+             * launch template are not our children, so we only check that
+             * the pid still exists. */
+            bool closed;
+            if (context->use_template)
+                closed = (kill(context->game_pid, 0) != 0);
+            else
+                closed = (waitpid(context->fork_pid, nullptr, WNOHANG) == context->fork_pid);
+
+            if (closed) {
                 emit alertToShow(QString("Game was closed"));
                 loopExit();
                 return;
@@ -92,14 +126,22 @@ void GameLoop::start()
                 hasFrameAdvanced = processEvent(eventType, hk);
             }
 
+            /* Lua coroutines waiting on movie.frameAdvance() drive the game
+             * themselves, even when paused */
             endInnerLoop = context->config.sc.running || ar_advance ||
-                hasFrameAdvanced || (context->status == Context::QUITTING);
+                hasFrameAdvanced || (context->status == Context::QUITTING) ||
+                Lua::Main::hasWaitingCoroutines();
 
             if (!endInnerLoop) {
                 sleepSendPreview();
             }
         } while (!endInnerLoop);
 
+        /* Resume lua coroutines at the frame boundary, where they are
+         * allowed to save and load states */
+        if (context->status != Context::QUITTING)
+            Lua::Main::resumeCoroutines(context);
+
         AllInputs ai;
         processInputs(ai);
         prev_ai = ai;
@@ -181,30 +223,60 @@ void GameLoop::init()
 
     /* Init savestate list */
     SaveStateList::init(context);
+    GreenZone::init();
+
+    /* The new game process has no watchpoint yet */
+    WatchpointList::invalidate();
+
+    /* Determine if the game can be started from a launch template. Wine games
+     * delay our initialization, and gdb must execute the game itself. */
+    if (context->status != Context::RESTARTING) {
+        int gameArch = extractBinaryType(context->gamepath);
+        context->use_template = context->config.launch_template &&
+            !context->attach_gdb && ((gameArch == BT_ELF32) || (gameArch == BT_ELF64));
+    }
 
-    /* We fork here so that the child process calls the game */
-    context->fork_pid = fork();
-    if (context->fork_pid == 0) {
-        GameThread::launch(context);
+    /* Check that the launch template is still alive. It is our child, so
+     * this also reaps it if it died */
+    if (context->template_pid && (waitpid(context->template_pid, nullptr, WNOHANG) != 0))
+        context->template_pid = 0;
+
+    /* We fork here so that the child process calls the game, except when
+     * restarting from a launch template */
+    if (!context->use_template || !context->template_pid) {
+        context->fork_pid = fork();
+        if (context->fork_pid == 0) {
+            GameThread::launch(context);
+        }
+    }
+
+    /* Get a new game process from the launch template */
+    if (context->use_template) {
+        if (!requestTemplateFork(&context->template_pid, &context->game_pid)) {
+            emit alertToShow(QString("Could not get a game process from the launch template, starting the game normally"));
+
+            /* The template is the process that we forked. It may be stuck or
+             * running the game itself, so terminate it before starting the
+             * game without a template. */
+            kill(context->fork_pid, SIGKILL);
+            waitpid(context->fork_pid, nullptr, 0);
+            removeTemplateSocket();
+            context->template_pid = 0;
+            context->use_template = false;
+
+            context->fork_pid = fork();
+            if (context->fork_pid == 0) {
+                GameThread::launch(context);
+            }
+        }
     }
 
     ar_ticks = -1;
     ar_delay = 50;
     ar_freq = 2;
 
-    /* Compute the MD5 hash of the game binary */
-    context->md5_game.clear();
-    std::ostringstream cmd;
-    cmd << "md5sum -b \"" << context->gamepath << "\" 2> /dev/null";
-
-    FILE *md5str = popen(cmd.str().c_str(), "r");
-    if (md5str != NULL) {
-        std::array<char,33> buf;
-        if (fgets(buf.data(), buf.size(), md5str) != nullptr) {
-            context->md5_game.assign(buf.data());
-        }
-        pclose(md5str);
-    }
+    /* Compute the MD5 hashes of the game files, while the game is starting */
+    GameFingerprint::compute(context);
 
     /* Only open the movie if we did not restart */
     if (context->status != Context::RESTARTING) {
@@ -225,6 +297,11 @@ void GameLoop::init()
             /* Check md5 match */
             if ((!context->md5_movie.empty()) && (context->md5_game.compare(context->md5_movie) != 0))
                 emit alertToShow(QString("Game executable hash does not match with the hash stored in the movie!"));
+            else {
+                std::string diff = GameFingerprint::compare(context->game_hashes, context->movie_hashes);
+                if (!diff.empty())
+                    emit alertToShow(QString("Game files do not match with the hashes stored in the movie:%1").arg(diff.c_str()));
+            }
 
         }
         else {
@@ -364,6 +441,7 @@ void GameLoop::initProcessMessages()
 bool GameLoop::startFrameMessages()
 {
     bool draw_frame = true;
+    std::vector<WatchpointHit> watchpoint_hits;
     
     /* Wait for frame boundary */
     int message = receiveMessage();
@@ -459,6 +537,21 @@ bool GameLoop::startFrameMessages()
         case MSGB_NONDRAW_FRAME:
             draw_frame = false;
             break;
+        case MSGB_WATCHPOINT_HIT:
+        {
+            WatchpointHit hit;
+            receiveData(&hit, sizeof(WatchpointHit));
+            WatchpointList::addHit(hit);
+            watchpoint_hits.push_back(hit);
+            break;
+        }
+        case MSGB_FRAME_PROFILE:
+        {
+            /* Only used by the frame boundary benchmark */
+            FrameProfile profile;
+            receiveData(&profile, sizeof(FrameProfile));
+            break;
+        }
 
         case MSGB_QUIT:
             if (!context->interactive) {
@@ -494,9 +587,14 @@ bool GameLoop::startFrameMessages()
         }
     }
 
-    /* Execute the lua callback onPaint here */
+    /* Execute the lua callbacks of watchpoints, then onPaint */
+    for (const WatchpointHit& hit : watchpoint_hits)
+        Lua::Memory::callWatchpoint(context, hit);
     Lua::Main::callLua(context, "onPaint");
 
+    /* Send watchpoints if they changed */
+    WatchpointList::send();
+
     sendMessage(MSGN_START_FRAMEBOUNDARY);
 
     return false;
@@ -544,20 +642,19 @@ uint8_t GameLoop::nextEvent(struct HotKey &hk)
                  * supported or not by the X server.
                  * If detectable auto-repeat is supported, we detect if pressed
                  * event is from the same key as the last pressed key, without
-                 * a key release.
+                 * a key release. Release events are always genuine.
                  * If detectable auto-repeat is not supported, we detect if a
                  * released event is followed by a pressed event with the same
-                 * sequence number. If not, we must keep the later event for
+                 * timestamp. If not, we must keep the later event for
                  * the next call (xcb does not support peeking events).
                  */
                 if (kc == last_pressed_key) {
-                    if (response_type == XCB_KEY_RELEASE) {
-                        /* Check the next event. We wait a bit for the next
-                         * event to be generated if auto-repeat. There are still
-                         * are few cases where we would have to wait a significantly
-                         * longer time.
+                    if ((response_type == XCB_KEY_RELEASE) && !context->detectable_autorepeat) {
+                        /* Check the next event. The server generates both
+                         * events of an auto-repeat sequence at the same time,
+                         * so we don't wait for it, which would stall the
+                         * frame loop on each key release.
                          */
-                        usleep(500);
                         next_event = xcb_poll_for_event(context->conn);
                         xcb_key_press_event_t* next_key_event = reinterpret_cast<xcb_key_press_event_t*>(next_event);
 
@@ -572,7 +669,9 @@ uint8_t GameLoop::nextEvent(struct HotKey &hk)
                             next_event = nullptr;
                             continue;
                         }
+                    }
 
+                    if (response_type == XCB_KEY_RELEASE) {
                         /* Normal key release */
                         last_pressed_key = 0;
                     }
@@ -792,6 +891,7 @@ bool GameLoop::processEvent(uint8_t type, struct HotKey &hk)
                 /* Loading the movie */
                 emit inputsToBeChanged();
                 movie.loadSavestateMovie(SaveStateList::get(statei).getMoviePath());
+                GreenZone::invalidate(context->framecount);
                 emit inputsChanged();
 
                 /* Return if we already are on the correct frame */
@@ -853,6 +953,19 @@ bool GameLoop::processEvent(uint8_t type, struct HotKey &hk)
             return false;
         }
 
+        case HOTKEY_LOADGREENZONE:
+        {
+            /* Loading is not allowed if currently encoding */
+            if (context->config.sc.av_dumping)
+                return false;
+
+            int slot = GreenZone::takeLoadRequest();
+            if (slot != -1)
+                loadGreenZoneState(slot);
+
+            return false;
+        }
+
         case HOTKEY_READWRITE:
             /* Switch between movie write and read-only */
             switch (context->config.sc.recording) {
@@ -928,38 +1041,57 @@ bool GameLoop::processEvent(uint8_t type, struct HotKey &hk)
                     std::cerr << "error in xcb_change_window_attributes: " << error->error_code << std::endl;
                 }
 
-                /* Wait for a mouse press. We cannot use mouse press events
+                /* Wait for a mouse click. We cannot use mouse press events
                  * because only one window can select mouse press events.
-                 * So we are using the mouse query function.
+                 * We use XInput2 raw events if available, otherwise we
+                 * poll the mouse query function.
                  */
-                usleep(500*1000);
-
-                xcb_query_pointer_cookie_t pointer_cookie = xcb_query_pointer(context->conn, context->game_window);
-                xcb_query_pointer_reply_t* pointer_reply = xcb_query_pointer_reply(context->conn, pointer_cookie, nullptr);
-
-                while (!(pointer_reply->mask & XCB_BUTTON_MASK_1)) {
-                    free(pointer_reply);
-                    usleep(10*1000);
+                RawPointer rawPointer;
+                xcb_query_pointer_cookie_t pointer_cookie;
+                xcb_query_pointer_reply_t* pointer_reply = nullptr;
+
+                /* Give up after some time without a click, so that the UI
+                 * is not stuck */
+                RawPointer::ClickStatus click = rawPointer.waitClick(1, 10000);
+                if (click == RawPointer::CLICK_DONE) {
                     pointer_cookie = xcb_query_pointer(context->conn, context->game_window);
                     pointer_reply = xcb_query_pointer_reply(context->conn, pointer_cookie, nullptr);
                 }
+                else if (click == RawPointer::CLICK_TIMEOUT) {
+                    std::cerr << "Mouse calibration cancelled: no click" << std::endl;
+                }
+                else {
+                    usleep(500*1000);
 
-                /* Wait for mouse release */
-                while (pointer_reply->mask & XCB_BUTTON_MASK_1) {
-                    free(pointer_reply);
-                    usleep(10*1000);
                     pointer_cookie = xcb_query_pointer(context->conn, context->game_window);
                     pointer_reply = xcb_query_pointer_reply(context->conn, pointer_cookie, nullptr);
+
+                    while (!(pointer_reply->mask & XCB_BUTTON_MASK_1)) {
+                        free(pointer_reply);
+                        usleep(10*1000);
+                        pointer_cookie = xcb_query_pointer(context->conn, context->game_window);
+                        pointer_reply = xcb_query_pointer_reply(context->conn, pointer_cookie, nullptr);
+                    }
+
+                    /* Wait for mouse release */
+                    while (pointer_reply->mask & XCB_BUTTON_MASK_1) {
+                        free(pointer_reply);
+                        usleep(10*1000);
+                        pointer_cookie = xcb_query_pointer(context->conn, context->game_window);
+                        pointer_reply = xcb_query_pointer_reply(context->conn, pointer_cookie, nullptr);
+                    }
                 }
 
-                int pointer_x = pointer_reply->win_x;
-                int pointer_y = pointer_reply->win_y;
+                if (pointer_reply) {
+                    int pointer_x = pointer_reply->win_x;
+                    int pointer_y = pointer_reply->win_y;
 
-                free(pointer_reply);
+                    free(pointer_reply);
 
-                /* Set our calibration offsets */
-                pointer_offset_x = prev_ai.pointer_x - pointer_x;
-                pointer_offset_y = prev_ai.pointer_y - pointer_y;
+                    /* Set our calibration offsets */
+                    pointer_offset_x = prev_ai.pointer_x - pointer_x;
+                    pointer_offset_y = prev_ai.pointer_y - pointer_y;
+                }
 
                 /* Switch back to default cursor */
                 value_list = 0;
@@ -1069,6 +1201,7 @@ void GameLoop::processInputs(AllInputs &ai)
             /* Call lua onInput() here so that a script can modify inputs */
             Lua::Input::registerInputs(&ai);
             Lua::Main::callLua(context, "onInput");
+            Lua::Input::registerInputs(nullptr);
 
             if (context->config.sc.recording == SharedConfig::RECORDING_WRITE) {
                 /* If the input editor is visible, we should keep future inputs.
@@ -1261,7 +1394,7 @@ void GameLoop::loopExit()
         SaveStateList::backupMovies();
 
         /* wait on the game process to terminate */
-        wait(nullptr);
+        waitGame();
 
         context->status = Context::RESTARTING;
         emit statusChanged();
@@ -1298,8 +1431,86 @@ void GameLoop::loopExit()
     context->framecount = 0;
 
     /* wait on the game process to terminate */
-    wait(nullptr);
+    waitGame();
+
+    /* Terminate the launch template */
+    if (context->use_template && context->template_pid) {
+        kill(context->template_pid, SIGKILL);
+        waitpid(context->template_pid, nullptr, 0);
+        context->template_pid = 0;
+        removeTemplateSocket();
+    }
 
     context->status = Context::INACTIVE;
     emit statusChanged();
 }
+
+void GameLoop::waitGame()
+{
+    if (context->use_template) {
+        /* The launch template reaps the game process, just wait for its pid
+         * to disappear */
+        struct timespec tim = {0, 10L*1000L*1000L};
+        while (kill(context->game_pid, 0) == 0)
+            nanosleep(&tim, NULL);
+    }
+    else {
+        wait(nullptr);
+    }
+}
+
+bool GameLoop::luaSaveState(int slot)
+{
+    if (context->config.sc.av_dumping)
+        return false;
+
+    int message = SaveStateList::save(slot, context, movie);
+    if (message != MSGB_SAVING_SUCCEEDED)
+        return false;
+
+    emit savestatePerformed(slot, context->framecount);
+    return true;
+}
+
+bool GameLoop::luaLoadState(int slot)
+{
+    if (context->config.sc.av_dumping)
+        return false;
+
+    /* Errors are only reported to the script, without prompting the user,
+     * so that a search can continue unattended */
+    int error = SaveStateList::load(slot, context, movie, false);
+    if (error < 0)
+        return false;
+
+    emit inputsToBeChanged();
+    int message = SaveStateList::postLoad(slot, context, movie, false);
+    emit inputsChanged();
+
+    if (message != MSGB_LOADING_SUCCEEDED)
+        return false;
+
+    emit savestatePerformed(slot, 0);
+    return true;
+}
+
+bool GameLoop::loadGreenZoneState(int slot)
+{
+    int error = SaveStateList::load(slot, context, movie, false);
+    if (error < 0)
+        return false;
+
+    /* Greenzone states don't store a movie, the current inputs are kept */
+    emit inputsToBeChanged();
+    int message = SaveStateList::postLoad(slot, context, movie, false);
+    emit inputsChanged();
+
+    if (message == SaveState::ENOLOAD) {
+        if (!context->config.sc.opengl_soft) {
+            emit alertToShow(QString("Crash after loading the savestate. Savestates are unstable unless you check Video>Force software rendering"));
+        }
+        return false;
+    }
+
+    return message == MSGB_LOADING_SUCCEEDED;
+}
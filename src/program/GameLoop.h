@@ -91,6 +91,17 @@ private:
 
     void loopExit();
 
+    /* Wait on the game process to terminate */
+    void waitGame();
+
+    /* Save and load states on behalf of a lua script. Returns if the
+     * operation succeeded. */
+    bool luaSaveState(int slot);
+    bool luaLoadState(int slot);
+
+    /* Load a greenzone state requested by the input editor */
+    bool loadGreenZoneState(int slot);
+
 signals:
     void statusChanged();
     void configChanged();
@@ -114,6 +114,10 @@ void GameThread::launch(Context *context)
 
     setenv("LIBTAS_START_FRAME", std::to_string(context->framecount).c_str(), 1);
 
+    /* Ask the game to wait for fork requests before its main */
+    if (context->use_template)
+        setenv("LIBTAS_LAUNCH_TEMPLATE", "1", 1);
+
 
     /* Disable Address Space Layout Randomization for the game, so that ram
      * watch addresses do not change on game restart.
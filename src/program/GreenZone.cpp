@@ -0,0 +1,272 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GreenZone.h"
+#include "SaveStateList.h"
+#include "../shared/SharedConfig.h"
+#include "../shared/messages.h"
+
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <sys/stat.h> // stat
+#include <unistd.h> // sysconf
+
+/* Number of states for each density level. The interval between states
+ * doubles after each level */
+#define STATES_PER_LEVEL 8
+
+struct GreenZoneState {
+    bool valid = false;
+    uint64_t framecount = 0;
+    /* Estimated memory used by the state, in bytes */
+    uint64_t size = 0;
+};
+
+static GreenZoneState states[SharedConfig::SS_SLOT_GREENZONE_COUNT];
+
+/* Lowest frame whose inputs changed while a state was being saved */
+static uint64_t invalid_during_save = UINT64_MAX;
+
+static int load_request = -1;
+
+static std::mutex mutex;
+
+/* Is a state at this frame part of the greenzone, seen from the current frame */
+static bool isWanted(uint64_t framecount, uint64_t current, int interval)
+{
+    uint64_t distance = (framecount > current) ? (framecount - current) : (current - framecount);
+    uint64_t step = interval;
+
+    while (distance >= STATES_PER_LEVEL * step) {
+        distance -= STATES_PER_LEVEL * step;
+        step *= 2;
+    }
+
+    return (framecount % step) == 0;
+}
+
+/* Estimate the size of a state just saved. States stored on disk are measured
+ * directly. States stored in RAM cannot be inspected from here, so we use the
+ * resident memory of the game, which is an upper bound of a full state. */
+static uint64_t estimateSize(Context* context, int slot)
+{
+    if (!(context->config.sc.savestate_settings & SharedConfig::SS_RAM)) {
+        std::string path = context->config.savestatedir + '/';
+        path += context->gamename;
+        path += ".state" + std::to_string(slot);
+
+        uint64_t size = 0;
+        struct stat sb;
+        if (stat((path + ".pm").c_str(), &sb) == 0)
+            size += sb.st_size;
+        if (stat((path + ".p").c_str(), &sb) == 0)
+            size += sb.st_size;
+        return size;
+    }
+
+    std::ifstream statm("/proc/" + std::to_string(context->game_pid) + "/statm");
+    uint64_t total = 0, resident = 0;
+    statm >> total >> resident;
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+/* Returns the index of the state to evict, or -1 if none is valid. States
+ * that are not wanted anymore go first, starting with the farthest one. */
+static int victim(uint64_t current, int interval)
+{
+    int best = -1;
+    bool best_wanted = true;
+    uint64_t best_distance = 0;
+
+    for (int i = 0; i < SharedConfig::SS_SLOT_GREENZONE_COUNT; i++) {
+        if (!states[i].valid)
+            continue;
+
+        bool wanted = isWanted(states[i].framecount, current, interval);
+        uint64_t distance = (states[i].framecount > current) ?
+            (states[i].framecount - current) : (current - states[i].framecount);
+
+        if ((best == -1) || (best_wanted && !wanted) ||
+            ((best_wanted == wanted) && (distance > best_distance))) {
+            best = i;
+            best_wanted = wanted;
+            best_distance = distance;
+        }
+    }
+
+    return best;
+}
+
+void GreenZone::init()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (int i = 0; i < SharedConfig::SS_SLOT_GREENZONE_COUNT; i++)
+        states[i] = GreenZoneState();
+
+    invalid_during_save = UINT64_MAX;
+    load_request = -1;
+}
+
+void GreenZone::update(Context* context, MovieFile& movie)
+{
+    int interval = context->config.greenzone_interval;
+    if (interval <= 0)
+        return;
+
+    uint64_t current = context->framecount;
+    if ((current == 0) || (current % interval))
+        return;
+
+    uint64_t budget = static_cast<uint64_t>(context->config.greenzone_memory) * 1024 * 1024;
+    int index = -1;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        /* Drop from the branch the states that were invalidated by the UI */
+        uint64_t used = 0;
+        uint64_t state_size = 0;
+        for (int i = 0; i < SharedConfig::SS_SLOT_GREENZONE_COUNT; i++) {
+            SaveState& ss = SaveStateList::get(SharedConfig::SS_SLOT_GREENZONE + i);
+            if (!states[i].valid && ss.framecount)
+                SaveStateList::release(SharedConfig::SS_SLOT_GREENZONE + i, context);
+
+            if (states[i].valid) {
+                if (states[i].framecount == current)
+                    return;
+                used += states[i].size;
+                state_size = std::max(state_size, states[i].size);
+            }
+        }
+
+        /* Use the largest known state as estimate for the new one */
+        if (budget && (state_size > budget))
+            return;
+
+        /* Make room for the new state */
+        while (true) {
+            for (index = 0; index < SharedConfig::SS_SLOT_GREENZONE_COUNT; index++)
+                if (!states[index].valid)
+                    break;
+
+            bool over_budget = budget && ((used + state_size) > budget);
+            if ((index < SharedConfig::SS_SLOT_GREENZONE_COUNT) && !over_budget)
+                break;
+
+            int v = victim(current, interval);
+            if (v == -1)
+                break;
+
+            states[v].valid = false;
+            used -= states[v].size;
+            SaveStateList::release(SharedConfig::SS_SLOT_GREENZONE + v, context);
+        }
+
+        if (index == SharedConfig::SS_SLOT_GREENZONE_COUNT)
+            return;
+
+        invalid_during_save = UINT64_MAX;
+    }
+
+    /* Saving communicates with the game, so don't keep the UI waiting on
+     * the lock meanwhile */
+    int slot = SharedConfig::SS_SLOT_GREENZONE + index;
+    int message = SaveStateList::save(slot, context, movie);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (message != MSGB_SAVING_SUCCEEDED)
+        return;
+
+    /* Inputs may have been edited before this frame while we were saving */
+    if (current > invalid_during_save) {
+        SaveStateList::release(slot, context);
+        return;
+    }
+
+    states[index].valid = true;
+    states[index].framecount = current;
+    states[index].size = estimateSize(context, slot);
+}
+
+void GreenZone::invalidate(uint64_t frame)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (int i = 0; i < SharedConfig::SS_SLOT_GREENZONE_COUNT; i++) {
+        if (states[i].valid && (states[i].framecount > frame))
+            states[i].valid = false;
+    }
+
+    if (frame < invalid_during_save)
+        invalid_during_save = frame;
+}
+
+int GreenZone::nearestState(uint64_t framecount)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    int best = -1;
+    for (int i = 0; i < SharedConfig::SS_SLOT_GREENZONE_COUNT; i++) {
+        if (!states[i].valid || (states[i].framecount > framecount))
+            continue;
+        if ((best == -1) || (states[i].framecount > states[best].framecount))
+            best = i;
+    }
+
+    if (best == -1)
+        return -1;
+
+    return SharedConfig::SS_SLOT_GREENZONE + best;
+}
+
+uint64_t GreenZone::stateFramecount(int slot)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    int i = slot - SharedConfig::SS_SLOT_GREENZONE;
+    if ((i < 0) || (i >= SharedConfig::SS_SLOT_GREENZONE_COUNT) || !states[i].valid)
+        return 0;
+
+    return states[i].framecount;
+}
+
+void GreenZone::requestLoad(int slot)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    load_request = slot;
+}
+
+int GreenZone::takeLoadRequest()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    int slot = load_request;
+    load_request = -1;
+
+    /* The state may have been invalidated in the meantime */
+    int i = slot - SharedConfig::SS_SLOT_GREENZONE;
+    if ((i < 0) || (i >= SharedConfig::SS_SLOT_GREENZONE_COUNT) || !states[i].valid)
+        return -1;
+
+    return slot;
+}
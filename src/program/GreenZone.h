@@ -0,0 +1,60 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBTAS_GREENZONE_H_INCLUDED
+#define LIBTAS_GREENZONE_H_INCLUDED
+
+#include "Context.h"
+#include "movie/MovieFile.h"
+#include <stdint.h>
+
+/* Savestates taken automatically while the input editor is opened, so that
+ * seeking to any past frame only needs to fast-forward a few frames. States
+ * are denser around the current frame, and get sparser with the distance.
+ * They use their own savestate slots and are only valid as long as the inputs
+ * before them are unchanged. It can be accessed from both the UI thread and
+ * the game loop thread. */
+namespace GreenZone {
+
+    /* Forget all greenzone states, when starting a new game */
+    void init();
+
+    /* Take a greenzone state at the current frame if needed, evicting states
+     * to stay within the slot count and memory budget. Must be called at the
+     * frame boundary. */
+    void update(Context* context, MovieFile& movie);
+
+    /* Inputs from this frame have changed, so drop all states that were taken
+     * after it */
+    void invalidate(uint64_t frame);
+
+    /* Returns the slot of the latest valid state not after framecount, or -1 */
+    int nearestState(uint64_t framecount);
+
+    /* Returns the frame of a valid state slot */
+    uint64_t stateFramecount(int slot);
+
+    /* Ask the game loop to load a greenzone state, and get the requested slot,
+     * or -1 if none */
+    void requestLoad(int slot);
+    int takeLoadRequest();
+
+}
+
+#endif
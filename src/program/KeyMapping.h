@@ -79,6 +79,7 @@ typedef int HotKeyType; enum
     HOTKEY_LOADBRANCH8,
     HOTKEY_LOADBRANCH9,
     HOTKEY_LOADBRANCH_BACKTRACK,
+    HOTKEY_LOADGREENZONE, // Load the greenzone state requested by the input editor, cannot be mapped
     HOTKEY_LEN
 };
 
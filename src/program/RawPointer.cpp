@@ -0,0 +1,165 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include "RawPointer.h"
+
+#include <iostream>
+#include <cstdlib>
+#include <poll.h>
+#include <time.h>
+
+#ifdef LIBTAS_HAS_XCB_XINPUT
+#include <xcb/xinput.h>
+#endif
+
+RawPointer::RawPointer()
+{
+#ifdef LIBTAS_HAS_XCB_XINPUT
+    conn = xcb_connect(NULL, NULL);
+    if (xcb_connection_has_error(conn))
+        return;
+
+    const xcb_query_extension_reply_t *ext = xcb_get_extension_data(conn, &xcb_input_id);
+    if (!ext || !ext->present)
+        return;
+    xi_opcode = ext->major_opcode;
+
+    /* Announce XInput 2.2: clients announcing 2.0 don't receive raw events
+     * while another client (the game) grabs the pointer */
+    xcb_input_xi_query_version_cookie_t version_cookie = xcb_input_xi_query_version(conn, 2, 2);
+    xcb_input_xi_query_version_reply_t *version_reply = xcb_input_xi_query_version_reply(conn, version_cookie, nullptr);
+    if (!version_reply || (version_reply->major_version < 2) ||
+        ((version_reply->major_version == 2) && (version_reply->minor_version < 2))) {
+        free(version_reply);
+        return;
+    }
+    free(version_reply);
+
+    /* Select raw button events from all master devices on the root window */
+    struct {
+        xcb_input_event_mask_t head;
+        uint32_t mask;
+    } event_mask;
+    event_mask.head.deviceid = XCB_INPUT_DEVICE_ALL_MASTER;
+    event_mask.head.mask_len = 1;
+    event_mask.mask = XCB_INPUT_XI_EVENT_MASK_RAW_BUTTON_PRESS | XCB_INPUT_XI_EVENT_MASK_RAW_BUTTON_RELEASE;
+
+    xcb_window_t root = xcb_setup_roots_iterator(xcb_get_setup(conn)).data->root;
+    xcb_void_cookie_t select_cookie = xcb_input_xi_select_events_checked(conn, root, 1, &event_mask.head);
+    xcb_generic_error_t *error = xcb_request_check(conn, select_cookie);
+    if (error) {
+        std::cerr << "Could not select XInput2 raw events, X error " << static_cast<int>(error->error_code) << std::endl;
+        free(error);
+        return;
+    }
+
+    available = true;
+#endif
+}
+
+RawPointer::~RawPointer()
+{
+    if (conn)
+        xcb_disconnect(conn);
+}
+
+int RawPointer::nextButtonEvent(int *button, const struct timespec &deadline)
+{
+#ifdef LIBTAS_HAS_XCB_XINPUT
+    struct pollfd pfd;
+    pfd.fd = xcb_get_file_descriptor(conn);
+    pfd.events = POLLIN;
+
+    while (true) {
+        xcb_generic_event_t *event;
+        while ((event = xcb_poll_for_event(conn))) {
+            if ((event->response_type & ~0x80) == XCB_GE_GENERIC) {
+                xcb_ge_generic_event_t *ge = reinterpret_cast<xcb_ge_generic_event_t*>(event);
+                if ((ge->extension == xi_opcode) &&
+                    ((ge->event_type == XCB_INPUT_RAW_BUTTON_PRESS) || (ge->event_type == XCB_INPUT_RAW_BUTTON_RELEASE))) {
+                    xcb_input_raw_button_press_event_t *raw = reinterpret_cast<xcb_input_raw_button_press_event_t*>(event);
+                    int type = ge->event_type;
+                    *button = raw->detail;
+                    free(event);
+                    return type;
+                }
+            }
+            free(event);
+        }
+
+        if (xcb_connection_has_error(conn))
+            return -1;
+
+        /* Sleep until the server sends something or the deadline passes */
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long remaining_ms = (deadline.tv_sec - now.tv_sec) * 1000 +
+            (deadline.tv_nsec - now.tv_nsec) / 1000000;
+        if (remaining_ms <= 0)
+            return -2;
+
+        if (poll(&pfd, 1, static_cast<int>(remaining_ms)) == 0)
+            return -2;
+    }
+#else
+    return -1;
+#endif
+}
+
+RawPointer::ClickStatus RawPointer::waitClick(int button, int timeout_ms)
+{
+#ifdef LIBTAS_HAS_XCB_XINPUT
+    if (!available)
+        return CLICK_UNAVAILABLE;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    int type, b;
+
+    /* Wait for a press of the button */
+    do {
+        type = nextButtonEvent(&b, deadline);
+        if (type == -2)
+            return CLICK_TIMEOUT;
+        if (type < 0)
+            return CLICK_UNAVAILABLE;
+    } while ((type != XCB_INPUT_RAW_BUTTON_PRESS) || (b != button));
+
+    /* Wait for its release */
+    do {
+        type = nextButtonEvent(&b, deadline);
+        if (type == -2)
+            return CLICK_TIMEOUT;
+        if (type < 0)
+            return CLICK_UNAVAILABLE;
+    } while ((type != XCB_INPUT_RAW_BUTTON_RELEASE) || (b != button));
+
+    return CLICK_DONE;
+#else
+    return CLICK_UNAVAILABLE;
+#endif
+}
@@ -0,0 +1,60 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBTAS_RAWPOINTER_H_INCLUDED
+#define LIBTAS_RAWPOINTER_H_INCLUDED
+
+#include <xcb/xcb.h>
+#include <stdint.h>
+#include <time.h>
+
+/* Receive raw pointer button events from the XInput2 extension, on a
+ * dedicated X connection. Raw events are delivered to every client that
+ * selects them, even if another client (the game) already selected button
+ * events on the window, so we don't need to poll the pointer state.
+ */
+class RawPointer {
+public:
+    RawPointer();
+    ~RawPointer();
+
+    enum ClickStatus {
+        CLICK_DONE, // The button was pressed and released
+        CLICK_UNAVAILABLE, // Raw events are not available
+        CLICK_TIMEOUT, // No click before the timeout
+    };
+
+    /* Block until the button is pressed and released, or until timeout_ms
+     * milliseconds have passed */
+    ClickStatus waitClick(int button, int timeout_ms);
+
+private:
+    xcb_connection_t *conn = nullptr;
+
+    /* Major opcode of the XInput extension */
+    uint8_t xi_opcode = 0;
+
+    bool available = false;
+
+    /* Wait for the next raw button event and return its type and button,
+     * -1 on connection error or -2 if the deadline (CLOCK_MONOTONIC) passed */
+    int nextButtonEvent(int *button, const struct timespec &deadline);
+};
+
+#endif
@@ -18,9 +18,11 @@
  */
 
 #include <iostream>
+#include <algorithm> // std::mismatch
 #include <unistd.h> // access()
 
 #include "SaveState.h"
+#include "GreenZone.h"
 #include "utils.h"
 #include "../shared/sockethelpers.h"
 #include "../shared/SharedConfig.h"
@@ -29,7 +31,8 @@
 void SaveState::init(Context* context, int i)
 {
     id = i;
-    is_backtrack = (i == 10);
+    is_backtrack = (i == SharedConfig::SS_SLOT_BACKTRACK);
+    is_greenzone = (i >= SharedConfig::SS_SLOT_GREENZONE);
     framecount = 0; // Special value for `no state`
     parent = -1;
     movie = std::unique_ptr<MovieFile>(new MovieFile(context));
@@ -106,7 +109,7 @@ const std::string& SaveState::getMoviePath() const
 
 int SaveState::save(Context* context, const MovieFile& m)
 {    
-    if (context->config.sc.recording != SharedConfig::NO_RECORDING) {
+    if ((context->config.sc.recording != SharedConfig::NO_RECORDING) && !is_greenzone) {
         /* Save the movie file */
         m.copyTo(*movie);
     }
@@ -128,7 +131,7 @@ int SaveState::save(Context* context, const MovieFile& m)
         op.close();
     }
 
-    if (context->config.sc.osd & SharedConfig::OSD_MESSAGES) {
+    if ((context->config.sc.osd & SharedConfig::OSD_MESSAGES) && !is_greenzone) {
         sendMessage(MSGN_OSD_MSG);
         sendString(saving_msg);
     }
@@ -192,7 +195,7 @@ int SaveState::load(Context* context, const MovieFile& m, bool branch)
     }
 
     /* When loading in read mode and not branch, we don't allow loading a non-prefix movie */
-    if ((context->config.sc.recording == SharedConfig::RECORDING_READ) && (!branch)) {
+    if ((context->config.sc.recording == SharedConfig::RECORDING_READ) && (!branch) && !is_greenzone) {
 
         /* Checking if the savestate movie is a prefix of our movie */
         if (!movie || !m.isPrefix(*movie)) {
@@ -205,7 +208,7 @@ int SaveState::load(Context* context, const MovieFile& m, bool branch)
         }
     }
 
-    if (context->config.sc.osd & SharedConfig::OSD_MESSAGES) {
+    if ((context->config.sc.osd & SharedConfig::OSD_MESSAGES) && !is_greenzone) {
         std::string msg;
         sendMessage(MSGN_OSD_MSG);
         sendString(loading_msg);
@@ -232,10 +235,21 @@ int SaveState::postLoad(Context* context, MovieFile& m, bool branch)
         sendMessage(MSGN_CONFIG);
         sendData(&context->config.sc, sizeof(SharedConfig));
 
-        if ((context->config.sc.recording == SharedConfig::RECORDING_WRITE) || branch) {
+        if (((context->config.sc.recording == SharedConfig::RECORDING_WRITE) || branch) && !is_greenzone) {
             /* When in writing move or loading a branch,
              * we load the movie associated with the savestate.
              */
+
+            /* Greenzone states are only valid for the inputs they were
+             * taken with, so drop the ones after the first difference */
+            const std::vector<AllInputs>& cur_list = m.inputs->input_list;
+            const std::vector<AllInputs>& new_list = movie->inputs->input_list;
+            size_t common = std::min(cur_list.size(), new_list.size());
+            auto diff = std::mismatch(cur_list.begin(), cur_list.begin() + common, new_list.begin());
+            size_t first_diff = diff.first - cur_list.begin();
+            if ((first_diff < common) || (cur_list.size() != new_list.size()))
+                GreenZone::invalidate(first_diff);
+
             movie->copyTo(m);
         }
 
@@ -268,7 +282,7 @@ int SaveState::postLoad(Context* context, MovieFile& m, bool branch)
         }
     }
 
-    if (didLoad && (context->config.sc.osd & SharedConfig::OSD_MESSAGES)) {
+    if (didLoad && (context->config.sc.osd & SharedConfig::OSD_MESSAGES) && !is_greenzone) {
         sendMessage(MSGN_OSD_MSG);
         sendString(loaded_msg);
     }
@@ -281,8 +295,28 @@ int SaveState::postLoad(Context* context, MovieFile& m, bool branch)
     return 0;
 }
 
+void SaveState::release(Context* context)
+{
+    /* Send the savestate index */
+    sendMessage(MSGN_SAVESTATE_INDEX);
+    sendData(&id, sizeof(int));
+
+    /* Send the savestate path */
+    if (! (context->config.sc.savestate_settings & SharedConfig::SS_RAM)) {
+        sendMessage(MSGN_SAVESTATE_PATH);
+        sendString(path);
+    }
+    else {
+        /* Remove the empty savestate files */
+        unlink(pagemap_path.c_str());
+        unlink(pages_path.c_str());
+    }
+
+    sendMessage(MSGN_RELEASESTATE);
+}
+
 void SaveState::backupMovie()
 {
-    if (framecount) // 0 means no state has been made
+    if (framecount && !is_greenzone) // 0 means no state has been made
         movie->saveMovie(movie_path);
 }
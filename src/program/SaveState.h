@@ -46,6 +46,10 @@ public:
     /* Is backtrack savestate */
     bool is_backtrack;
 
+    /* Is a state managed by the greenzone. Those states don't store a movie,
+     * because the greenzone drops them as soon as earlier inputs change */
+    bool is_greenzone;
+
     /* Id of parent savestate, or -1 if no parent */
     int parent;
 
@@ -69,6 +73,9 @@ public:
     /* Process after state loading. Return message or error */
     int postLoad(Context* context, MovieFile& movie, bool branch);
 
+    /* Ask the game to free the savestate storage */
+    void release(Context* context);
+
     /* Save movie on disk when exiting */
     void backupMovie();
 
@@ -21,9 +21,11 @@
 
 #include "SaveStateList.h"
 #include "SaveState.h"
+#include "WatchpointList.h"
 #include "../shared/messages.h"
+#include "../shared/SharedConfig.h"
 
-#define NB_STATES 11
+#define NB_STATES SharedConfig::SS_SLOT_COUNT
 
 /* Array of savestates */
 static SaveState states[NB_STATES];
@@ -96,11 +98,39 @@ int SaveStateList::postLoad(int id, Context* context, MovieFile& movie, bool bra
         /* Update root savestate */
         old_root_framecount = rootStateFramecount();
         last_state_id = id;
+
+        /* The game restored the watchpoints it had when saving */
+        WatchpointList::invalidate();
     }
     
     return message;
 }
 
+void SaveStateList::remove(int id)
+{
+    SaveState& ss = get(id);
+
+    /* Update parent of every child to its grandparent */
+    for (int cid = 0; cid < NB_STATES; cid++) {
+        if (cid == id)
+            continue;
+        if (states[cid].parent == id)
+            states[cid].parent = ss.parent;
+    }
+
+    if (last_state_id == id)
+        last_state_id = ss.parent;
+
+    ss.parent = -1;
+    ss.framecount = 0;
+}
+
+void SaveStateList::release(int id, Context* context)
+{
+    remove(id);
+    get(id).release(context);
+}
+
 uint64_t SaveStateList::rootStateFramecount()
 {
     if (last_state_id == -1)
@@ -130,7 +160,10 @@ int SaveStateList::nearestState(uint64_t framecount)
     int parent_id = last_state_id;
     
     while (parent_id != -1) {
-        if (states[parent_id].framecount <= framecount)
+        /* Greenzone states are looked up with GreenZone::nearestState(),
+         * which knows if they are still valid */
+        if ((parent_id < SharedConfig::SS_SLOT_GREENZONE) &&
+            (states[parent_id].framecount <= framecount))
             return parent_id;
         parent_id = states[parent_id].parent;
     }
@@ -42,6 +42,12 @@ namespace SaveStateList {
     /* Process after loading state from its id and handle parent */
     int postLoad(int id, Context* context, MovieFile& movie, bool branch);
 
+    /* Remove a state from the branch, reattaching its children to its parent */
+    void remove(int id);
+
+    /* Remove a state from the branch and free its storage in the game */
+    void release(int id, Context* context);
+
     /* Returns the framecount of the root state, or -1 if already root */
     uint64_t rootStateFramecount();
 
@@ -0,0 +1,158 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "WatchpointList.h"
+#include "../shared/sockethelpers.h"
+#include "../shared/messages.h"
+
+#include <map>
+#include <mutex>
+
+struct WatchpointEntry {
+    Watchpoint wp;
+    int owners;
+};
+
+static std::vector<WatchpointEntry> entries;
+
+/* Last access for each watched address */
+static std::map<uintptr_t, WatchpointHit> last_hits;
+
+static bool modified = false;
+
+static std::mutex mutex;
+
+bool WatchpointList::add(uintptr_t addr, int size, int owner)
+{
+    /* Debug registers only support aligned accesses of these sizes */
+    if ((size != 1) && (size != 2) && (size != 4) && (size != 8))
+        return false;
+    if (addr % size)
+        return false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (WatchpointEntry& entry : entries) {
+        if (entry.wp.addr == addr) {
+            entry.owners |= owner;
+            if (entry.wp.size < size) {
+                entry.wp.size = size;
+                modified = true;
+            }
+            return true;
+        }
+    }
+
+    if (static_cast<int>(entries.size()) >= Watchpoint::MAX)
+        return false;
+
+    WatchpointEntry entry;
+    entry.wp.addr = addr;
+    entry.wp.size = size;
+    entry.wp.type = Watchpoint::WRITE;
+    entry.owners = owner;
+    entries.push_back(entry);
+    modified = true;
+    return true;
+}
+
+void WatchpointList::remove(uintptr_t addr, int owner)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if (it->wp.addr == addr) {
+            it->owners &= ~owner;
+            if (!it->owners) {
+                last_hits.erase(addr);
+                entries.erase(it);
+                modified = true;
+            }
+            return;
+        }
+    }
+}
+
+void WatchpointList::removeOwner(int owner)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto it = entries.begin(); it != entries.end();) {
+        it->owners &= ~owner;
+        if (!it->owners) {
+            last_hits.erase(it->wp.addr);
+            it = entries.erase(it);
+            modified = true;
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+bool WatchpointList::contains(uintptr_t addr, int owner)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (const WatchpointEntry& entry : entries)
+        if ((entry.wp.addr == addr) && (entry.owners & owner))
+            return true;
+
+    return false;
+}
+
+void WatchpointList::invalidate()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    modified = true;
+}
+
+void WatchpointList::send()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!modified)
+        return;
+
+    sendMessage(MSGN_WATCHPOINTS);
+    int count = entries.size();
+    sendData(&count, sizeof(int));
+    for (const WatchpointEntry& entry : entries)
+        sendData(&entry.wp, sizeof(Watchpoint));
+
+    modified = false;
+}
+
+void WatchpointList::addHit(const WatchpointHit& hit)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    last_hits[hit.addr] = hit;
+}
+
+bool WatchpointList::lastHit(uintptr_t addr, WatchpointHit& hit)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = last_hits.find(addr);
+    if (it == last_hits.end())
+        return false;
+
+    hit = it->second;
+    return true;
+}
@@ -0,0 +1,67 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBTAS_WATCHPOINTLIST_H_INCLUDED
+#define LIBTAS_WATCHPOINTLIST_H_INCLUDED
+
+#include "../shared/Watchpoint.h"
+#include <vector>
+#include <stdint.h>
+
+/* List of hardware watchpoints requested by the ram watch window and by lua
+ * scripts, which is sent to the game, and the accesses reported back. It can
+ * be accessed from both the UI thread and the game loop thread. */
+namespace WatchpointList {
+
+    /* Who requested the watchpoint. An address can be watched by both. */
+    enum Owner {
+        OWNER_RAMWATCH = 0x1,
+        OWNER_LUA = 0x2,
+    };
+
+    /* Watch writes on an address. Returns false if the size or alignment is
+     * not supported, or if all debug registers are already used. */
+    bool add(uintptr_t addr, int size, int owner);
+
+    /* Stop watching an address for this owner */
+    void remove(uintptr_t addr, int owner);
+
+    /* Stop watching all addresses of this owner */
+    void removeOwner(int owner);
+
+    /* Is the address watched by this owner? */
+    bool contains(uintptr_t addr, int owner);
+
+    /* Force sending the list on the next frame boundary, because the game
+     * does not have the current list (new game, state loaded) */
+    void invalidate();
+
+    /* Send the list to the game if it changed. Must be called at the frame
+     * boundary. */
+    void send();
+
+    /* Store an access reported by the game */
+    void addHit(const WatchpointHit& hit);
+
+    /* Get the last access to an address. Returns false if there was none */
+    bool lastHit(uintptr_t addr, WatchpointHit& hit);
+
+}
+
+#endif
@@ -26,7 +26,7 @@ extern "C" {
 #include <lauxlib.h>
 }
 
-static AllInputs* ai;
+static AllInputs* ai = nullptr;
 
 /* List of functions to register */
 static const luaL_Reg input_functions[] =
@@ -51,9 +51,12 @@ void Lua::Input::registerFunctions(Context* context)
     lua_setglobal(context->lua_state, "input");
 }
 
+/* Inputs used outside of onInput(), which are not sent to the game */
+static AllInputs unused_ai;
+
 void Lua::Input::registerInputs(AllInputs* frame_ai)
 {
-    ai = frame_ai;
+    ai = frame_ai ? frame_ai : &unused_ai;
 }
 
 int Lua::Input::clear(lua_State *L)
@@ -22,13 +22,18 @@
 #include "Input.h"
 #include "Movie.h"
 #include "Memory.h"
+#include "Savestate.h"
 #include <iostream>
+#include <vector>
 extern "C" {
 #include <lua.h>
 #include <lualib.h>
 #include <lauxlib.h>
 }
 
+/* Registry references of coroutines waiting for the next frame */
+static std::vector<int> waiting_coroutines;
+
 void Lua::Main::init(Context* context)
 {
     if (context->lua_state)
@@ -42,10 +47,15 @@ void Lua::Main::init(Context* context)
     Lua::Input::registerFunctions(context);
     Lua::Memory::registerFunctions(context);
     Lua::Movie::registerFunctions(context);
+    Lua::Savestate::registerFunctions(context);
 }
 
 void Lua::Main::exit(Context* context)
 {
+    /* References are invalidated with the lua state */
+    waiting_coroutines.clear();
+    Lua::Memory::clearWatchpoints();
+
     if (context->lua_state)
         lua_close(context->lua_state);
     context->lua_state = nullptr;
@@ -84,3 +94,45 @@ void Lua::Main::callLua(Context* context, const char* func)
         lua_pop(context->lua_state, 1);
     }
 }
+
+void Lua::Main::waitFrame(lua_State *L)
+{
+    /* Keep a reference so that the coroutine is not garbage collected */
+    lua_pushthread(L);
+    waiting_coroutines.push_back(luaL_ref(L, LUA_REGISTRYINDEX));
+}
+
+bool Lua::Main::hasWaitingCoroutines()
+{
+    return !waiting_coroutines.empty();
+}
+
+void Lua::Main::resumeCoroutines(Context* context)
+{
+    if (waiting_coroutines.empty())
+        return;
+
+    /* Coroutines may register again during their execution */
+    std::vector<int> coroutines;
+    coroutines.swap(waiting_coroutines);
+
+    Lua::Savestate::allow(true);
+
+    for (int ref : coroutines) {
+        lua_rawgeti(context->lua_state, LUA_REGISTRYINDEX, ref);
+        lua_State *co = lua_tothread(context->lua_state, -1);
+        lua_pop(context->lua_state, 1);
+
+        if (co) {
+            int ret = lua_resume(co, context->lua_state, 0);
+            if ((ret != LUA_OK) && (ret != LUA_YIELD)) {
+                std::cerr << "error running coroutine: " << lua_tostring(co, -1) << std::endl;
+                lua_pop(co, 1);
+            }
+        }
+
+        luaL_unref(context->lua_state, LUA_REGISTRYINDEX, ref);
+    }
+
+    Lua::Savestate::allow(false);
+}
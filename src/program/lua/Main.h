@@ -24,6 +24,9 @@
 #include "../Context.h"
 
 #include <string>
+extern "C" {
+#include <lua.h>
+}
 
 namespace Lua {
 
@@ -44,6 +47,16 @@ namespace Main {
     /* Call the lua function */
     void callLua(Context* context, const char* func);
 
+    /* Register a coroutine to be resumed at the beginning of the next frame */
+    void waitFrame(lua_State *L);
+
+    /* Are there coroutines waiting for the next frame? */
+    bool hasWaitingCoroutines();
+
+    /* Resume the coroutines waiting for the next frame. Savestate functions
+     * are only allowed inside these coroutines. */
+    void resumeCoroutines(Context* context);
+
 }
 }
 
@@ -18,8 +18,14 @@
  */
 
 #include "Memory.h"
+#include "../WatchpointList.h"
+#include "../ramsearch/MemAccess.h"
 
 #include <iostream>
+#include <vector>
+#include <map>
+#include <cstring>
+#include <sys/uio.h> // process_vm_readv
 extern "C" {
 #include <lua.h>
 #include <lauxlib.h>
@@ -27,6 +33,9 @@ extern "C" {
 
 static Context* context;
 
+/* Registry references of the functions called on watchpoint accesses */
+static std::map<uintptr_t, int> watchpoint_functions;
+
 /* List of functions to register */
 static const luaL_Reg memory_functions[] =
 {
@@ -38,10 +47,16 @@ static const luaL_Reg memory_functions[] =
     { "reads16", Lua::Memory::reads16},
     { "reads32", Lua::Memory::reads32},
     { "reads64", Lua::Memory::reads64},
+    { "readbytes", Lua::Memory::readbytes},
+    { "readarray", Lua::Memory::readarray},
+    { "readstruct", Lua::Memory::readstruct},
+    { "readmulti", Lua::Memory::readmulti},
+    { "readpointerchain", Lua::Memory::readpointerchain},
     { "write8", Lua::Memory::write8},
     { "write16", Lua::Memory::write16},
     { "write32", Lua::Memory::write32},
     { "write64", Lua::Memory::write64},
+    { "onwrite", Lua::Memory::onwrite},
     { NULL, NULL }
 };
 
@@ -86,6 +101,211 @@ READFUNC(s16, int16_t)
 READFUNC(s32, int32_t)
 READFUNC(s64, int64_t)
 
+/* Types accepted by the bulk read functions */
+enum ValueType {
+    TYPE_U8, TYPE_U16, TYPE_U32, TYPE_U64,
+    TYPE_S8, TYPE_S16, TYPE_S32, TYPE_S64,
+    TYPE_F32, TYPE_F64,
+    TYPE_COUNT
+};
+
+static const char* type_names[TYPE_COUNT] = {"u8", "u16", "u32", "u64", "s8", "s16", "s32", "s64", "f32", "f64"};
+static const int type_sizes[TYPE_COUNT] = {1, 2, 4, 8, 1, 2, 4, 8, 4, 8};
+
+/* Return the type index from its name, or -1 if unknown */
+static int typeFromName(const char* name)
+{
+    if (!name)
+        return -1;
+    for (int t = 0; t < TYPE_COUNT; t++) {
+        if (strcmp(name, type_names[t]) == 0)
+            return t;
+    }
+    return -1;
+}
+
+/* Push a value of the given type that is stored at data */
+static void pushValue(lua_State *L, const char* data, int type)
+{
+    switch (type) {
+#define PUSHINT(T, TYPE) \
+        case T: { TYPE v; memcpy(&v, data, sizeof(TYPE)); lua_pushinteger(L, static_cast<lua_Integer>(v)); break; }
+        PUSHINT(TYPE_U8, uint8_t)
+        PUSHINT(TYPE_U16, uint16_t)
+        PUSHINT(TYPE_U32, uint32_t)
+        PUSHINT(TYPE_U64, uint64_t)
+        PUSHINT(TYPE_S8, int8_t)
+        PUSHINT(TYPE_S16, int16_t)
+        PUSHINT(TYPE_S32, int32_t)
+        PUSHINT(TYPE_S64, int64_t)
+#undef PUSHINT
+        case TYPE_F32: { float v; memcpy(&v, data, sizeof(float)); lua_pushnumber(L, v); break; }
+        case TYPE_F64: { double v; memcpy(&v, data, sizeof(double)); lua_pushnumber(L, v); break; }
+        default: lua_pushinteger(L, 0);
+    }
+}
+
+int Lua::Memory::readbytes(lua_State *L)
+{
+    uintptr_t addr = static_cast<uintptr_t>(lua_tointeger(L, 1));
+    lua_Integer len = lua_tointeger(L, 2);
+
+    if (len <= 0) {
+        lua_pushstring(L, "");
+        return 1;
+    }
+
+    std::vector<char> buf(len);
+    if (read(addr, buf.data(), len))
+        lua_pushlstring(L, buf.data(), len);
+    else
+        lua_pushnil(L);
+    return 1;
+}
+
+int Lua::Memory::readarray(lua_State *L)
+{
+    uintptr_t addr = static_cast<uintptr_t>(lua_tointeger(L, 1));
+    int type = typeFromName(lua_tostring(L, 2));
+    lua_Integer count = lua_tointeger(L, 3);
+
+    if (type < 0)
+        return luaL_argerror(L, 2, "unknown type");
+
+    lua_newtable(L);
+    if (count <= 0)
+        return 1;
+
+    int size = type_sizes[type];
+    std::vector<char> buf(count * size);
+    bool ret = read(addr, buf.data(), buf.size());
+
+    for (lua_Integer i = 0; i < count; i++) {
+        if (ret)
+            pushValue(L, buf.data() + i * size, type);
+        else
+            lua_pushinteger(L, 0);
+        lua_rawseti(L, -2, i + 1);
+    }
+    return 1;
+}
+
+int Lua::Memory::readstruct(lua_State *L)
+{
+    uintptr_t addr = static_cast<uintptr_t>(lua_tointeger(L, 1));
+    const char* format = luaL_checkstring(L, 2);
+
+    /* Get the size of the structure from string.packsize() */
+    lua_getglobal(L, "string");
+    lua_getfield(L, -1, "packsize");
+    lua_pushstring(L, format);
+    lua_call(L, 1, 1);
+    lua_Integer size = lua_tointeger(L, -1);
+    lua_pop(L, 1);
+
+    /* Read the structure, and let string.unpack() decode it */
+    std::string data(size, '\0');
+    if (!read(addr, &data[0], size)) {
+        lua_pop(L, 1);
+        lua_pushnil(L);
+        return 1;
+    }
+
+    int base = lua_gettop(L);
+    lua_getfield(L, -1, "unpack");
+    lua_pushstring(L, format);
+    lua_pushlstring(L, data.data(), data.size());
+    lua_call(L, 2, LUA_MULTRET);
+
+    /* Last returned value is the position after the structure */
+    int nvalues = lua_gettop(L) - base - 1;
+    lua_pop(L, 1);
+
+    lua_createtable(L, nvalues, 0);
+    lua_insert(L, base + 1);
+    for (int i = nvalues; i >= 1; i--) {
+        lua_rawseti(L, base + 1, i);
+    }
+
+    /* Remove the string table */
+    lua_remove(L, base);
+    return 1;
+}
+
+int Lua::Memory::readmulti(lua_State *L)
+{
+    luaL_checktype(L, 1, LUA_TTABLE);
+    lua_Integer n = luaL_len(L, 1);
+
+    std::vector<int> types(n, -1);
+    std::vector<struct iovec> local, remote;
+    std::vector<lua_Integer> indexes;
+    std::vector<uint64_t> values(n);
+
+    /* Build the list of areas to read */
+    for (lua_Integer i = 0; i < n; i++) {
+        lua_rawgeti(L, 1, i + 1);
+        if (lua_istable(L, -1)) {
+            lua_rawgeti(L, -1, 1);
+            uintptr_t addr = static_cast<uintptr_t>(lua_tointeger(L, -1));
+            lua_rawgeti(L, -2, 2);
+            types[i] = typeFromName(lua_tostring(L, -1));
+            lua_pop(L, 2);
+
+            if (types[i] >= 0) {
+                struct iovec l, r;
+                l.iov_base = &values[i];
+                l.iov_len = type_sizes[types[i]];
+                r.iov_base = reinterpret_cast<void*>(addr);
+                r.iov_len = type_sizes[types[i]];
+                local.push_back(l);
+                remote.push_back(r);
+                indexes.push_back(i);
+            }
+        }
+        lua_pop(L, 1);
+    }
+
+    std::vector<bool> valid = MemAccess::readVectored(context->game_pid, local, remote);
+
+    lua_createtable(L, n, 0);
+    for (lua_Integer i = 0; i < n; i++) {
+        lua_pushinteger(L, 0);
+        lua_rawseti(L, -2, i + 1);
+    }
+    for (size_t k = 0; k < indexes.size(); k++) {
+        if (!valid[k])
+            continue;
+        lua_Integer i = indexes[k];
+        pushValue(L, reinterpret_cast<const char*>(&values[i]), types[i]);
+        lua_rawseti(L, -2, i + 1);
+    }
+    return 1;
+}
+
+int Lua::Memory::readpointerchain(lua_State *L)
+{
+    uintptr_t addr = static_cast<uintptr_t>(lua_tointeger(L, 1));
+    luaL_checktype(L, 2, LUA_TTABLE);
+    lua_Integer n = luaL_len(L, 2);
+
+    for (lua_Integer i = 1; i <= n; i++) {
+        lua_rawgeti(L, 2, i);
+        intptr_t offset = static_cast<intptr_t>(lua_tointeger(L, -1));
+        lua_pop(L, 1);
+
+        uintptr_t next_addr;
+        if (!read(addr, &next_addr, sizeof(uintptr_t))) {
+            lua_pushnil(L);
+            return 1;
+        }
+        addr = next_addr + offset;
+    }
+
+    lua_pushinteger(L, static_cast<lua_Integer>(addr));
+    return 1;
+}
+
 void Lua::Memory::write(uintptr_t addr, void* value, int size)
 {
     /* Write value into the game process address */
@@ -119,3 +339,61 @@ WRITEFUNC(8, uint8_t, int8_t)
 WRITEFUNC(16, uint16_t, int16_t)
 WRITEFUNC(32, uint32_t, int32_t)
 WRITEFUNC(64, uint64_t, int64_t)
+
+int Lua::Memory::onwrite(lua_State *L)
+{
+    uintptr_t addr = static_cast<uintptr_t>(luaL_checkinteger(L, 1));
+    int size = static_cast<int>(luaL_checkinteger(L, 2));
+
+    /* Remove the previous function */
+    auto it = watchpoint_functions.find(addr);
+    if (it != watchpoint_functions.end()) {
+        luaL_unref(L, LUA_REGISTRYINDEX, it->second);
+        watchpoint_functions.erase(it);
+        WatchpointList::remove(addr, WatchpointList::OWNER_LUA);
+    }
+
+    if (lua_isnoneornil(L, 3)) {
+        lua_pushboolean(L, 1);
+        return 1;
+    }
+
+    luaL_checktype(L, 3, LUA_TFUNCTION);
+
+    if (!WatchpointList::add(addr, size, WatchpointList::OWNER_LUA)) {
+        lua_pushboolean(L, 0);
+        return 1;
+    }
+
+    lua_pushvalue(L, 3);
+    watchpoint_functions[addr] = luaL_ref(L, LUA_REGISTRYINDEX);
+
+    lua_pushboolean(L, 1);
+    return 1;
+}
+
+void Lua::Memory::callWatchpoint(Context* context, const WatchpointHit& hit)
+{
+    auto it = watchpoint_functions.find(hit.addr);
+    if (it == watchpoint_functions.end())
+        return;
+
+    lua_State *L = context->lua_state;
+    lua_rawgeti(L, LUA_REGISTRYINDEX, it->second);
+    lua_pushinteger(L, static_cast<lua_Integer>(hit.addr));
+    lua_pushinteger(L, static_cast<lua_Integer>(hit.frame));
+    lua_pushinteger(L, static_cast<lua_Integer>(hit.ip));
+
+    int ret = lua_pcall(L, 3, 0, 0);
+    if (ret != 0) {
+        std::cerr << "error running watchpoint function: " << lua_tostring(L, -1) << std::endl;
+        lua_pop(L, 1);
+    }
+}
+
+void Lua::Memory::clearWatchpoints()
+{
+    /* References are released with the lua state */
+    watchpoint_functions.clear();
+    WatchpointList::removeOwner(WatchpointList::OWNER_LUA);
+}
@@ -21,6 +21,7 @@
 #define LIBTAS_LUAMEMORY_H_INCLUDED
 
 #include "../Context.h"
+#include "../../shared/Watchpoint.h"
 #include <stdint.h>
 extern "C" {
 #include <lua.h>
@@ -60,6 +61,30 @@ namespace Memory {
     /* Read a signed 64-bit integer */
     int reads64(lua_State *L);
 
+    /* Read a block of memory into a string.
+     * Arguments: address, length */
+    int readbytes(lua_State *L);
+
+    /* Read an array of values of the same type into a table.
+     * Arguments: address, type ("u8", "s32", "f64", etc.), count */
+    int readarray(lua_State *L);
+
+    /* Read a structure described by a format string, using the same format
+     * as string.unpack(), into a table.
+     * Arguments: address, format */
+    int readstruct(lua_State *L);
+
+    /* Read a list of values at different addresses, all with one syscall.
+     * Argument: table of {address, type} pairs. Returns a table of values,
+     * with 0 for values that could not be read */
+    int readmulti(lua_State *L);
+
+    /* Resolve a pointer chain, with the same semantics as ram watches:
+     * each offset is added to the pointer read at the current address.
+     * Each level depends on the previous one, so it needs one read per level.
+     * Arguments: base address, table of offsets. Returns nil on error */
+    int readpointerchain(lua_State *L);
+
     /* Helper function for reading an integer */
     void write(uintptr_t addr, void* value, int size);
 
@@ -74,6 +99,18 @@ namespace Memory {
 
     /* Write a 64-bit integer */
     int write64(lua_State *L);
+
+    /* Call a function each time the game writes to an address, using a
+     * hardware watchpoint. Passing nil as function removes the watchpoint.
+     * Arguments: address, size (1, 2, 4 or 8), function. Returns if the
+     * watchpoint could be set */
+    int onwrite(lua_State *L);
+
+    /* Execute the function registered for a watchpoint access */
+    void callWatchpoint(Context* context, const WatchpointHit& hit);
+
+    /* Remove all watchpoints set by the script */
+    void clearWatchpoints();
 }
 }
 
@@ -18,8 +18,10 @@
  */
 
 #include "Movie.h"
+#include "Main.h"
 
 #include <iostream>
+#include <vector>
 extern "C" {
 #include <lua.h>
 #include <lauxlib.h>
@@ -27,6 +29,9 @@ extern "C" {
 
 // static AllInputs* ai;
 static Context* context;
+static MovieFile* movie = nullptr;
+static std::function<void()> inputs_to_be_changed;
+static std::function<void()> inputs_changed;
 
 /* List of functions to register */
 static const luaL_Reg movie_functions[] =
@@ -36,6 +41,15 @@ static const luaL_Reg movie_functions[] =
     { "status", Lua::Movie::status},
     { "time", Lua::Movie::time},
     { "rerecords", Lua::Movie::rerecords},
+    { "frameAdvance", Lua::Movie::frameAdvance},
+    { "getInputs", Lua::Movie::getInputs},
+    { "setInputs", Lua::Movie::setInputs},
+    { "getInputsRange", Lua::Movie::getInputsRange},
+    { "setInputsRange", Lua::Movie::setInputsRange},
+    { "insertInputs", Lua::Movie::insertInputs},
+    { "deleteInputs", Lua::Movie::deleteInputs},
+    { "copyInputs", Lua::Movie::copyInputs},
+    { "inputs", Lua::Movie::inputs},
     { NULL, NULL }
 };
 
@@ -46,6 +60,13 @@ void Lua::Movie::registerFunctions(Context* c)
     lua_setglobal(context->lua_state, "movie");
 }
 
+void Lua::Movie::registerMovie(MovieFile* m, std::function<void()> toBeChanged, std::function<void()> changed)
+{
+    movie = m;
+    inputs_to_be_changed = toBeChanged;
+    inputs_changed = changed;
+}
+
 int Lua::Movie::currentFrame(lua_State *L)
 {
     lua_pushinteger(L, static_cast<lua_Integer>(context->framecount));
@@ -82,3 +103,328 @@ int Lua::Movie::rerecords(lua_State *L)
         lua_pushinteger(L, static_cast<lua_Integer>(context->rerecord_count));
     return 1;
 }
+
+int Lua::Movie::frameAdvance(lua_State *L)
+{
+    if (!lua_isyieldable(L))
+        return luaL_error(L, "movie.frameAdvance() must be called from a coroutine");
+
+    Lua::Main::waitFrame(L);
+    return lua_yield(L, 0);
+}
+
+/* Push a table with all the fields of the inputs */
+static void pushInputs(lua_State *L, const AllInputs& ai)
+{
+    lua_newtable(L);
+
+    lua_newtable(L);
+    int k = 1;
+    for (int i = 0; i < AllInputs::MAXKEYS; i++) {
+        if (ai.keyboard[i]) {
+            lua_pushinteger(L, static_cast<lua_Integer>(ai.keyboard[i]));
+            lua_rawseti(L, -2, k++);
+        }
+    }
+    lua_setfield(L, -2, "keys");
+
+    lua_pushinteger(L, static_cast<lua_Integer>(ai.pointer_x));
+    lua_setfield(L, -2, "pointer_x");
+    lua_pushinteger(L, static_cast<lua_Integer>(ai.pointer_y));
+    lua_setfield(L, -2, "pointer_y");
+    lua_pushinteger(L, static_cast<lua_Integer>(ai.pointer_mode));
+    lua_setfield(L, -2, "pointer_mode");
+    lua_pushinteger(L, static_cast<lua_Integer>(ai.pointer_mask));
+    lua_setfield(L, -2, "pointer_mask");
+
+    lua_newtable(L);
+    for (int j = 0; j < AllInputs::MAXJOYS; j++) {
+        lua_newtable(L);
+        lua_pushinteger(L, static_cast<lua_Integer>(ai.controller_buttons[j]));
+        lua_setfield(L, -2, "buttons");
+        lua_newtable(L);
+        for (int a = 0; a < AllInputs::MAXAXES; a++) {
+            lua_pushinteger(L, static_cast<lua_Integer>(ai.controller_axes[j][a]));
+            lua_rawseti(L, -2, a+1);
+        }
+        lua_setfield(L, -2, "axes");
+        lua_rawseti(L, -2, j+1);
+    }
+    lua_setfield(L, -2, "controllers");
+
+    lua_pushinteger(L, static_cast<lua_Integer>(ai.flags));
+    lua_setfield(L, -2, "flags");
+    lua_pushinteger(L, static_cast<lua_Integer>(ai.framerate_num));
+    lua_setfield(L, -2, "framerate_num");
+    lua_pushinteger(L, static_cast<lua_Integer>(ai.framerate_den));
+    lua_setfield(L, -2, "framerate_den");
+}
+
+/* Get an integer field of the table at the top of the stack, or 0 */
+static lua_Integer getIntegerField(lua_State *L, const char* name)
+{
+    lua_getfield(L, -1, name);
+    lua_Integer value = lua_tointeger(L, -1);
+    lua_pop(L, 1);
+    return value;
+}
+
+/* Build inputs from the table at index idx. Missing fields are left to
+ * their default value */
+static void toInputs(lua_State *L, int idx, AllInputs& ai)
+{
+    luaL_checktype(L, idx, LUA_TTABLE);
+    ai.emptyInputs();
+
+    lua_pushvalue(L, idx);
+
+    if (lua_getfield(L, -1, "keys") == LUA_TTABLE) {
+        int n = static_cast<int>(lua_rawlen(L, -1));
+        if (n > AllInputs::MAXKEYS)
+            n = AllInputs::MAXKEYS;
+        for (int i = 0; i < n; i++) {
+            lua_rawgeti(L, -1, i+1);
+            ai.keyboard[i] = static_cast<uint32_t>(lua_tointeger(L, -1));
+            lua_pop(L, 1);
+        }
+    }
+    lua_pop(L, 1);
+
+    ai.pointer_x = static_cast<int>(getIntegerField(L, "pointer_x"));
+    ai.pointer_y = static_cast<int>(getIntegerField(L, "pointer_y"));
+    lua_getfield(L, -1, "pointer_mode");
+    if (!lua_isnil(L, -1))
+        ai.pointer_mode = static_cast<unsigned int>(lua_tointeger(L, -1));
+    lua_pop(L, 1);
+    ai.pointer_mask = static_cast<unsigned int>(getIntegerField(L, "pointer_mask"));
+
+    if (lua_getfield(L, -1, "controllers") == LUA_TTABLE) {
+        for (int j = 0; j < AllInputs::MAXJOYS; j++) {
+            if (lua_rawgeti(L, -1, j+1) == LUA_TTABLE) {
+                ai.controller_buttons[j] = static_cast<unsigned short>(getIntegerField(L, "buttons"));
+                if (lua_getfield(L, -1, "axes") == LUA_TTABLE) {
+                    for (int a = 0; a < AllInputs::MAXAXES; a++) {
+                        lua_rawgeti(L, -1, a+1);
+                        ai.controller_axes[j][a] = static_cast<short>(lua_tointeger(L, -1));
+                        lua_pop(L, 1);
+                    }
+                }
+                lua_pop(L, 1);
+            }
+            lua_pop(L, 1);
+        }
+    }
+    lua_pop(L, 1);
+
+    ai.flags = static_cast<uint32_t>(getIntegerField(L, "flags"));
+    ai.framerate_num = static_cast<uint32_t>(getIntegerField(L, "framerate_num"));
+    ai.framerate_den = static_cast<uint32_t>(getIntegerField(L, "framerate_den"));
+
+    lua_pop(L, 1);
+}
+
+/* Build a list of inputs from the array of tables at index idx */
+static void toInputsList(lua_State *L, int idx, std::vector<AllInputs>& list)
+{
+    luaL_checktype(L, idx, LUA_TTABLE);
+    size_t n = lua_rawlen(L, idx);
+    list.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        lua_rawgeti(L, idx, i+1);
+        toInputs(L, -1, list[i]);
+        lua_pop(L, 1);
+    }
+}
+
+/* Check that frames starting at pos can be modified: past inputs were
+ * already sent to the game, like in the input editor */
+static bool canModify(uint64_t pos)
+{
+    return movie && (pos >= context->framecount) && (pos <= movie->inputs->nbFrames());
+}
+
+/* Notify the input editor once around a modification of the movie inputs */
+static void beginModify()
+{
+    if (inputs_to_be_changed)
+        inputs_to_be_changed();
+}
+
+static void endModify()
+{
+    movie->inputs->updateLength();
+    if (inputs_changed)
+        inputs_changed();
+}
+
+int Lua::Movie::getInputs(lua_State *L)
+{
+    uint64_t pos = static_cast<uint64_t>(luaL_checkinteger(L, 1));
+
+    if (!movie || (pos >= movie->inputs->nbFrames())) {
+        lua_pushnil(L);
+        return 1;
+    }
+
+    pushInputs(L, movie->inputs->input_list[pos]);
+    return 1;
+}
+
+int Lua::Movie::setInputs(lua_State *L)
+{
+    uint64_t pos = static_cast<uint64_t>(luaL_checkinteger(L, 1));
+    std::vector<AllInputs> list(1);
+    toInputs(L, 2, list[0]);
+
+    if (!canModify(pos)) {
+        lua_pushboolean(L, 0);
+        return 1;
+    }
+
+    beginModify();
+    movie->inputs->setInputsRange(list, pos);
+    endModify();
+
+    lua_pushboolean(L, 1);
+    return 1;
+}
+
+int Lua::Movie::getInputsRange(lua_State *L)
+{
+    uint64_t pos = static_cast<uint64_t>(luaL_checkinteger(L, 1));
+    uint64_t count = static_cast<uint64_t>(luaL_checkinteger(L, 2));
+
+    lua_newtable(L);
+    if (!movie)
+        return 1;
+
+    uint64_t end = pos + count;
+    if (end > movie->inputs->nbFrames())
+        end = movie->inputs->nbFrames();
+
+    int i = 1;
+    for (uint64_t f = pos; f < end; f++) {
+        pushInputs(L, movie->inputs->input_list[f]);
+        lua_rawseti(L, -2, i++);
+    }
+    return 1;
+}
+
+int Lua::Movie::setInputsRange(lua_State *L)
+{
+    uint64_t pos = static_cast<uint64_t>(luaL_checkinteger(L, 1));
+    std::vector<AllInputs> list;
+    toInputsList(L, 2, list);
+
+    if (!canModify(pos)) {
+        lua_pushboolean(L, 0);
+        return 1;
+    }
+
+    beginModify();
+    movie->inputs->setInputsRange(list, pos);
+    endModify();
+
+    lua_pushboolean(L, 1);
+    return 1;
+}
+
+int Lua::Movie::insertInputs(lua_State *L)
+{
+    uint64_t pos = static_cast<uint64_t>(luaL_checkinteger(L, 1));
+    std::vector<AllInputs> list;
+
+    if (lua_istable(L, 2)) {
+        toInputsList(L, 2, list);
+    }
+    else {
+        lua_Integer count = luaL_checkinteger(L, 2);
+        if (count < 0)
+            return luaL_argerror(L, 2, "count must be positive");
+
+        AllInputs ai;
+        ai.emptyInputs();
+        list.assign(count, ai);
+    }
+
+    if (!canModify(pos)) {
+        lua_pushboolean(L, 0);
+        return 1;
+    }
+
+    beginModify();
+    movie->inputs->insertInputsBefore(list, pos);
+    endModify();
+
+    lua_pushboolean(L, 1);
+    return 1;
+}
+
+int Lua::Movie::deleteInputs(lua_State *L)
+{
+    uint64_t pos = static_cast<uint64_t>(luaL_checkinteger(L, 1));
+    uint64_t count = static_cast<uint64_t>(luaL_checkinteger(L, 2));
+
+    if (!canModify(pos) || (pos == movie->inputs->nbFrames())) {
+        lua_pushboolean(L, 0);
+        return 1;
+    }
+
+    beginModify();
+    movie->inputs->deleteInputs(pos, count);
+    endModify();
+
+    lua_pushboolean(L, 1);
+    return 1;
+}
+
+int Lua::Movie::copyInputs(lua_State *L)
+{
+    uint64_t src = static_cast<uint64_t>(luaL_checkinteger(L, 1));
+    uint64_t dst = static_cast<uint64_t>(luaL_checkinteger(L, 2));
+    uint64_t count = static_cast<uint64_t>(luaL_checkinteger(L, 3));
+
+    if (!canModify(dst) || ((src + count) > movie->inputs->nbFrames())) {
+        lua_pushboolean(L, 0);
+        return 1;
+    }
+
+    /* Ranges may overlap, so copy the source first */
+    std::vector<AllInputs> list(movie->inputs->input_list.begin() + src,
+        movie->inputs->input_list.begin() + src + count);
+
+    beginModify();
+    movie->inputs->setInputsRange(list, dst);
+    endModify();
+
+    lua_pushboolean(L, 1);
+    return 1;
+}
+
+/* Iterator function, with the next frame and the last frame as upvalues */
+static int inputsIterator(lua_State *L)
+{
+    lua_Integer frame = lua_tointeger(L, lua_upvalueindex(1));
+    lua_Integer last = lua_tointeger(L, lua_upvalueindex(2));
+
+    if (!movie || (frame > last) || (static_cast<uint64_t>(frame) >= movie->inputs->nbFrames()))
+        return 0;
+
+    lua_pushinteger(L, frame + 1);
+    lua_replace(L, lua_upvalueindex(1));
+
+    lua_pushinteger(L, frame);
+    pushInputs(L, movie->inputs->input_list[frame]);
+    return 2;
+}
+
+int Lua::Movie::inputs(lua_State *L)
+{
+    lua_Integer first = luaL_checkinteger(L, 1);
+    lua_Integer last = luaL_optinteger(L, 2, LUA_MAXINTEGER);
+
+    lua_pushinteger(L, first);
+    lua_pushinteger(L, last);
+    lua_pushcclosure(L, inputsIterator, 2);
+    return 1;
+}
@@ -21,6 +21,8 @@
 #define LIBTAS_LUAMOVIE_H_INCLUDED
 
 #include "../Context.h"
+#include "../movie/MovieFile.h"
+#include <functional>
 extern "C" {
 #include <lua.h>
 }
@@ -32,6 +34,10 @@ namespace Movie {
     /* Register all functions */
     void registerFunctions(Context* context);
 
+    /* Register the movie whose inputs are accessed, and the functions
+     * notifying the input editor before and after inputs are modified */
+    void registerMovie(MovieFile* movie, std::function<void()> toBeChanged, std::function<void()> changed);
+
     /* Get the current framecount */
     int currentFrame(lua_State *L);
 
@@ -47,6 +53,49 @@ namespace Movie {
     /* Get the movie rerecord count */
     int rerecords(lua_State *L);
 
+    /* Suspend the calling coroutine until the beginning of the next frame.
+     * The game advances even when paused while a coroutine is waiting. */
+    int frameAdvance(lua_State *L);
+
+    /* Get the inputs of a frame as a table, or nil if the frame is past the
+     * end of the movie.
+     * Argument: frame */
+    int getInputs(lua_State *L);
+
+    /* Set the inputs of a frame from a table. The frame can be right after
+     * the end of the movie. Returns if the inputs were set.
+     * Arguments: frame, inputs */
+    int setInputs(lua_State *L);
+
+    /* Get the inputs of a range of frames as an array of tables, stopping
+     * at the end of the movie.
+     * Arguments: first frame, number of frames */
+    int getInputsRange(lua_State *L);
+
+    /* Set the inputs of consecutive frames from an array of tables, which can
+     * extend the movie. Returns if the inputs were set.
+     * Arguments: first frame, array of inputs */
+    int setInputsRange(lua_State *L);
+
+    /* Insert frames before a frame, either a number of blank frames or an
+     * array of inputs. Returns if the frames were inserted.
+     * Arguments: frame, count or array of inputs */
+    int insertInputs(lua_State *L);
+
+    /* Delete a range of frames. Returns if the frames were deleted.
+     * Arguments: first frame, number of frames */
+    int deleteInputs(lua_State *L);
+
+    /* Copy inputs of a range of frames over another range, which can extend
+     * the movie. Returns if the inputs were copied.
+     * Arguments: source frame, destination frame, number of frames */
+    int copyInputs(lua_State *L);
+
+    /* Return an iterator over the inputs of a range of frames, to be used as
+     * `for frame, inputs in movie.inputs(first, last) do`.
+     * Arguments: first frame, optional last frame (included) */
+    int inputs(lua_State *L);
+
 }
 }
 
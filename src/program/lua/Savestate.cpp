@@ -0,0 +1,84 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Savestate.h"
+
+#include <iostream>
+extern "C" {
+#include <lua.h>
+#include <lauxlib.h>
+}
+
+static Context* context;
+static Lua::Savestate::StateFunction save_function;
+static Lua::Savestate::StateFunction load_function;
+static bool is_allowed = false;
+
+/* List of functions to register */
+static const luaL_Reg savestate_functions[] =
+{
+    { "save", Lua::Savestate::save},
+    { "load", Lua::Savestate::load},
+    { NULL, NULL }
+};
+
+void Lua::Savestate::registerFunctions(Context* c)
+{
+    context = c;
+    luaL_newlib(context->lua_state, savestate_functions);
+    lua_setglobal(context->lua_state, "savestate");
+}
+
+void Lua::Savestate::setStateFunctions(StateFunction save, StateFunction load)
+{
+    save_function = save;
+    load_function = load;
+}
+
+void Lua::Savestate::allow(bool allowed)
+{
+    is_allowed = allowed;
+}
+
+/* Check the arguments and the state of the game loop, and return the slot */
+static int checkSlot(lua_State *L)
+{
+    int slot = static_cast<int>(luaL_checkinteger(L, 1));
+    if ((slot < 1) || (slot > 9))
+        luaL_argerror(L, 1, "slot must be between 1 and 9");
+
+    if (!is_allowed)
+        luaL_error(L, "savestates can only be used from a coroutine resumed by movie.frameAdvance()");
+
+    return slot;
+}
+
+int Lua::Savestate::save(lua_State *L)
+{
+    int slot = checkSlot(L);
+    lua_pushboolean(L, save_function && save_function(slot));
+    return 1;
+}
+
+int Lua::Savestate::load(lua_State *L)
+{
+    int slot = checkSlot(L);
+    lua_pushboolean(L, load_function && load_function(slot));
+    return 1;
+}
@@ -0,0 +1,56 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBTAS_LUASAVESTATE_H_INCLUDED
+#define LIBTAS_LUASAVESTATE_H_INCLUDED
+
+#include "../Context.h"
+#include <functional>
+extern "C" {
+#include <lua.h>
+}
+
+namespace Lua {
+
+namespace Savestate {
+
+    /* Function that saves or loads a state from its slot, and returns if
+     * it succeeded. Provided by the game loop. */
+    typedef std::function<bool(int)> StateFunction;
+
+    /* Register all functions */
+    void registerFunctions(Context* context);
+
+    /* Set the functions performing the savestate operations */
+    void setStateFunctions(StateFunction save, StateFunction load);
+
+    /* Allow or forbid savestate operations. They are only allowed at the
+     * beginning of a frame, before inputs are processed */
+    void allow(bool allowed);
+
+    /* Save a state in a slot (1 to 9). Returns if saving succeeded */
+    int save(lua_State *L);
+
+    /* Load a state from a slot (1 to 9). Returns if loading succeeded */
+    int load(lua_State *L);
+
+}
+}
+
+#endif
@@ -172,6 +172,9 @@ int main(int argc, char **argv)
     if (error) {
     	std::cerr << "failed to set XKB per-client flags, not using detectable repeat" << std::endl;
     }
+    else if (pcf_reply) {
+        context.detectable_autorepeat = pcf_reply->value & XCB_XKB_PER_CLIENT_FLAG_DETECTABLE_AUTO_REPEAT;
+    }
     free(pcf_reply);
 
     /* Initialize mouse cursor.
@@ -336,6 +339,10 @@ int main(int argc, char **argv)
             /* The game didn't close. Kill it */
             kill(context.game_pid, SIGKILL);
         }
+
+        /* Terminate the launch template if any */
+        if (context.template_pid)
+            kill(context.template_pid, SIGKILL);
     }
 
     xcb_free_cursor (context.conn, context.crosshair_cursor);
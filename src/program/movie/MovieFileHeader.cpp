@@ -50,6 +50,7 @@ void MovieFileHeader::load()
     context->config.sc.nb_controllers = config.value("nb_controllers").toInt();
     context->config.sc.initial_time_sec = config.value("initial_time_sec").toULongLong();
     context->config.sc.initial_time_nsec = config.value("initial_time_nsec").toULongLong();
+    context->config.sc.prng_seed = config.value("prng_seed").toULongLong();
 
     framerate_num = config.value("framerate_num").toUInt();
     framerate_den = config.value("framerate_den").toUInt();
@@ -73,6 +74,11 @@ void MovieFileHeader::load()
     context->rerecord_count = config.value("rerecord_count").toUInt();
     context->authors = config.value("authors").toString().toStdString();
     context->md5_movie = config.value("md5").toString().toStdString();
+    context->movie_hashes.clear();
+    config.beginGroup("game_hashes");
+    for (const QString& key : config.allKeys())
+        context->movie_hashes[key.toStdString()] = config.value(key).toString().toStdString();
+    config.endGroup();
     savestate_framecount = config.value("savestate_frame_count").toULongLong();
     context->config.auto_restart = config.value("auto_restart").toBool();
     context->config.sc.variable_framerate = config.value("variable_framerate").toBool();
@@ -127,6 +133,7 @@ void MovieFileHeader::save(uint64_t tot_frames, uint64_t nb_frames)
     config.setValue("nb_controllers", context->config.sc.nb_controllers);
     config.setValue("initial_time_sec", static_cast<unsigned long long>(context->config.sc.initial_time_sec));
     config.setValue("initial_time_nsec", static_cast<unsigned long long>(context->config.sc.initial_time_nsec));
+    config.setValue("prng_seed", static_cast<unsigned long long>(context->config.sc.prng_seed));
     config.setValue("length_sec", static_cast<unsigned long long>(context->movie_time_sec));
     config.setValue("length_nsec", static_cast<unsigned long long>(context->movie_time_nsec));
     config.setValue("framerate_num", framerate_num);
@@ -143,6 +150,12 @@ void MovieFileHeader::save(uint64_t tot_frames, uint64_t nb_frames)
     if (!context->md5_game.empty())
         config.setValue("md5", context->md5_game.c_str());
 
+    config.remove("game_hashes");
+    config.beginGroup("game_hashes");
+    for (auto& hash : context->game_hashes)
+        config.setValue(hash.first.c_str(), hash.second.c_str());
+    config.endGroup();
+
     config.beginGroup("mainthread_timetrack");
     config.setValue("time", context->config.sc.main_gettimes_threshold[SharedConfig::TIMETYPE_TIME]);
     config.setValue("gettimeofday", context->config.sc.main_gettimes_threshold[SharedConfig::TIMETYPE_GETTIMEOFDAY]);
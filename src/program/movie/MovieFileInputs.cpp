@@ -19,8 +19,10 @@
 
 #include <QSettings>
 #include <iostream>
+#include <algorithm>
 
 #include "MovieFileInputs.h"
+#include "../GreenZone.h"
 #include "../utils.h"
 #include "../../shared/version.h"
 
@@ -374,7 +376,7 @@ int MovieFileInputs::setInputs(const AllInputs& inputs, uint64_t pos, bool keep_
     /* Check that we are writing to the next frame */
     if (pos == input_list.size()) {
         input_list.push_back(inputs);
-        wasModified();
+        wasModified(pos);
         return 0;
     }
     else if (pos < input_list.size()) {
@@ -383,13 +385,17 @@ int MovieFileInputs::setInputs(const AllInputs& inputs, uint64_t pos, bool keep_
          * the end.
          */
         if (keep_inputs) {
+            /* Don't flag the movie as modified when playing back the same
+             * inputs, which would discard the greenzone after this frame */
+            if (input_list[pos] == inputs)
+                return 0;
             input_list[pos] = inputs;
         }
         else {
             input_list.resize(pos);
             input_list.push_back(inputs);
         }
-        wasModified();
+        wasModified(pos);
         return 0;
     }
     else {
@@ -398,6 +404,21 @@ int MovieFileInputs::setInputs(const AllInputs& inputs, uint64_t pos, bool keep_
     }
 }
 
+int MovieFileInputs::setInputsRange(const std::vector<AllInputs>& inputs, uint64_t pos)
+{
+    if (pos > input_list.size()) {
+        std::cerr << "Writing to a frame " << pos << " higher than the current list " << input_list.size() << std::endl;
+        return 1;
+    }
+
+    if ((pos + inputs.size()) > input_list.size())
+        input_list.resize(pos + inputs.size());
+
+    std::copy(inputs.begin(), inputs.end(), input_list.begin() + pos);
+    wasModified(pos);
+    return 0;
+}
+
 int MovieFileInputs::getInputs(AllInputs& inputs) const
 {
     return getInputs(inputs, context->framecount);
@@ -434,7 +455,16 @@ void MovieFileInputs::insertInputsBefore(const AllInputs& inputs, uint64_t pos)
         return;
 
     input_list.insert(input_list.begin() + pos, inputs);
-    wasModified();
+    wasModified(pos);
+}
+
+void MovieFileInputs::insertInputsBefore(const std::vector<AllInputs>& inputs, uint64_t pos)
+{
+    if (pos > input_list.size())
+        return;
+
+    input_list.insert(input_list.begin() + pos, inputs.begin(), inputs.end());
+    wasModified(pos);
 }
 
 void MovieFileInputs::deleteInputs(uint64_t pos)
@@ -443,7 +473,19 @@ void MovieFileInputs::deleteInputs(uint64_t pos)
         return;
 
     input_list.erase(input_list.begin() + pos);
-    wasModified();
+    wasModified(pos);
+}
+
+void MovieFileInputs::deleteInputs(uint64_t pos, uint64_t count)
+{
+    if (pos >= input_list.size())
+        return;
+
+    if (count > (input_list.size() - pos))
+        count = input_list.size() - pos;
+
+    input_list.erase(input_list.begin() + pos, input_list.begin() + pos + count);
+    wasModified(pos);
 }
 
 // void MovieFileInputs::truncateInputs(uint64_t size)
@@ -466,9 +508,12 @@ bool MovieFileInputs::isPrefix(const MovieFileInputs* movie, unsigned int frame)
     return std::equal(movie->input_list.begin(), movie->input_list.begin() + frame, input_list.begin());
 }
 
-void MovieFileInputs::wasModified()
+void MovieFileInputs::wasModified(uint64_t pos)
 {
     modifiedSinceLastSave = true;
     modifiedSinceLastAutoSave = true;
     modifiedSinceLastStateLoad = true;
+
+    /* States taken after this frame don't match the inputs anymore */
+    GreenZone::invalidate(pos);
 }
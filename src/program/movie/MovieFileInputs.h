@@ -89,12 +89,23 @@ public:
     /* Load inputs from the current frame */
     int getInputs(AllInputs& inputs) const;
 
+    /* Set a range of inputs starting at a certain frame, keeping the inputs
+     * that follow. The range can extend the movie. Returns 1 if pos is past
+     * the end of the movie */
+    int setInputsRange(const std::vector<AllInputs>& inputs, uint64_t pos);
+
     /* Insert inputs before the requested pos */
     void insertInputsBefore(const AllInputs& inputs, uint64_t pos);
 
+    /* Insert a range of inputs before the requested pos */
+    void insertInputsBefore(const std::vector<AllInputs>& inputs, uint64_t pos);
+
     /* Delete inputs at the requested pos */
     void deleteInputs(uint64_t pos);
 
+    /* Delete a range of inputs starting at the requested pos */
+    void deleteInputs(uint64_t pos, uint64_t count);
+
     /* Truncate inputs to a frame number */
     // void truncateInputs(uint64_t size);
 
@@ -105,8 +116,9 @@ public:
      * a specified frame count. */
     bool isPrefix(const MovieFileInputs* movie, unsigned int frame) const;
 
-    /* Helper function called when the movie has been modified */
-    void wasModified();
+    /* Helper function called when the movie has been modified, starting
+     * from frame pos */
+    void wasModified(uint64_t pos);
 
 private:
     Context* context;
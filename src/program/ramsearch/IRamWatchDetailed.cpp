@@ -34,47 +34,7 @@ void IRamWatchDetailed::update_addr()
     if (isPointer) {
         struct iovec local, remote;
 
-        /* Update the base address from the file and file offset */
-        if (!base_address) {
-
-            /* If file is empty, address is absolute */
-            if (base_file.empty()) {
-                base_address = base_file_offset;
-            }
-            else {
-                /* Compose the filename for the /proc memory map, and open it. */
-                std::ostringstream oss;
-                oss << "/proc/" << game_pid << "/maps";
-                std::ifstream mapsfile(oss.str());
-                if (!mapsfile) {
-                    std::cerr << "Could not open " << oss.str() << std::endl;
-                    return;
-                }
-
-                std::string line;
-                MemSection::reset();
-
-                while (std::getline(mapsfile, line)) {
-                    MemSection section;
-                    section.readMap(line);
-                    std::string file = fileFromPath(section.filename);
-
-                    if (base_file.compare(file) == 0) {
-                        if ((base_file_offset >= 0) &&
-                            (base_file_offset >= section.offset) &&
-                            (base_file_offset < (section.offset + section.size))) {
-
-                            base_address = section.addr - section.offset + base_file_offset;
-                            break;
-                        }
-                        if (base_file_offset < 0) {
-                            base_address = section.endaddr + base_file_offset;
-                            break;                            
-                        }
-                    }
-                }
-            }
-        }
+        update_base_addr();
 
         address = base_address;
         for (auto offset : pointer_offsets) {
@@ -93,3 +53,48 @@ void IRamWatchDetailed::update_addr()
     }
 
 }
+
+void IRamWatchDetailed::update_base_addr()
+{
+    /* Update the base address from the file and file offset */
+    if (!base_address) {
+
+        /* If file is empty, address is absolute */
+        if (base_file.empty()) {
+            base_address = base_file_offset;
+        }
+        else {
+            /* Compose the filename for the /proc memory map, and open it. */
+            std::ostringstream oss;
+            oss << "/proc/" << game_pid << "/maps";
+            std::ifstream mapsfile(oss.str());
+            if (!mapsfile) {
+                std::cerr << "Could not open " << oss.str() << std::endl;
+                return;
+            }
+
+            std::string line;
+            MemSection::reset();
+
+            while (std::getline(mapsfile, line)) {
+                MemSection section;
+                section.readMap(line);
+                std::string file = fileFromPath(section.filename);
+
+                if (base_file.compare(file) == 0) {
+                    if ((base_file_offset >= 0) &&
+                        (base_file_offset >= section.offset) &&
+                        (base_file_offset < (section.offset + section.size))) {
+
+                        base_address = section.addr - section.offset + base_file_offset;
+                        break;
+                    }
+                    if (base_file_offset < 0) {
+                        base_address = section.endaddr + base_file_offset;
+                        break;                            
+                    }
+                }
+            }
+        }
+    }
+}
@@ -33,9 +33,17 @@ public:
     /* Update the actual address to look at (in case of pointer chain) */
     void update_addr();
 
+    /* Find the base address of a pointer chain from the file and offset,
+     * if not already done */
+    void update_base_addr();
+
     /* Return the current value of the ram watch as a string */
     virtual std::string value_str() = 0;
 
+    /* Return the value stored in the buffer (of the size of the type) as a
+     * string */
+    virtual std::string format_value(const void* value) = 0;
+
     /* Poke a value (given as a string) into the ram watch address. Return
      * the result of process_vm_writev call
      */
@@ -44,6 +52,9 @@ public:
     /* Returns the index of the stored type */
     virtual int type() = 0;
 
+    /* Returns the size of the stored type */
+    virtual int size() = 0;
+
     uintptr_t address;
     std::string label;
     bool hex;
@@ -54,6 +65,12 @@ public:
     off_t base_file_offset;
     std::string base_file;
 
+    /* Address watched for writes by a hardware watchpoint, or 0 */
+    uintptr_t watchpoint_addr = 0;
+
+    /* Value as a string from the last refresh of the ram watch window */
+    std::string value_cache;
+
     static pid_t game_pid;
     static bool isValid;
 
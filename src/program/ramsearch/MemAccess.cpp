@@ -0,0 +1,62 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MemAccess.h"
+
+#include <climits> // IOV_MAX
+#include <cerrno>
+
+std::vector<bool> MemAccess::readVectored(pid_t pid, std::vector<struct iovec>& local, std::vector<struct iovec>& remote)
+{
+    size_t n = local.size();
+    std::vector<bool> valid(n, false);
+
+    size_t i = 0;
+    while (i < n) {
+        size_t count = n - i;
+        if (count > IOV_MAX)
+            count = IOV_MAX;
+
+        ssize_t ret = process_vm_readv(pid, &local[i], count, &remote[i], count, 0);
+        if (ret < 0) {
+            /* The game is gone */
+            if (errno == ESRCH)
+                break;
+
+            /* The first area could not be read */
+            i++;
+            continue;
+        }
+
+        /* Transfers are done at the granularity of iovec elements */
+        size_t k = i;
+        while ((k < i + count) && (static_cast<size_t>(ret) >= local[k].iov_len)) {
+            ret -= local[k].iov_len;
+            valid[k] = true;
+            k++;
+        }
+
+        /* Skip the area that failed */
+        if (k < i + count)
+            k++;
+        i = k;
+    }
+
+    return valid;
+}
@@ -0,0 +1,37 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBTAS_MEMACCESS_H_INCLUDED
+#define LIBTAS_MEMACCESS_H_INCLUDED
+
+#include <vector>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+namespace MemAccess {
+
+    /* Read many memory areas of the game with as few syscalls as possible.
+     * process_vm_readv() stops at the first area that cannot be read, so we
+     * skip that area and continue with the next ones. Returns which areas
+     * were read. */
+    std::vector<bool> readVectored(pid_t pid, std::vector<struct iovec>& local, std::vector<struct iovec>& remote);
+
+}
+
+#endif
@@ -24,6 +24,7 @@
 #include "TypeIndex.h"
 #include <sstream>
 #include <iostream>
+#include <cstring>
 #include <sys/uio.h>
 
 template <class T>
@@ -52,22 +53,32 @@ public:
 
     std::string value_str()
     {
+        T value = get_value();
+        if (!isValid)
+            return std::string("??????");
+
+        return format_value(&value);
+    }
+
+    std::string format_value(const void* data)
+    {
+        T value;
+        memcpy(&value, data, sizeof(T));
+
         std::ostringstream oss;
         if (hex) oss << std::hex;
         /* Output char and unsigned char as integer values. There might be a
          * more elegant solution.
          */
         if (std::is_same<T, char>::value) {
-            oss << static_cast<int>(get_value());
+            oss << static_cast<int>(value);
         }
         else if (std::is_same<T, unsigned char>::value) {
-            oss << static_cast<unsigned int>(get_value());
+            oss << static_cast<unsigned int>(value);
         }
         else {
-            oss << get_value();
+            oss << value;
         }
-        if (!isValid)
-            return std::string("??????");
 
         return oss.str();
     }
@@ -110,6 +121,11 @@ public:
         return type_index<T>();
     }
 
+    int size()
+    {
+        return sizeof(T);
+    }
+
 };
 
 #endif
@@ -20,6 +20,7 @@
 #include <QFormLayout>
 #include "GameInfoWindow.h"
 #include "MainWindow.h"
+#include "../../shared/SharedConfig.h"
 
 GameInfoWindow::GameInfoWindow(QWidget *parent) : QDialog(parent)
 {
@@ -30,6 +31,8 @@ GameInfoWindow::GameInfoWindow(QWidget *parent) : QDialog(parent)
     keyboardLabel = new QLabel(tr("unknown"));
     mouseLabel = new QLabel(tr("unknown"));
     joystickLabel = new QLabel(tr("unknown"));
+    timeTrapLabel = new QLabel(tr("none"));
+    engineLabel = new QLabel(tr("unknown"));
 
     QFormLayout *layout = new QFormLayout;
     layout->addRow(new QLabel(tr("Video support:")), videoLabel);
@@ -37,6 +40,8 @@ GameInfoWindow::GameInfoWindow(QWidget *parent) : QDialog(parent)
     layout->addRow(new QLabel(tr("Keyboard support:")), keyboardLabel);
     layout->addRow(new QLabel(tr("Mouse support:")), mouseLabel);
     layout->addRow(new QLabel(tr("Joystick support:")), joystickLabel);
+    layout->addRow(new QLabel(tr("Low-level time:")), timeTrapLabel);
+    layout->addRow(new QLabel(tr("Game engine:")), engineLabel);
     setLayout(layout);
 
     qRegisterMetaType<GameInfo>("GameInfo");
@@ -161,4 +166,42 @@ void GameInfoWindow::update(GameInfo game_info)
     else {
         joystickLabel->setText(tr("unknown"));
     }
+
+    QStringList timeTraps;
+    if (game_info.time_trap & SharedConfig::TIME_TRAP_SYSCALL)
+        timeTraps << tr("raw syscalls");
+    if (game_info.time_trap & SharedConfig::TIME_TRAP_VDSO)
+        timeTraps << tr("vDSO");
+    if (game_info.time_trap & SharedConfig::TIME_TRAP_TSC)
+        timeTraps << tr("rdtsc");
+    timeTrapLabel->setText(timeTraps.isEmpty() ? tr("none") : timeTraps.join(", "));
+
+    switch (game_info.engine) {
+        case GameInfo::ENGINE_UNITY_MONO:
+            engineLabel->setText(tr("Unity (Mono)"));
+            break;
+        case GameInfo::ENGINE_UNITY_IL2CPP:
+            engineLabel->setText(tr("Unity (IL2CPP)"));
+            break;
+        case GameInfo::ENGINE_UNREAL:
+            engineLabel->setText(tr("Unreal Engine"));
+            break;
+        case GameInfo::ENGINE_GODOT:
+            engineLabel->setText(tr("Godot"));
+            break;
+        case GameInfo::ENGINE_GAMEMAKER:
+            engineLabel->setText(tr("GameMaker"));
+            break;
+        case GameInfo::ENGINE_XNA_FNA:
+            engineLabel->setText(tr("XNA/FNA"));
+            break;
+        case GameInfo::ENGINE_RPGMAKER:
+            engineLabel->setText(tr("RPG Maker"));
+            break;
+        case GameInfo::ENGINE_RENPY:
+            engineLabel->setText(tr("Ren'Py"));
+            break;
+        default:
+            engineLabel->setText(tr("unknown"));
+    }
 }
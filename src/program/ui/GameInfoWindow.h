@@ -36,6 +36,8 @@ private:
     QLabel *keyboardLabel;
     QLabel *mouseLabel;
     QLabel *joystickLabel;
+    QLabel *timeTrapLabel;
+    QLabel *engineLabel;
 
 public slots:
     /* Update UI elements */
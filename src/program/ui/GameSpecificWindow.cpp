@@ -51,6 +51,15 @@ GameSpecificWindow::GameSpecificWindow(Context* c, QWidget *parent) : QDialog(pa
     syncLayout->addWidget(syncWitness);
     syncGroupBox->setLayout(syncLayout);
 
+    /* Engine profile */
+    engineProfile = new QCheckBox("Apply policies of the detected engine");
+    engineProfile->setToolTip("Use the loading threads, sleeps, busy loop detection and wait settings that work for the game engine. The detected engine is shown in the game information window");
+
+    QGroupBox *engineGroupBox = new QGroupBox(tr("Engine profile"));
+    QVBoxLayout *engineLayout = new QVBoxLayout;
+    engineLayout->addWidget(engineProfile);
+    engineGroupBox->setLayout(engineLayout);
+
     QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
 
     connect(buttonBox, &QDialogButtonBox::accepted, this, &GameSpecificWindow::slotOk);
@@ -66,6 +75,7 @@ GameSpecificWindow::GameSpecificWindow(Context* c, QWidget *parent) : QDialog(pa
     QVBoxLayout *mainLayout = new QVBoxLayout;
 
     mainLayout->addLayout(settingsLayout);
+    mainLayout->addWidget(engineGroupBox);
     mainLayout->addStretch(1);
     mainLayout->addWidget(buttonBox);
 
@@ -79,6 +89,7 @@ void GameSpecificWindow::update_config()
     timingCeleste->setChecked(context->config.sc.game_specific_timing & SharedConfig::GC_TIMING_CELESTE);
     syncCeleste->setChecked(context->config.sc.game_specific_sync & SharedConfig::GC_SYNC_CELESTE);
     syncWitness->setChecked(context->config.sc.game_specific_sync & SharedConfig::GC_SYNC_WITNESS);
+    engineProfile->setChecked(context->config.sc.engine_profile);
 }
 
 void GameSpecificWindow::slotOk()
@@ -93,6 +104,8 @@ void GameSpecificWindow::slotOk()
     if (syncWitness->isChecked())
         context->config.sc.game_specific_sync |= SharedConfig::GC_SYNC_WITNESS;
 
+    context->config.sc.engine_profile = engineProfile->isChecked();
+
     context->config.sc_modified = true;
 
     /* Close window */
@@ -0,0 +1,87 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QDialogButtonBox>
+#include <QVBoxLayout>
+#include <QFormLayout>
+#include <QLabel>
+#include <QSpinBox>
+
+#include "GreenZoneWindow.h"
+
+GreenZoneWindow::GreenZoneWindow(Context* c, QWidget *parent) : QDialog(parent), context(c)
+{
+    setWindowTitle("Greenzone configuration");
+
+    greenzoneBox = new QGroupBox(tr("Take savestates while the input editor is opened"));
+    greenzoneBox->setCheckable(true);
+
+    greenzoneInterval = new QSpinBox();
+    greenzoneInterval->setMinimum(1);
+    greenzoneInterval->setMaximum(1000000000);
+
+    greenzoneMemory = new QSpinBox();
+    greenzoneMemory->setMaximum(1000000);
+    greenzoneMemory->setSuffix(tr(" MB"));
+    greenzoneMemory->setSpecialValueText(tr("Unlimited"));
+
+    /* Create the form layout */
+    QFormLayout *formLayout = new QFormLayout;
+    formLayout->addRow(new QLabel(tr("Frames between states near the current frame:")), greenzoneInterval);
+    formLayout->addRow(new QLabel(tr("Maximum memory used by states:")), greenzoneMemory);
+
+    greenzoneBox->setLayout(formLayout);
+
+    QLabel *infoLabel = new QLabel(tr("States get sparser with the distance from the current frame, and are removed when earlier inputs are modified."));
+    infoLabel->setWordWrap(true);
+
+    /* Buttons */
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Save | QDialogButtonBox::Cancel);
+
+    connect(buttonBox, &QDialogButtonBox::accepted, this, &GreenZoneWindow::slotOk);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &GreenZoneWindow::reject);
+
+    /* Create the main layout */
+    QVBoxLayout *mainLayout = new QVBoxLayout;
+
+    mainLayout->addWidget(greenzoneBox);
+    mainLayout->addWidget(infoLabel);
+    mainLayout->addWidget(buttonBox);
+
+    setLayout(mainLayout);
+
+    update_config();
+}
+
+void GreenZoneWindow::update_config()
+{
+    greenzoneBox->setChecked(context->config.greenzone);
+    greenzoneInterval->setValue(context->config.greenzone_interval);
+    greenzoneMemory->setValue(context->config.greenzone_memory);
+}
+
+void GreenZoneWindow::slotOk()
+{
+    context->config.greenzone = greenzoneBox->isChecked();
+    context->config.greenzone_interval = greenzoneInterval->value();
+    context->config.greenzone_memory = greenzoneMemory->value();
+
+    /* Close window */
+    accept();
+}
@@ -0,0 +1,71 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QPainter>
+
+#include "InputEditorDelegate.h"
+
+InputEditorDelegate::InputEditorDelegate(InputEditorModel *model, QObject *parent) : QStyledItemDelegate(parent), inputEditorModel(model) {}
+
+const QPixmap& InputEditorDelegate::glyph(int column, bool selected, const QStyleOptionViewItem &option, qreal ratio) const
+{
+    if (static_cast<int>(glyphs.size()) <= column)
+        glyphs.resize(column + 1);
+
+    Glyph& g = glyphs[column][selected ? 1 : 0];
+    const QString& label = inputEditorModel->columnLabel(column);
+    QColor color = option.palette.color(QPalette::Normal, selected ? QPalette::HighlightedText : QPalette::Text);
+
+    /* Render the label again if anything changed */
+    if ((g.label != label) || (g.size != option.rect.size()) || (g.color != color.rgba()) || (g.ratio != ratio)) {
+        g.label = label;
+        g.size = option.rect.size();
+        g.color = color.rgba();
+        g.ratio = ratio;
+
+        g.pixmap = QPixmap(g.size * ratio);
+        g.pixmap.setDevicePixelRatio(ratio);
+        g.pixmap.fill(Qt::transparent);
+
+        QPainter p(&g.pixmap);
+        p.setFont(option.font);
+        p.setPen(color);
+        p.drawText(QRect(QPoint(0, 0), g.size), Qt::AlignCenter, label);
+    }
+
+    return g.pixmap;
+}
+
+void InputEditorDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    if ((index.column() < 2) || inputEditorModel->isInputAnalog(index.column())) {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+
+    bool selected = option.state & QStyle::State_Selected;
+
+    if (selected)
+        painter->fillRect(option.rect, option.palette.brush(QPalette::Normal, QPalette::Highlight));
+    else
+        painter->fillRect(option.rect, qvariant_cast<QBrush>(index.data(Qt::BackgroundRole)));
+
+    if (inputEditorModel->isInputSet(index.row(), index.column()))
+        painter->drawPixmap(option.rect.topLeft(), glyph(index.column(), selected, option, painter->device()->devicePixelRatioF()));
+}
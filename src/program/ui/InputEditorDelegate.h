@@ -0,0 +1,56 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBTAS_INPUTEDITORDELEGATE_H_INCLUDED
+#define LIBTAS_INPUTEDITORDELEGATE_H_INCLUDED
+
+#include <QStyledItemDelegate>
+#include <QPixmap>
+#include <array>
+#include <vector>
+
+#include "InputEditorModel.h"
+
+/* Paint digital input cells from cached pixmaps of the input label, instead
+ * of laying out the text of each cell on every paint. Other cells are
+ * painted by the default delegate. */
+class InputEditorDelegate : public QStyledItemDelegate {
+public:
+    InputEditorDelegate(InputEditorModel *model, QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+private:
+    InputEditorModel *inputEditorModel;
+
+    struct Glyph {
+        QString label;
+        QSize size;
+        QRgb color = 0;
+        qreal ratio = 0;
+        QPixmap pixmap;
+    };
+
+    /* Label pixmap of each column, for unselected and selected cells */
+    mutable std::vector<std::array<Glyph, 2>> glyphs;
+
+    const QPixmap& glyph(int column, bool selected, const QStyleOptionViewItem &option, qreal ratio) const;
+};
+
+#endif
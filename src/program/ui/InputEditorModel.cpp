@@ -26,13 +26,35 @@
 #include <sstream>
 #include <iostream>
 #include <set>
+#include <algorithm>
 
 #include "InputEditorModel.h"
 #include "../SaveStateList.h"
+#include "../GreenZone.h"
 
 InputEditorModel::InputEditorModel(Context* c, MovieFile* m, QObject *parent) : QAbstractTableModel(parent), context(c), movie(m)
 {
     savestate_frames.fill(-1);
+
+    bold_font.setBold(true);
+    updateBrushes();
+
+    /* Keep cached row and column information in sync */
+    auto rowsChanged = [this]() {
+        row_states.clear();
+        known_rows = rowCount();
+    };
+    connect(this, &QAbstractItemModel::rowsInserted, this, rowsChanged);
+    connect(this, &QAbstractItemModel::rowsRemoved, this, rowsChanged);
+    connect(this, &QAbstractItemModel::modelReset, this, rowsChanged);
+
+    auto columnsChanged = [this]() {
+        column_cache_valid = false;
+    };
+    connect(this, &QAbstractItemModel::columnsInserted, this, columnsChanged);
+    connect(this, &QAbstractItemModel::columnsRemoved, this, columnsChanged);
+    connect(this, &QAbstractItemModel::modelReset, this, columnsChanged);
+    connect(this, &InputEditorModel::inputSetChanged, this, columnsChanged);
 }
 
 int InputEditorModel::rowCount(const QModelIndex & /*parent*/) const
@@ -98,84 +120,37 @@ QVariant InputEditorModel::data(const QModelIndex &index, int role) const
     }
 
     if (role == Qt::FontRole) {
-        QFont font;
         if ((index.column() == 0) && (index.row() == last_savestate)) {
-            font.setBold(true);
+            return bold_font;
         }
-        return font;
+        return QVariant();
     }
 
     if (role == Qt::BackgroundRole) {
-        /* Main color */
-        QColor color = QGuiApplication::palette().window().color();
-        int r, g, b;
-        color.getRgb(&r, &g, &b, nullptr);
-        
-        if (color.lightness() > 128) {
-            /* Light theme */
-            if (index.row() == static_cast<int>(context->framecount))
-                color.setRgb(r - 0x30, g - 0x10, b);
-            else if (index.row() < static_cast<int>(context->framecount)) {
-                if (movie->editor->isDraw(index.row()))
-                    color.setRgb(r - 0x30, g, b - 0x30);
-                else
-                    color.setRgb(r, g - 0x30, b - 0x30);
-            }
-            else {
-                if (movie->editor->isDraw(index.row()))
-                    color.setRgb(r, g, b - 0x18);
-                else
-                    color.setRgb(r, g - 0x18, b - 0x18);
-            }
-        }
-        else {
-            /* Dark theme */
-            if (index.row() == static_cast<int>(context->framecount))
-                color.setRgb(r, g + 0x10, b + 0x20);
-            else if (index.row() < static_cast<int>(context->framecount)) {
-                if (movie->editor->isDraw(index.row()))
-                    color.setRgb(r, g + 0x18, b);
-                else
-                    color.setRgb(r + 0x18, g, b);
-            }
-            else {
-                if (movie->editor->isDraw(index.row()))
-                    color.setRgb(r + 0x08, g + 0x08, b);
-                else
-                    color.setRgb(r + 0x08, g, b);
-            }
-        }
+        int row = index.row();
+        int framecount = static_cast<int>(context->framecount);
+        uint8_t state = rowState(row);
+
+        int position = (row == framecount) ? 0 : ((row < framecount) ? 1 : 2);
+        int nondraw = (state & ROW_NONDRAW) ? 1 : 0;
+        int type = 0;
+        if (index.column() > 1)
+            type = columnInfo(index.column()).locked ? 2 : 1;
+
+        int darker = 0;
 
-        /* Frame column */
-        if (index.column() <= 1) {
-            color = color.lighter(105);
-        }
-        else {
-            /* Check for locked input */
-            if (!movie->editor->locked_inputs.empty()) {
-                const SingleInput si = movie->editor->input_set[index.column()-2];
-                if (movie->editor->locked_inputs.find(si) != movie->editor->locked_inputs.end()) {
-                    color = color.darker(150);
-                }
-            }
-        }
-        
         /* Greenzone */
-        if (index.row() < static_cast<int>(context->framecount)) {
+        if (row < framecount) {
             uint64_t root_frame = SaveStateList::rootStateFramecount();
-            if (!root_frame && index.row() >= root_frame)
-                color = color.darker(105);            
+            if (!root_frame && row >= root_frame)
+                darker++;
         }
 
         /* Frame containing a savestate */
-        for (unsigned int i=0; i<savestate_frames.size(); i++) {
-            if (savestate_frames[i] == index.row()) {
-                color = color.darker(105);
-                break;
-            }
-        }
+        if (state & ROW_SAVESTATE)
+            darker++;
 
-        return QBrush(color);
+        return brushes[((position * 2 + nondraw) * 3 + type) * 3 + darker];
     }
 
     if (role == Qt::DisplayRole) {
@@ -183,9 +158,11 @@ QVariant InputEditorModel::data(const QModelIndex &index, int role) const
             return QVariant();
         }
         if (index.column() == 0) {
-            for (unsigned int i=0; i<savestate_frames.size(); i++) {
-                if (savestate_frames[i] == index.row()) {
-                    return i;
+            if (rowState(index.row()) & ROW_SAVESTATE) {
+                for (unsigned int i=0; i<savestate_frames.size(); i++) {
+                    if (savestate_frames[i] == index.row()) {
+                        return i;
+                    }
                 }
             }
             return QString("");
@@ -194,18 +171,19 @@ QVariant InputEditorModel::data(const QModelIndex &index, int role) const
             return index.row();
         }
 
-        const AllInputs ai = movie->inputs->input_list[index.row()];
-        const SingleInput si = movie->editor->input_set[index.column()-2];
+        const ColumnInfo& ci = columnInfo(index.column());
+        const AllInputs& ai = movie->inputs->input_list[index.row()];
+        const SingleInput& si = movie->editor->input_set[index.column()-2];
 
         /* Get the value of the single input in movie inputs */
         int value = ai.getInput(si);
 
-        if (si.isAnalog()) {
+        if (ci.analog) {
             return QString().setNum(value);
         }
 
         if (value) {
-            return QString(si.description.c_str());
+            return ci.label;
         }
         else {
             return QString("");
@@ -226,7 +204,7 @@ QVariant InputEditorModel::data(const QModelIndex &index, int role) const
         if (movie->editor->locked_inputs.find(si) != movie->editor->locked_inputs.end())
             return QVariant();
 
-        const AllInputs ai = movie->inputs->input_list[index.row()];
+        const AllInputs& ai = movie->inputs->input_list[index.row()];
 
         /* Get the value of the single input in movie inputs */
         int value = ai.getInput(si);
@@ -269,7 +247,7 @@ bool InputEditorModel::setData(const QModelIndex &index, const QVariant &value,
         int ivalue = value.toInt();
 
         ai.setInput(si, ivalue);
-        movie->inputs->wasModified();
+        movie->inputs->wasModified(index.row());
         emit dataChanged(index, index, {role});
         return true;
     }
@@ -277,7 +255,7 @@ bool InputEditorModel::setData(const QModelIndex &index, const QVariant &value,
 }
 
 
-void InputEditorModel::buildInputSet()
+std::vector<SingleInput> InputEditorModel::newInputs()
 {
     std::set<SingleInput> new_input_set;
 
@@ -287,26 +265,49 @@ void InputEditorModel::buildInputSet()
     }
 
     /* Remove inputs already on the list */
-    for (SingleInput si : movie->editor->input_set) {
+    for (const SingleInput& si : movie->editor->input_set) {
         new_input_set.erase(si);
     }
 
-    /* Add the new inputs if any */
+    std::vector<SingleInput> new_inputs;
     for (SingleInput si : new_input_set) {
 
         /* Gather input description */
-        for (SingleInput ti : context->config.km.input_list) {
+        for (const SingleInput& ti : context->config.km.input_list) {
             if (si == ti) {
                 si.description = ti.description;
                 break;
             }
         }
 
-        /* Insert input */
+        new_inputs.push_back(si);
+    }
+
+    return new_inputs;
+}
+
+void InputEditorModel::buildInputSet()
+{
+    /* Add the new inputs if any */
+    for (const SingleInput& si : newInputs()) {
         movie->editor->input_set.push_back(si);
     }
 }
 
+void InputEditorModel::extendInputSet()
+{
+    std::vector<SingleInput> new_inputs = newInputs();
+    if (new_inputs.empty())
+        return;
+
+    beginInsertColumns(QModelIndex(), columnCount(), columnCount() + new_inputs.size() - 1);
+    for (const SingleInput& si : new_inputs) {
+        movie->editor->input_set.push_back(si);
+    }
+    endInsertColumns();
+    emit inputSetChanged();
+}
+
 bool InputEditorModel::toggleInput(const QModelIndex &index)
 {
     /* Don't toggle savestate / frame count */
@@ -345,7 +346,7 @@ bool InputEditorModel::toggleInput(const QModelIndex &index)
     AllInputs &ai = movie->inputs->input_list[index.row()];
 
     int value = ai.toggleInput(si);
-    movie->inputs->wasModified();
+    movie->inputs->wasModified(index.row());
 
     emit dataChanged(index, index);
 
@@ -380,13 +381,141 @@ std::string InputEditorModel::inputDescription(int column)
     return "";
 }
 
-bool InputEditorModel::isInputAnalog(int column)
+bool InputEditorModel::isInputAnalog(int column) const
 {
     if (column < 2)
         return false;
 
-    const SingleInput si = movie->editor->input_set[column-2];
-    return si.isAnalog();
+    return columnInfo(column).analog;
+}
+
+const QString& InputEditorModel::columnLabel(int column) const
+{
+    return columnInfo(column).label;
+}
+
+bool InputEditorModel::isInputSet(int row, int column) const
+{
+    if ((column < 2) || (row >= movie->inputs->nbFrames()))
+        return false;
+
+    return movie->inputs->input_list[row].getInput(movie->editor->input_set[column-2]) != 0;
+}
+
+const InputEditorModel::ColumnInfo& InputEditorModel::columnInfo(int column) const
+{
+    if (!column_cache_valid) {
+        column_cache.clear();
+        for (const SingleInput& si : movie->editor->input_set) {
+            ColumnInfo ci;
+            ci.label = QString(si.description.c_str());
+            ci.analog = si.isAnalog();
+            ci.locked = movie->editor->locked_inputs.find(si) != movie->editor->locked_inputs.end();
+            column_cache.push_back(ci);
+        }
+        column_cache_valid = true;
+    }
+
+    return column_cache[column-2];
+}
+
+uint8_t InputEditorModel::rowState(int row) const
+{
+    if (row < 0)
+        return 0;
+
+    if (row >= static_cast<int>(row_states.size()))
+        row_states.resize(row + 1, 0);
+
+    uint8_t& state = row_states[row];
+    if (!(state & ROW_VALID)) {
+        state = ROW_VALID;
+        if (!movie->editor->isDraw(row))
+            state |= ROW_NONDRAW;
+        for (unsigned int i=0; i<savestate_frames.size(); i++) {
+            if (savestate_frames[i] == static_cast<unsigned long long>(row)) {
+                state |= ROW_SAVESTATE;
+                break;
+            }
+        }
+    }
+    return state;
+}
+
+void InputEditorModel::invalidateRows(uint64_t first, uint64_t last)
+{
+    for (uint64_t r = first; (r <= last) && (r < row_states.size()); r++)
+        row_states[r] = 0;
+}
+
+void InputEditorModel::updateBrushes()
+{
+    /* Main color */
+    QColor window = QGuiApplication::palette().window().color();
+    if (window == brushes_color)
+        return;
+    brushes_color = window;
+
+    int r, g, b;
+    window.getRgb(&r, &g, &b, nullptr);
+
+    for (int position = 0; position < 3; position++) {
+        for (int nondraw = 0; nondraw < 2; nondraw++) {
+            QColor color = window;
+
+            if (window.lightness() > 128) {
+                /* Light theme */
+                if (position == 0)
+                    color.setRgb(r - 0x30, g - 0x10, b);
+                else if (position == 1) {
+                    if (!nondraw)
+                        color.setRgb(r - 0x30, g, b - 0x30);
+                    else
+                        color.setRgb(r, g - 0x30, b - 0x30);
+                }
+                else {
+                    if (!nondraw)
+                        color.setRgb(r, g, b - 0x18);
+                    else
+                        color.setRgb(r, g - 0x18, b - 0x18);
+                }
+            }
+            else {
+                /* Dark theme */
+                if (position == 0)
+                    color.setRgb(r, g + 0x10, b + 0x20);
+                else if (position == 1) {
+                    if (!nondraw)
+                        color.setRgb(r, g + 0x18, b);
+                    else
+                        color.setRgb(r + 0x18, g, b);
+                }
+                else {
+                    if (!nondraw)
+                        color.setRgb(r + 0x08, g + 0x08, b);
+                    else
+                        color.setRgb(r + 0x08, g, b);
+                }
+            }
+
+            for (int type = 0; type < 3; type++) {
+                QColor type_color = color;
+
+                /* Frame column */
+                if (type == 0)
+                    type_color = type_color.lighter(105);
+                /* Locked input */
+                else if (type == 2)
+                    type_color = type_color.darker(150);
+
+                /* Greenzone and savestate markers */
+                for (int darker = 0; darker < 3; darker++) {
+                    brushes[((position * 2 + nondraw) * 3 + type) * 3 + darker] = QBrush(type_color);
+                    type_color = type_color.darker(105);
+                }
+            }
+        }
+    }
 }
 
 bool InputEditorModel::insertRows(int row, int count, const QModelIndex &parent)
@@ -400,9 +529,7 @@ bool InputEditorModel::insertRows(int row, int count, const QModelIndex &parent)
     AllInputs ai;
     ai.emptyInputs();
 
-    for (int i=0; i<count; i++) {
-        movie->inputs->insertInputsBefore(ai, row);
-    }
+    movie->inputs->insertInputsBefore(std::vector<AllInputs>(count, ai), row);
 
     endInsertRows();
 
@@ -420,9 +547,7 @@ bool InputEditorModel::removeRows(int row, int count, const QModelIndex &parent)
 
     beginRemoveRows(parent, row, row+count-1);
 
-    for (int i=0; i<count; i++) {
-        movie->inputs->deleteInputs(row);
-    }
+    movie->inputs->deleteInputs(row, count);
 
     endRemoveRows();
 
@@ -599,7 +724,7 @@ void InputEditorModel::clearUniqueInput(int column)
         movie->inputs->input_list[f].setInput(si, 0);
     }
 
-    movie->inputs->wasModified();
+    movie->inputs->wasModified(context->framecount);
 }
 
 void InputEditorModel::removeUniqueInput(int column)
@@ -617,7 +742,7 @@ void InputEditorModel::removeUniqueInput(int column)
         movie->inputs->input_list[f].setInput(si, 0);
     }
 
-    movie->inputs->wasModified();
+    movie->inputs->wasModified(context->framecount);
 
     /* Remove clear locked state */
     if (movie->editor->locked_inputs.find(si) != movie->editor->locked_inputs.end())
@@ -657,6 +782,8 @@ void InputEditorModel::lockUniqueInput(int column, bool locked)
         movie->editor->locked_inputs.erase(si);
     }
 
+    column_cache_valid = false;
+
     /* Update the input column */
     emit dataChanged(createIndex(0,column), createIndex(rowCount()-1,column));
 }
@@ -667,7 +794,7 @@ void InputEditorModel::clearInput(int row)
     movie->inputs->input_list[row].emptyInputs();
     emit dataChanged(createIndex(row, 0), createIndex(row, columnCount()));
 
-    movie->inputs->wasModified();
+    movie->inputs->wasModified(row);
 }
 
 void InputEditorModel::beginModifyInputs()
@@ -709,16 +836,32 @@ void InputEditorModel::endEditInputs()
 
 void InputEditorModel::update()
 {
+    updateBrushes();
+
+    /* Rows between the previous and current frame may have changed state */
+    uint64_t first = std::min(last_update_framecount, context->framecount);
+    uint64_t last = std::max(last_update_framecount, context->framecount);
+    if (first > 0)
+        first--;
+    invalidateRows(first, last);
+    last_update_framecount = context->framecount;
+
     if (context->framecount == 1) {
-        beginResetModel();
-        buildInputSet();
-        endResetModel();
-        emit inputSetChanged();
-    }
-    else {
-        emit dataChanged(createIndex(context->framecount,0), createIndex(context->framecount,columnCount()));
-        // emit dataChanged(createIndex(0,0), createIndex(rowCount(),columnCount()));
+        /* The movie may have been replaced without notifying the views */
+        if (rowCount() != known_rows) {
+            beginResetModel();
+            buildInputSet();
+            endResetModel();
+            emit inputSetChanged();
+            return;
+        }
+
+        /* Otherwise, only add columns for new inputs, because resetting the
+         * model is costly for long movies */
+        extendInputSet();
     }
+
+    emit dataChanged(createIndex(first,0), createIndex(last,columnCount()-1));
 }
 
 void InputEditorModel::resetInputs()
@@ -735,8 +878,13 @@ void InputEditorModel::resetInputs()
  */
 void InputEditorModel::registerSavestate(int slot, unsigned long long frame)
 {
-    if (frame > 0)
+    if (frame > 0) {
+        /* Old and new frames of the slot change state */
+        if (savestate_frames[slot] < row_states.size())
+            row_states[savestate_frames[slot]] = 0;
         savestate_frames[slot] = frame;
+        invalidateRows(frame, frame);
+    }
     unsigned long long old_savestate = last_savestate;
     last_savestate = savestate_frames[slot];
     emit dataChanged(createIndex(old_savestate,0), createIndex(old_savestate,0));
@@ -760,6 +908,7 @@ void InputEditorModel::moveInputs(int oldIndex, int newIndex)
     SingleInput si = movie->editor->input_set[oldIndex];
     movie->editor->input_set.erase(movie->editor->input_set.begin() + oldIndex);
     movie->editor->input_set.insert(movie->editor->input_set.begin() + newIndex, si);
+    column_cache_valid = false;
 }
 
 bool InputEditorModel::rewind(uint64_t framecount)
@@ -768,6 +917,18 @@ bool InputEditorModel::rewind(uint64_t framecount)
         return false;
         
     int state = SaveStateList::nearestState(framecount);
+    int64_t state_framecount = (state == -1) ? -1 : SaveStateList::get(state).framecount;
+
+    /* Use a greenzone state if it is closer */
+    int gz_state = GreenZone::nearestState(framecount);
+    if (gz_state != -1) {
+        int64_t gz_framecount = GreenZone::stateFramecount(gz_state);
+        if (gz_framecount > state_framecount) {
+            state = gz_state;
+            state_framecount = gz_framecount;
+        }
+    }
+
     if (state == -1)
         return false;
         
@@ -778,10 +939,15 @@ bool InputEditorModel::rewind(uint64_t framecount)
     }
 
     /* Load state */
-    context->hotkey_pressed_queue.push(HOTKEY_LOADSTATE1 + (state-1));
+    if (state == gz_state) {
+        GreenZone::requestLoad(state);
+        context->hotkey_pressed_queue.push(HOTKEY_LOADGREENZONE);
+    }
+    else {
+        context->hotkey_pressed_queue.push(HOTKEY_LOADSTATE1 + (state-1));
+    }
 
     /* Fast-forward to frame if further than state framecount */
-    int64_t state_framecount = SaveStateList::get(state).framecount;
     if (framecount > state_framecount) {
         context->pause_frame = framecount;
 
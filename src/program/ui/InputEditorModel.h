@@ -21,6 +21,10 @@
 #define LIBTAS_INPUTEDITORMODEL_H_INCLUDED
 
 #include <QAbstractTableModel>
+#include <QBrush>
+#include <QColor>
+#include <QFont>
+#include <QString>
 #include <vector>
 #include <array>
 #include <stdint.h>
@@ -65,7 +69,13 @@ public:
     std::string inputDescription(int column);
 
     /* Return if a column contains an analog input */
-    bool isInputAnalog(int column);
+    bool isInputAnalog(int column) const;
+
+    /* Return the label of an input column, as displayed */
+    const QString& columnLabel(int column) const;
+
+    /* Return if an input is set, without formatting the cell content */
+    bool isInputSet(int row, int column) const;
 
     /* Add an input column */
     void addUniqueInput(const SingleInput &si);
@@ -142,6 +152,57 @@ private:
     /* Last saved/loaded state */
     unsigned long long last_savestate = 0;
 
+    /* Frame count at the last update */
+    uint64_t last_update_framecount = 0;
+
+    /* Row count known by the views */
+    int known_rows = 0;
+
+    /* Cached information about input columns, which are needed for each
+     * painted cell */
+    struct ColumnInfo {
+        QString label;
+        bool analog;
+        bool locked;
+    };
+    mutable std::vector<ColumnInfo> column_cache;
+    mutable bool column_cache_valid = false;
+
+    const ColumnInfo& columnInfo(int column) const;
+
+    /* Cached state of each row, computed when the row is first painted */
+    enum RowState {
+        ROW_VALID = 0x01,
+        ROW_NONDRAW = 0x02,
+        ROW_SAVESTATE = 0x04,
+    };
+    mutable std::vector<uint8_t> row_states;
+
+    uint8_t rowState(int row) const;
+
+    /* Invalidate the cached state of a range of rows */
+    void invalidateRows(uint64_t first, uint64_t last);
+
+    /* Background brushes for each combination of row position (current,
+     * past, future), draw/non-draw frame, column type (frame, input, locked
+     * input) and number of darkening markers (greenzone, savestate) */
+    static const int BRUSH_COUNT = 3 * 2 * 3 * 3;
+    std::array<QBrush, BRUSH_COUNT> brushes;
+
+    /* Window color used to compute the brushes */
+    QColor brushes_color;
+
+    /* Compute the brushes again if the palette changed */
+    void updateBrushes();
+
+    QFont bold_font;
+
+    /* Gather inputs present in the movie that are not in the input set */
+    std::vector<SingleInput> newInputs();
+
+    /* Add new inputs present in the movie as new columns */
+    void extendInputSet();
+
 signals:
     void inputSetChanged();
 
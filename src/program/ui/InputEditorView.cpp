@@ -24,6 +24,7 @@
 #include <stdint.h>
 
 #include "InputEditorView.h"
+#include "InputEditorDelegate.h"
 #include "MainWindow.h"
 #include "qtutils.h"
 
@@ -43,6 +44,7 @@ InputEditorView::InputEditorView(Context* c, QWidget *parent, QWidget *gp) : QTa
 
     inputEditorModel = new InputEditorModel(context, movie);
     setModel(inputEditorModel);
+    setItemDelegate(new InputEditorDelegate(inputEditorModel, this));
 
     connect(inputEditorModel, &InputEditorModel::inputSetChanged, this, &InputEditorView::resizeAllColumns);
 
@@ -29,6 +29,7 @@
 #include <QInputDialog>
 #include <QApplication>
 #include <QTimer>
+#include <QRegularExpressionValidator>
 
 #include "MainWindow.h"
 #include "../movie/MovieFile.h"
@@ -84,6 +85,7 @@ MainWindow::MainWindow(Context* c) : QMainWindow(), context(c)
     osdWindow = new OsdWindow(c, this);
     annotationsWindow = new AnnotationsWindow(c, this);
     autoSaveWindow = new AutoSaveWindow(c, this);
+    greenZoneWindow = new GreenZoneWindow(c, this);
     timeTraceWindow = new TimeTraceWindow(c, this);
 
     connect(gameLoop, &GameLoop::inputsToBeChanged, inputEditorWindow->inputEditorView->inputEditorModel, &InputEditorModel::beginModifyInputs);
@@ -177,6 +179,13 @@ MainWindow::MainWindow(Context* c) : QMainWindow(), context(c)
     disabledWidgetsOnStart.append(initialTimeSec);
     disabledWidgetsOnStart.append(initialTimeNsec);
 
+    /* Random seed */
+    /* The seed is a 64-bit value, which does not fit in a spinbox */
+    prngSeed = new QLineEdit();
+    prngSeed->setValidator(new QRegularExpressionValidator(QRegularExpression("[0-9]{1,20}"), this));
+    prngSeed->setMinimumWidth(50);
+    disabledWidgetsOnStart.append(prngSeed);
+
     /* Pause/FF */
     pauseCheck = new QCheckBox("Pause");
     connect(pauseCheck, &QAbstractButton::clicked, this, &MainWindow::slotPause);
@@ -289,6 +298,9 @@ MainWindow::MainWindow(Context* c) : QMainWindow(), context(c)
     generalTimeLayout->addWidget(initialTimeNsec);
     generalTimeLayout->addWidget(new QLabel(tr("nsec")));
     generalTimeLayout->addStretch(1);
+    generalTimeLayout->addWidget(new QLabel(tr("Random seed:")));
+    generalTimeLayout->addWidget(prngSeed);
+    generalTimeLayout->addStretch(1);
 
     QHBoxLayout *generalControlLayout = new QHBoxLayout;
     generalControlLayout->addWidget(pauseCheck);
@@ -437,6 +449,12 @@ void MainWindow::createActions()
     addActionCheckable(channelGroup, tr("Mono"), 1);
     addActionCheckable(channelGroup, tr("Stereo"), 2);
 
+    audioSinkGroup = new QActionGroup(this);
+
+    addActionCheckable(audioSinkGroup, tr("Audio device"), SharedConfig::AUDIO_SINK_ALSA, "Play samples on the default ALSA device. Falls back to Null if the device cannot be opened");
+    addActionCheckable(audioSinkGroup, tr("Null"), SharedConfig::AUDIO_SINK_NULL, "Discard samples at the rate of a real device, for machines without sound hardware");
+    addActionCheckable(audioSinkGroup, tr("WAV file"), SharedConfig::AUDIO_SINK_WAV, "Write all samples to libtas_audio.wav in the game directory, or to the file in the LIBTAS_AUDIO_WAV environment variable. Loading a savestate rewinds the file");
+
     localeGroup = new QActionGroup(this);
 
     addActionCheckable(localeGroup, tr("English"), SharedConfig::LOCALE_ENGLISH);
@@ -492,6 +510,12 @@ void MainWindow::createActions()
     addActionCheckable(asyncGroup, tr("SDL events at frame beginning"), SharedConfig::ASYNC_SDLEVENTS_BEG);
     addActionCheckable(asyncGroup, tr("SDL events at frame end"), SharedConfig::ASYNC_SDLEVENTS_END);
 
+    timeTrapGroup = new QActionGroup(this);
+    timeTrapGroup->setExclusive(false);
+    addActionCheckable(timeTrapGroup, tr("Raw syscalls"), SharedConfig::TIME_TRAP_SYSCALL, "Intercept time syscalls that don't go through libc, using a seccomp filter. Prevents the game from running setuid programs");
+    addActionCheckable(timeTrapGroup, tr("vDSO"), SharedConfig::TIME_TRAP_VDSO, "Patch the vDSO time functions, used directly by some statically linked runtimes");
+    addActionCheckable(timeTrapGroup, tr("rdtsc"), SharedConfig::TIME_TRAP_TSC, "Make rdtsc instructions fault and return a deterministic value. Slow if the game uses it a lot");
+
     savestateGroup = new QActionGroup(this);
     savestateGroup->setExclusive(false);
     connect(savestateGroup, &QActionGroup::triggered, this, &MainWindow::slotSavestate);
@@ -650,6 +674,7 @@ void MainWindow::createMenus()
     movieMenu->addSeparator();
 
     movieMenu->addAction(tr("Autosave..."), autoSaveWindow, &AutoSaveWindow::show);
+    movieMenu->addAction(tr("Greenzone..."), greenZoneWindow, &GreenZoneWindow::show);
 
     movieMenu->addSeparator();
 
@@ -658,6 +683,14 @@ void MainWindow::createMenus()
     autoRestartAction->setCheckable(true);
     autoRestartAction->setToolTip("When checked, the game will automatically restart if closed, except when using the Stop button");
     disabledActionsOnStart.append(autoRestartAction);
+    launchTemplateAction = movieMenu->addAction(tr("Restart from launch template"), this, &MainWindow::slotLaunchTemplate);
+    launchTemplateAction->setCheckable(true);
+    launchTemplateAction->setToolTip("When checked, a copy of the game process is kept before its main function, and game restarts are forked from it instead of executing the game again. Not available for Windows games or when attaching gdb");
+    disabledActionsOnStart.append(launchTemplateAction);
+    hashGameDirAction = movieMenu->addAction(tr("Store game directory hashes"), this, &MainWindow::slotHashGameDir);
+    hashGameDirAction->setCheckable(true);
+    hashGameDirAction->setToolTip("When checked, the hashes of every file in the game directory are stored in the movie and checked when loading it, in addition to the executable and libraries");
+    disabledActionsOnStart.append(hashGameDirAction);
 
     QMenu *movieEndMenu = movieMenu->addMenu(tr("On Movie End"));
     movieEndMenu->addActions(movieEndGroup->actions());
@@ -710,6 +743,11 @@ void MainWindow::createMenus()
     formatMenu->addActions(channelGroup->actions());
     disabledWidgetsOnStart.append(formatMenu);
 
+    QMenu *sinkMenu = soundMenu->addMenu(tr("Output"));
+    sinkMenu->setToolTipsVisible(true);
+    sinkMenu->addActions(audioSinkGroup->actions());
+    disabledWidgetsOnStart.append(sinkMenu);
+
     muteAction = soundMenu->addAction(tr("Mute"), this, &MainWindow::slotMuteSound);
     muteAction->setCheckable(true);
     disableAction = soundMenu->addAction(tr("Disable"), this, &MainWindow::slotDisableSound);
@@ -736,6 +774,12 @@ void MainWindow::createMenus()
     disabledWidgetsOnStart.append(waitMenu);
     waitMenu->addActions(waitGroup->actions());
 
+    QMenu *timeTrapMenu = runtimeMenu->addMenu(tr("Low-level time interception"));
+    timeTrapMenu->setToolTipsVisible(true);
+    timeTrapMenu->setToolTip("Intercept time queries of games that bypass libc. Sources used by the game are shown in the game information window");
+    disabledWidgetsOnStart.append(timeTrapMenu);
+    timeTrapMenu->addActions(timeTrapGroup->actions());
+
     QMenu *savestateMenu = runtimeMenu->addMenu(tr("Savestates"));
     // savestateMenu->setToolTipsVisible(true);
     savestateMenu->addActions(savestateGroup->actions());
@@ -747,6 +791,11 @@ void MainWindow::createMenus()
     recycleThreadsAction->setToolTip("Recycle threads when they finish, to make savestates more useable. Can crash on some games");
     recycleThreadsAction->setCheckable(true);
     disabledActionsOnStart.append(recycleThreadsAction);
+
+    deferredSignalsAction = runtimeMenu->addAction(tr("Deterministic signal delivery"), this, &MainWindow::slotDeferredSignals);
+    deferredSignalsAction->setToolTip("Deliver signals sent between game threads at deterministic points, to prevent desyncs with games scheduling threads using signals");
+    deferredSignalsAction->setCheckable(true);
+    disabledActionsOnStart.append(deferredSignalsAction);
     steamAction = runtimeMenu->addAction(tr("Virtual Steam client"), this, &MainWindow::slotSteam);
     steamAction->setToolTip("Implement a dummy Steam client, to be able to launch some Steam games");
     steamAction->setCheckable(true);
@@ -871,6 +920,7 @@ void MainWindow::updateStatus()
             fpsDenField->setEnabled(true);
             initialTimeSec->setValue(context->config.sc.initial_time_sec);
             initialTimeNsec->setValue(context->config.sc.initial_time_nsec);
+            prngSeed->setText(QString::number(context->config.sc.prng_seed));
 
             if (context->config.sc.av_dumping) {
                 context->config.sc.av_dumping = false;
@@ -1150,7 +1200,10 @@ void MainWindow::updateMovieParams()
     fpsDenField->setValue(context->config.sc.framerate_den);
     initialTimeSec->setValue(context->config.sc.initial_time_sec);
     initialTimeNsec->setValue(context->config.sc.initial_time_nsec);
+    prngSeed->setText(QString::number(context->config.sc.prng_seed));
     autoRestartAction->setChecked(context->config.auto_restart);
+    launchTemplateAction->setChecked(context->config.launch_template);
+    hashGameDirAction->setChecked(context->config.hash_game_dir);
     variableFramerateAction->setChecked(context->config.sc.variable_framerate);
     for (auto& action : timeMainGroup->actions()) {
         action->setChecked(context->config.sc.main_gettimes_threshold[action->data().toInt()] != -1);
@@ -1180,6 +1233,7 @@ void MainWindow::updateUIFromConfig()
     setRadioFromList(frequencyGroup, context->config.sc.audio_frequency);
     setRadioFromList(bitDepthGroup, context->config.sc.audio_bitdepth);
     setRadioFromList(channelGroup, context->config.sc.audio_channels);
+    setRadioFromList(audioSinkGroup, context->config.sc.audio_sink);
 
     muteAction->setChecked(context->config.sc.audio_mute);
     disableAction->setChecked(context->config.sc.audio_disabled);
@@ -1214,8 +1268,10 @@ void MainWindow::updateUIFromConfig()
     renderPerfAction->setChecked(context->config.sc.opengl_performance);
     preventSavefileAction->setChecked(context->config.sc.prevent_savefiles);
     recycleThreadsAction->setChecked(context->config.sc.recycle_threads);
+    deferredSignalsAction->setChecked(context->config.sc.deferred_signals);
     steamAction->setChecked(context->config.sc.virtual_steam);
     setCheckboxesFromMask(asyncGroup, context->config.sc.async_events);
+    setCheckboxesFromMask(timeTrapGroup, context->config.sc.time_trap);
 
     setCheckboxesFromMask(savestateGroup, context->config.sc.savestate_settings);
 
@@ -1269,10 +1325,15 @@ void MainWindow::slotLaunch()
     context->config.sc.framerate_den = fpsDenField->value();
     context->config.sc.initial_time_sec = initialTimeSec->value();
     context->config.sc.initial_time_nsec = initialTimeNsec->value();
+    bool seedOk;
+    qulonglong seed = prngSeed->text().toULongLong(&seedOk);
+    if (seedOk)
+        context->config.sc.prng_seed = seed;
 
     setListFromRadio(frequencyGroup, context->config.sc.audio_frequency);
     setListFromRadio(bitDepthGroup, context->config.sc.audio_bitdepth);
     setListFromRadio(channelGroup, context->config.sc.audio_channels);
+    setListFromRadio(audioSinkGroup, context->config.sc.audio_sink);
 
     setListFromRadio(loggingOutputGroup, context->config.sc.logging_status);
 
@@ -1303,6 +1364,7 @@ void MainWindow::slotLaunch()
 
     setListFromRadio(waitGroup, context->config.sc.wait_timeout);
     setMaskFromCheckboxes(asyncGroup, context->config.sc.async_events);
+    setMaskFromCheckboxes(timeTrapGroup, context->config.sc.time_trap);
     setMaskFromCheckboxes(savestateGroup, context->config.sc.savestate_settings);
 
     context->config.gameargs = cmdOptions->text().toStdString();
@@ -1382,6 +1444,7 @@ void MainWindow::slotGamePathChanged()
     inputWindow->update();
     osdWindow->update_config();
     autoSaveWindow->update_config();
+    greenZoneWindow->update_config();
 }
 
 void MainWindow::slotBrowseMoviePath()
@@ -1585,6 +1648,7 @@ BOOLSLOT(slotOsdEncode, context->config.sc.osd_encode)
 BOOLSLOT(slotBusyLoop, context->config.sc.busyloop_detection)
 BOOLSLOT(slotPreventSavefile, context->config.sc.prevent_savefiles)
 BOOLSLOT(slotRecycleThreads, context->config.sc.recycle_threads)
+BOOLSLOT(slotDeferredSignals, context->config.sc.deferred_signals)
 BOOLSLOT(slotSteam, context->config.sc.virtual_steam)
 BOOLSLOT(slotAsyncEvents, context->config.sc.async_events)
 
@@ -1594,6 +1658,8 @@ void MainWindow::slotMovieEnd()
 }
 
 BOOLSLOT(slotAutoRestart, context->config.auto_restart)
+BOOLSLOT(slotLaunchTemplate, context->config.launch_template)
+BOOLSLOT(slotHashGameDir, context->config.hash_game_dir)
 BOOLSLOT(slotVariableFramerate, context->config.sc.variable_framerate)
 BOOLSLOT(slotMouseMode, context->config.sc.mouse_mode_relative)
 BOOLSLOT(slotMouseWarp, context->config.mouse_warp)
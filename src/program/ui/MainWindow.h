@@ -47,6 +47,7 @@
 #include "OsdWindow.h"
 #include "AnnotationsWindow.h"
 #include "AutoSaveWindow.h"
+#include "GreenZoneWindow.h"
 #include "TimeTraceWindow.h"
 #include "../GameLoop.h"
 #include "../Context.h"
@@ -77,6 +78,7 @@ public:
     OsdWindow* osdWindow;
     AnnotationsWindow* annotationsWindow;
     AutoSaveWindow* autoSaveWindow;
+    GreenZoneWindow* greenZoneWindow;
     TimeTraceWindow* timeTraceWindow;
 
     QList<QWidget*> disabledWidgetsOnStart;
@@ -87,6 +89,8 @@ public:
     QAction *annotateMovieAction;
 
     QAction *autoRestartAction;
+    QAction *launchTemplateAction;
+    QAction *hashGameDirAction;
     QAction *variableFramerateAction;
     QActionGroup *movieEndGroup;
     QActionGroup *screenResGroup;
@@ -99,6 +103,7 @@ public:
     QActionGroup *frequencyGroup;
     QActionGroup *bitDepthGroup;
     QActionGroup *channelGroup;
+    QActionGroup *audioSinkGroup;
     QAction *muteAction;
     QAction *disableAction;
 
@@ -110,11 +115,13 @@ public:
     QAction *busyloopAction;
     QAction *preventSavefileAction;
     QAction *recycleThreadsAction;
+    QAction *deferredSignalsAction;
 
     QActionGroup *savestateGroup;
     QAction *steamAction;
     QActionGroup *waitGroup;
     QActionGroup *asyncGroup;
+    QActionGroup *timeTrapGroup;
 
     QActionGroup *debugStateGroup;
     QActionGroup *loggingOutputGroup;
@@ -162,6 +169,7 @@ public:
 
     QSpinBox *initialTimeSec;
     QSpinBox *initialTimeNsec;
+    QLineEdit *prngSeed;
 
     QPushButton *launchButton;
     QPushButton *launchGdbButton;
@@ -258,10 +266,13 @@ private slots:
     void slotMovieEnd();
     void slotPauseMovie();
     void slotRecycleThreads(bool checked);
+    void slotDeferredSignals(bool checked);
     void slotSteam(bool checked);
     void slotAsyncEvents(bool checked);
     void slotCalibrateMouse();
     void slotAutoRestart(bool checked);
+    void slotLaunchTemplate(bool checked);
+    void slotHashGameDir(bool checked);
     void slotVariableFramerate(bool checked);
     void slotMouseMode(bool checked);
     void slotMouseWarp(bool checked);
@@ -21,8 +21,12 @@
 #include "RamWatchModel.h"
 #include "../ramsearch/IRamWatchDetailed.h"
 #include "../ramsearch/RamWatchDetailed.h"
+#include "../ramsearch/MemAccess.h"
+#include "../WatchpointList.h"
 
 #include <stdint.h>
+#include <algorithm>
+#include <sys/uio.h>
 
 RamWatchModel::RamWatchModel(QObject *parent) : QAbstractTableModel(parent) {}
 
@@ -33,7 +37,7 @@ int RamWatchModel::rowCount(const QModelIndex & /*parent*/) const
 
 int RamWatchModel::columnCount(const QModelIndex & /*parent*/) const
 {
-    return 3;
+    return 4;
 }
 
 QVariant RamWatchModel::headerData(int section, Qt::Orientation orientation, int role) const
@@ -47,6 +51,8 @@ QVariant RamWatchModel::headerData(int section, Qt::Orientation orientation, int
                 return QString("Value");
             case 2:
                 return QString("Label");
+            case 3:
+                return QString("Last write");
             }
         }
     }
@@ -64,9 +70,20 @@ QVariant RamWatchModel::data(const QModelIndex &index, int role) const
                 else
                     return QString("%1").arg(watch->address, 0, 16);
             case 1:
-                return QString(watch->value_str().c_str());
+                return QString(watch->value_cache.c_str());
             case 2:
                 return QString(watch->label.c_str());
+            case 3:
+            {
+                if (!watch->watchpoint_addr)
+                    return QString();
+
+                WatchpointHit hit;
+                if (!WatchpointList::lastHit(watch->watchpoint_addr, hit))
+                    return QString("none");
+
+                return QString("frame %1 @ %2").arg(hit.frame).arg(hit.ip, 0, 16);
+            }
             default:
                 return QString();
         }
@@ -83,6 +100,9 @@ void RamWatchModel::addWatch(std::unique_ptr<IRamWatchDetailed> ramwatch)
 
 void RamWatchModel::removeWatch(int row)
 {
+    if (ramwatches[row]->watchpoint_addr)
+        WatchpointList::remove(ramwatches[row]->watchpoint_addr, WatchpointList::OWNER_RAMWATCH);
+
     beginRemoveRows(QModelIndex(), row, row);
     ramwatches.erase(ramwatches.begin() + row);
     endRemoveRows();
@@ -120,6 +140,7 @@ void RamWatchModel::loadSettings(QSettings& watchSettings)
 
     int size = watchSettings.beginReadArray("watches");
     ramwatches.clear();
+    WatchpointList::removeOwner(WatchpointList::OWNER_RAMWATCH);
     for (int i = 0; i < size; ++i) {
         watchSettings.setArrayIndex(i);
 
@@ -186,5 +207,130 @@ void RamWatchModel::loadSettings(QSettings& watchSettings)
 
 void RamWatchModel::update()
 {
-    emit dataChanged(createIndex(0,0), createIndex(rowCount(),1));
+    update(0, rowCount()-1);
+}
+
+void RamWatchModel::update(int first, int last)
+{
+    if (first < 0)
+        first = 0;
+    if (last >= rowCount())
+        last = rowCount() - 1;
+    if (first > last)
+        return;
+
+    int count = last - first + 1;
+    pid_t pid = IRamWatchDetailed::game_pid;
+
+    std::vector<uintptr_t> addresses(count);
+    std::vector<bool> valid(count, true);
+    size_t max_depth = 0;
+
+    for (int i = 0; i < count; i++) {
+        IRamWatchDetailed* watch = ramwatches[first+i].get();
+        if (watch->isPointer) {
+            watch->update_base_addr();
+            addresses[i] = watch->base_address;
+            if (watch->pointer_offsets.size() > max_depth)
+                max_depth = watch->pointer_offsets.size();
+        }
+        else {
+            addresses[i] = watch->address;
+        }
+    }
+
+    /* Resolve pointer chains, with one read for each level of all chains */
+    std::vector<struct iovec> local, remote;
+    std::vector<int> rows;
+    std::vector<uintptr_t> pointers(count);
+    for (size_t level = 0; level < max_depth; level++) {
+        local.clear();
+        remote.clear();
+        rows.clear();
+
+        for (int i = 0; i < count; i++) {
+            IRamWatchDetailed* watch = ramwatches[first+i].get();
+            if (!watch->isPointer || !valid[i] || (level >= watch->pointer_offsets.size()))
+                continue;
+
+            local.push_back({&pointers[i], sizeof(uintptr_t)});
+            remote.push_back({reinterpret_cast<void*>(addresses[i]), sizeof(uintptr_t)});
+            rows.push_back(i);
+        }
+
+        std::vector<bool> read = MemAccess::readVectored(pid, local, remote);
+        for (size_t r = 0; r < rows.size(); r++) {
+            int i = rows[r];
+            if (read[r])
+                addresses[i] = pointers[i] + ramwatches[first+i]->pointer_offsets[level];
+            else
+                valid[i] = false;
+        }
+    }
+
+    /* Read all values */
+    local.clear();
+    remote.clear();
+    rows.clear();
+    std::vector<uint64_t> values(count);
+    for (int i = 0; i < count; i++) {
+        if (!valid[i])
+            continue;
+
+        local.push_back({&values[i], static_cast<size_t>(ramwatches[first+i]->size())});
+        remote.push_back({reinterpret_cast<void*>(addresses[i]), static_cast<size_t>(ramwatches[first+i]->size())});
+        rows.push_back(i);
+    }
+
+    std::vector<bool> read = MemAccess::readVectored(pid, local, remote);
+    for (size_t r = 0; r < rows.size(); r++)
+        if (!read[r])
+            valid[rows[r]] = false;
+
+    /* Update the cache, and notify the view of the cells that changed.
+     * Consecutive rows with the same changed columns are merged. */
+    int range_first = -1, range_col_first = 0, range_col_last = 0;
+    for (int i = 0; i <= count; i++) {
+        int col_first = columnCount(), col_last = -1;
+
+        if (i < count) {
+            IRamWatchDetailed* watch = ramwatches[first+i].get();
+            std::string value = valid[i] ? watch->format_value(&values[i]) : std::string("??????");
+
+            /* A watch that was never refreshed is new or was just edited */
+            if (watch->value_cache.empty()) {
+                col_first = 0;
+                col_last = columnCount() - 1;
+            }
+
+            /* Address column shows the resolved address of pointers */
+            if (watch->isPointer && (watch->address != addresses[i])) {
+                watch->address = addresses[i];
+                col_first = 0;
+                col_last = std::max(col_last, 0);
+            }
+            if (value != watch->value_cache) {
+                watch->value_cache = value;
+                col_first = std::min(col_first, 1);
+                col_last = std::max(col_last, 1);
+            }
+
+            /* The last write is cheap to get, so always refresh it */
+            if (watch->watchpoint_addr) {
+                col_first = std::min(col_first, 3);
+                col_last = 3;
+            }
+        }
+
+        if ((range_first != -1) && ((col_first != range_col_first) || (col_last != range_col_last))) {
+            emit dataChanged(createIndex(first+range_first, range_col_first), createIndex(first+i-1, range_col_last));
+            range_first = -1;
+        }
+
+        if ((range_first == -1) && (col_last != -1)) {
+            range_first = i;
+            range_col_first = col_first;
+            range_col_last = col_last;
+        }
+    }
 }
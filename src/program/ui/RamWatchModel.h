@@ -50,7 +50,14 @@ public:
     void saveSettings(QSettings& watchSettings);
     void loadSettings(QSettings& watchSettings);
 
+    /* Refresh the values of all watches */
     void update();
+
+    /* Refresh the values of the watches between two rows (included), and
+     * notify the view only for the cells that changed. Pointer chains are
+     * resolved one level at a time for all watches, and values are read
+     * with a single vectored read. */
+    void update(int first, int last);
 };
 
 #endif
@@ -24,8 +24,11 @@
 #include <QHeaderView>
 #include <QSettings>
 #include <QFileDialog>
+#include <QMessageBox>
+#include <QScrollBar>
 
 #include "RamWatchWindow.h"
+#include "../WatchpointList.h"
 
 RamWatchWindow::RamWatchWindow(Context* c, QWidget *parent) : QDialog(parent), context(c)
 {
@@ -44,6 +47,9 @@ RamWatchWindow::RamWatchWindow(Context* c, QWidget *parent) : QDialog(parent), c
     ramWatchModel = new RamWatchModel();
     ramWatchView->setModel(ramWatchModel);
 
+    /* Rows that become visible may have outdated values */
+    connect(ramWatchView->verticalScrollBar(), &QAbstractSlider::valueChanged, this, &RamWatchWindow::refreshVisibleRows);
+
     /* Buttons */
     QPushButton *addWatch = new QPushButton(tr("Add Watch"));
     connect(addWatch, &QAbstractButton::clicked, this, &RamWatchWindow::slotAdd);
@@ -57,11 +63,15 @@ RamWatchWindow::RamWatchWindow(Context* c, QWidget *parent) : QDialog(parent), c
     QPushButton *scanWatch = new QPushButton(tr("Scan Pointer"));
     connect(scanWatch, &QAbstractButton::clicked, this, &RamWatchWindow::slotScanPointer);
 
+    QPushButton *watchWrites = new QPushButton(tr("Watch Writes"));
+    connect(watchWrites, &QAbstractButton::clicked, this, &RamWatchWindow::slotWatchWrites);
+
     QDialogButtonBox *buttonBox = new QDialogButtonBox();
     buttonBox->addButton(addWatch, QDialogButtonBox::ActionRole);
     buttonBox->addButton(editWatch, QDialogButtonBox::ActionRole);
     buttonBox->addButton(removeWatch, QDialogButtonBox::ActionRole);
     buttonBox->addButton(scanWatch, QDialogButtonBox::ActionRole);
+    buttonBox->addButton(watchWrites, QDialogButtonBox::ActionRole);
 
     /* Other buttons */
     QPushButton *saveWatch = new QPushButton(tr("Save Watches"));
@@ -90,7 +100,30 @@ RamWatchWindow::RamWatchWindow(Context* c, QWidget *parent) : QDialog(parent), c
 void RamWatchWindow::update()
 {
     IRamWatchDetailed::game_pid = context->game_pid;
-    ramWatchModel->update();
+
+    /* Values of hidden rows are refreshed when they are shown */
+    if (isVisible())
+        refreshVisibleRows();
+}
+
+void RamWatchWindow::refreshVisibleRows()
+{
+    int first = ramWatchView->rowAt(0);
+    int last = ramWatchView->rowAt(ramWatchView->viewport()->height() - 1);
+
+    /* rowAt() returns -1 below the last row */
+    if (first == -1)
+        return;
+    if (last == -1)
+        last = ramWatchModel->rowCount() - 1;
+
+    ramWatchModel->update(first, last);
+}
+
+void RamWatchWindow::showEvent(QShowEvent *event)
+{
+    QDialog::showEvent(event);
+    refreshVisibleRows();
 }
 
 void RamWatchWindow::slotAdd()
@@ -100,6 +133,7 @@ void RamWatchWindow::slotAdd()
     if (editWindow->ramwatch) {
         editWindow->ramwatch->game_pid = context->game_pid;
         ramWatchModel->addWatch(std::move(editWindow->ramwatch));
+        refreshVisibleRows();
     }
 }
 
@@ -137,9 +171,12 @@ void RamWatchWindow::slotEdit()
 
     /* Modify the watch */
     if (editWindow->ramwatch) {
+        if (ramWatchModel->ramwatches[row]->watchpoint_addr)
+            WatchpointList::remove(ramWatchModel->ramwatches[row]->watchpoint_addr, WatchpointList::OWNER_RAMWATCH);
+
         editWindow->ramwatch->game_pid = context->game_pid;
         ramWatchModel->ramwatches[row] = std::move(editWindow->ramwatch);
-        ramWatchModel->update();
+        ramWatchModel->update(row, row);
     }
 }
 
@@ -172,6 +209,34 @@ void RamWatchWindow::slotScanPointer()
     pointerScanWindow->exec();
 }
 
+void RamWatchWindow::slotWatchWrites()
+{
+    const QModelIndex index = ramWatchView->selectionModel()->currentIndex();
+
+    /* If no watch was selected, return */
+    if (!index.isValid())
+        return;
+
+    std::unique_ptr<IRamWatchDetailed> &watch = ramWatchModel->ramwatches.at(index.row());
+
+    /* Toggle the hardware watchpoint */
+    if (watch->watchpoint_addr) {
+        WatchpointList::remove(watch->watchpoint_addr, WatchpointList::OWNER_RAMWATCH);
+        watch->watchpoint_addr = 0;
+    }
+    else {
+        watch->update_addr();
+        if (WatchpointList::add(watch->address, watch->size(), WatchpointList::OWNER_RAMWATCH)) {
+            watch->watchpoint_addr = watch->address;
+        }
+        else {
+            QMessageBox::warning(this, "Error", QString("Could not watch writes on this address. It must be aligned on the size of the value, and at most %1 addresses can be watched.").arg(Watchpoint::MAX));
+        }
+    }
+
+    ramWatchModel->update(index.row(), index.row());
+}
+
 void RamWatchWindow::slotSave()
 {
     QString filename = QFileDialog::getSaveFileName(this, tr("Choose a watch file"), context->gamepath.c_str(), tr("watch files (*.wch)"));
@@ -205,4 +270,5 @@ void RamWatchWindow::slotLoad()
 	watchSettings.setFallbacksEnabled(false);
 
     ramWatchModel->loadSettings(watchSettings);
+    refreshVisibleRows();
 }
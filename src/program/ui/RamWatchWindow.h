@@ -44,6 +44,12 @@ private:
     QTableView *ramWatchView;
     RamWatchModel *ramWatchModel;
 
+    /* Refresh the values of the rows that are visible */
+    void refreshVisibleRows();
+
+protected:
+    void showEvent(QShowEvent *event) override;
+
 public slots:
     void slotAdd();
     void slotGet(std::string &watch);
@@ -52,6 +58,7 @@ private slots:
     void slotEdit();
     void slotRemove();
     void slotScanPointer();
+    void slotWatchWrites();
     void slotSave();
     void slotLoad();
 
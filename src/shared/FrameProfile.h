@@ -0,0 +1,47 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBTAS_FRAMEPROFILE_H_INCLUDED
+#define LIBTAS_FRAMEPROFILE_H_INCLUDED
+
+#include <stdint.h>
+
+/*
+ * Time spent in each stage of a frame boundary, measured by the game when
+ * the DEBUG_FRAME_PROFILE flag is set, and sent to the program.
+ */
+struct FrameProfile {
+    enum Stage {
+        GAME, // game code between two frame boundaries
+        TIMER, // deterministic timer, including sleeps
+        AUDIO, // audio mixing
+        MESSAGES, // socket messages, including waiting for the program
+        CAPTURE, // saving and restoring the screen pixels
+        HUD, // drawing the OSD
+        ENCODE, // audio/video encoding
+        DRAW, // native draw call
+        INPUTS, // synthesizing input events, and waiting for the game to process them
+        STAGE_COUNT
+    };
+
+    /* Time in nanoseconds for each stage */
+    uint64_t ns[STAGE_COUNT] = {};
+};
+
+#endif
@@ -67,6 +67,26 @@ struct GameInfo {
     };
     Profile opengl_profile = NONE;
 
+    /* Low-level time sources that were used by the game, among the ones that
+     * are intercepted. Uses the flags of SharedConfig::TimeTrapFlags */
+    int time_trap = 0;
+
+    /* Game engine, detected from the libraries, symbols and data files that
+     * the game uses */
+    enum Engine {
+        ENGINE_UNKNOWN,
+        ENGINE_UNITY_MONO,
+        ENGINE_UNITY_IL2CPP,
+        ENGINE_UNREAL,
+        ENGINE_GODOT,
+        ENGINE_GAMEMAKER,
+        ENGINE_XNA_FNA,
+        ENGINE_RPGMAKER,
+        ENGINE_RENPY,
+        ENGINE_COUNT
+    };
+    int engine = ENGINE_UNKNOWN;
+
 };
 
 #endif
@@ -111,6 +111,15 @@ struct __attribute__((packed, aligned(8))) SharedConfig {
     /* Frequency of buffer in Hz */
     int audio_frequency = 44100;
 
+    /* Where the mixed samples are sent when audio is not muted */
+    enum AudioSink {
+        AUDIO_SINK_ALSA = 0, // Default audio device
+        AUDIO_SINK_NULL = 1, // Samples are discarded at the rate of a device
+        AUDIO_SINK_WAV = 2, // Samples are written to a WAV file
+    };
+
+    int audio_sink = AUDIO_SINK_ALSA;
+
     /* Encode config */
     int video_codec = 0;
     int video_bitrate = 4000;
@@ -146,6 +155,10 @@ struct __attribute__((packed, aligned(8))) SharedConfig {
     int64_t initial_time_sec = 1;
     int64_t initial_time_nsec = 0;
 
+    /* Seed of the deterministic entropy source (getrandom, /dev/urandom,
+     * arc4random) */
+    uint64_t prng_seed = 0;
+
     /* Virtual monitor resolution */
     int screen_width = 0;
     int screen_height = 0;
@@ -154,7 +167,8 @@ struct __attribute__((packed, aligned(8))) SharedConfig {
     enum DebugFlags {
         DEBUG_UNCONTROLLED_TIME = 0x01, // Using undeterministic timer
         DEBUG_NATIVE_EVENTS = 0x02, // Allow game to access real events
-        DEBUG_MAIN_FIRST_THREAD = 0x04 // Keep main thread as first thread
+        DEBUG_MAIN_FIRST_THREAD = 0x04, // Keep main thread as first thread
+        DEBUG_FRAME_PROFILE = 0x08 // Send the time spent in each stage of the frame boundary
     };
 
     int debug_state = 0;
@@ -203,6 +217,18 @@ struct __attribute__((packed, aligned(8))) SharedConfig {
     /* How are we handling waits */
     int wait_timeout = WAIT_NATIVE;
 
+    /* An enum indicating which low-level time sources are intercepted, for
+     * games that read the time without going through libc */
+    enum TimeTrapFlags
+    {
+        TIME_TRAP_SYSCALL = 0x01, /* Raw time syscalls, using a seccomp filter */
+        TIME_TRAP_VDSO = 0x02, /* Time functions of the vDSO, by patching them */
+        TIME_TRAP_TSC = 0x04, /* rdtsc/rdtscp instructions, by making them fault */
+    };
+
+    /* Intercepted low-level time sources */
+    int time_trap = 0;
+
     /* An enum indicating enabled game-specific timing settings */
     enum GameSpecificTiming
     {
@@ -222,6 +248,9 @@ struct __attribute__((packed, aligned(8))) SharedConfig {
     /* Game-specific timing settings */
     int game_specific_sync = 0;
 
+    /* Apply the timing and threading policies of the detected game engine */
+    bool engine_profile = false;
+
     /* An enum indicating several savestate options */
     enum SaveStateFlags
     {
@@ -236,6 +265,17 @@ struct __attribute__((packed, aligned(8))) SharedConfig {
     /* Savestate settings */
     int savestate_settings = SS_COMPRESSED;
 
+    /* Savestate slots. Slot 0 holds the base state of incremental savestates,
+     * slots 1 to 9 are the user slots, followed by the backtrack slot and
+     * by the slots managed by the input editor greenzone */
+    enum SaveStateSlots
+    {
+        SS_SLOT_BACKTRACK = 10,
+        SS_SLOT_GREENZONE = 11,
+        SS_SLOT_GREENZONE_COUNT = 32,
+        SS_SLOT_COUNT = SS_SLOT_GREENZONE + SS_SLOT_GREENZONE_COUNT,
+    };
+
     /* Stacktrace hash to advance time */
     uint64_t busy_loop_hash = 0;
 
@@ -281,6 +321,9 @@ struct __attribute__((packed, aligned(8))) SharedConfig {
     /* Recycle threads when they terminate */
     bool recycle_threads = false;
 
+    /* Delay signals sent to other threads until deterministic points */
+    bool deferred_signals = false;
+
     /* Simulates a virtual Steam client */
     bool virtual_steam = false;
 
@@ -0,0 +1,52 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBTAS_WATCHPOINT_H_INCLUDED
+#define LIBTAS_WATCHPOINT_H_INCLUDED
+
+#include <stdint.h>
+
+/*
+ * Hardware watchpoint on a game address, set by the program and implemented
+ * by the game using debug registers.
+ */
+struct Watchpoint {
+    /* Number of debug registers available for watchpoints on x86 */
+    static const int MAX = 4;
+
+    enum Type {
+        WRITE = 0, // triggered on writes
+        ACCESS = 1, // triggered on reads and writes
+    };
+
+    uint64_t addr = 0;
+    int size = 0; // 1, 2, 4 or 8 bytes, address must be aligned on size
+    int type = WRITE;
+};
+
+/*
+ * Access to a watched address, sent back to the program
+ */
+struct WatchpointHit {
+    uint64_t addr = 0; // watched address
+    uint64_t frame = 0; // frame during which the access happened
+    uint64_t ip = 0; // address of the instruction following the access
+};
+
+#endif
@@ -137,6 +137,12 @@ enum {
      */
     MSGN_LOADSTATE,
 
+    /*
+     * Ask the game to free the memory or files of a savestate
+     * Argument: none
+     */
+    MSGN_RELEASESTATE,
+
     /*
      * Tells the program that the saving succeeded
      * Argument: none
@@ -287,6 +293,26 @@ enum {
      */
     MSGB_LUA_RESOLUTION,
 
+    /*
+     * Send the full list of hardware watchpoints to the game, replacing the
+     * previous one.
+     * Argument: int count, then count * struct Watchpoint
+     */
+    MSGN_WATCHPOINTS,
+
+    /*
+     * Send an access to a watched address that happened during the frame.
+     * Argument: struct WatchpointHit
+     */
+    MSGB_WATCHPOINT_HIT,
+
+    /*
+     * Send the time spent in each stage of the previous frame boundary, if
+     * the DEBUG_FRAME_PROFILE flag is set.
+     * Argument: struct FrameProfile
+     */
+    MSGB_FRAME_PROFILE,
+
 };
 
 #endif
@@ -35,6 +35,7 @@
 #endif
 
 #define SOCKET_FILENAME "/tmp/libTAS.socket"
+#define TEMPLATE_SOCKET_FILENAME "/tmp/libTAS.template.socket"
 
 /* Socket to communicate between the program and the game */
 static int socket_fd = 0;
@@ -55,7 +56,18 @@ bool initSocketProgram(void)
     const int MAX_RETRIES = 10;
     int retry = 0;
 
-    nanosleep(&tim, NULL);
+    /* Quietly poll at a short interval during the first delay, because a game
+     * forked from a launch template creates its socket almost immediately */
+    struct timespec short_tim = {0, 20L*1000L*1000L};
+    for (int i = 0; i < 25; i++) {
+        if (connect(socket_fd, reinterpret_cast<const struct sockaddr*>(&addr),
+                sizeof(struct sockaddr_un)) == 0) {
+            std::cout << "Attempt " << retry + 1 << ": Connected." << std::endl;
+            return true;
+        }
+        nanosleep(&short_tim, NULL);
+    }
+
     while (connect(socket_fd, reinterpret_cast<const struct sockaddr*>(&addr),
                 sizeof(struct sockaddr_un))) {
         std::cout << "Attempt " << retry + 1 << ": Couldn't connect to socket." << std::endl;
@@ -106,6 +118,76 @@ bool initSocketGame(void)
     return true;
 }
 
+int initTemplateSocket(void)
+{
+    unlink(TEMPLATE_SOCKET_FILENAME);
+
+    const struct sockaddr_un addr = { AF_UNIX, TEMPLATE_SOCKET_FILENAME };
+    const int tmp_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (bind(tmp_fd, reinterpret_cast<const struct sockaddr*>(&addr), sizeof(struct sockaddr_un)))
+    {
+        std::cerr << "Couldn't bind template socket." << std::endl;
+        close(tmp_fd);
+        return -1;
+    }
+
+    if (listen(tmp_fd, 1))
+    {
+        std::cerr << "Couldn't listen on template socket." << std::endl;
+        close(tmp_fd);
+        return -1;
+    }
+
+    return tmp_fd;
+}
+
+bool requestTemplateFork(pid_t* template_pid, pid_t* game_pid)
+{
+    const struct sockaddr_un addr = { AF_UNIX, TEMPLATE_SOCKET_FILENAME };
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    /* The template may still be loading the game libraries */
+    struct timespec tim = {0, 100L*1000L*1000L};
+    const int MAX_RETRIES = 100;
+    int retry = 0;
+
+    while (connect(fd, reinterpret_cast<const struct sockaddr*>(&addr),
+                sizeof(struct sockaddr_un))) {
+        retry++;
+        if (retry < MAX_RETRIES) {
+            nanosleep(&tim, NULL);
+        } else {
+            std::cerr << "Couldn't connect to template socket." << std::endl;
+            close(fd);
+            return false;
+        }
+    }
+
+    /* The template answers with its pid and the pid of the forked process */
+    pid_t pids[2];
+    size_t received = 0;
+    while (received < sizeof(pids)) {
+        ssize_t ret = recv(fd, reinterpret_cast<char*>(pids) + received, sizeof(pids) - received, 0);
+        if (ret <= 0) {
+            if ((ret == -1) && (errno == EINTR))
+                continue;
+            close(fd);
+            return false;
+        }
+        received += ret;
+    }
+
+    close(fd);
+    *template_pid = pids[0];
+    *game_pid = pids[1];
+    return true;
+}
+
+void removeTemplateSocket(void)
+{
+    unlink(TEMPLATE_SOCKET_FILENAME);
+}
+
 void closeSocket(void)
 {
     close(socket_fd);
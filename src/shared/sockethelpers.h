@@ -22,6 +22,7 @@
 
 #include <cstddef>
 #include <string>
+#include <sys/types.h>
 
 /* Remove the socker file */
 void removeSocket();
@@ -32,6 +33,17 @@ bool initSocketProgram(void);
 /* Initiate a socket connection with libTAS */
 bool initSocketGame(void);
 
+/* Create the socket on which the launch template waits for fork requests.
+ * Returns the listening socket, or -1 on error. */
+int initTemplateSocket(void);
+
+/* Ask the launch template to fork a new game process. Returns the pid of the
+ * template and of the new game process. */
+bool requestTemplateFork(pid_t* template_pid, pid_t* game_pid);
+
+/* Remove the launch template socket file */
+void removeTemplateSocket(void);
+
 /* Close the socket connection */
 void closeSocket(void);
 
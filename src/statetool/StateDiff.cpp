@@ -0,0 +1,189 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StateDiff.h"
+
+#include <cstring>
+#include <cerrno>
+#include <sys/uio.h> // process_vm_readv
+
+using libtas::Area;
+
+/* Merge consecutive differences into ranges before sending them */
+class RangeMerger {
+    public:
+        RangeMerger(const StateDiff::Callback& cb) : callback(cb) {}
+        ~RangeMerger() {flush();}
+
+        void add(DiffRange::Kind kind, uintptr_t addr, size_t size, const char* first, const char* second)
+        {
+            if (pending && (range.kind == kind) && (range.addr + range.size == addr)) {
+                range.size += size;
+                return;
+            }
+
+            flush();
+            pending = true;
+            range.kind = kind;
+            range.addr = addr;
+            range.size = size;
+            range.preview_size = 0;
+            if (first && second) {
+                range.preview_size = (size < DiffRange::PREVIEW_SIZE) ? size : DiffRange::PREVIEW_SIZE;
+                memcpy(range.first, first, range.preview_size);
+                memcpy(range.second, second, range.preview_size);
+            }
+        }
+
+        void flush()
+        {
+            if (pending)
+                callback(range);
+            pending = false;
+        }
+
+    private:
+        const StateDiff::Callback& callback;
+        DiffRange range;
+        bool pending = false;
+};
+
+/* Compare the content of one page, and add the differences */
+static void comparePage(uintptr_t addr, const char* first, const char* second, bool byte_level, RangeMerger& merger, DiffStats& stats)
+{
+    stats.pages_compared++;
+
+    if (memcmp(first, second, STATE_PAGE_SIZE) == 0)
+        return;
+
+    stats.pages_changed++;
+
+    if (!byte_level) {
+        merger.add(DiffRange::CHANGED, addr, STATE_PAGE_SIZE, nullptr, nullptr);
+        for (int i = 0; i < STATE_PAGE_SIZE; i++)
+            if (first[i] != second[i])
+                stats.bytes_changed++;
+        return;
+    }
+
+    int i = 0;
+    while (i < STATE_PAGE_SIZE) {
+        if (first[i] == second[i]) {
+            i++;
+            continue;
+        }
+        int start = i;
+        while ((i < STATE_PAGE_SIZE) && (first[i] != second[i]))
+            i++;
+        merger.add(DiffRange::CHANGED, addr + start, i - start, first + start, second + start);
+        stats.bytes_changed += i - start;
+    }
+}
+
+bool StateDiff::diffStates(StateFile& first, StateFile& second, bool byte_level, const Callback& callback, DiffStats& stats, std::string& error)
+{
+    RangeMerger merger(callback);
+    char first_page[STATE_PAGE_SIZE];
+    char second_page[STATE_PAGE_SIZE];
+
+    bool has_first = first.rewind() && first.nextPage();
+    bool has_second = second.rewind() && second.nextPage();
+
+    while (has_first || has_second) {
+        if (has_first && (!has_second || (first.pageAddr() < second.pageAddr()))) {
+            merger.add(DiffRange::ONLY_FIRST, first.pageAddr(), STATE_PAGE_SIZE, nullptr, nullptr);
+            stats.pages_only_first++;
+            has_first = first.nextPage();
+            continue;
+        }
+
+        if (has_second && (!has_first || (second.pageAddr() < first.pageAddr()))) {
+            merger.add(DiffRange::ONLY_SECOND, second.pageAddr(), STATE_PAGE_SIZE, nullptr, nullptr);
+            stats.pages_only_second++;
+            has_second = second.nextPage();
+            continue;
+        }
+
+        /* Avoid reading pages that are known to be identical */
+        bool identical = false;
+        if (first.isZeroPage() && second.isZeroPage())
+            identical = true;
+        else if ((first.pageFlag() == Area::BASE_PAGE) && (second.pageFlag() == Area::BASE_PAGE) &&
+            first.baseState() && second.baseState() &&
+            (first.baseState()->prefix() == second.baseState()->prefix()))
+            identical = true;
+
+        if (identical) {
+            stats.pages_compared++;
+        }
+        else {
+            if (!first.readPage(first_page)) {
+                error = first.error();
+                return false;
+            }
+            if (!second.readPage(second_page)) {
+                error = second.error();
+                return false;
+            }
+            comparePage(first.pageAddr(), first_page, second_page, byte_level, merger, stats);
+        }
+
+        has_first = first.nextPage();
+        has_second = second.nextPage();
+    }
+
+    return true;
+}
+
+bool StateDiff::diffProcess(StateFile& state, pid_t pid, bool byte_level, const Callback& callback, DiffStats& stats, std::string& error)
+{
+    RangeMerger merger(callback);
+    char state_page[STATE_PAGE_SIZE];
+    char process_page[STATE_PAGE_SIZE];
+
+    if (!state.rewind()) {
+        error = state.error();
+        return false;
+    }
+
+    while (state.nextPage()) {
+        struct iovec local = {process_page, STATE_PAGE_SIZE};
+        struct iovec remote = {reinterpret_cast<void*>(state.pageAddr()), STATE_PAGE_SIZE};
+        ssize_t ret = process_vm_readv(pid, &local, 1, &remote, 1, 0);
+
+        if (ret != STATE_PAGE_SIZE) {
+            /* The first error is probably a permission issue */
+            if ((ret < 0) && (errno != EFAULT)) {
+                error = std::string("Could not read the process memory: ") + strerror(errno);
+                return false;
+            }
+            merger.add(DiffRange::ONLY_SECOND, state.pageAddr(), STATE_PAGE_SIZE, nullptr, nullptr);
+            stats.pages_only_second++;
+            continue;
+        }
+
+        if (!state.readPage(state_page)) {
+            error = state.error();
+            return false;
+        }
+        comparePage(state.pageAddr(), state_page, process_page, byte_level, merger, stats);
+    }
+
+    return true;
+}
@@ -0,0 +1,76 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBTAS_STATEDIFF_H_INCLUDED
+#define LIBTAS_STATEDIFF_H_INCLUDED
+
+#include "StateFile.h"
+#include <functional>
+#include <string>
+#include <stdint.h>
+#include <sys/types.h>
+
+/* Range of memory that differs between two states, or between a state and
+ * the memory of a running process */
+struct DiffRange {
+    enum Kind {
+        CHANGED, // content is different
+        ONLY_FIRST, // only stored in the first state
+        ONLY_SECOND, // only stored in the second state, or not readable in the process
+    };
+
+    Kind kind;
+    uintptr_t addr;
+    size_t size;
+
+    /* First bytes of the range in each state, for byte-level diffs */
+    static const int PREVIEW_SIZE = 8;
+    int preview_size = 0;
+    uint8_t first[PREVIEW_SIZE];
+    uint8_t second[PREVIEW_SIZE];
+};
+
+struct DiffStats {
+    uint64_t pages_compared = 0;
+    uint64_t pages_changed = 0;
+    uint64_t pages_only_first = 0;
+    uint64_t pages_only_second = 0;
+    uint64_t bytes_changed = 0;
+};
+
+/* Compare states page by page, in a single pass over both states, so that
+ * memory usage does not depend on the state size. Consecutive differences
+ * are merged into ranges, which are sent to the callback in increasing
+ * address order. With byte_level, changed pages are compared byte by byte
+ * and ranges are made of the bytes that differ. */
+namespace StateDiff {
+
+    typedef std::function<void(const DiffRange&)> Callback;
+
+    /* Compare two states. Returns false on error, with the error message */
+    bool diffStates(StateFile& first, StateFile& second, bool byte_level, const Callback& callback, DiffStats& stats, std::string& error);
+
+    /* Compare a state with the current memory of a process, for the memory
+     * areas stored in the state. Returns false on error, with the error
+     * message */
+    bool diffProcess(StateFile& state, pid_t pid, bool byte_level, const Callback& callback, DiffStats& stats, std::string& error);
+
+}
+
+#endif
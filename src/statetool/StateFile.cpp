@@ -0,0 +1,352 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StateFile.h"
+#include "../external/lz4.h"
+
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+using libtas::Area;
+
+/* Read exactly size bytes at an offset */
+static bool readAllAt(int fd, void* buf, size_t size, off_t offset)
+{
+    char* cbuf = static_cast<char*>(buf);
+    while (size > 0) {
+        ssize_t ret = pread(fd, cbuf, size, offset);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            return false;
+        cbuf += ret;
+        size -= ret;
+        offset += ret;
+    }
+    return true;
+}
+
+/* Read exactly size bytes at the current position */
+static bool readAll(int fd, void* buf, size_t size)
+{
+    char* cbuf = static_cast<char*>(buf);
+    while (size > 0) {
+        ssize_t ret = read(fd, cbuf, size);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            return false;
+        cbuf += ret;
+        size -= ret;
+    }
+    return true;
+}
+
+StateFile::StateFile()
+{
+    memset(&sh, 0, sizeof(sh));
+    memset(&current_area, 0, sizeof(current_area));
+}
+
+StateFile::~StateFile()
+{
+    close();
+}
+
+bool StateFile::open(const std::string& path)
+{
+    close();
+
+    /* Accept the path of the pagemap or pages file as well */
+    pathprefix = path;
+    if ((pathprefix.size() > 3) && (pathprefix.compare(pathprefix.size() - 3, 3, ".pm") == 0))
+        pathprefix.resize(pathprefix.size() - 3);
+    else if ((pathprefix.size() > 2) && (pathprefix.compare(pathprefix.size() - 2, 2, ".p") == 0))
+        pathprefix.resize(pathprefix.size() - 2);
+
+    std::string pmpath = pathprefix + ".pm";
+    std::string ppath = pathprefix + ".p";
+
+    pmfd = ::open(pmpath.c_str(), O_RDONLY);
+    if (pmfd < 0) {
+        err = "Could not open " + pmpath + ": " + strerror(errno);
+        return false;
+    }
+
+    pfd = ::open(ppath.c_str(), O_RDONLY);
+    if (pfd < 0) {
+        err = "Could not open " + ppath + ": " + strerror(errno);
+        close();
+        return false;
+    }
+
+    if (!readAllAt(pmfd, &sh, sizeof(sh), 0) || (sh.thread_count < 0) || (sh.thread_count > STATEMAXTHREADS)) {
+        err = pmpath + " is not a savestate";
+        close();
+        return false;
+    }
+
+    return rewind();
+}
+
+void StateFile::close()
+{
+    if (pmfd >= 0)
+        ::close(pmfd);
+    if (pfd >= 0)
+        ::close(pfd);
+    pmfd = -1;
+    pfd = -1;
+    at_end = true;
+    page_valid = false;
+}
+
+void StateFile::setBase(StateFile* b)
+{
+    base = b;
+}
+
+bool StateFile::rewind()
+{
+    if (lseek(pmfd, sizeof(libtas::StateHeader), SEEK_SET) == -1) {
+        err = "Could not seek in " + pathprefix + ".pm";
+        at_end = true;
+        return false;
+    }
+
+    memset(&current_area, 0, sizeof(current_area));
+    at_end = false;
+    flags_remaining = 0;
+    flag_i = flag_count = 0;
+    page_valid = false;
+    return true;
+}
+
+bool StateFile::nextArea()
+{
+    if (at_end)
+        return false;
+
+    /* Skip the remaining flags of the current area */
+    if (flags_remaining > 0)
+        lseek(pmfd, flags_remaining, SEEK_CUR);
+
+    page_valid = false;
+    flag_i = flag_count = 0;
+    flags_remaining = 0;
+
+    if (!readAll(pmfd, &current_area, sizeof(Area))) {
+        err = pathprefix + ".pm is truncated";
+        at_end = true;
+        return false;
+    }
+
+    /* Last area is null */
+    if (current_area.addr == nullptr) {
+        at_end = true;
+        return false;
+    }
+
+    if (!current_area.skip)
+        flags_remaining = current_area.size / STATE_PAGE_SIZE;
+
+    page_addr = reinterpret_cast<uintptr_t>(current_area.addr) - STATE_PAGE_SIZE;
+    next_offset = current_area.page_offset;
+    return true;
+}
+
+bool StateFile::readFlag()
+{
+    if (flag_i == flag_count) {
+        if (flags_remaining == 0)
+            return false;
+
+        int size = (flags_remaining > sizeof(flags)) ? sizeof(flags) : flags_remaining;
+        if (!readAll(pmfd, flags, size)) {
+            err = pathprefix + ".pm is truncated";
+            flags_remaining = 0;
+            return false;
+        }
+        flags_remaining -= size;
+        flag_count = size;
+        flag_i = 0;
+    }
+
+    page_flag = flags[flag_i++];
+    return true;
+}
+
+bool StateFile::nextPageInArea()
+{
+    if (at_end || (current_area.addr == nullptr) || !readFlag()) {
+        page_valid = false;
+        return false;
+    }
+
+    page_addr += STATE_PAGE_SIZE;
+    page_offset = next_offset;
+
+    /* Compute the position of the next stored page */
+    if (page_flag == Area::FULL_PAGE) {
+        next_offset += STATE_PAGE_SIZE;
+    }
+    else if (page_flag == Area::COMPRESSED_PAGE) {
+        if (!readAllAt(pfd, &compressed_length, sizeof(int), page_offset)) {
+            err = pathprefix + ".p is truncated";
+            compressed_length = 0;
+        }
+        next_offset += sizeof(int) + compressed_length;
+    }
+
+    page_valid = true;
+    return true;
+}
+
+bool StateFile::nextPage()
+{
+    while (!nextPageInArea()) {
+        if (!nextArea())
+            return false;
+    }
+    return true;
+}
+
+bool StateFile::readPage(char* buf)
+{
+    if (!page_valid)
+        return false;
+
+    switch (page_flag) {
+        case Area::NO_PAGE:
+        case Area::ZERO_PAGE:
+            memset(buf, 0, STATE_PAGE_SIZE);
+            return true;
+
+        case Area::FULL_PAGE:
+            if (!readAllAt(pfd, buf, STATE_PAGE_SIZE, page_offset)) {
+                err = pathprefix + ".p is truncated";
+                return false;
+            }
+            return true;
+
+        case Area::COMPRESSED_PAGE:
+        {
+            char compressed[LZ4_COMPRESSBOUND(STATE_PAGE_SIZE)];
+            if ((compressed_length <= 0) || (compressed_length > LZ4_COMPRESSBOUND(STATE_PAGE_SIZE)) ||
+                !readAllAt(pfd, compressed, compressed_length, page_offset + sizeof(int))) {
+                err = pathprefix + ".p is truncated";
+                return false;
+            }
+            if (LZ4_decompress_safe(compressed, buf, compressed_length, STATE_PAGE_SIZE) != STATE_PAGE_SIZE) {
+                err = pathprefix + ".p has a corrupted compressed page";
+                return false;
+            }
+            return true;
+        }
+
+        case Area::BASE_PAGE:
+            if (!base) {
+                err = "Page stored in the base savestate, which was not given";
+                return false;
+            }
+            if (!base->seekPage(page_addr) || (base->pageFlag() == Area::BASE_PAGE)) {
+                err = "Page not found in the base savestate";
+                return false;
+            }
+            if (!base->readPage(buf)) {
+                err = base->error();
+                return false;
+            }
+            return true;
+
+        default:
+            err = "Unknown page flag";
+            return false;
+    }
+}
+
+bool StateFile::seekPage(uintptr_t addr)
+{
+    addr &= ~static_cast<uintptr_t>(STATE_PAGE_SIZE - 1);
+
+    /* We can only move forward, so start again if needed */
+    if (page_valid && (addr == page_addr))
+        return true;
+    if (at_end || (page_valid && (addr < page_addr)) ||
+        ((current_area.addr != nullptr) && (addr < reinterpret_cast<uintptr_t>(current_area.addr)))) {
+        if (!rewind())
+            return false;
+    }
+
+    /* Find the area containing the address */
+    while ((current_area.addr == nullptr) || (addr >= reinterpret_cast<uintptr_t>(current_area.endAddr))) {
+        if (!nextArea())
+            return false;
+    }
+
+    if (addr < reinterpret_cast<uintptr_t>(current_area.addr))
+        return false;
+
+    while (!page_valid || (page_addr < addr)) {
+        if (!nextPageInArea())
+            return false;
+    }
+    return true;
+}
+
+size_t StateFile::read(uintptr_t addr, char* buf, size_t size)
+{
+    char page[STATE_PAGE_SIZE];
+    size_t done = 0;
+
+    while (done < size) {
+        uintptr_t cur = addr + done;
+        if (!seekPage(cur) || !readPage(page))
+            break;
+
+        size_t page_off = cur - page_addr;
+        size_t len = STATE_PAGE_SIZE - page_off;
+        if (len > size - done)
+            len = size - done;
+        memcpy(buf + done, page + page_off, len);
+        done += len;
+    }
+
+    return done;
+}
+
+const char* StateFile::flagName(char flag)
+{
+    switch (flag) {
+        case Area::NO_PAGE:
+            return "unmapped";
+        case Area::ZERO_PAGE:
+            return "zero";
+        case Area::FULL_PAGE:
+            return "full";
+        case Area::BASE_PAGE:
+            return "base";
+        case Area::COMPRESSED_PAGE:
+            return "compressed";
+        default:
+            return "none";
+    }
+}
@@ -0,0 +1,140 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBTAS_STATEFILE_H_INCLUDED
+#define LIBTAS_STATEFILE_H_INCLUDED
+
+#include "../library/checkpoint/ProcMapsArea.h"
+#include "../library/checkpoint/StateHeader.h"
+#include <string>
+#include <stdint.h>
+#include <sys/types.h>
+
+#define STATE_PAGE_SIZE 4096
+
+/* Streaming reader of a savestate stored on disk, as written by
+ * Checkpoint::writeAllAreas(). A state is made of two files:
+ * - <prefix>.pm: a StateHeader, then for each memory area an Area struct
+ *   followed by one flag per page (Area::PageFlag), and an Area with a null
+ *   address at the end;
+ * - <prefix>.p: the content of FULL_PAGE pages, and of COMPRESSED_PAGE pages
+ *   as an int length followed by the LZ4 compressed data.
+ *
+ * Pages are read sequentially in increasing address order, and only one
+ * chunk of flags is kept in memory, so that arbitrary large states can be
+ * processed. Pages stored as BASE_PAGE by incremental savestates are read
+ * from the base state, which must be set with setBase().
+ */
+class StateFile {
+    public:
+        StateFile();
+        ~StateFile();
+
+        /* Open the state files from the prefix, or from the path of one of
+         * the two files. Returns false and sets the error string on error. */
+        bool open(const std::string& path);
+        void close();
+
+        /* Base state used for BASE_PAGE pages. It must be a separate object
+         * from the states that are read, because reading a BASE_PAGE page
+         * moves the position in the base state. */
+        void setBase(StateFile* base);
+        StateFile* baseState() const {return base;}
+
+        const std::string& error() const {return err;}
+        const std::string& prefix() const {return pathprefix;}
+        const libtas::StateHeader& header() const {return sh;}
+
+        /* Go back to the first area */
+        bool rewind();
+
+        /* Read the next area, skipping the pages left in the current one.
+         * Returns false after the last area. */
+        bool nextArea();
+
+        /* Current area */
+        const libtas::Area& area() const {return current_area;}
+
+        /* Read the flag of the next page in the current area. Returns false
+         * at the end of the area, or if the area is skipped. */
+        bool nextPageInArea();
+
+        /* Read the flag of the next page, moving to the next areas if needed.
+         * Returns false after the last page. */
+        bool nextPage();
+
+        /* Address and flag of the current page */
+        uintptr_t pageAddr() const {return page_addr;}
+        char pageFlag() const {return page_flag;}
+
+        /* Fill the buffer with the content of the current page. Returns false
+         * if the content is not stored, for BASE_PAGE pages without a base
+         * state or if the files are truncated. */
+        bool readPage(char* buf);
+
+        /* Move to the page at an address, which must be after the current
+         * page, or else the state is read again from the beginning. Returns
+         * false if the address is not stored in the state. */
+        bool seekPage(uintptr_t addr);
+
+        /* Read memory at any address, which may span several pages. Returns
+         * the number of bytes read, which is less than size if some page is
+         * not stored in the state. */
+        size_t read(uintptr_t addr, char* buf, size_t size);
+
+        /* Does the current page only contain zeros, without reading it */
+        bool isZeroPage() const {
+            return (page_flag == libtas::Area::NO_PAGE) || (page_flag == libtas::Area::ZERO_PAGE);
+        }
+
+        /* Printable name of a page flag */
+        static const char* flagName(char flag);
+
+    private:
+        bool readFlag();
+
+        std::string pathprefix;
+        std::string err;
+
+        int pmfd = -1;
+        int pfd = -1;
+        StateFile* base = nullptr;
+
+        libtas::StateHeader sh;
+        libtas::Area current_area;
+        bool at_end = true;
+
+        /* Chunk of flags of the current area */
+        char flags[4096];
+        int flag_i = 0;
+        int flag_count = 0;
+        size_t flags_remaining = 0;
+
+        uintptr_t page_addr = 0;
+        char page_flag = libtas::Area::NONE;
+        bool page_valid = false;
+
+        /* Offset of the current page content in the pages file, and of the
+         * next page */
+        off_t page_offset = 0;
+        off_t next_offset = 0;
+        int compressed_length = 0;
+};
+
+#endif
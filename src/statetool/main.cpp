@@ -0,0 +1,334 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StateFile.h"
+#include "StateDiff.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <getopt.h>
+#include <unistd.h> // access
+#include <sys/mman.h> // PROT_*
+#include <inttypes.h> // PRIxPTR
+#include <stdint.h>
+
+using libtas::Area;
+
+static void print_usage(void)
+{
+    std::cout << "Usage: libTAS-statetool [options] command arguments" << std::endl;
+    std::cout << "Savestates are given by the path of their .pm or .p file, or without extension." << std::endl;
+    std::cout << "Commands are:" << std::endl;
+    std::cout << "  areas STATE                     List the memory areas of a state" << std::endl;
+    std::cout << "  extract STATE ADDR SIZE         Print memory from a state as hexadecimal" << std::endl;
+    std::cout << "  diff STATE1 STATE2              List the memory differences between two states" << std::endl;
+    std::cout << "  diff-process STATE PID          List the memory differences between a state and a running process" << std::endl;
+    std::cout << "Options are:" << std::endl;
+    std::cout << "  -b, --base STATE    Base state of incremental savestates (default: state number 0 next to the state)" << std::endl;
+    std::cout << "  -x, --bytes         Compare changed pages byte by byte" << std::endl;
+    std::cout << "  -o, --output FILE   Write extracted memory as raw bytes into FILE" << std::endl;
+    std::cout << "  -h, --help          Show this message" << std::endl;
+}
+
+/* Path of the base state, which is the state with index 0 in the same
+ * directory, as stored by the program */
+static std::string default_base(const std::string& path)
+{
+    std::string prefix = path;
+    if (prefix.size() > 3 && prefix.compare(prefix.size() - 3, 3, ".pm") == 0)
+        prefix.resize(prefix.size() - 3);
+    else if (prefix.size() > 2 && prefix.compare(prefix.size() - 2, 2, ".p") == 0)
+        prefix.resize(prefix.size() - 2);
+
+    size_t digits = prefix.size();
+    while (digits > 0 && isdigit(prefix[digits-1]))
+        digits--;
+    if (digits == prefix.size())
+        return "";
+
+    std::string base = prefix.substr(0, digits) + "0";
+    if ((base == prefix) || (access((base + ".pm").c_str(), R_OK) != 0))
+        return "";
+    return base;
+}
+
+/* Open a state and its base state if it has one */
+static bool open_state(const std::string& path, const std::string& basepath, StateFile& state, std::unique_ptr<StateFile>& base)
+{
+    if (!state.open(path)) {
+        std::cerr << state.error() << std::endl;
+        return false;
+    }
+
+    std::string bpath = basepath.empty() ? default_base(path) : basepath;
+    if (!bpath.empty()) {
+        base.reset(new StateFile());
+        if (!base->open(bpath)) {
+            std::cerr << base->error() << std::endl;
+            return false;
+        }
+        state.setBase(base.get());
+    }
+    return true;
+}
+
+static std::string area_perms(const Area& area)
+{
+    std::string perms;
+    perms += (area.prot & PROT_READ) ? 'r' : '-';
+    perms += (area.prot & PROT_WRITE) ? 'w' : '-';
+    perms += (area.prot & PROT_EXEC) ? 'x' : '-';
+    perms += (area.flags & MAP_SHARED) ? 's' : 'p';
+    return perms;
+}
+
+static int cmd_areas(StateFile& state)
+{
+    const libtas::StateHeader& sh = state.header();
+    std::cout << "Threads:";
+    for (int t = 0; t < sh.thread_count; t++)
+        std::cout << " " << sh.tids[t];
+    std::cout << std::endl;
+
+    std::cout << "Start            End              Perm  Pages    Zero     Full     Compr    Base     Unmap    Name" << std::endl;
+
+    while (state.nextArea()) {
+        const Area& area = state.area();
+        uint64_t counts[Area::COMPRESSED_PAGE + 1] = {};
+        uint64_t pages = area.size / STATE_PAGE_SIZE;
+        while (state.nextPageInArea()) {
+            char flag = state.pageFlag();
+            if ((flag >= 0) && (flag <= Area::COMPRESSED_PAGE))
+                counts[static_cast<int>(flag)]++;
+        }
+
+        std::cout << std::hex << std::setfill('0') << std::setw(16) << reinterpret_cast<uintptr_t>(area.addr) << " ";
+        std::cout << std::setw(16) << reinterpret_cast<uintptr_t>(area.endAddr) << std::dec << std::setfill(' ') << " ";
+        std::cout << area_perms(area) << "  ";
+        std::cout << std::left << std::setw(8) << pages << " ";
+        if (area.skip) {
+            std::cout << std::setw(44) << "(not saved)";
+        }
+        else {
+            std::cout << std::setw(8) << counts[Area::ZERO_PAGE] << " ";
+            std::cout << std::setw(8) << counts[Area::FULL_PAGE] << " ";
+            std::cout << std::setw(8) << counts[Area::COMPRESSED_PAGE] << " ";
+            std::cout << std::setw(8) << counts[Area::BASE_PAGE] << " ";
+            std::cout << std::setw(8) << counts[Area::NO_PAGE];
+        }
+        std::cout << std::right << " " << area.name << std::endl;
+    }
+
+    if (!state.error().empty()) {
+        std::cerr << state.error() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+static int cmd_extract(StateFile& state, uintptr_t addr, size_t size, const std::string& outfile)
+{
+    std::ofstream out;
+    if (!outfile.empty()) {
+        out.open(outfile, std::ios::binary);
+        if (!out) {
+            std::cerr << "Could not open " << outfile << std::endl;
+            return 1;
+        }
+    }
+
+    /* Extract by chunks to keep a bounded memory usage */
+    static const size_t CHUNK_SIZE = 1024 * 1024;
+    std::unique_ptr<char[]> buf(new char[CHUNK_SIZE]);
+
+    size_t done = 0;
+    while (done < size) {
+        size_t len = (size - done > CHUNK_SIZE) ? CHUNK_SIZE : (size - done);
+        size_t got = state.read(addr + done, buf.get(), len);
+
+        if (out.is_open()) {
+            out.write(buf.get(), got);
+        }
+        else {
+            for (size_t line = 0; line < got; line += 16) {
+                printf("%016" PRIxPTR ": ", addr + done + line);
+                for (size_t i = line; i < line + 16; i++) {
+                    if (i < got)
+                        printf("%02x ", static_cast<unsigned char>(buf[i]));
+                    else
+                        printf("   ");
+                }
+                printf(" ");
+                for (size_t i = line; (i < line + 16) && (i < got); i++)
+                    putchar(isprint(static_cast<unsigned char>(buf[i])) ? buf[i] : '.');
+                printf("\n");
+            }
+        }
+
+        done += got;
+        if (got < len) {
+            std::cerr << "Address 0x" << std::hex << (addr + done) << std::dec << " is not stored in the state";
+            if (!state.error().empty())
+                std::cerr << ": " << state.error();
+            std::cerr << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void print_range(const DiffRange& range)
+{
+    const char* kind = "changed";
+    if (range.kind == DiffRange::ONLY_FIRST)
+        kind = "only in first";
+    else if (range.kind == DiffRange::ONLY_SECOND)
+        kind = "only in second";
+
+    printf("%016" PRIxPTR "-%016" PRIxPTR " %10zu  %s", range.addr, range.addr + range.size, range.size, kind);
+
+    if (range.preview_size > 0) {
+        printf("  ");
+        for (int i = 0; i < range.preview_size; i++)
+            printf("%02x", range.first[i]);
+        printf(" -> ");
+        for (int i = 0; i < range.preview_size; i++)
+            printf("%02x", range.second[i]);
+        if (range.size > static_cast<size_t>(range.preview_size))
+            printf("...");
+    }
+    printf("\n");
+}
+
+static void print_stats(const DiffStats& stats)
+{
+    printf("%" PRIu64 " pages compared, %" PRIu64 " changed (%" PRIu64 " bytes), %" PRIu64 " only in first, %" PRIu64 " only in second\n",
+        stats.pages_compared, stats.pages_changed, stats.bytes_changed, stats.pages_only_first, stats.pages_only_second);
+}
+
+int main(int argc, char **argv)
+{
+    std::string basepath;
+    std::string outfile;
+    bool byte_level = false;
+
+    static struct option long_options[] =
+    {
+        {"base", required_argument, nullptr, 'b'},
+        {"bytes", no_argument, nullptr, 'x'},
+        {"output", required_argument, nullptr, 'o'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+    int option_index = 0;
+    int c;
+
+    while ((c = getopt_long (argc, argv, "b:xo:h", long_options, &option_index)) != -1) {
+        switch (c) {
+            case 'b':
+                basepath = optarg;
+                break;
+            case 'x':
+                byte_level = true;
+                break;
+            case 'o':
+                outfile = optarg;
+                break;
+            case 'h':
+                print_usage();
+                return 0;
+            default:
+                print_usage();
+                return 1;
+        }
+    }
+
+    if (optind >= argc) {
+        print_usage();
+        return 1;
+    }
+
+    std::string command = argv[optind];
+    int nargs = argc - optind - 1;
+    char** args = argv + optind + 1;
+
+    if (command == "areas" && nargs == 1) {
+        StateFile state;
+        std::unique_ptr<StateFile> base;
+        if (!open_state(args[0], basepath, state, base))
+            return 1;
+        return cmd_areas(state);
+    }
+
+    if (command == "extract" && nargs == 3) {
+        StateFile state;
+        std::unique_ptr<StateFile> base;
+        if (!open_state(args[0], basepath, state, base))
+            return 1;
+        uintptr_t addr = strtoull(args[1], nullptr, 0);
+        size_t size = strtoull(args[2], nullptr, 0);
+        return cmd_extract(state, addr, size, outfile);
+    }
+
+    if (command == "diff" && nargs == 2) {
+        /* Each state needs its own base object, because reading from the
+         * base moves its position */
+        StateFile first, second;
+        std::unique_ptr<StateFile> first_base, second_base;
+        if (!open_state(args[0], basepath, first, first_base))
+            return 1;
+        if (!open_state(args[1], basepath, second, second_base))
+            return 1;
+
+        DiffStats stats;
+        std::string error;
+        if (!StateDiff::diffStates(first, second, byte_level, print_range, stats, error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        print_stats(stats);
+        return 0;
+    }
+
+    if (command == "diff-process" && nargs == 2) {
+        StateFile state;
+        std::unique_ptr<StateFile> base;
+        if (!open_state(args[0], basepath, state, base))
+            return 1;
+
+        DiffStats stats;
+        std::string error;
+        if (!StateDiff::diffProcess(state, atoi(args[1]), byte_level, print_range, stats, error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        print_stats(stats);
+        return 0;
+    }
+
+    print_usage();
+    return 1;
+}
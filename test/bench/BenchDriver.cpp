@@ -0,0 +1,319 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchDriver.h"
+#include "shared/sockethelpers.h"
+#include "shared/messages.h"
+#include "shared/GameInfo.h"
+#include "shared/Watchpoint.h"
+
+#include <iostream>
+#include <cstring>
+#include <csignal> // kill
+#include <ctime>
+#include <unistd.h>
+#include <sys/stat.h> // stat
+#include <sys/wait.h> // waitpid
+
+static std::string savestateprefix;
+
+static FrameProfile profile;
+
+static std::string statePath(int slot)
+{
+    return savestateprefix + std::to_string(slot);
+}
+
+pid_t BenchDriver::launch(const std::string& libtaspath, const std::vector<std::string>& args, SharedConfig& sc, const std::string& statedir)
+{
+    savestateprefix = statedir + "/bench.state";
+
+    /* A base state left by a previous run would be used as the base of the
+     * incremental states of this game */
+    unlink((statePath(0) + ".pm").c_str());
+    unlink((statePath(0) + ".p").c_str());
+
+    removeSocket();
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        setenv("LIBTAS_LIBRARY_PATH", libtaspath.c_str(), 1);
+        setenv("LD_PRELOAD", libtaspath.c_str(), 1);
+
+        std::vector<char*> argv;
+        for (const std::string& arg : args)
+            argv.push_back(const_cast<char*>(arg.c_str()));
+        argv.push_back(nullptr);
+
+        execv(argv[0], argv.data());
+        std::cerr << "Could not execute " << args[0] << std::endl;
+        _exit(1);
+    }
+
+    if (pid < 0)
+        return -1;
+
+    if (!initSocketProgram()) {
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+        return -1;
+    }
+
+    /* Receive informations from the game */
+    int message = receiveMessage();
+    while (message != MSGB_END_INIT) {
+        switch (message) {
+            case MSGB_PID:
+                pid_t game_pid;
+                receiveData(&game_pid, sizeof(pid_t));
+                break;
+            case MSGB_GIT_COMMIT:
+                receiveString();
+                break;
+            default:
+                std::cerr << "Unexpected init message " << message << std::endl;
+                quit(pid);
+                return -1;
+        }
+        message = receiveMessage();
+    }
+
+    sendMessage(MSGN_CONFIG_SIZE);
+    int config_size = sizeof(SharedConfig);
+    sendData(&config_size, sizeof(int));
+
+    sendMessage(MSGN_CONFIG);
+    sendData(&sc, sizeof(SharedConfig));
+
+    /* Same base state as the program */
+    if (sc.savestate_settings & SharedConfig::SS_INCREMENTAL) {
+        sendMessage(MSGN_BASE_SAVESTATE_INDEX);
+        int index = 0;
+        sendData(&index, sizeof(int));
+
+        if (!(sc.savestate_settings & SharedConfig::SS_RAM)) {
+            sendMessage(MSGN_BASE_SAVESTATE_PATH);
+            sendString(statePath(0));
+        }
+    }
+
+    sendMessage(MSGN_ENCODING_SEGMENT);
+    int segment = 0;
+    sendData(&segment, sizeof(int));
+
+    sendMessage(MSGN_END_INIT);
+
+    return pid;
+}
+
+bool BenchDriver::startFrame(uint64_t& framecount)
+{
+    int message = receiveMessage();
+
+    while (message != MSGB_START_FRAMEBOUNDARY) {
+        switch (message) {
+        case MSGB_WINDOW_ID:
+        {
+            uint32_t window;
+            receiveData(&window, sizeof(uint32_t));
+            break;
+        }
+        case MSGB_ALERT_MSG:
+            std::cerr << "Game alert: " << receiveString() << std::endl;
+            break;
+        case MSGB_ENCODE_FAILED:
+        case MSGB_NONDRAW_FRAME:
+        case MSGB_DO_BACKTRACK_SAVESTATE:
+            break;
+        case MSGB_FRAMECOUNT_TIME:
+        {
+            uint64_t time_sec, time_nsec;
+            receiveData(&framecount, sizeof(uint64_t));
+            receiveData(&time_sec, sizeof(uint64_t));
+            receiveData(&time_nsec, sizeof(uint64_t));
+            break;
+        }
+        case MSGB_GAMEINFO:
+        {
+            GameInfo game_info;
+            receiveData(&game_info, sizeof(GameInfo));
+            break;
+        }
+        case MSGB_FPS:
+        {
+            float fps, lfps;
+            receiveData(&fps, sizeof(float));
+            receiveData(&lfps, sizeof(float));
+            break;
+        }
+        case MSGB_ENCODING_SEGMENT:
+        {
+            int segment;
+            receiveData(&segment, sizeof(int));
+            break;
+        }
+        case MSGB_GETTIME_BACKTRACE:
+        {
+            int type;
+            uint64_t hash;
+            receiveData(&type, sizeof(int));
+            receiveData(&hash, sizeof(uint64_t));
+            receiveString();
+            break;
+        }
+        case MSGB_WATCHPOINT_HIT:
+        {
+            WatchpointHit hit;
+            receiveData(&hit, sizeof(WatchpointHit));
+            break;
+        }
+        case MSGB_FRAME_PROFILE:
+            receiveData(&profile, sizeof(FrameProfile));
+            break;
+        case MSGB_QUIT:
+            return false;
+        case -1:
+        case -2:
+            std::cerr << "The connection to the game was lost" << std::endl;
+            return false;
+        default:
+            std::cerr << "Got unknown message " << message << std::endl;
+            return false;
+        }
+        message = receiveMessage();
+    }
+
+    sendMessage(MSGN_START_FRAMEBOUNDARY);
+    return true;
+}
+
+void BenchDriver::endFrame(const SharedConfig& sc)
+{
+    /* Empty inputs, which don't need AllInputs::emptyInputs() */
+    AllInputs ai;
+    memset(&ai, 0, sizeof(AllInputs));
+    ai.framerate_num = sc.framerate_num;
+    ai.framerate_den = sc.framerate_den;
+
+    endFrame(ai);
+}
+
+void BenchDriver::endFrame(const AllInputs& ai)
+{
+    sendMessage(MSGN_ALL_INPUTS);
+    sendData(&ai, sizeof(AllInputs));
+    sendMessage(MSGN_END_FRAMEBOUNDARY);
+}
+
+const FrameProfile& BenchDriver::frameProfile()
+{
+    return profile;
+}
+
+int BenchDriver::saveState(int slot, const SharedConfig& sc)
+{
+    sendMessage(MSGN_SAVESTATE_INDEX);
+    sendData(&slot, sizeof(int));
+
+    if (!(sc.savestate_settings & SharedConfig::SS_RAM)) {
+        sendMessage(MSGN_SAVESTATE_PATH);
+        sendString(statePath(slot));
+    }
+
+    sendMessage(MSGN_SAVESTATE);
+    return receiveMessage();
+}
+
+bool BenchDriver::saveBaseState(const SharedConfig& sc)
+{
+    if (!(sc.savestate_settings & SharedConfig::SS_INCREMENTAL))
+        return true;
+
+    /* The game writes the base state before its first incremental state, so
+     * we save a state in the backtrack slot, which benchmarks don't use */
+    return saveState(SharedConfig::SS_SLOT_BACKTRACK, sc) == MSGB_SAVING_SUCCEEDED;
+}
+
+bool BenchDriver::loadState(int slot, const SharedConfig& sc, uint64_t& framecount)
+{
+    sendMessage(MSGN_SAVESTATE_INDEX);
+    sendData(&slot, sizeof(int));
+
+    if (!(sc.savestate_settings & SharedConfig::SS_RAM)) {
+        sendMessage(MSGN_SAVESTATE_PATH);
+        sendString(statePath(slot));
+    }
+
+    sendMessage(MSGN_LOADSTATE);
+
+    int message = receiveMessage();
+    bool didLoad = (message == MSGB_LOADING_SUCCEEDED);
+    if (didLoad) {
+        sendMessage(MSGN_CONFIG);
+        sendData(&sc, sizeof(SharedConfig));
+        message = receiveMessage();
+    }
+
+    if (message != MSGB_FRAMECOUNT_TIME) {
+        std::cerr << "Got wrong message after state loading" << std::endl;
+        return false;
+    }
+
+    uint64_t time_sec, time_nsec;
+    receiveData(&framecount, sizeof(uint64_t));
+    receiveData(&time_sec, sizeof(uint64_t));
+    receiveData(&time_nsec, sizeof(uint64_t));
+
+    return didLoad;
+}
+
+uint64_t BenchDriver::stateSize(int slot, const SharedConfig& sc)
+{
+    if (sc.savestate_settings & SharedConfig::SS_RAM)
+        return 0;
+
+    uint64_t size = 0;
+    struct stat sb;
+    if (stat((statePath(slot) + ".pm").c_str(), &sb) == 0)
+        size += sb.st_size;
+    if (stat((statePath(slot) + ".p").c_str(), &sb) == 0)
+        size += sb.st_size;
+    return size;
+}
+
+void BenchDriver::quit(pid_t pid)
+{
+    /* The game may not handle the quit event, so we don't wait for it */
+    closeSocket();
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+    removeSocket();
+
+    for (int i = 0; i < SharedConfig::SS_SLOT_COUNT; i++) {
+        unlink((statePath(i) + ".pm").c_str());
+        unlink((statePath(i) + ".p").c_str());
+    }
+}
+
+double BenchDriver::now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
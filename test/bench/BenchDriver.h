@@ -0,0 +1,78 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBTAS_BENCHDRIVER_H_INCLUDED
+#define LIBTAS_BENCHDRIVER_H_INCLUDED
+
+#include "shared/SharedConfig.h"
+#include "shared/AllInputs.h"
+#include "shared/FrameProfile.h"
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <sys/types.h>
+
+/* Minimal replacement of the libTAS program for benchmarks: it launches a
+ * game with libtas.so preloaded, and speaks the same socket protocol as
+ * GameLoop, without any UI, movie or hotkey. */
+namespace BenchDriver {
+
+    /* Launch the game with libtas.so preloaded and perform the init
+     * messages. Returns the game pid, or -1 on error. */
+    pid_t launch(const std::string& libtaspath, const std::vector<std::string>& args, SharedConfig& sc, const std::string& statedir);
+
+    /* Wait for the next frame boundary, and start it. Returns false if the
+     * game quit or the connection was lost. */
+    bool startFrame(uint64_t& framecount);
+
+    /* End the current frame boundary with empty inputs */
+    void endFrame(const SharedConfig& sc);
+
+    /* End the current frame boundary with the given inputs */
+    void endFrame(const AllInputs& ai);
+
+    /* Time spent in each stage of the previous frame boundary, received at
+     * the last startFrame() if the DEBUG_FRAME_PROFILE flag is set */
+    const FrameProfile& frameProfile();
+
+    /* Save a state in a slot, during a frame boundary. Returns the received
+     * message (MSGB_SAVING_SUCCEEDED on success) */
+    int saveState(int slot, const SharedConfig& sc);
+
+    /* Save the base state (slot 0) of incremental savestates, during a
+     * frame boundary, so that it is not measured with the first state.
+     * Does nothing for other modes. Returns true on success */
+    bool saveBaseState(const SharedConfig& sc);
+
+    /* Load a state from a slot, during a frame boundary. Returns true on
+     * success, and updates the frame count */
+    bool loadState(int slot, const SharedConfig& sc, uint64_t& framecount);
+
+    /* Size of a state stored on disk, or 0 if stored in RAM */
+    uint64_t stateSize(int slot, const SharedConfig& sc);
+
+    /* Kill the game and clean savestates */
+    void quit(pid_t pid);
+
+    /* Current monotonic time in seconds */
+    double now();
+
+}
+
+#endif
@@ -0,0 +1,235 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Frame boundary benchmark: runs the synthetic game fbgame under libtas.so
+ * in fast-forward, feeding it a synthetic movie, and measures how many frames
+ * per second libTAS can sustain, with the time spent in each stage of the
+ * frame boundary.
+ *
+ * fbgame needs an X server and an OpenGL implementation. For stable results,
+ * run on Xvfb with Mesa llvmpipe, like `make bench` does.
+ *
+ * Usage: ./fbbench [-l libtas.so] [-g fbgame] [-m modes] [-n frames]
+ *                  [-W width] [-H height] [-q quads]
+ * Modes are a comma-separated list, run ./fbbench -h for the available
+ * values.
+ */
+
+#include "BenchDriver.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h> // getopt
+
+struct Mode {
+    const char* name;
+    int fastforward_mode;
+    int osd;
+};
+
+static const Mode modes[] = {
+    /* Default fast-forward, which draws a few frames per second */
+    {"fastforward", SharedConfig::FF_SLEEP | SharedConfig::FF_MIXING, 0},
+    /* Same with all OSD elements, to measure the HUD */
+    {"osd", SharedConfig::FF_SLEEP | SharedConfig::FF_MIXING,
+        SharedConfig::OSD_FRAMECOUNT | SharedConfig::OSD_INPUTS | SharedConfig::OSD_MESSAGES},
+    /* No rendering at all, which only leaves the frame boundary overhead */
+    {"norender", SharedConfig::FF_SLEEP | SharedConfig::FF_MIXING | SharedConfig::FF_RENDERING, 0},
+};
+
+static const char* stage_names[FrameProfile::STAGE_COUNT] = {
+    "game", "timer", "audio", "messages", "capture", "hud", "encode", "draw", "inputs"
+};
+
+/* Frames to run before measuring, so that the game is settled */
+#define WARMUP_FRAMES 60
+
+struct Options {
+    std::string libtas = "../../src/library/libtas.so";
+    std::string game = "./fbgame";
+    int frames = 3000;
+    int width = 640;
+    int height = 480;
+    int quads = 100;
+};
+
+static std::vector<std::string> split(const std::string& list)
+{
+    std::vector<std::string> items;
+    std::istringstream iss(list);
+    std::string item;
+    while (std::getline(iss, item, ','))
+        if (!item.empty())
+            items.push_back(item);
+    return items;
+}
+
+/* Inputs of the synthetic movie: a held direction key that changes every
+ * few frames, a key mashed every other frame and a moving pointer, so that
+ * each frame has events to generate. */
+static void movieInputs(uint64_t frame, const SharedConfig& sc, const Options& opt, AllInputs& ai)
+{
+    memset(&ai, 0, sizeof(AllInputs));
+    ai.framerate_num = sc.framerate_num;
+    ai.framerate_den = sc.framerate_den;
+
+    ai.keyboard[0] = ((frame / 16) % 2) ? 0xff53 /* XK_Right */ : 0xff51 /* XK_Left */;
+    if (frame % 2)
+        ai.keyboard[1] = 0x20; // XK_space
+    ai.pointer_x = frame % opt.width;
+    ai.pointer_y = (frame * 3) % opt.height;
+}
+
+static bool runOne(const Options& opt, const Mode& mode)
+{
+    SharedConfig sc;
+    sc.running = true;
+    sc.fastforward = true;
+    sc.fastforward_mode = mode.fastforward_mode;
+    sc.osd = mode.osd;
+    sc.audio_disabled = true;
+    sc.debug_state = SharedConfig::DEBUG_FRAME_PROFILE;
+
+    std::vector<std::string> args = {opt.game, std::to_string(opt.width),
+        std::to_string(opt.height), std::to_string(opt.quads)};
+
+    pid_t pid = BenchDriver::launch(opt.libtas, args, sc, "/tmp");
+    if (pid < 0) {
+        std::cerr << "Could not launch the game" << std::endl;
+        return false;
+    }
+
+    uint64_t framecount = 0;
+    AllInputs ai;
+    FrameProfile total;
+    double start = 0;
+    int measured = 0;
+    bool alive = true;
+
+    for (int f = 0; f < WARMUP_FRAMES + opt.frames; f++) {
+        if (!BenchDriver::startFrame(framecount)) {
+            alive = false;
+            break;
+        }
+
+        if (f == WARMUP_FRAMES)
+            start = BenchDriver::now();
+
+        /* The profile received now is from the previous frame boundary */
+        if (f > WARMUP_FRAMES) {
+            const FrameProfile& profile = BenchDriver::frameProfile();
+            for (int s = 0; s < FrameProfile::STAGE_COUNT; s++)
+                total.ns[s] += profile.ns[s];
+            measured++;
+        }
+
+        movieInputs(framecount, sc, opt, ai);
+        BenchDriver::endFrame(ai);
+    }
+
+    double elapsed = BenchDriver::now() - start;
+    BenchDriver::quit(pid);
+
+    if (!alive) {
+        std::cerr << "Game stopped during " << mode.name << std::endl;
+        return false;
+    }
+
+    uint64_t sum = 0;
+    for (int s = 0; s < FrameProfile::STAGE_COUNT; s++)
+        sum += total.ns[s];
+
+    printf("%-12s %9.1f", mode.name, elapsed > 0 ? (opt.frames / elapsed) : 0.0);
+    for (int s = 0; s < FrameProfile::STAGE_COUNT; s++) {
+        double us = measured ? (total.ns[s] / 1000.0 / measured) : 0;
+        printf(" %9.1f", us);
+    }
+    printf(" %9.1f\n", measured ? (sum / 1000.0 / measured) : 0.0);
+    fflush(stdout);
+
+    return true;
+}
+
+static void usage(const char* name)
+{
+    std::cerr << "Usage: " << name << " [-l libtas.so] [-g fbgame] [-m modes] [-n frames] [-W width] [-H height] [-q quads]" << std::endl;
+    std::cerr << "Modes:";
+    for (const Mode& m : modes)
+        std::cerr << " " << m.name;
+    std::cerr << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    Options opt;
+    std::vector<std::string> selected_modes;
+    for (const Mode& m : modes)
+        selected_modes.push_back(m.name);
+
+    int c;
+    while ((c = getopt(argc, argv, "l:g:m:n:W:H:q:h")) != -1) {
+        switch (c) {
+            case 'l': opt.libtas = optarg; break;
+            case 'g': opt.game = optarg; break;
+            case 'm': selected_modes = split(optarg); break;
+            case 'n': opt.frames = atoi(optarg); break;
+            case 'W': opt.width = atoi(optarg); break;
+            case 'H': opt.height = atoi(optarg); break;
+            case 'q': opt.quads = atoi(optarg); break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    /* The library needs an absolute path to be preloaded from the game */
+    char* path = realpath(opt.libtas.c_str(), nullptr);
+    if (!path) {
+        std::cerr << "Could not find " << opt.libtas << std::endl;
+        return 1;
+    }
+    opt.libtas = path;
+    free(path);
+
+    printf("%d frames at %dx%d with %d quads, stage times in us per frame\n",
+        opt.frames, opt.width, opt.height, opt.quads);
+    printf("%-12s %9s", "mode", "frames/s");
+    for (int s = 0; s < FrameProfile::STAGE_COUNT; s++)
+        printf(" %9s", stage_names[s]);
+    printf(" %9s\n", "total");
+
+    for (const std::string& m : selected_modes) {
+        const Mode* mode = nullptr;
+        for (const Mode& candidate : modes)
+            if (m == candidate.name)
+                mode = &candidate;
+        if (!mode) {
+            std::cerr << "Unknown mode " << m << std::endl;
+            continue;
+        }
+        runOne(opt, *mode);
+    }
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+// Synthetic game for the frame boundary benchmark, to be run by fbbench
+// under libtas.so. It opens a GLX window and loops forever: process X
+// events, draw a number of quads whose color depends on the pressed keys,
+// then swap buffers, which makes libTAS trigger a frame boundary.
+// It is meant to run on Xvfb with Mesa llvmpipe, so that rendering costs
+// are stable between runs.
+//
+// Usage: ./fbgame [width height [quads]]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <X11/Xlib.h>
+#include <GL/gl.h>
+#include <GL/glx.h>
+
+int main(int argc, char **argv)
+{
+    int width = 640;
+    int height = 480;
+    int quads = 100;
+
+    if (argc >= 3) {
+        width = atoi(argv[1]);
+        height = atoi(argv[2]);
+    }
+    if (argc >= 4)
+        quads = atoi(argv[3]);
+
+    Display *display = XOpenDisplay(NULL);
+    if (!display) {
+        fprintf(stderr, "Could not open display\n");
+        return 1;
+    }
+
+    int attribs[] = {GLX_RGBA, GLX_DOUBLEBUFFER, GLX_RED_SIZE, 8,
+        GLX_GREEN_SIZE, 8, GLX_BLUE_SIZE, 8, None};
+    XVisualInfo *vi = glXChooseVisual(display, DefaultScreen(display), attribs);
+    if (!vi) {
+        fprintf(stderr, "No suitable visual\n");
+        return 1;
+    }
+
+    Window root = RootWindow(display, vi->screen);
+    XSetWindowAttributes swa;
+    swa.colormap = XCreateColormap(display, root, vi->visual, AllocNone);
+    swa.event_mask = KeyPressMask | KeyReleaseMask | ExposureMask;
+    Window window = XCreateWindow(display, root, 0, 0, width, height, 0,
+        vi->depth, InputOutput, vi->visual, CWColormap | CWEventMask, &swa);
+    XMapWindow(display, window);
+
+    GLXContext glc = glXCreateContext(display, vi, NULL, GL_TRUE);
+    glXMakeCurrent(display, window, glc);
+    glViewport(0, 0, width, height);
+
+    int pressed = 0;
+    unsigned int frame = 0;
+
+    while (1) {
+        while (XPending(display)) {
+            XEvent event;
+            XNextEvent(display, &event);
+            if (event.type == KeyPress)
+                pressed++;
+            else if ((event.type == KeyRelease) && (pressed > 0))
+                pressed--;
+        }
+
+        glClearColor((frame % 256) / 255.0f, 0.2f, pressed ? 0.8f : 0.2f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        glBegin(GL_QUADS);
+        for (int q = 0; q < quads; q++) {
+            float x = ((q * 37 + frame) % 200) / 100.0f - 1.0f;
+            float y = ((q * 91) % 200) / 100.0f - 1.0f;
+            glColor3f((q % 7) / 7.0f, (q % 5) / 5.0f, pressed / 4.0f);
+            glVertex2f(x, y);
+            glVertex2f(x + 0.1f, y);
+            glVertex2f(x + 0.1f, y + 0.1f);
+            glVertex2f(x, y + 0.1f);
+        }
+        glEnd();
+
+        glXSwapBuffers(display, window);
+        frame++;
+    }
+
+    return 0;
+}
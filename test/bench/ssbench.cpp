@@ -0,0 +1,278 @@
+/*
+    Copyright 2015-2020 Clément Gallet <clement.gallet@ens-lyon.org>
+
+    This file is part of libTAS.
+
+    libTAS is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libTAS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libTAS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Savestate benchmark: runs the synthetic game ssgame under libtas.so for
+ * each workload and savestate mode, and measures the latency of saving and
+ * loading states through the real checkpoint code.
+ *
+ * Usage: ./ssbench [-l libtas.so] [-g ssgame] [-w workloads] [-m modes]
+ *                  [-s size in MB] [-t threads] [-n states] [-f frames]
+ *                  [-d savestate dir]
+ * Workloads and modes are comma-separated lists, run ./ssbench -h for the
+ * available values.
+ */
+
+#include "BenchDriver.h"
+#include "shared/messages.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h> // getopt
+
+struct Mode {
+    const char* name;
+    int settings;
+};
+
+static const Mode modes[] = {
+    {"disk", 0},
+    {"compressed", SharedConfig::SS_COMPRESSED},
+    {"ram", SharedConfig::SS_RAM},
+    {"ram-compressed", SharedConfig::SS_RAM | SharedConfig::SS_COMPRESSED},
+    {"incremental", SharedConfig::SS_INCREMENTAL},
+    {"incremental-ram", SharedConfig::SS_INCREMENTAL | SharedConfig::SS_RAM},
+    {"fork", SharedConfig::SS_FORK},
+    {"fork-compressed", SharedConfig::SS_FORK | SharedConfig::SS_COMPRESSED},
+};
+
+static const char* workloads[] = {"zero", "static", "dirty", "fragmented", "threads"};
+
+/* Frames to run before the first state, so that the game is settled */
+#define WARMUP_FRAMES 10
+
+struct Stats {
+    double mean = 0, median = 0, p95 = 0, max = 0;
+};
+
+static Stats computeStats(std::vector<double> values)
+{
+    Stats stats;
+    if (values.empty())
+        return stats;
+
+    std::sort(values.begin(), values.end());
+    for (double v : values)
+        stats.mean += v;
+    stats.mean /= values.size();
+    stats.median = values[values.size() / 2];
+    stats.p95 = values[(values.size() * 95) / 100 < values.size() ? (values.size() * 95) / 100 : values.size() - 1];
+    stats.max = values.back();
+    return stats;
+}
+
+static std::vector<std::string> split(const std::string& list)
+{
+    std::vector<std::string> items;
+    std::istringstream iss(list);
+    std::string item;
+    while (std::getline(iss, item, ','))
+        if (!item.empty())
+            items.push_back(item);
+    return items;
+}
+
+static bool advance(int frames, const SharedConfig& sc, uint64_t& framecount)
+{
+    for (int f = 0; f < frames; f++) {
+        if (!BenchDriver::startFrame(framecount))
+            return false;
+        BenchDriver::endFrame(sc);
+    }
+    return true;
+}
+
+struct Options {
+    std::string libtas = "../../src/library/libtas.so";
+    std::string game = "./ssgame";
+    std::string dir = "/tmp";
+    int size = 256;
+    int threads = 8;
+    int states = 20;
+    int frames = 5;
+};
+
+static bool runOne(const Options& opt, const std::string& workload, const Mode& mode)
+{
+    SharedConfig sc;
+    sc.running = true;
+    sc.fastforward = true;
+    sc.osd = 0;
+    sc.audio_disabled = true;
+    sc.savestate_settings = mode.settings;
+
+    std::vector<std::string> args = {opt.game, workload, std::to_string(opt.size), std::to_string(opt.threads)};
+
+    pid_t pid = BenchDriver::launch(opt.libtas, args, sc, opt.dir);
+    if (pid < 0) {
+        std::cerr << "Could not launch the game" << std::endl;
+        return false;
+    }
+
+    uint64_t framecount = 0;
+    std::vector<double> save_times, load_times;
+    std::vector<int> saved_slots;
+    uint64_t disk_size = 0;
+    int failures = 0;
+    bool alive = advance(WARMUP_FRAMES, sc, framecount);
+
+    if (alive && BenchDriver::startFrame(framecount)) {
+        if (!BenchDriver::saveBaseState(sc))
+            failures++;
+        BenchDriver::endFrame(sc);
+    }
+    else {
+        alive = false;
+    }
+
+    /* Slot 0 is the incremental base, and keep away from the backtrack slot */
+    for (int i = 0; alive && (i < opt.states); i++) {
+        alive = advance(opt.frames, sc, framecount);
+        if (!alive || !BenchDriver::startFrame(framecount))
+            break;
+
+        int slot = 1 + (i % 9);
+        double start = BenchDriver::now();
+        int message = BenchDriver::saveState(slot, sc);
+        double end = BenchDriver::now();
+
+        if (message == MSGB_SAVING_SUCCEEDED) {
+            save_times.push_back(end - start);
+            if (std::find(saved_slots.begin(), saved_slots.end(), slot) == saved_slots.end())
+                saved_slots.push_back(slot);
+            disk_size += BenchDriver::stateSize(slot, sc);
+        }
+        else {
+            /* In fork mode, the previous state in this slot may not be
+             * written yet */
+            failures++;
+        }
+        BenchDriver::endFrame(sc);
+    }
+
+    for (int i = 0; alive && !saved_slots.empty() && (i < opt.states); i++) {
+        alive = advance(opt.frames, sc, framecount);
+        if (!alive || !BenchDriver::startFrame(framecount))
+            break;
+
+        int slot = saved_slots[i % saved_slots.size()];
+        double start = BenchDriver::now();
+        bool loaded = BenchDriver::loadState(slot, sc, framecount);
+        double end = BenchDriver::now();
+
+        if (loaded)
+            load_times.push_back(end - start);
+        else
+            failures++;
+        BenchDriver::endFrame(sc);
+    }
+
+    BenchDriver::quit(pid);
+
+    if (!alive)
+        std::cerr << "Game stopped during " << workload << "/" << mode.name << std::endl;
+
+    Stats save = computeStats(save_times);
+    Stats load = computeStats(load_times);
+    double throughput = save.mean > 0 ? opt.size / save.mean : 0;
+
+    printf("%-11s %-16s %8.2f %8.2f %8.2f %8.2f | %8.2f %8.2f %8.2f | %9.1f %9.1f %5d\n",
+        workload.c_str(), mode.name,
+        save.mean * 1000, save.median * 1000, save.p95 * 1000, save.max * 1000,
+        load.mean * 1000, load.median * 1000, load.p95 * 1000,
+        throughput,
+        save_times.empty() ? 0.0 : static_cast<double>(disk_size) / save_times.size() / (1024 * 1024),
+        failures);
+    fflush(stdout);
+
+    return alive;
+}
+
+static void usage(const char* name)
+{
+    std::cerr << "Usage: " << name << " [-l libtas.so] [-g ssgame] [-w workloads] [-m modes] [-s size in MB] [-t threads] [-n states] [-f frames] [-d savestate dir]" << std::endl;
+    std::cerr << "Workloads:";
+    for (const char* w : workloads)
+        std::cerr << " " << w;
+    std::cerr << std::endl << "Modes:";
+    for (const Mode& m : modes)
+        std::cerr << " " << m.name;
+    std::cerr << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    Options opt;
+    std::vector<std::string> selected_workloads(std::begin(workloads), std::end(workloads));
+    std::vector<std::string> selected_modes;
+    for (const Mode& m : modes)
+        selected_modes.push_back(m.name);
+
+    int c;
+    while ((c = getopt(argc, argv, "l:g:w:m:s:t:n:f:d:h")) != -1) {
+        switch (c) {
+            case 'l': opt.libtas = optarg; break;
+            case 'g': opt.game = optarg; break;
+            case 'w': selected_workloads = split(optarg); break;
+            case 'm': selected_modes = split(optarg); break;
+            case 's': opt.size = atoi(optarg); break;
+            case 't': opt.threads = atoi(optarg); break;
+            case 'n': opt.states = atoi(optarg); break;
+            case 'f': opt.frames = atoi(optarg); break;
+            case 'd': opt.dir = optarg; break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    /* The library needs an absolute path to be preloaded from the game */
+    char* path = realpath(opt.libtas.c_str(), nullptr);
+    if (!path) {
+        std::cerr << "Could not find " << opt.libtas << std::endl;
+        return 1;
+    }
+    opt.libtas = path;
+    free(path);
+
+    printf("Working set: %d MB, %d states every %d frames\n", opt.size, opt.states, opt.frames);
+    printf("%-11s %-16s %8s %8s %8s %8s | %8s %8s %8s | %9s %9s %5s\n",
+        "workload", "mode", "save ms", "median", "p95", "max",
+        "load ms", "median", "p95", "MB/s", "disk MB", "fail");
+
+    for (const std::string& w : selected_workloads) {
+        for (const std::string& m : selected_modes) {
+            const Mode* mode = nullptr;
+            for (const Mode& candidate : modes)
+                if (m == candidate.name)
+                    mode = &candidate;
+            if (!mode) {
+                std::cerr << "Unknown mode " << m << std::endl;
+                continue;
+            }
+            runOne(opt, w, *mode);
+        }
+    }
+
+    return 0;
+}
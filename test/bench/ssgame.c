@@ -0,0 +1,196 @@
+// Synthetic game for the savestate benchmark, to be run by ssbench under
+// libtas.so. It allocates a working set with a specific memory pattern, then
+// loops forever: modify the working set, then sleep for one frame, which
+// makes libTAS trigger a (non-draw) frame boundary.
+//
+// Usage: ./ssgame <workload> <size in MB> <thread count>
+// Workloads:
+//   zero: pages are present but mostly filled with zeros
+//   static: random content that is never modified after startup
+//   dirty: random content, a quarter of the pages are rewritten each frame
+//   fragmented: many small mappings that the kernel cannot merge
+//   threads: like dirty, but the working set is split between threads
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#define MAX_THREADS 64
+
+static size_t page_size;
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t next_random(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+static void fill_random(char *addr, size_t size, uint64_t *state)
+{
+    uint64_t *p = (uint64_t*) addr;
+    for (size_t i = 0; i < size / sizeof(uint64_t); i++)
+        p[i] = next_random(state);
+}
+
+/* Rewrite one page out of `ratio`, starting at a different page each frame */
+static void dirty_pages(char *addr, size_t size, int ratio, uint64_t frame, uint64_t *state)
+{
+    size_t pages = size / page_size;
+    for (size_t i = frame % ratio; i < pages; i += ratio)
+        fill_random(addr + i * page_size, page_size, state);
+}
+
+static char *alloc_area(size_t size)
+{
+    char *addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED) {
+        perror("mmap");
+        exit(1);
+    }
+    return addr;
+}
+
+/* Fragmented workload: two-page mappings with alternating protections */
+#define FRAGMENT_PAGES 2
+static char **fragments;
+static size_t fragment_count;
+
+/* Threads workload */
+struct worker {
+    pthread_t thread;
+    char *addr;
+    size_t size;
+    uint64_t state;
+};
+static struct worker workers[MAX_THREADS];
+static int worker_count;
+static uint64_t worker_frame;
+static int workers_done;
+static pthread_mutex_t worker_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t frame_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+
+static void *worker_main(void *arg)
+{
+    struct worker *w = arg;
+    uint64_t frame = 0;
+
+    fill_random(w->addr, w->size, &w->state);
+
+    while (1) {
+        pthread_mutex_lock(&worker_mutex);
+        while (worker_frame == frame)
+            pthread_cond_wait(&frame_cond, &worker_mutex);
+        frame = worker_frame;
+        pthread_mutex_unlock(&worker_mutex);
+
+        dirty_pages(w->addr, w->size, 4, frame, &w->state);
+
+        pthread_mutex_lock(&worker_mutex);
+        workers_done++;
+        pthread_cond_signal(&done_cond);
+        pthread_mutex_unlock(&worker_mutex);
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <zero|static|dirty|fragmented|threads> <size in MB> [thread count]\n", argv[0]);
+        return 1;
+    }
+
+    const char *workload = argv[1];
+    size_t size = (size_t) atol(argv[2]) * 1024 * 1024;
+    int threads = (argc > 3) ? atoi(argv[3]) : 8;
+    page_size = sysconf(_SC_PAGESIZE);
+
+    char *area = NULL;
+
+    if (strcmp(workload, "zero") == 0) {
+        area = alloc_area(size);
+        memset(area, 0, size);
+        /* A few pages with content */
+        for (size_t off = 0; off < size; off += 64 * page_size)
+            fill_random(area + off, page_size, &rng_state);
+    }
+    else if ((strcmp(workload, "static") == 0) || (strcmp(workload, "dirty") == 0)) {
+        area = alloc_area(size);
+        fill_random(area, size, &rng_state);
+    }
+    else if (strcmp(workload, "fragmented") == 0) {
+        size_t fragment_size = FRAGMENT_PAGES * page_size;
+        fragment_count = size / fragment_size;
+        fragments = malloc(fragment_count * sizeof(char*));
+        for (size_t i = 0; i < fragment_count; i++) {
+            fragments[i] = alloc_area(fragment_size);
+            fill_random(fragments[i], fragment_size, &rng_state);
+            /* Prevent neighbour mappings from being merged */
+            if (i % 2)
+                mprotect(fragments[i], fragment_size, PROT_READ);
+        }
+    }
+    else if (strcmp(workload, "threads") == 0) {
+        if (threads < 1)
+            threads = 1;
+        if (threads > MAX_THREADS)
+            threads = MAX_THREADS;
+        worker_count = threads;
+        for (int i = 0; i < worker_count; i++) {
+            workers[i].size = size / worker_count;
+            workers[i].addr = alloc_area(workers[i].size);
+            workers[i].state = rng_state + i;
+            pthread_create(&workers[i].thread, NULL, worker_main, &workers[i]);
+        }
+    }
+    else {
+        fprintf(stderr, "Unknown workload %s\n", workload);
+        return 1;
+    }
+
+    struct timespec frame_time = {0, 1000000000L / 60};
+
+    for (uint64_t frame = 1; ; frame++) {
+        if (strcmp(workload, "zero") == 0) {
+            /* Modify the pages with content */
+            for (size_t off = (frame % 4) * 64 * page_size; off < size; off += 256 * page_size)
+                area[off] = (char) frame;
+        }
+        else if (strcmp(workload, "static") == 0) {
+            area[0] = (char) frame;
+        }
+        else if (strcmp(workload, "dirty") == 0) {
+            dirty_pages(area, size, 4, frame, &rng_state);
+        }
+        else if (strcmp(workload, "fragmented") == 0) {
+            /* Only writable fragments, one out of 8 */
+            for (size_t i = (frame % 4) * 2; i < fragment_count; i += 8)
+                fill_random(fragments[i], FRAGMENT_PAGES * page_size, &rng_state);
+        }
+        else if (worker_count) {
+            pthread_mutex_lock(&worker_mutex);
+            workers_done = 0;
+            worker_frame = frame;
+            pthread_cond_broadcast(&frame_cond);
+            while (workers_done < worker_count)
+                pthread_cond_wait(&done_cond, &worker_mutex);
+            pthread_mutex_unlock(&worker_mutex);
+        }
+
+        nanosleep(&frame_time, NULL);
+    }
+
+    return 0;
+}